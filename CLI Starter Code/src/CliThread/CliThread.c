@@ -58,9 +58,141 @@ static const CLI_Command_Definition_t xTicksCommand =
     0                                  /**< Number of expected parameters */
 };
 
+/// Console statistics command definition.
+static const CLI_Command_Definition_t xConsoleStatsCommand =
+{
+    "constats",                        /**< Command name */
+    "constats:\r\n Prints the serial console transfer counters.\r\n", /**< Help text */
+    CLI_ConsoleStatsCommand,           /**< Callback function pointer */
+    0                                  /**< Number of expected parameters */
+};
+
+/// Echo mode command definition.
+static const CLI_Command_Definition_t xEchoCommand =
+{
+    "echo",                            /**< Command name */
+    "echo [isr|task|off]:\r\n Shows or sets who echoes typed characters.\r\n", /**< Help text */
+    CLI_EchoCommand,                   /**< Callback function pointer */
+    -1                                 /**< Number of expected parameters (0 or 1) */
+};
+
+/// Baud rate command definition.
+static const CLI_Command_Definition_t xBaudCommand =
+{
+    "baud",                            /**< Command name */
+    "baud [rate]:\r\n Shows the baud rate and throughput, or switches the rate. The switch\r\n"
+    " must be confirmed by pressing Enter at the new rate, else the start-up rate is restored.\r\n", /**< Help text */
+    CLI_BaudCommand,                   /**< Callback function pointer */
+    -1                                 /**< Number of expected parameters (0 or 1) */
+};
+
+/// Power command definition.
+static const CLI_Command_Definition_t xPowerCommand =
+{
+    "power",                           /**< Command name */
+    "power:\r\n Prints the time spent in standby, the estimated average current and the\r\n"
+    " console start-bit wakeups.\r\n", /**< Help text */
+    CLI_PowerCommand,                  /**< Callback function pointer */
+    0                                  /**< Number of expected parameters */
+};
+
+/// Log statistics command definition.
+static const CLI_Command_Definition_t xLogStatsCommand =
+{
+    "logstats",                        /**< Command name */
+    "logstats:\r\n Prints the CPU cycles spent per LogMessage call and the log buffer\r\n"
+    " and logger counters.\r\n",     /**< Help text */
+    CLI_LogStatsCommand,               /**< Callback function pointer */
+    0                                  /**< Number of expected parameters */
+};
+
+/// Log level command definition.
+static const CLI_Command_Definition_t xLogLevelCommand =
+{
+    "loglevel",                        /**< Command name */
+    "loglevel [module] [level]:\r\n Shows the log level of every module, or sets the level of one\r\n"
+    " module (app, console, cli, link), of the uart sink, or of all modules (info, debug, warning,\r\n"
+    " error, fatal, off).\r\n", /**< Help text */
+    CLI_LogLevelCommand,               /**< Callback function pointer */
+    -1                                 /**< Number of expected parameters (0 to 2) */
+};
+
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+/// Log buffer command definition.
+static const CLI_Command_Definition_t xDmesgCommand =
+{
+    "dmesg",                           /**< Command name */
+    "dmesg [-l level] [-n N] [-f]:\r\n Prints the log buffer, or its last N messages at level and\r\n"
+    " above. With -f, keeps printing new messages until Enter is pressed.\r\n", /**< Help text */
+    CLI_DmesgCommand,                  /**< Callback function pointer */
+    -1                                 /**< Number of expected parameters (0 to 5) */
+};
+#endif
+
+#if CONF_SERIAL_CONSOLE_CRASH_LOG
+/// Crash record command definition.
+static const CLI_Command_Definition_t xCrashLogCommand =
+{
+    "crashlog",                        /**< Command name */
+    "crashlog [clear]:\r\n Prints the fault record and last log messages kept from the previous\r\n"
+    " run, or forgets them.\r\n",    /**< Help text */
+    CLI_CrashLogCommand,               /**< Callback function pointer */
+    -1                                 /**< Number of expected parameters (0 or 1) */
+};
+#endif
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+/// Receive timing command definition.
+static const CLI_Command_Definition_t xRxTimingCommand =
+{
+    "rxtime",                          /**< Command name */
+    "rxtime [reset]:\r\n Prints the console receive latency, reader wakeup and inter-byte gap\r\n"
+    " histograms (us), or clears them.\r\n", /**< Help text */
+    CLI_RxTimingCommand,               /**< Callback function pointer */
+    -1                                 /**< Number of expected parameters (0 or 1) */
+};
+#endif
+
+#if CONF_SERIAL_CONSOLE_LINK
+/// Link statistics command definition.
+static const CLI_Command_Definition_t xLinkStatsCommand =
+{
+    "link",                            /**< Command name */
+    "link [n]:\r\n Prints the frame counters and goodput of the console link. With n, drops\r\n"
+    " every nth reliable frame to exercise the retransmissions (0 stops).\r\n", /**< Help text */
+    CLI_LinkStatsCommand,              /**< Callback function pointer */
+    -1                                 /**< Number of expected parameters (0 or 1) */
+};
+
+/// Dummy game data command definition.
+static const CLI_Command_Definition_t xGameCommand =
+{
+    "game",                            /**< Command name */
+    "game [count]:\r\n Streams count dummy game data packets over the reliable link channel.\r\n", /**< Help text */
+    CLI_SendDummyGameData,             /**< Callback function pointer */
+    -1                                 /**< Number of expected parameters (0 or 1) */
+};
+#endif
+
+/// Names of the echo modes, indexed by enum eEchoMode.
+static const char *const pcEchoModeNames[] = { "isr", "task", "off" };
+
+/// Names of the log levels, indexed by enum eDebugLogLevels.
+static const char *const pcLogLevelNames[N_DEBUG_LEVELS] = { "info", "debug", "warning", "error", "fatal", "off" };
+
+/// Names of the log modules, indexed by enum eLogModule.
+static const char *const pcLogModuleNames[N_LOG_MODULES] = { "app", "console", "cli", "link" };
+
+#if CONF_SERIAL_CONSOLE_CRASH_LOG
+/// Names of the crash reasons, indexed by enum eCrashReason.
+static const char *const pcCrashReasonNames[N_CRASH_REASONS] = { "none", "malloc failed", "stack overflow",
+                                                                 "hard fault", "assert" };
+#endif
+
 /******************************************************************************/
 /* Forward Declarations                                                       */
 /******************************************************************************/
+#if !CONF_SERIAL_CONSOLE_LINE_MODE
 /**
  * @brief Blocks until a character is available from the UART.
  *
@@ -71,6 +203,35 @@ static const CLI_Command_Definition_t xTicksCommand =
  *                       character will be stored.
  */
 static void FreeRTOS_read(char *character);
+#endif
+
+/**
+ * @brief Runs a command line through the CLI interpreter and prints its output.
+ *
+ * @param[in] pcCommand Null-terminated command line.
+ */
+static void CLI_ProcessCommand(const char *pcCommand);
+
+/**
+ * @brief Looks a command parameter up in a table of names, ignoring case.
+ *
+ * @param[in] names       Table of names.
+ * @param[in] count       Number of names.
+ * @param[in] pcParameter The parameter, not terminated.
+ * @param[in] len         Length of the parameter.
+ * @return Index of the name, or count if none matches.
+ */
+static size_t CLI_FindName(const char *const *names, size_t count, const char *pcParameter, BaseType_t len);
+
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+/**
+ * @brief Waits for the key that ends "dmesg -f".
+ *
+ * @param[in] timeout Ticks to wait.
+ * @return true if Enter (any key in raw mode) was pressed; the input is discarded.
+ */
+static bool CLI_WaitForStop(TickType_t timeout);
+#endif
 
 /******************************************************************************/
 /* CLI Thread                                                                 */
@@ -78,8 +239,10 @@ static void FreeRTOS_read(char *character);
 /**
  * @brief Task that handles the Command Line Interface (CLI).
  *
- * This task registers CLI commands, waits for user input character by character,
- * and processes complete command strings when a newline is received.
+ * This task registers CLI commands and processes complete command strings.
+ * In cooked mode (CONF_SERIAL_CONSOLE_LINE_MODE) the receive path assembles
+ * and echoes the line and the task only wakes once it is complete; otherwise
+ * the task reads and edits the input character by character.
  *
  * @param[in] pvParameters Pointer to task parameters (unused).
  */
@@ -90,19 +253,50 @@ void vCommandConsoleTask(void *pvParameters)
     FreeRTOS_CLIRegisterCommand(&xResetCommand);
     FreeRTOS_CLIRegisterCommand(&xVersionCommand);
     FreeRTOS_CLIRegisterCommand(&xTicksCommand);
+    FreeRTOS_CLIRegisterCommand(&xConsoleStatsCommand);
+    FreeRTOS_CLIRegisterCommand(&xEchoCommand);
+    FreeRTOS_CLIRegisterCommand(&xBaudCommand);
+    FreeRTOS_CLIRegisterCommand(&xPowerCommand);
+    FreeRTOS_CLIRegisterCommand(&xLogStatsCommand);
+    FreeRTOS_CLIRegisterCommand(&xLogLevelCommand);
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+    FreeRTOS_CLIRegisterCommand(&xDmesgCommand);
+#endif
+#if CONF_SERIAL_CONSOLE_CRASH_LOG
+    FreeRTOS_CLIRegisterCommand(&xCrashLogCommand);
+#endif
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+    FreeRTOS_CLIRegisterCommand(&xRxTimingCommand);
+#endif
+#if CONF_SERIAL_CONSOLE_LINK
+    FreeRTOS_CLIRegisterCommand(&xLinkStatsCommand);
+    FreeRTOS_CLIRegisterCommand(&xGameCommand);
+#endif
+
+    /* Input buffer is declared static to keep it off the stack. */
+    static char pcInputString[MAX_INPUT_LENGTH_CLI];
+
+    /* Send a welcome message to the user to indicate the connection. */
+    SerialConsoleWriteString(pcWelcomeMessage);
 
+#if CONF_SERIAL_CONSOLE_LINE_MODE
+    for (;;)
+    {
+        /* Blocks until the receive path has assembled a whole line */
+        SerialConsoleReadLine(pcInputString, MAX_INPUT_LENGTH_CLI);
+        if (SerialConsoleGetEchoMode() == ECHO_MODE_TASK)
+        {
+            SerialConsolePrintf("%s\r\n", pcInputString);
+        }
+        CLI_ProcessCommand(pcInputString);
+    }
+#else
     uint8_t cRxedChar[2], cInputIndex = 0;
-    BaseType_t xMoreDataToFollow;
-    /* Input and output buffers are declared static to keep them off the stack. */
-    static char pcOutputString[MAX_OUTPUT_LENGTH_CLI], pcInputString[MAX_INPUT_LENGTH_CLI];
     static char pcLastCommand[MAX_INPUT_LENGTH_CLI];
     static bool isEscapeCode = false;
     static char pcEscapeCodes[4];
     static uint8_t pcEscapeCodePos = 0;
 
-    /* Send a welcome message to the user to indicate the connection. */
-    SerialConsoleWriteString(pcWelcomeMessage);
-    char rxChar;
     for (;;)
     {
         /* Read a single character. The task blocks until a character is received. */
@@ -111,7 +305,10 @@ void vCommandConsoleTask(void *pvParameters)
         if (cRxedChar[0] == '\n' || cRxedChar[0] == '\r')
         {
             /* Newline received: process the complete command string. */
-            SerialConsoleWriteString("\r\n");
+            if (SerialConsoleGetEchoMode() != ECHO_MODE_OFF)
+            {
+                SerialConsoleWriteString("\r\n");
+            }
             /* Save the last command */
             isEscapeCode = false;
             pcEscapeCodePos = 0;
@@ -119,19 +316,7 @@ void vCommandConsoleTask(void *pvParameters)
             pcLastCommand[MAX_INPUT_LENGTH_CLI - 1] = 0; // Ensure null termination
 
             /* Process command string using the CLI command interpreter */
-            do
-            {
-                xMoreDataToFollow = FreeRTOS_CLIProcessCommand(
-                    pcInputString,        /**< Command string */
-                    pcOutputString,       /**< Output buffer */
-                    MAX_OUTPUT_LENGTH_CLI /**< Size of output buffer */
-                );
-
-                /* Output the generated response */
-                pcOutputString[MAX_OUTPUT_LENGTH_CLI - 1] = 0;
-                SerialConsoleWriteString(pcOutputString);
-
-            } while (xMoreDataToFollow != pdFALSE);
+            CLI_ProcessCommand(pcInputString);
 
             /* Clear the input buffer for the next command */
             cInputIndex = 0;
@@ -157,14 +342,15 @@ void vCommandConsoleTask(void *pvParameters)
                     /* If UP arrow is detected, show last command */
                     if (strcasecmp(pcEscapeCodes, "oa"))
                     {
-                        sprintf(pcInputString, "%c[2K\r>", 27);
-                        SerialConsoleWriteString(pcInputString);
                         cInputIndex = 0;
                         memset(pcInputString, 0x00, MAX_INPUT_LENGTH_CLI);
                         strncpy(pcInputString, pcLastCommand, MAX_INPUT_LENGTH_CLI - 1);
                         cInputIndex = (strlen(pcInputString) < MAX_INPUT_LENGTH_CLI - 1) ?
                                         strlen(pcLastCommand) : MAX_INPUT_LENGTH_CLI - 1;
-                        SerialConsoleWriteString(pcInputString);
+                        if (SerialConsoleGetEchoMode() != ECHO_MODE_OFF)
+                        {
+                            SerialConsolePrintf("%c[2K\r>%s", ASCII_ESC, pcInputString);
+                        }
                     }
 
                     isEscapeCode = false;
@@ -177,8 +363,10 @@ void vCommandConsoleTask(void *pvParameters)
             }
             else if (cRxedChar[0] == ASCII_BACKSPACE || cRxedChar[0] == ASCII_DELETE)
             {
-                char erase[4] = {0x08, 0x20, 0x08, 0x00};
-                SerialConsoleWriteString(erase);
+                if (SerialConsoleGetEchoMode() == ECHO_MODE_TASK)
+                {
+                    SerialConsoleWrite((const uint8_t *)"\b \b", 3);
+                }
                 if (cInputIndex > 0)
                 {
                     cInputIndex--;
@@ -198,13 +386,105 @@ void vCommandConsoleTask(void *pvParameters)
                     pcInputString[cInputIndex] = cRxedChar[0];
                     cInputIndex++;
                 }
-                cRxedChar[1] = 0;
-                SerialConsoleWriteString((char *)&cRxedChar[0]);
+                if (SerialConsoleGetEchoMode() == ECHO_MODE_TASK)
+                {
+                    SerialConsoleWrite(cRxedChar, 1);
+                }
             }
         }
     }
+#endif
+}
+
+/**************************************************************************//**
+ * @fn          static void CLI_ProcessCommand(const char *pcCommand)
+ * @brief       Runs a command line through the CLI interpreter and prints its output.
+ * @param[in]   pcCommand Null-terminated command line.
+ * @return      None.
+ *****************************************************************************/
+static void CLI_ProcessCommand(const char *pcCommand)
+{
+    /* Output buffer is declared static to keep it off the stack. */
+    static char pcOutputString[MAX_OUTPUT_LENGTH_CLI];
+    BaseType_t xMoreDataToFollow;
+
+    do
+    {
+        xMoreDataToFollow = FreeRTOS_CLIProcessCommand(
+            pcCommand,            /**< Command string */
+            pcOutputString,       /**< Output buffer */
+            MAX_OUTPUT_LENGTH_CLI /**< Size of output buffer */
+        );
+
+        /* Output the generated response */
+        pcOutputString[MAX_OUTPUT_LENGTH_CLI - 1] = 0;
+        SerialConsoleWriteString(pcOutputString);
+
+    } while (xMoreDataToFollow != pdFALSE);
+}
+
+/**************************************************************************//**
+ * @fn          static size_t CLI_FindName(const char *const *names, size_t count,
+ *                                         const char *pcParameter, BaseType_t len)
+ * @brief       Looks a command parameter up in a table of names, ignoring case.
+ * @param[in]   names Table of names.
+ * @param[in]   count Number of names.
+ * @param[in]   pcParameter The parameter, not terminated.
+ * @param[in]   len Length of the parameter.
+ * @return      Index of the name, or count if none matches.
+ *****************************************************************************/
+static size_t CLI_FindName(const char *const *names, size_t count, const char *pcParameter, BaseType_t len)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (strlen(names[i]) == (size_t)len && strncasecmp(pcParameter, names[i], (size_t)len) == 0)
+        {
+            break;
+        }
+    }
+
+    return i;
 }
 
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+/**************************************************************************//**
+ * @fn          static bool CLI_WaitForStop(TickType_t timeout)
+ * @brief       Waits for the key that ends "dmesg -f".
+ * @details     In cooked mode the line typed is discarded. In raw mode a lone LF is
+ *              the end of the CR LF that ran the command, not a key press.
+ * @param[in]   timeout Ticks to wait.
+ * @return      true if the follow should end.
+ *****************************************************************************/
+static bool CLI_WaitForStop(TickType_t timeout)
+{
+#if CONF_SERIAL_CONSOLE_LINE_MODE
+    char line[2];
+
+    if (!SerialConsoleWaitForLine(timeout))
+    {
+        return false;
+    }
+    SerialConsoleReadLine(line, sizeof(line));
+    return true;
+#else
+    uint8_t c;
+    bool stop = false;
+
+    if (SerialConsoleWaitForInput(timeout))
+    {
+        while (SerialConsoleRead(&c, 1) == 1)
+        {
+            stop = stop || (c != '\n');
+        }
+    }
+    return stop;
+#endif
+}
+#endif
+
+#if !CONF_SERIAL_CONSOLE_LINE_MODE
 /**************************************************************************//**
  * @fn          static void FreeRTOS_read(char *character)
  * @brief       Blocks until a character is available from the UART.
@@ -213,17 +493,24 @@ void vCommandConsoleTask(void *pvParameters)
  *****************************************************************************/
 static void FreeRTOS_read(char *character)
 {
-    /* Block until a character is available (the semaphore is given in the USART callback) */
-    if (xSemaphoreTake(xSemaphore, portMAX_DELAY) == pdTRUE)
+    static uint8_t rxChunk[CLI_RX_CHUNK_SIZE];
+    static size_t rxChunkLen = 0, rxChunkPos = 0;
+
+    /* The console signals once per received burst, so drain the RX buffer
+     * a chunk at a time and only block when it is empty. */
+    while (rxChunkPos == rxChunkLen)
     {
-        /* Retrieve the character from the circular RX buffer */
-        if (circular_buf_get(cbufRx, (uint8_t *)character) == -1)
+        rxChunkPos = 0;
+        rxChunkLen = SerialConsoleRead(rxChunk, sizeof(rxChunk));
+        if (rxChunkLen == 0)
         {
-            /* In the unlikely event the buffer is empty, set the character to null */
-            *character = '\0';
+            SerialConsoleWaitForInput(portMAX_DELAY);
         }
     }
+
+    *character = (char)rxChunk[rxChunkPos++];
 }
+#endif
 
 /******************************************************************************/
 /* CLI Functions                                                              */
@@ -291,3 +578,728 @@ BaseType_t CLI_TicksCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const
     snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Ticks: %lu\r\n", (unsigned long)ticks);
     return pdFALSE;
 }
+
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_ConsoleStatsCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                                    const int8_t *pcCommandString)
+ * @brief       Prints the serial console transfer counters.
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string (unused).
+ * @return      pdTRUE while more lines follow, pdFALSE after the last one.
+ *****************************************************************************/
+BaseType_t CLI_ConsoleStatsCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    static uint8_t line = 0;
+    static struct SerialChannelStats stats;
+    unsigned long perKiB;
+
+    if (line == 0)
+    {
+        SerialConsoleGetStats(&stats);
+    }
+
+    switch (line++)
+    {
+    case 0:
+        /* Interrupts per transmitted KiB, in hundredths */
+        perKiB = (stats.txBytes != 0) ?
+                 (unsigned long)(((uint64_t)stats.txInterrupts * 102400) / stats.txBytes) : 0;
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "TX: %lu B, %lu irq (%lu.%02lu/KiB), %lu blk, %lu err, %lu drop\r\n",
+                 (unsigned long)stats.txBytes, (unsigned long)stats.txInterrupts, perKiB / 100, perKiB % 100,
+                 (unsigned long)stats.txDmaBlocks, (unsigned long)stats.txDmaErrors,
+                 (unsigned long)stats.txDropped);
+        return pdTRUE;
+
+    case 1:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "TX full: %lu msg dropped (%lu oldest), %lu blocked\r\n",
+                 (unsigned long)stats.txDroppedMessages, (unsigned long)stats.txEvictedMessages,
+                 (unsigned long)stats.txBlockedWrites);
+        return pdTRUE;
+
+    case 2:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "TX lanes: urgent %lu B (peak %lu), bulk %lu B (peak %lu), %lu urgent msg, %lu preempt\r\n",
+                 (unsigned long)stats.txQueued[TX_LANE_URGENT], (unsigned long)stats.txQueuedPeak[TX_LANE_URGENT],
+                 (unsigned long)stats.txQueued[TX_LANE_BULK], (unsigned long)stats.txQueuedPeak[TX_LANE_BULK],
+                 (unsigned long)stats.txUrgentMessages, (unsigned long)stats.txPreemptions);
+        return pdTRUE;
+
+    case 3:
+        /* Consumer wakeups per received KiB, in hundredths */
+        perKiB = (stats.rxBytes != 0) ?
+                 (unsigned long)(((uint64_t)stats.rxWakeups * 102400) / stats.rxBytes) : 0;
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "RX: %lu B, %lu wake (%lu.%02lu/KiB, %lu idle), %lu ovr, %lu err\r\n",
+                 (unsigned long)stats.rxBytes, (unsigned long)stats.rxWakeups, perKiB / 100, perKiB % 100,
+                 (unsigned long)stats.rxIdleWakeups, (unsigned long)stats.rxOverruns,
+                 (unsigned long)stats.rxDmaErrors);
+        return pdTRUE;
+
+    case 4:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "RX lines: %lu, %lu chars dropped\r\n",
+                 (unsigned long)stats.rxLines, (unsigned long)stats.rxLineDrops);
+        return pdTRUE;
+
+    case 5:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "RX errors: %lu framing, %lu parity, %lu overflow\r\n",
+                 (unsigned long)stats.rxFramingErrors, (unsigned long)stats.rxParityErrors,
+                 (unsigned long)stats.rxBufferOverflows);
+        return pdTRUE;
+
+    case 6:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "Flow: RTS %lu paused, %lu resumed; CTS %lu paused\r\n",
+                 (unsigned long)stats.rxFlowPauses, (unsigned long)stats.rxFlowResumes,
+                 (unsigned long)stats.txFlowPauses);
+        return pdTRUE;
+
+    default:
+    {
+        /* SERCOM handler cycles per byte moved, in hundredths (ISR profiling only) */
+        unsigned long perByte = (stats.isrBytes != 0) ?
+                                (unsigned long)((stats.isrCycles * 100) / stats.isrBytes) : 0;
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "SERCOM ISR: %lu calls, %lu B, %lu.%02lu cyc/B\r\n",
+                 (unsigned long)stats.isrCalls, (unsigned long)stats.isrBytes, perByte / 100, perByte % 100);
+        line = 0;
+        return pdFALSE;
+    }
+    }
+}
+
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_EchoCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                            const int8_t *pcCommandString)
+ * @brief       Shows or sets the console echo mode (isr, task or off).
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string, with the optional mode as first parameter.
+ * @return      pdFALSE after the command has been processed.
+ *****************************************************************************/
+BaseType_t CLI_EchoCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    BaseType_t xParameterLen = 0;
+    const char *pcParameter = FreeRTOS_CLIGetParameter((const char *)pcCommandString, 1, &xParameterLen);
+
+    if (pcParameter != NULL)
+    {
+        size_t mode = CLI_FindName(pcEchoModeNames, sizeof(pcEchoModeNames) / sizeof(pcEchoModeNames[0]), pcParameter,
+                                   xParameterLen);
+        if (mode == sizeof(pcEchoModeNames) / sizeof(pcEchoModeNames[0]))
+        {
+            snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Unknown echo mode, use isr, task or off\r\n");
+            return pdFALSE;
+        }
+        SerialConsoleSetEchoMode((enum eEchoMode)mode);
+    }
+
+    snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Echo: %s\r\n", pcEchoModeNames[SerialConsoleGetEchoMode()]);
+    return pdFALSE;
+}
+
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_BaudCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                            const int8_t *pcCommandString)
+ * @brief       Shows the console baud rate and throughput, or switches the rate.
+ * @details     The announcement goes out at the old rate. The peer then has
+ *              CONF_SERIAL_CONSOLE_BAUD_CONFIRM_MS to answer at the new rate,
+ *              else both sides fall back to the start-up rate.
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string, with the optional rate as first parameter.
+ * @return      pdFALSE after the command has been processed.
+ *****************************************************************************/
+BaseType_t CLI_BaudCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    BaseType_t xParameterLen = 0;
+    const char *pcParameter = FreeRTOS_CLIGetParameter((const char *)pcCommandString, 1, &xParameterLen);
+    uint32_t txRate, rxRate;
+
+    if (pcParameter != NULL)
+    {
+        uint32_t baudRate = (uint32_t)strtoul(pcParameter, NULL, 10);
+
+        SerialConsolePrintf("Switching to %lu baud, press Enter within %u ms\r\n", (unsigned long)baudRate,
+                            (unsigned)CONF_SERIAL_CONSOLE_BAUD_CONFIRM_MS);
+        if (!SerialConsoleNegotiateBaudRate(baudRate, pdMS_TO_TICKS(CONF_SERIAL_CONSOLE_BAUD_CONFIRM_MS)))
+        {
+            snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Not confirmed, baud: %lu\r\n",
+                     (unsigned long)SerialConsoleGetBaudRate());
+            return pdFALSE;
+        }
+    }
+
+    /* 10 bits per byte on the wire (8N1) */
+    SerialConsoleGetThroughput(&txRate, &rxRate);
+    snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Baud: %lu (%lu B/s line), TX %lu B/s, RX %lu B/s\r\n",
+             (unsigned long)SerialConsoleGetBaudRate(), (unsigned long)(SerialConsoleGetBaudRate() / 10),
+             (unsigned long)txRate, (unsigned long)rxRate);
+    return pdFALSE;
+}
+
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_PowerCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                             const int8_t *pcCommandString)
+ * @brief       Prints the standby counters and the estimated average current.
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string (unused).
+ * @return      pdTRUE while more lines follow, pdFALSE after the last one.
+ *****************************************************************************/
+BaseType_t CLI_PowerCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    static uint8_t line = 0;
+    static struct SerialConsoleStandbyStats stats;
+    unsigned long permille;
+
+    if (line == 0)
+    {
+        SerialConsoleGetStandbyStats(&stats);
+    }
+
+    switch (line++)
+    {
+    case 0:
+        permille = (stats.uptimeMs != 0) ? (unsigned long)(stats.asleepUs / stats.uptimeMs) : 0;
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "Standby: %lu sleeps (%lu aborted), %lu.%lu%% of %lu s asleep\r\n",
+                 (unsigned long)stats.sleeps, (unsigned long)stats.aborts, permille / 10, permille % 10,
+                 (unsigned long)(stats.uptimeMs / 1000));
+        return pdTRUE;
+
+    case 1:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Estimated average current: %lu uA\r\n",
+                 (unsigned long)stats.averageUa);
+        return pdTRUE;
+
+    default:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Start-bit wakeups: %lu, %lu first bytes missed\r\n",
+                 (unsigned long)stats.rxStartWakeups, (unsigned long)stats.rxWakeMissed);
+        line = 0;
+        return pdFALSE;
+    }
+}
+
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_LogStatsCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                                const int8_t *pcCommandString)
+ * @brief       Prints the cost of LogMessage and the log buffer and logger counters.
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string (unused).
+ * @return      pdTRUE while more lines follow, pdFALSE after the last one.
+ *****************************************************************************/
+BaseType_t CLI_LogStatsCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    static uint8_t line = 0;
+    static struct DebugLoggerStats stats;
+    unsigned long hundredths;
+
+    if (line == 0)
+    {
+        DebugLoggerGetStats(&stats);
+    }
+
+    switch (line++)
+    {
+    case 0:
+        hundredths = (stats.calls != 0) ? (unsigned long)(stats.cycles * 100 / stats.calls) : 0;
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Log: %lu msgs, %lu.%02lu cyc/msg, %lu max (%s)\r\n",
+                 (unsigned long)stats.calls, hundredths / 100, hundredths % 100, (unsigned long)stats.maxCycles,
+                 CONF_SERIAL_CONSOLE_TOKENIZED_LOG ? "tokenized"
+                 : CONF_SERIAL_CONSOLE_DEFERRED_LOG ? "deferred" : "immediate");
+        return pdTRUE;
+
+    case 1:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Buffer: %lu recorded, %lu truncated, %lu entries\r\n",
+                 (unsigned long)stats.recorded, (unsigned long)stats.truncated, (unsigned long)stats.capacity);
+        return pdTRUE;
+
+    default:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "UART (%s and up): %lu sent later, %lu dropped, %lu behind (peak %lu)\r\n",
+                 pcLogLevelNames[getUartLogLevel()], (unsigned long)stats.sent, (unsigned long)stats.dropped,
+                 (unsigned long)stats.backlog, (unsigned long)stats.backlogPeak);
+        line = 0;
+        return pdFALSE;
+    }
+}
+
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_LogLevelCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                                const int8_t *pcCommandString)
+ * @brief       Shows the log level of every module, or sets one module's or all of them.
+ * @details     "loglevel cli debug" sets one module, "loglevel warning" sets all of
+ *              them. Levels below CONF_SERIAL_CONSOLE_LOG_BUILD_LEVEL are not in the
+ *              build, whatever the runtime level.
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string, with the optional module and level.
+ * @return      pdFALSE after the command has been processed.
+ *****************************************************************************/
+BaseType_t CLI_LogLevelCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    BaseType_t xModuleLen = 0, xLevelLen = 0;
+    const char *pcModule = FreeRTOS_CLIGetParameter((const char *)pcCommandString, 1, &xModuleLen);
+    const char *pcLevel = FreeRTOS_CLIGetParameter((const char *)pcCommandString, 2, &xLevelLen);
+    size_t module = N_LOG_MODULES; // All of them
+    bool uart = false;
+    int used;
+
+    if (pcLevel == NULL)
+    {
+        pcLevel = pcModule;
+        xLevelLen = xModuleLen;
+        pcModule = NULL;
+    }
+    if (pcModule != NULL)
+    {
+        uart = (xModuleLen == 4 && strncasecmp(pcModule, "uart", 4) == 0);
+        module = uart ? N_LOG_MODULES : CLI_FindName(pcLogModuleNames, N_LOG_MODULES, pcModule, xModuleLen);
+        if (module == N_LOG_MODULES && !uart)
+        {
+            snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                     "Unknown module, use app, console, cli, link or uart\r\n");
+            return pdFALSE;
+        }
+    }
+    if (pcLevel != NULL)
+    {
+        size_t level = CLI_FindName(pcLogLevelNames, N_DEBUG_LEVELS, pcLevel, xLevelLen);
+        if (level == N_DEBUG_LEVELS)
+        {
+            snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                     "Unknown level, use info, debug, warning, error, fatal or off\r\n");
+            return pdFALSE;
+        }
+        if (uart)
+        {
+            setUartLogLevel((enum eDebugLogLevels)level);
+        }
+        else if (module == N_LOG_MODULES)
+        {
+            setLogLevel((enum eDebugLogLevels)level);
+        }
+        else
+        {
+            setModuleLogLevel((enum eLogModule)module, (enum eDebugLogLevels)level);
+        }
+    }
+
+    used = snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Log levels (built from %s):",
+                    pcLogLevelNames[CONF_SERIAL_CONSOLE_LOG_BUILD_LEVEL]);
+    for (module = 0; module < N_LOG_MODULES && used > 0 && (size_t)used < xWriteBufferLen; module++)
+    {
+        used += snprintf((char *)pcWriteBuffer + used, xWriteBufferLen - (size_t)used, " %s=%s",
+                         pcLogModuleNames[module], pcLogLevelNames[getModuleLogLevel((enum eLogModule)module)]);
+    }
+    if (used > 0 && (size_t)used < xWriteBufferLen)
+    {
+        snprintf((char *)pcWriteBuffer + used, xWriteBufferLen - (size_t)used, " uart=%s\r\n",
+                 pcLogLevelNames[getUartLogLevel()]);
+    }
+    return pdFALSE;
+}
+
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_DmesgCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                             const int8_t *pcCommandString)
+ * @brief       Prints the messages of the log buffer, one per call, oldest first.
+ * @details     "-l level" keeps the messages at level and above, "-n N" the last N of
+ *              those. "-f" then waits for new messages, polling every
+ *              CLI_DMESG_POLL_MS, until Enter is pressed. Messages overwritten
+ *              before they were printed are counted in a note.
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string, with the options.
+ * @return      pdTRUE while more lines follow, pdFALSE after the last one.
+ *****************************************************************************/
+BaseType_t CLI_DmesgCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    static bool running = false, follow;
+    static uint8_t minLevel;
+    static uint32_t next;
+    static struct DebugLogEntry entry;
+    uint32_t head;
+
+    if (!running)
+    {
+        unsigned long count = CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES;
+
+        follow = false;
+        minLevel = LOG_INFO_LVL;
+        for (UBaseType_t i = 1;; i++)
+        {
+            BaseType_t xLen = 0, xValueLen = 0;
+            const char *pcParameter = FreeRTOS_CLIGetParameter((const char *)pcCommandString, i, &xLen);
+            const char *pcValue = FreeRTOS_CLIGetParameter((const char *)pcCommandString, i + 1, &xValueLen);
+            char *end;
+
+            if (pcParameter == NULL)
+            {
+                break;
+            }
+            if (xLen == 2 && strncmp(pcParameter, "-f", 2) == 0)
+            {
+                follow = true;
+                continue;
+            }
+            if (xLen == 2 && strncmp(pcParameter, "-l", 2) == 0 && pcValue != NULL)
+            {
+                size_t level = CLI_FindName(pcLogLevelNames, N_DEBUG_LEVELS, pcValue, xValueLen);
+                if (level < N_DEBUG_LEVELS)
+                {
+                    minLevel = (uint8_t)level;
+                    i++;
+                    continue;
+                }
+            }
+            else if (xLen == 2 && strncmp(pcParameter, "-n", 2) == 0 && pcValue != NULL)
+            {
+                count = strtoul(pcValue, &end, 10);
+                if (end == pcValue + xValueLen)
+                {
+                    i++;
+                    continue;
+                }
+            }
+            snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                     "Usage: dmesg [-l info|debug|warning|error|fatal] [-n N] [-f]\r\n");
+            return pdFALSE;
+        }
+
+        /* Walk back to the count-th newest message that passes the filter */
+        head = DebugLoggerHead();
+        next = head;
+        while (count > 0 && next != 0 && head - next < CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES)
+        {
+            next--;
+            if (DebugLoggerRead(next, &entry) && entry.level >= minLevel)
+            {
+                count--;
+            }
+        }
+        running = true;
+    }
+
+    for (;;)
+    {
+        head = DebugLoggerHead();
+        if (head - next > CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES)
+        {
+            snprintf((char *)pcWriteBuffer, xWriteBufferLen, "-- %lu messages overwritten --\r\n",
+                     (unsigned long)(head - next - CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES));
+            next = head - CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES;
+            return pdTRUE;
+        }
+        while (next != head)
+        {
+            if (DebugLoggerRead(next++, &entry) && entry.level >= minLevel)
+            {
+                size_t len = DebugLoggerFormat(&entry, (char *)pcWriteBuffer, xWriteBufferLen - 1);
+                pcWriteBuffer[len] = '\0';
+                return pdTRUE;
+            }
+        }
+        if (!follow || CLI_WaitForStop(pdMS_TO_TICKS(CLI_DMESG_POLL_MS)))
+        {
+            break;
+        }
+    }
+
+    running = false;
+    pcWriteBuffer[0] = '\0';
+    return pdFALSE;
+}
+#endif
+
+#if CONF_SERIAL_CONSOLE_CRASH_LOG
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_CrashLogCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                                const int8_t *pcCommandString)
+ * @brief       Prints the crash record of the previous run, one line per call, or clears it.
+ * @details     The fault comes first, then the log messages that led to it, oldest
+ *              first. Messages whose format is not in this firmware are skipped.
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string, with the optional "clear" as first parameter.
+ * @return      pdTRUE while more lines follow, pdFALSE after the last one.
+ *****************************************************************************/
+BaseType_t CLI_CrashLogCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    static size_t line = 0, entries;
+    static struct CrashLogFault fault;
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+    static struct DebugLogEntry entry;
+#endif
+    uint32_t ms;
+
+    if (line == 0)
+    {
+        BaseType_t xParameterLen = 0;
+        const char *pcParameter = FreeRTOS_CLIGetParameter((const char *)pcCommandString, 1, &xParameterLen);
+
+        if (pcParameter != NULL)
+        {
+            if (xParameterLen == 5 && strncasecmp(pcParameter, "clear", 5) == 0)
+            {
+                CrashLogClear();
+                snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Crash record cleared\r\n");
+            }
+            else
+            {
+                snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Usage: crashlog [clear]\r\n");
+            }
+            return pdFALSE;
+        }
+        if (!CrashLogGetFault(&fault, &entries))
+        {
+            snprintf((char *)pcWriteBuffer, xWriteBufferLen, "No crash recorded\r\n");
+            return pdFALSE;
+        }
+    }
+
+    switch (line++)
+    {
+    case 0:
+        ms = fault.tick * portTICK_PERIOD_MS;
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Crash: %s in task '%s' at %lu.%03lu s\r\n",
+                 pcCrashReasonNames[fault.reason], fault.task, (unsigned long)(ms / 1000), (unsigned long)(ms % 1000));
+        return pdTRUE;
+
+    case 1:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "PC 0x%08lx LR 0x%08lx SP 0x%08lx xPSR 0x%08lx\r\n",
+                 (unsigned long)fault.pc, (unsigned long)fault.lr, (unsigned long)fault.sp, (unsigned long)fault.psr);
+        return pdTRUE;
+
+    case 2:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Free heap: %lu B, last %lu log messages:\r\n",
+                 (unsigned long)fault.freeHeap, (unsigned long)entries);
+        return pdTRUE;
+
+    default:
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+        /* Lines 3 and up print the messages, skipping those that cannot be formatted */
+        for (; line - 4 < entries; line++)
+        {
+            if (CrashLogGetEntry(line - 4, &entry))
+            {
+                size_t len = DebugLoggerFormat(&entry, (char *)pcWriteBuffer, xWriteBufferLen - 1);
+                pcWriteBuffer[len] = '\0';
+                return pdTRUE;
+            }
+        }
+#endif
+        pcWriteBuffer[0] = '\0';
+        line = 0;
+        return pdFALSE;
+    }
+}
+#endif
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_RxTimingCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                                const int8_t *pcCommandString)
+ * @brief       Prints the console receive timing histograms, one bucket per line, or clears them.
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string, with the optional "reset" as first parameter.
+ * @return      pdTRUE while more lines follow, pdFALSE after the last one.
+ *****************************************************************************/
+BaseType_t CLI_RxTimingCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    static uint8_t line = 0;
+    static struct SerialChannelTiming timing;
+
+    if (line == 0)
+    {
+        BaseType_t xParameterLen = 0;
+        const char *pcParameter = FreeRTOS_CLIGetParameter((const char *)pcCommandString, 1, &xParameterLen);
+
+        if (pcParameter != NULL)
+        {
+            if (xParameterLen == 5 && strncasecmp(pcParameter, "reset", 5) == 0)
+            {
+                SerialConsoleResetRxTiming();
+                snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Receive timing cleared\r\n");
+            }
+            else
+            {
+                snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Usage: rxtime [reset]\r\n");
+            }
+            return pdFALSE;
+        }
+
+        SerialConsoleGetRxTiming(&timing);
+        line++;
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%8s %10s %10s %10s\r\n", "from us", "latency", "wakeup", "gap");
+        return pdTRUE;
+    }
+
+    if (line <= SERIAL_CHANNEL_TIMING_BUCKETS)
+    {
+        uint8_t bucket = line - 1;
+        line++;
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%8lu %10lu %10lu %10lu\r\n",
+                 (bucket == 0) ? 0UL : 1UL << bucket, (unsigned long)timing.latency[bucket],
+                 (unsigned long)timing.wakeup[bucket], (unsigned long)timing.gap[bucket]);
+        return pdTRUE;
+    }
+
+    snprintf((char *)pcWriteBuffer, xWriteBufferLen, "%8s %10lu %10lu %10lu\r\n", "max",
+             (unsigned long)timing.latencyMaxUs, (unsigned long)timing.wakeupMaxUs,
+             (unsigned long)timing.gapMaxUs);
+    line = 0;
+    return pdFALSE;
+}
+#endif
+
+#if CONF_SERIAL_CONSOLE_LINK
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_LinkStatsCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                                 const int8_t *pcCommandString)
+ * @brief       Prints the frame counters and goodput of the console link, or sets the loss injection.
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string, with the optional loss interval as first parameter.
+ * @return      pdTRUE while more lines follow, pdFALSE after the last one.
+ *****************************************************************************/
+BaseType_t CLI_LinkStatsCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    static uint8_t line = 0;
+    static struct SerialLinkStats stats;
+    unsigned long goodput;
+
+    if (line == 0)
+    {
+        BaseType_t xParameterLen = 0;
+        const char *pcParameter = FreeRTOS_CLIGetParameter((const char *)pcCommandString, 1, &xParameterLen);
+
+        if (pcParameter != NULL)
+        {
+            uint16_t every = (uint16_t)strtoul(pcParameter, NULL, 10);
+            SerialConsoleSetLinkLossInjection(every);
+            snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Dropping every %u reliable frame%s\r\n",
+                     (unsigned)every, (every == 0) ? " (off)" : "");
+            return pdFALSE;
+        }
+        SerialConsoleGetLinkStats(&stats);
+    }
+
+    switch (line++)
+    {
+    case 0:
+        /* Payload bytes per wire byte, in percent */
+        goodput = (stats.txWireBytes != 0) ?
+                  (unsigned long)(((uint64_t)stats.txPayloadBytes * 100) / stats.txWireBytes) : 0;
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "TX: %lu frames, %lu B payload, %lu B wire (%lu%%), %lu dropped\r\n",
+                 (unsigned long)stats.txFrames, (unsigned long)stats.txPayloadBytes,
+                 (unsigned long)stats.txWireBytes, goodput, (unsigned long)stats.txQueueDrops);
+        return pdTRUE;
+
+    case 1:
+        goodput = (stats.rxWireBytes != 0) ?
+                  (unsigned long)(((uint64_t)stats.rxPayloadBytes * 100) / stats.rxWireBytes) : 0;
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "RX: %lu frames, %lu B payload, %lu B wire (%lu%%), %lu unhandled\r\n",
+                 (unsigned long)stats.rxFrames, (unsigned long)stats.rxPayloadBytes,
+                 (unsigned long)stats.rxWireBytes, goodput, (unsigned long)stats.rxUnhandled);
+        return pdTRUE;
+
+    case 2:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "RX errors: %lu crc, %lu framing, %lu overlong, %lu line, %lu lost\r\n",
+                 (unsigned long)stats.rxCrcErrors, (unsigned long)stats.rxFramingErrors,
+                 (unsigned long)stats.rxOverlong, (unsigned long)stats.rxLineErrors,
+                 (unsigned long)stats.rxSeqGaps);
+        return pdTRUE;
+
+    case 3:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "ARQ: window %u, %u in flight, srtt %lu ms (var %lu), rto %lu ms\r\n",
+                 (unsigned)stats.window, (unsigned)stats.inFlight, (unsigned long)stats.srttMs,
+                 (unsigned long)stats.rttvarMs, (unsigned long)stats.rtoMs);
+        return pdTRUE;
+
+    default:
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen,
+                 "ARQ: %lu retx (%lu timeouts, %lu injected), %lu dup, %lu out of order, %lu resync\r\n",
+                 (unsigned long)stats.txRetransmits, (unsigned long)stats.txTimeouts,
+                 (unsigned long)stats.txInjectedLosses, (unsigned long)stats.rxDuplicates,
+                 (unsigned long)stats.rxOutOfOrder, (unsigned long)stats.rxResyncs);
+        line = 0;
+        return pdFALSE;
+    }
+}
+
+/**************************************************************************//**
+ * @fn          BaseType_t CLI_SendDummyGameData(int8_t *pcWriteBuffer, size_t xWriteBufferLen,
+ *                                                  const int8_t *pcCommandString)
+ * @brief       Streams dummy game data packets over the reliable channel of the console link.
+ * @details     Each packet is a 16-bit packet number followed by a move pattern; the
+ *              receiver can check that every number arrives once and in order.
+ * @param[out]  pcWriteBuffer Pointer to the output buffer.
+ * @param[in]   xWriteBufferLen Size of the output buffer.
+ * @param[in]   pcCommandString The command string, with the optional packet count as first parameter.
+ * @return      pdFALSE after the command has been processed.
+ *****************************************************************************/
+BaseType_t CLI_SendDummyGameData(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString)
+{
+    static uint16_t packetNumber = 0;
+    BaseType_t xParameterLen = 0;
+    const char *pcParameter = FreeRTOS_CLIGetParameter((const char *)pcCommandString, 1, &xParameterLen);
+    unsigned long count = (pcParameter != NULL) ? strtoul(pcParameter, NULL, 10) : 1;
+    unsigned long queued = 0;
+    bool stalled = false;
+    uint8_t packet[GAME_PACKET_SIZE];
+
+    for (; queued < count; queued++)
+    {
+        TimeOut_t xTimeOut;
+        TickType_t timeout = pdMS_TO_TICKS(CLI_GAME_SEND_TIMEOUT_MS);
+
+        packet[0] = (uint8_t)packetNumber;
+        packet[1] = (uint8_t)(packetNumber >> 8);
+        for (size_t i = 2; i < sizeof(packet); i++)
+        {
+            packet[i] = (uint8_t)((packetNumber + i) % 16); // Dummy moves
+        }
+        /* Wait for the window to drain rather than dropping packets, but only
+         * while the peer acknowledges: without one the window never drains */
+        vTaskSetTimeOutState(&xTimeOut);
+        while (!SerialConsoleLinkSend(CONF_SERIAL_CONSOLE_LINK_RELIABLE_CHANNEL, packet, sizeof(packet)))
+        {
+            if (xTaskCheckForTimeOut(&xTimeOut, &timeout) != pdFALSE)
+            {
+                stalled = true;
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        if (stalled)
+        {
+            break;
+        }
+        packetNumber++;
+    }
+
+    if (stalled)
+    {
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Queued %lu of %lu game packets, no ACK from the peer\r\n",
+                 queued, count);
+    }
+    else
+    {
+        snprintf((char *)pcWriteBuffer, xWriteBufferLen, "Queued %lu game packets\r\n", queued);
+    }
+    return pdFALSE;
+}
+#endif
@@ -10,6 +10,8 @@
 
 #include "asf.h"
 #include "SerialConsole.h"
+#include "DebugLogger.h"
+#include "CrashLog.h"
 #include "FreeRTOS_CLI.h"
 
 
@@ -21,6 +23,10 @@
 #define MAX_OUTPUT_LENGTH_CLI   130	//STUDENT FILL
 
 #define CLI_MSG_LEN						16
+#define CLI_RX_CHUNK_SIZE				16	///< Characters moved out of the RX buffer per read
+#define GAME_PACKET_SIZE				8	///< Bytes per dummy game data packet (game command)
+#define CLI_GAME_SEND_TIMEOUT_MS		2000	///< How long "game" waits for window space before giving up on the peer
+#define CLI_DMESG_POLL_MS				100	///< How often "dmesg -f" looks for new messages
 #define CLI_PC_ESCAPE_CODE_SIZE			4
 #define CLI_PC_MIN_ESCAPE_CODE_SIZE		2
 
@@ -41,8 +47,6 @@ BaseType_t xCliClearTerminalScreen( char *pcWriteBuffer,size_t xWriteBufferLen,c
 
 void vCommandConsoleTask( void *pvParameters );
 
-extern SemaphoreHandle_t xSemaphore;
-
 BaseType_t CLI_GetImuData( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
 BaseType_t CLI_OTAU( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
 BaseType_t CLI_NeotrellisSetLed( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
@@ -51,4 +55,22 @@ BaseType_t CLI_DistanceSensorGetDistance( int8_t *pcWriteBuffer,size_t xWriteBuf
 BaseType_t CLI_ResetDevice( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
 BaseType_t CLI_SendDummyGameData( int8_t *pcWriteBuffer,size_t xWriteBufferLen,const int8_t *pcCommandString );
 BaseType_t CLI_VersionCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
-BaseType_t CLI_TicksCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
\ No newline at end of file
+BaseType_t CLI_TicksCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+BaseType_t CLI_ConsoleStatsCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+BaseType_t CLI_EchoCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+BaseType_t CLI_BaudCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+BaseType_t CLI_PowerCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+BaseType_t CLI_LogStatsCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+BaseType_t CLI_LogLevelCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+BaseType_t CLI_DmesgCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+#endif
+#if CONF_SERIAL_CONSOLE_CRASH_LOG
+BaseType_t CLI_CrashLogCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+#endif
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+BaseType_t CLI_RxTimingCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+#endif
+#if CONF_SERIAL_CONSOLE_LINK
+BaseType_t CLI_LinkStatsCommand(int8_t *pcWriteBuffer, size_t xWriteBufferLen, const int8_t *pcCommandString);
+#endif
@@ -0,0 +1,315 @@
+/**************************************************************************//**
+ * @file        CrashLog.c
+ * @ingroup     Serial Console
+ * @brief       Fault record and last log messages kept across a reset.
+ * @details     The code in this file will:
+ *              - Record the fault, with a copy of the newest log messages, in a
+ *                .noinit structure sealed by a magic number and a CRC.
+ *              - Take the stacked registers in the HardFault handler.
+ *              - Validate the record of the previous run at boot and hand it to
+ *                "crashlog".
+ * @copyright
+ * @author
+ * @date        October 17, 2026
+ * @version     0.1
+ *****************************************************************************/
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include "CrashLog.h"
+#include "crc16.h"
+
+/******************************************************************************/
+/* Defines                                                                    */
+/******************************************************************************/
+#define CRASH_LOG_MAGIC 0x48535243u /**< "CRSH": the record is complete */
+
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+#define CRASH_LOG_ENTRIES CONF_SERIAL_CONSOLE_CRASH_LOG_ENTRIES /**< Log messages kept */
+#else
+#define CRASH_LOG_ENTRIES 0 /**< No log buffer to take them from */
+#endif
+
+/******************************************************************************/
+/* Structures and Enumerations                                                */
+/******************************************************************************/
+#if CONF_SERIAL_CONSOLE_CRASH_LOG
+/** Retained record, see CrashLog.h */
+struct CrashLog {
+    uint32_t magic;              /**< CRASH_LOG_MAGIC once the record is sealed */
+    uint16_t crc;                /**< crc16_ccitt of the rest, from entries on */
+    uint16_t entries;            /**< Messages in log */
+    struct CrashLogFault fault;  /**< State at the crash */
+    struct DebugLogEntry log[CRASH_LOG_ENTRIES ? CRASH_LOG_ENTRIES : 1]; /**< Newest messages, oldest first */
+};
+
+static struct CrashLog crashLog __attribute__((section(".noinit"))); /**< Not cleared by the startup code */
+static bool crashLogValid = false; /**< crashLog holds the record of an earlier run */
+
+extern uint32_t _etext; /**< End of code and constants in flash (linker script) */
+#endif
+
+/******************************************************************************/
+/* Local Function Declarations                                                */
+/******************************************************************************/
+#if CONF_SERIAL_CONSOLE_CRASH_LOG
+static uint16_t crash_log_crc(void);
+static void crash_log_record(enum eCrashReason reason, const char *task, uint32_t pc, uint32_t lr, uint32_t sp,
+                             uint32_t psr);
+static void crash_log_hard_fault(const uint32_t *frame) __attribute__((used, noinline, noreturn));
+#endif
+
+/******************************************************************************/
+/* Global Functions                                                           */
+/******************************************************************************/
+#if CONF_SERIAL_CONSOLE_CRASH_LOG
+/**************************************************************************//**
+ * @brief Checks the retained record of the previous run.
+ *
+ * After a power-up the section holds random data, which the magic number and
+ * the CRC reject.
+ *
+ * @return None.
+ *****************************************************************************/
+void CrashLogInit(void)
+{
+    crashLogValid = crashLog.magic == CRASH_LOG_MAGIC && crashLog.entries <= CRASH_LOG_ENTRIES
+                    && crashLog.fault.reason < N_CRASH_REASONS && crashLog.crc == crash_log_crc();
+    if (!crashLogValid)
+    {
+        crashLog.magic = 0;
+    }
+}
+
+/**************************************************************************//**
+ * @brief Copies the retained fault record.
+ *
+ * @param[out] fault   Receives the record.
+ * @param[out] entries Receives the number of log messages kept with it.
+ *
+ * @return false if there is none.
+ *****************************************************************************/
+bool CrashLogGetFault(struct CrashLogFault *fault, size_t *entries)
+{
+    if (!crashLogValid)
+    {
+        return false;
+    }
+    *fault = crashLog.fault;
+    fault->task[sizeof(fault->task) - 1] = '\0';
+    *entries = crashLog.entries;
+    return true;
+}
+
+/**************************************************************************//**
+ * @brief Copies one retained log message.
+ *
+ * The entry points at its format string, so only formats inside this
+ * firmware's flash are accepted; after a reflash they may be wrong text but
+ * never a wild pointer.
+ *
+ * @param[in]  index Message, 0 is the oldest.
+ * @param[out] entry Receives the message.
+ *
+ * @return false if there is none, or if it cannot be formatted.
+ *****************************************************************************/
+bool CrashLogGetEntry(size_t index, struct DebugLogEntry *entry)
+{
+    if (!crashLogValid || index >= crashLog.entries)
+    {
+        return false;
+    }
+    *entry = crashLog.log[index];
+    return entry->format != NULL && (uintptr_t)entry->format < (uintptr_t)&_etext
+           && entry->words <= CONF_SERIAL_CONSOLE_LOG_MAX_ARGS && entry->stringsLen <= CONF_SERIAL_CONSOLE_LOG_MAX_STRINGS;
+}
+
+/**************************************************************************//**
+ * @brief Forgets the retained record.
+ *
+ * @return None.
+ *****************************************************************************/
+void CrashLogClear(void)
+{
+    crashLogValid = false;
+    crashLog.magic = 0;
+}
+
+/**************************************************************************//**
+ * @brief Records a crash reported by a hook, then resets or spins.
+ *
+ * @param[in] reason Why.
+ * @param[in] task   Name of the failing task, NULL for the running one.
+ * @param[in] caller Where the hook was called from.
+ *
+ * @return Does not return.
+ *****************************************************************************/
+void CrashLogPanic(enum eCrashReason reason, const char *task, const void *caller)
+{
+    __disable_irq();
+    crash_log_record(reason, task, (uint32_t)(uintptr_t)caller, 0, __get_PSP(), __get_xPSR());
+
+#if CONF_SERIAL_CONSOLE_CRASH_RESET
+    system_reset();
+#endif
+    for (;;)
+    {
+    }
+}
+
+/**************************************************************************//**
+ * @brief HardFault exception: hands the stacked registers to crash_log_hard_fault.
+ *
+ * Bit 2 of EXC_RETURN tells whether the faulting code ran on the process
+ * (task) stack or on the main stack.
+ *
+ * @return Does not return.
+ *****************************************************************************/
+__attribute__((naked)) void HardFault_Handler(void)
+{
+    __asm volatile(
+        "movs r0, #4              \n"
+        "mov  r1, lr              \n"
+        "tst  r0, r1              \n"
+        "beq  1f                  \n"
+        "mrs  r0, psp             \n"
+        "b    2f                  \n"
+        "1:                       \n"
+        "mrs  r0, msp             \n"
+        "2:                       \n"
+        "ldr  r1, =crash_log_hard_fault \n"
+        "bx   r1                  \n"
+        ".ltorg                   \n");
+}
+#else
+/**************************************************************************//**
+ * @brief Nothing is retained without CONF_SERIAL_CONSOLE_CRASH_LOG.
+ *
+ * @return None.
+ *****************************************************************************/
+void CrashLogInit(void)
+{
+}
+
+/**************************************************************************//**
+ * @brief Stops the device without recording anything.
+ *
+ * @param[in] reason Unused.
+ * @param[in] task   Unused.
+ * @param[in] caller Unused.
+ *
+ * @return Does not return.
+ *****************************************************************************/
+void CrashLogPanic(enum eCrashReason reason, const char *task, const void *caller)
+{
+    (void)reason;
+    (void)task;
+    (void)caller;
+    taskDISABLE_INTERRUPTS();
+    for (;;)
+    {
+    }
+}
+#endif
+
+/******************************************************************************/
+/* Local Functions                                                            */
+/******************************************************************************/
+#if CONF_SERIAL_CONSOLE_CRASH_LOG
+/**************************************************************************//**
+ * @brief CRC of the retained record, from the entries field on.
+ *
+ * @return crc16_ccitt of the record.
+ *****************************************************************************/
+static uint16_t crash_log_crc(void)
+{
+    const uint8_t *start = (const uint8_t *)&crashLog.entries;
+    return crc16_ccitt(CRC16_CCITT_INIT, start, sizeof(crashLog) - (size_t)(start - (const uint8_t *)&crashLog));
+}
+
+/**************************************************************************//**
+ * @brief Fills and seals the retained record.
+ *
+ * The magic number is cleared first and written last, so a crash while
+ * recording leaves no record rather than a torn one. Runs with interrupts
+ * disabled and uses nothing that could block.
+ *
+ * @param[in] reason Why.
+ * @param[in] task   Name of the failing task, NULL for the running one.
+ * @param[in] pc     Faulting instruction, or the hook's caller.
+ * @param[in] lr     Link register of the faulting code, 0 if unknown.
+ * @param[in] sp     Stack pointer of the faulting code.
+ * @param[in] psr    xPSR.
+ *
+ * @return None.
+ *****************************************************************************/
+static void crash_log_record(enum eCrashReason reason, const char *task, uint32_t pc, uint32_t lr, uint32_t sp,
+                             uint32_t psr)
+{
+    struct CrashLogFault *fault = &crashLog.fault;
+
+    crashLog.magic = 0;
+    crashLogValid = false;
+
+    memset(fault, 0, sizeof(*fault));
+    fault->reason = (uint32_t)reason;
+    fault->pc = pc;
+    fault->lr = lr;
+    fault->sp = sp;
+    fault->psr = psr;
+    fault->freeHeap = (uint32_t)xPortGetFreeHeapSize();
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+    {
+        fault->tick = xTaskGetTickCountFromISR();
+        if (task == NULL)
+        {
+            task = pcTaskGetName(NULL);
+        }
+    }
+    if (task != NULL)
+    {
+        strncpy(fault->task, task, sizeof(fault->task) - 1);
+    }
+
+    crashLog.entries = 0;
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+    {
+        uint32_t count = (CRASH_LOG_ENTRIES < CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES)
+                         ? CRASH_LOG_ENTRIES : CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES;
+        uint32_t head = DebugLoggerHead();
+
+        /* Messages torn by the crash fail the read and are left out */
+        for (uint32_t seq = (head > count) ? head - count : 0; seq != head; seq++)
+        {
+            if (DebugLoggerRead(seq, &crashLog.log[crashLog.entries]))
+            {
+                crashLog.entries++;
+            }
+        }
+    }
+#endif
+
+    crashLog.crc = crash_log_crc();
+    crashLog.magic = CRASH_LOG_MAGIC;
+}
+
+/**************************************************************************//**
+ * @brief Records a HardFault from the registers the exception stacked.
+ *
+ * @param[in] frame r0-r3, r12, lr, pc and xPSR of the faulting code.
+ *
+ * @return Does not return.
+ *****************************************************************************/
+static void crash_log_hard_fault(const uint32_t *frame)
+{
+    crash_log_record(CRASH_HARD_FAULT, NULL, frame[6], frame[5], (uint32_t)(frame + 8), frame[7]);
+
+#if CONF_SERIAL_CONSOLE_CRASH_RESET
+    system_reset();
+#endif
+    for (;;)
+    {
+    }
+}
+#endif
@@ -0,0 +1,104 @@
+/**************************************************************************//**
+ * @file        CrashLog.h
+ * @ingroup     Serial Console
+ * @brief       Fault record and last log messages kept across a reset.
+ * @details     With CONF_SERIAL_CONSOLE_CRASH_LOG the malloc-failed, stack-overflow
+ *				and assert hooks and the HardFault handler call CrashLogPanic. It
+ *				writes a fault record (reason, task, PC/LR/SP/xPSR, free heap) and
+ *				copies the newest CONF_SERIAL_CONSOLE_CRASH_LOG_ENTRIES messages of
+ *				the log buffer into the .noinit section. The startup code neither
+ *				loads nor zeroes that section, so it survives system_reset and
+ *				watchdog resets. The record is then sealed with a CRC and the
+ *				device resets (CONF_SERIAL_CONSOLE_CRASH_RESET).
+ *
+ *				On the next boot CrashLogInit keeps the record only if its magic
+ *				and CRC check out, which rejects the random RAM after a power-up.
+ *				"crashlog" prints it until it is cleared or replaced by the next
+ *				crash. The messages are kept unformatted, so they are printed with
+ *				the format strings of the running firmware. Formats outside its
+ *				flash are skipped.
+ *
+ * @copyright
+ * @author
+ * @date        October 17, 2026
+ * @version		0.1
+ *****************************************************************************/
+
+#ifndef CRASH_LOG_H
+#define CRASH_LOG_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "DebugLogger.h"
+
+/******************************************************************************
+ * Structures and Enumerations
+ ******************************************************************************/
+/** What ended the previous run */
+enum eCrashReason {
+	CRASH_NONE           = 0, /**< No crash recorded */
+	CRASH_MALLOC_FAILED  = 1, /**< vApplicationMallocFailedHook */
+	CRASH_STACK_OVERFLOW = 2, /**< vApplicationStackOverflowHook */
+	CRASH_HARD_FAULT     = 3, /**< HardFault exception */
+	CRASH_ASSERT         = 4, /**< configASSERT failed */
+	N_CRASH_REASONS      = 5  /**< Number of reasons */
+};
+
+/**
+ * State of the device when it crashed.
+ */
+struct CrashLogFault {
+	uint32_t reason;        /**< enum eCrashReason */
+	uint32_t tick;          /**< Tick count */
+	uint32_t pc;            /**< Faulting instruction; for the hooks, where the hook was called from */
+	uint32_t lr;            /**< Link register of the faulting code; 0 for the hooks */
+	uint32_t sp;            /**< Stack pointer of the faulting code (the task's PSP for the hooks) */
+	uint32_t psr;           /**< xPSR; its low bits hold the exception being handled */
+	uint32_t freeHeap;      /**< xPortGetFreeHeapSize() */
+	char task[configMAX_TASK_NAME_LEN]; /**< Running task, empty before the scheduler starts */
+};
+
+/******************************************************************************
+* Global Function Declarations
+******************************************************************************/
+/**
+ * @fn			void CrashLogInit(void)
+ * @brief		Checks the retained record of the previous run.
+ * @note		Called by InitializeSerialConsole.
+ *****************************************************************************/
+void CrashLogInit(void);
+
+/**
+ * @fn			bool CrashLogGetFault(struct CrashLogFault *fault, size_t *entries)
+ * @brief		Copies the retained fault record.
+ * @param[out]	fault   Receives the record
+ * @param[out]	entries Receives the number of log messages kept with it
+ * @return		false if there is none
+ *****************************************************************************/
+bool CrashLogGetFault(struct CrashLogFault *fault, size_t *entries);
+
+/**
+ * @fn			bool CrashLogGetEntry(size_t index, struct DebugLogEntry *entry)
+ * @brief		Copies one retained log message, oldest first.
+ * @return		false if there is none, or if its format is not in this firmware
+ *****************************************************************************/
+bool CrashLogGetEntry(size_t index, struct DebugLogEntry *entry);
+
+/**
+ * @fn			void CrashLogClear(void)
+ * @brief		Forgets the retained record.
+ *****************************************************************************/
+void CrashLogClear(void);
+
+/**
+ * @fn			void CrashLogPanic(enum eCrashReason reason, const char *task, const void *caller)
+ * @brief		Records a crash in retained RAM, then resets or spins.
+ * @details		Safe from any context; interrupts stay disabled from here on.
+ * @param[in]	reason Why
+ * @param[in]	task   Name of the failing task, NULL for the running one
+ * @param[in]	caller Where the hook was called from, __builtin_return_address(0)
+ *****************************************************************************/
+void CrashLogPanic(enum eCrashReason reason, const char *task, const void *caller) __attribute__((noreturn));
+
+#endif /* CRASH_LOG_H */
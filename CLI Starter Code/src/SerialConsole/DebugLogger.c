@@ -0,0 +1,399 @@
+/**************************************************************************//**
+ * @file        DebugLogger.c
+ * @ingroup     Serial Console
+ * @brief       Log buffer, deferred formatting and cost accounting for LogMessage.
+ * @details     The code in this file will:
+ *              - Capture messages into the log buffer: each writer claims the next
+ *                fixed-size entry in a short critical section and fills it
+ *                outside, so tasks and interrupts never interleave.
+ *              - Run the low-priority logger task, which formats the entries meant
+ *                for the UART into a line and hands it to the console.
+ *              - Keep the per-call cost and buffer counters of "logstats".
+ * @copyright
+ * @author
+ * @date        October 17, 2026
+ * @version     0.1
+ *****************************************************************************/
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include "DebugLogger.h"
+
+/******************************************************************************/
+/* Defines                                                                    */
+/******************************************************************************/
+#if CONF_SERIAL_CONSOLE_LOG_MAX_STRINGS > 255 || CONF_SERIAL_CONSOLE_LOG_MAX_ARGS > 255
+#error "CONF_SERIAL_CONSOLE_LOG_MAX_STRINGS and CONF_SERIAL_CONSOLE_LOG_MAX_ARGS must be at most 255"
+#endif
+
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES & (CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES - 1)
+#error "CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES must be a power of two"
+#endif
+
+#if CONF_SERIAL_CONSOLE_DEFERRED_LOG && !CONF_SERIAL_CONSOLE_LOG_BUFFER
+#error "CONF_SERIAL_CONSOLE_DEFERRED_LOG needs CONF_SERIAL_CONSOLE_LOG_BUFFER"
+#endif
+
+#define LOG_BUFFER_MASK (CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES - 1) /**< Entry index of a sequence number */
+
+/******************************************************************************/
+/* Structures and Enumerations                                                */
+/******************************************************************************/
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+/** Line being formatted */
+struct logLineCursor {
+    char *line;    /**< Destination */
+    size_t size;   /**< Size of line */
+    size_t length; /**< Characters written, at most size */
+};
+
+static struct DebugLogEntry logBuffer[CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES]; /**< The most recent messages */
+static volatile uint32_t logHead = 0; /**< Sequence number of the next message */
+static volatile uint32_t logSent = 0; /**< Next message the logger task looks at */
+#endif
+
+#if CONF_SERIAL_CONSOLE_DEFERRED_LOG
+static TaskHandle_t loggerTask = NULL;  /**< Formats and sends the entries */
+static volatile bool loggerIdle = false; /**< The logger task caught up and may be blocked */
+static char logLine[CONF_SERIAL_CONSOLE_LOG_LINE_LENGTH]; /**< Output of the logger task */
+#endif
+
+static struct DebugLoggerStats logStats; /**< Counters */
+
+/******************************************************************************/
+/* Local Function Declarations                                                */
+/******************************************************************************/
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+static void logger_line_printf(struct logLineCursor *cursor, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+static void logger_line_sink(void *ctx, const char *data, size_t len);
+#endif
+#if CONF_SERIAL_CONSOLE_DEFERRED_LOG
+static void logger_task(void *pvParameters);
+static bool logger_next(struct DebugLogEntry *entry);
+#endif
+
+/******************************************************************************/
+/* Global Functions                                                           */
+/******************************************************************************/
+
+/**************************************************************************//**
+ * @brief Creates the logger task.
+ *
+ * @return None.
+ *****************************************************************************/
+void DebugLoggerInit(void)
+{
+    logStats.capacity = CONF_SERIAL_CONSOLE_LOG_BUFFER ? CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES : 0;
+#if CONF_SERIAL_CONSOLE_DEFERRED_LOG
+    if (xTaskCreate(logger_task, "LOGGER", CONF_SERIAL_CONSOLE_LOG_TASK_SIZE, NULL,
+                    CONF_SERIAL_CONSOLE_LOG_TASK_PRIORITY, &loggerTask) != pdPASS)
+    {
+        SerialConsoleWriteString("ERR: Logger task could not be initialized!\r\n");
+    }
+#endif
+}
+
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+/**************************************************************************//**
+ * @brief Writes a message into the log buffer without formatting it.
+ *
+ * The next entry is claimed, and marked as being written, in a critical
+ * section; console_capture then walks the format once to pick up the argument
+ * words and copy the %s strings straight into it, and the sequence number
+ * published last makes it readable. The logger task is only notified for
+ * UART messages when it went idle, so a burst of messages costs one
+ * notification.
+ *
+ * @param[in] module Module of the message.
+ * @param[in] level  Level of the message.
+ * @param[in] uart   Let the logger task send it.
+ * @param[in] format printf format string; must stay valid, e.g. a literal.
+ * @param[in] args   Arguments for the format.
+ *
+ * @return None.
+ *****************************************************************************/
+void DebugLoggerVCapture(enum eLogModule module, enum eDebugLogLevels level, bool uart, const char *format,
+                         va_list args)
+{
+    struct DebugLogEntry *entry;
+    uint32_t seq;
+    size_t stringsLen;
+
+    system_interrupt_enter_critical_section();
+    seq = logHead++;
+    entry = &logBuffer[seq & LOG_BUFFER_MASK];
+    /* Overwriting a UART message the logger task has not reached yet */
+    if (entry->seq != 0 && entry->uart && entry->seq - 1 >= logSent)
+    {
+        logStats.dropped++;
+    }
+    entry->seq = 0;
+    logStats.recorded++;
+    if (uart && logHead - logSent > logStats.backlogPeak)
+    {
+        logStats.backlogPeak = (logHead - logSent < CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES)
+                               ? logHead - logSent : CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES;
+    }
+    system_interrupt_leave_critical_section();
+
+    size_t count = console_capture(format, args, entry->args, CONF_SERIAL_CONSOLE_LOG_MAX_ARGS, entry->strings,
+                                   sizeof(entry->strings), &stringsLen);
+    bool truncated = count > CONF_SERIAL_CONSOLE_LOG_MAX_ARGS || stringsLen > sizeof(entry->strings);
+
+    entry->tick = (__get_IPSR() != 0) ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+    entry->format = format;
+    entry->level = (uint8_t)level;
+    entry->module = (uint8_t)module;
+    entry->words = (uint8_t)(truncated ? CONF_SERIAL_CONSOLE_LOG_MAX_ARGS : count);
+    entry->stringsLen = (uint8_t)((stringsLen > sizeof(entry->strings)) ? sizeof(entry->strings) : stringsLen);
+    entry->uart = uart;
+    __DMB(); // Contents before the sequence number
+    entry->seq = seq + 1;
+
+    if (truncated)
+    {
+        system_interrupt_enter_critical_section();
+        logStats.truncated++;
+        system_interrupt_leave_critical_section();
+    }
+
+#if CONF_SERIAL_CONSOLE_DEFERRED_LOG
+    /* Wake the logger only if it ran dry */
+    if (uart && loggerIdle && loggerTask != NULL)
+    {
+        loggerIdle = false;
+        if (__get_IPSR() != 0)
+        {
+            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+            vTaskNotifyGiveFromISR(loggerTask, &xHigherPriorityTaskWoken);
+            portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        }
+        else
+        {
+            xTaskNotifyGive(loggerTask);
+        }
+    }
+#endif
+}
+
+/**************************************************************************//**
+ * @brief Sequence number the next message will get.
+ *
+ * @return Number of messages written into the buffer so far.
+ *****************************************************************************/
+uint32_t DebugLoggerHead(void)
+{
+    return logHead;
+}
+
+/**************************************************************************//**
+ * @brief Copies one message out of the log buffer.
+ *
+ * @param[in]  seq   Sequence number of the message.
+ * @param[out] entry Receives the message.
+ *
+ * @return false if the message has been overwritten or is still being written.
+ *****************************************************************************/
+bool DebugLoggerRead(uint32_t seq, struct DebugLogEntry *entry)
+{
+    const struct DebugLogEntry *slot = &logBuffer[seq & LOG_BUFFER_MASK];
+    bool valid;
+
+    system_interrupt_enter_critical_section();
+    valid = (slot->seq == seq + 1);
+    if (valid)
+    {
+        *entry = *slot;
+    }
+    system_interrupt_leave_critical_section();
+
+    return valid;
+}
+
+/**************************************************************************//**
+ * @brief Formats a message behind its capture time.
+ *
+ * @param[in]  entry The message.
+ * @param[out] line  Destination; not terminated.
+ * @param[in]  size  Size of line; longer lines are cut.
+ *
+ * @return Characters written.
+ *****************************************************************************/
+size_t DebugLoggerFormat(const struct DebugLogEntry *entry, char *line, size_t size)
+{
+    struct logLineCursor cursor = { line, size, 0 };
+    uint32_t ms = entry->tick * portTICK_PERIOD_MS;
+
+    logger_line_printf(&cursor, "[%5lu.%03lu] ", (unsigned long)(ms / 1000), (unsigned long)(ms % 1000));
+    console_wformat(logger_line_sink, &cursor, entry->format, entry->args, entry->words, entry->strings);
+
+    return cursor.length;
+}
+#endif
+
+/**************************************************************************//**
+ * @brief Adds one LogMessage call and its cost to the counters.
+ *
+ * @param[in] cycles CPU cycles the call took, 0 without profiling.
+ *
+ * @return None.
+ *****************************************************************************/
+void DebugLoggerCount(uint32_t cycles)
+{
+    system_interrupt_enter_critical_section();
+    logStats.calls++;
+    logStats.cycles += cycles;
+    if (cycles > logStats.maxCycles)
+    {
+        logStats.maxCycles = cycles;
+    }
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Copies the logging counters.
+ *
+ * @param[out] stats Structure that receives a snapshot of the counters.
+ *
+ * @return None.
+ *****************************************************************************/
+void DebugLoggerGetStats(struct DebugLoggerStats *stats)
+{
+    system_interrupt_enter_critical_section();
+    *stats = logStats;
+#if CONF_SERIAL_CONSOLE_DEFERRED_LOG
+    stats->backlog = (logHead - logSent < CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES)
+                     ? logHead - logSent : CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES;
+#endif
+    system_interrupt_leave_critical_section();
+}
+
+/******************************************************************************/
+/* Local Functions                                                            */
+/******************************************************************************/
+#if CONF_SERIAL_CONSOLE_DEFERRED_LOG
+/**************************************************************************//**
+ * @brief Logger task: formats and sends the UART messages, oldest first.
+ *
+ * Announces itself idle before looking at the buffer, so a message written
+ * after the check finds the flag set and notifies; one written before it is
+ * seen by the check.
+ *
+ * @param[in] pvParameters Unused.
+ *
+ * @return None.
+ *****************************************************************************/
+static void logger_task(void *pvParameters)
+{
+    struct DebugLogEntry entry;
+
+    (void)pvParameters;
+
+    for (;;)
+    {
+        loggerIdle = true;
+        if (logSent == logHead)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        loggerIdle = false;
+
+        if (logger_next(&entry))
+        {
+            size_t len = DebugLoggerFormat(&entry, logLine, sizeof(logLine));
+            SerialConsoleWriteLog((enum eDebugLogLevels)entry.level, (const uint8_t *)logLine, len);
+            logStats.sent++;
+        }
+    }
+}
+
+/**************************************************************************//**
+ * @brief Takes the next message for the logger task.
+ *
+ * Messages already overwritten are skipped; their writers counted the UART
+ * ones as dropped. Checking the entry and moving past it in one critical
+ * section keeps a writer from counting a message that was read. A message
+ * still being written by a preempted task is waited for.
+ *
+ * @param[out] entry Receives the message.
+ *
+ * @return true if entry holds a message for the UART.
+ *****************************************************************************/
+static bool logger_next(struct DebugLogEntry *entry)
+{
+    bool found = false, busy = false;
+
+    system_interrupt_enter_critical_section();
+    if (logHead - logSent > CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES)
+    {
+        logSent = logHead - CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES;
+    }
+    const struct DebugLogEntry *slot = &logBuffer[logSent & LOG_BUFFER_MASK];
+    if (slot->seq == logSent + 1)
+    {
+        found = slot->uart;
+        if (found)
+        {
+            *entry = *slot;
+        }
+        logSent++;
+    }
+    else if (slot->seq != 0)
+    {
+        logSent++; // Stale: its writer was preempted while the buffer wrapped around
+    }
+    else
+    {
+        busy = true;
+    }
+    system_interrupt_leave_critical_section();
+
+    if (busy)
+    {
+        vTaskDelay(1);
+    }
+    return found;
+}
+#endif
+
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+/**************************************************************************//**
+ * @brief printf into a line.
+ *
+ * @param[in] cursor Line being formatted.
+ * @param[in] format printf format string.
+ *
+ * @return None.
+ *****************************************************************************/
+static void logger_line_printf(struct logLineCursor *cursor, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    console_vformat(logger_line_sink, cursor, format, args);
+    va_end(args);
+}
+
+/**************************************************************************//**
+ * @brief Format sink appending to a line, cutting what does not fit.
+ *
+ * @param[in] ctx  The struct logLineCursor being written.
+ * @param[in] data Formatted characters.
+ * @param[in] len  Number of characters.
+ *
+ * @return None.
+ *****************************************************************************/
+static void logger_line_sink(void *ctx, const char *data, size_t len)
+{
+    struct logLineCursor *cursor = ctx;
+
+    if (len > cursor->size - cursor->length)
+    {
+        len = cursor->size - cursor->length;
+    }
+    memcpy(cursor->line + cursor->length, data, len);
+    cursor->length += len;
+}
+#endif
@@ -0,0 +1,132 @@
+/**************************************************************************//**
+ * @file        DebugLogger.h
+ * @ingroup     Serial Console
+ * @brief       Log buffer, deferred formatting and cost accounting for LogMessage.
+ * @details     With CONF_SERIAL_CONSOLE_LOG_BUFFER every message that passes its
+ *				module's level is kept in RAM, in a ring of fixed-size entries: the
+ *				tick count, the level and module, the format pointer and the raw
+ *				argument words. Nothing is formatted to store a message, so verbose
+ *				levels can stay enabled; "dmesg" formats the entries when they are
+ *				read back. The oldest entry is overwritten when the ring is full.
+ *
+ *				The UART is one sink of the buffer, with its own level (see
+ *				setUartLogLevel). With CONF_SERIAL_CONSOLE_DEFERRED_LOG a low-priority
+ *				logger task formats and sends the entries meant for it; messages it
+ *				has not reached when they are overwritten are counted as dropped.
+ *				Messages at CONF_SERIAL_CONSOLE_URGENT_LOG_LEVEL and above are
+ *				formatted at once into the urgent TX lane and only kept for dmesg.
+ *
+ *				The format must stay valid until it is formatted, which string
+ *				literals do. Strings passed for %s are copied into the entry, since
+ *				they often live on the caller's stack. Each line is prefixed with
+ *				the capture time, because it may be sent much later.
+ *
+ *				In every mode LogMessage can count its own cost in CPU cycles
+ *				(CONF_SERIAL_CONSOLE_LOG_PROFILING, see "logstats").
+ *
+ * @copyright
+ * @author
+ * @date        October 17, 2026
+ * @version		0.1
+ *****************************************************************************/
+
+#ifndef DEBUG_LOGGER_H
+#define DEBUG_LOGGER_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "SerialConsole.h"
+
+/******************************************************************************
+ * Structures
+ ******************************************************************************/
+/**
+ * One message of the log buffer.
+ */
+struct DebugLogEntry {
+	volatile uint32_t seq;  /**< Sequence number of the message + 1, 0 while it is written */
+	uint32_t tick;          /**< Tick count when LogMessage was called */
+	const char *format;     /**< The caller's format string */
+	uint8_t level;          /**< enum eDebugLogLevels */
+	uint8_t module;         /**< enum eLogModule */
+	uint8_t words;          /**< Argument words used */
+	uint8_t stringsLen;     /**< Bytes of %s copies used */
+	bool uart;              /**< To be sent by the logger task */
+	uint32_t args[CONF_SERIAL_CONSOLE_LOG_MAX_ARGS];       /**< Argument words */
+	char strings[CONF_SERIAL_CONSOLE_LOG_MAX_STRINGS];     /**< %s copies */
+};
+
+/**
+ * Logging counters, see DebugLoggerGetStats().
+ */
+struct DebugLoggerStats {
+	uint32_t calls;         /**< LogMessage calls that passed the level filter */
+	uint64_t cycles;        /**< CPU cycles spent in those calls (CONF_SERIAL_CONSOLE_LOG_PROFILING) */
+	uint32_t maxCycles;     /**< Slowest call */
+	uint32_t recorded;      /**< Messages written into the log buffer */
+	uint32_t truncated;     /**< Messages with more arguments or %s bytes than an entry holds */
+	uint32_t sent;          /**< Messages the logger task has sent to the UART */
+	uint32_t dropped;       /**< Messages for the UART overwritten before the logger task sent them */
+	uint32_t backlog;       /**< Entries the logger task had not reached when the counters were copied */
+	uint32_t backlogPeak;   /**< Largest backlog seen by a writer */
+	uint32_t capacity;      /**< Entries of the log buffer */
+};
+
+/******************************************************************************
+* Global Function Declarations
+******************************************************************************/
+/**
+ * @fn			void DebugLoggerInit(void)
+ * @brief		Creates the logger task (CONF_SERIAL_CONSOLE_DEFERRED_LOG).
+ * @note		Called by InitializeSerialConsole. Messages logged before the
+ *				scheduler starts wait in the buffer.
+ *****************************************************************************/
+void DebugLoggerInit(void);
+
+/**
+ * @fn			void DebugLoggerVCapture(enum eLogModule module, enum eDebugLogLevels level, bool uart,
+ *									 const char *format, va_list args)
+ * @brief		Writes a message into the log buffer without formatting it.
+ * @details		Safe from tasks and interrupts. Overwrites the oldest entry.
+ * @param[in]	uart Let the logger task send it (CONF_SERIAL_CONSOLE_DEFERRED_LOG)
+ *****************************************************************************/
+void DebugLoggerVCapture(enum eLogModule module, enum eDebugLogLevels level, bool uart, const char *format,
+                         va_list args);
+
+/**
+ * @fn			uint32_t DebugLoggerHead(void)
+ * @brief		Sequence number the next message will get.
+ * @note		The buffer holds the messages from Head - CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES
+ *				(or 0) up to Head - 1.
+ *****************************************************************************/
+uint32_t DebugLoggerHead(void);
+
+/**
+ * @fn			bool DebugLoggerRead(uint32_t seq, struct DebugLogEntry *entry)
+ * @brief		Copies one message out of the log buffer.
+ * @return		false if it has been overwritten, or is still being written
+ *****************************************************************************/
+bool DebugLoggerRead(uint32_t seq, struct DebugLogEntry *entry);
+
+/**
+ * @fn			size_t DebugLoggerFormat(const struct DebugLogEntry *entry, char *line, size_t size)
+ * @brief		Formats a message behind its capture time, "[    s.mmm] text".
+ * @return		Characters written; the line is cut at size and not terminated
+ *****************************************************************************/
+size_t DebugLoggerFormat(const struct DebugLogEntry *entry, char *line, size_t size);
+
+/**
+ * @fn			void DebugLoggerCount(uint32_t cycles)
+ * @brief		Adds one LogMessage call and its cost to the counters.
+ *****************************************************************************/
+void DebugLoggerCount(uint32_t cycles);
+
+/**
+ * @fn			void DebugLoggerGetStats(struct DebugLoggerStats *stats)
+ * @brief		Copies the logging counters.
+ * @note		Average cost of a call = cycles / calls.
+ *****************************************************************************/
+void DebugLoggerGetStats(struct DebugLoggerStats *stats);
+
+#endif /* DEBUG_LOGGER_H */
@@ -0,0 +1,2491 @@
+/**************************************************************************//**
+ * @file        SerialChannel.c
+ * @ingroup     Serial Console
+ * @brief       One UART on one SERCOM, with its own rings, transport, counters and wakeups.
+ * @details     The code in this file will, per channel:
+ *              - Initialize a SERCOM port to operate as a UART, 8N1.
+ *              - Move transmitted and received bytes through ASF one-byte jobs, a
+ *                lean SERCOM handler that streams straight from the rings, or the
+ *                DMAC: one transfer per contiguous TX span, and endless RX into the
+ *                ring with a byte-count watermark and an idle-line timeout.
+ *              - Send the urgent TX lane ahead of the bulk lane at bulk message
+ *                boundaries.
+ *              - Optionally run the cooked-mode line discipline in the receive path.
+ *              - Optionally drive RTS from the receive ring fill level and count
+ *                CTS pauses.
+ *              Interrupt handlers find their channel through the ASF module
+ *              pointer, the SERCOM instance or the DMAC channel number.
+ * @copyright
+ * @author
+ * @date        October 16, 2026
+ * @version     0.1
+ *****************************************************************************/
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include "SerialChannel.h"
+
+/******************************************************************************/
+/* Defines                                                                    */
+/******************************************************************************/
+#define ASCII_BACKSPACE_CHAR 0x08 /**< Erases the previous character in cooked mode */
+#define ASCII_DELETE_CHAR    0x7F /**< Sent by most terminals for the backspace key */
+#define ASCII_ESC_CHAR       0x1B /**< Starts a terminal escape sequence */
+
+#if CONF_SERIAL_CONSOLE_RTS_RESUME_PERCENT >= CONF_SERIAL_CONSOLE_RTS_PAUSE_PERCENT || \
+    CONF_SERIAL_CONSOLE_RTS_PAUSE_PERCENT > 100
+#error "CONF_SERIAL_CONSOLE_RTS_RESUME_PERCENT must be below CONF_SERIAL_CONSOLE_RTS_PAUSE_PERCENT <= 100"
+#endif
+
+#if (CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS & (CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS - 1)) != 0
+#error "CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS must be a power of two"
+#endif
+
+/******************************************************************************/
+/* Structures and Enumerations                                                */
+/******************************************************************************/
+/** First descriptor of every DMAC channel. The DMAC requires 128-bit alignment. */
+COMPILER_ALIGNED(16) static DmacDescriptor dmaDescriptorSection[CONF_SERIAL_CONSOLE_DMA_CHANNELS];
+/** Write-back area where the DMAC stores the state of suspended/active channels */
+COMPILER_ALIGNED(16) static DmacDescriptor dmaWritebackSection[CONF_SERIAL_CONSOLE_DMA_CHANNELS];
+static bool dmaInitialized = false; /**< DMAC clocks and sections are set up */
+
+/** Channel served by each DMAC channel, for DMAC_Handler */
+static struct SerialChannel *dmaChannelOwners[CONF_SERIAL_CONSOLE_DMA_CHANNELS];
+/** Channel running on each SERCOM, for the SERCOM handlers and the tick hook */
+static struct SerialChannel *sercomChannels[SERCOM_INST_NUM];
+
+/** Write position of SerialChannelVPrintf inside its reservation */
+struct txFormatCursor {
+    mpsc_reservation_t res; /**< Reserved TX ring space */
+    size_t offset;          /**< Characters written so far */
+};
+
+/******************************************************************************/
+/* Local Function Declarations                                                */
+/******************************************************************************/
+static void configure_usart(struct SerialChannel *ch, const struct SerialChannelConfig *config);
+static void configure_usart_callbacks(struct SerialChannel *ch);
+static void configure_flow_control(struct SerialChannel *ch);
+static void configure_dma(struct SerialChannel *ch);
+static void configure_dma_channel(int8_t channel, uint8_t trigger, uint8_t level);
+static void tx_start(struct SerialChannel *ch);
+static mpsc_ring_t *tx_lane(struct SerialChannel *ch, enum eTxLane lane);
+static bool tx_write(struct SerialChannel *ch, enum eTxLane lane, const uint8_t *data, size_t len,
+                     enum eTxPolicy policy, TickType_t timeout);
+static bool tx_acquire(struct SerialChannel *ch, enum eTxLane lane, size_t len, mpsc_reservation_t *res,
+                       enum eTxPolicy policy, TickType_t timeout);
+static void tx_commit(struct SerialChannel *ch, enum eTxLane lane);
+static void tx_format_sink(void *ctx, const char *data, size_t len);
+static bool tx_reserve(struct SerialChannel *ch, enum eTxLane lane, size_t len, mpsc_reservation_t *res, bool evict);
+static void tx_evict(struct SerialChannel *ch, size_t len);
+static void tx_drop(struct SerialChannel *ch, size_t len);
+static void tx_space_freed(struct SerialChannel *ch, BaseType_t *pxHigherPriorityTaskWoken);
+static void tx_drain(struct SerialChannel *ch);
+static bool tx_pending(struct SerialChannel *ch);
+static bool tx_bulk_at_boundary(struct SerialChannel *ch);
+static mpsc_ring_t *tx_select_lane(struct SerialChannel *ch);
+static int tx_next_byte(struct SerialChannel *ch, uint8_t *c);
+static size_t tx_bulk_burst(struct SerialChannel *ch);
+static bool rx_take_confirmation(struct SerialChannel *ch);
+static void rx_byte(struct SerialChannel *ch, uint8_t c, BaseType_t *pxHigherPriorityTaskWoken);
+static void rx_signal(struct SerialChannel *ch, BaseType_t *pxHigherPriorityTaskWoken);
+static void rx_line_drain(struct SerialChannel *ch, BaseType_t *pxHigherPriorityTaskWoken);
+static void rx_flow_update(struct SerialChannel *ch);
+static void tx_flow_changed(struct SerialChannel *ch);
+static void line_input(struct SerialChannel *ch, uint8_t c, BaseType_t *pxHigherPriorityTaskWoken);
+static void dma_tx_start(struct SerialChannel *ch);
+static void dma_rx_start(struct SerialChannel *ch);
+static size_t dma_rx_write_offset(struct SerialChannel *ch);
+static bool dma_rx_publish(struct SerialChannel *ch);
+static void usart_read_callback(struct usart_module *const usart_module);
+static void usart_write_callback(struct usart_module *const usart_module);
+static void usart_cts_callback(struct usart_module *const usart_module);
+static void usart_error_callback(struct usart_module *const usart_module);
+static void rx_error(struct SerialChannel *ch, uint8_t status);
+static void sercom_lean_handler(uint8_t instance);
+static void sercom_error_handler(uint8_t instance);
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+static uint32_t timing_now_us(void);
+static void timing_record(uint32_t *histogram, uint32_t *maxUs, uint32_t us);
+static void timing_read(struct SerialChannel *ch, uint32_t from, size_t len);
+#endif
+#if CONF_SERIAL_CONSOLE_ISR_PROFILING
+static void sercom_profiled_handler(uint8_t instance);
+#endif
+
+/******************************************************************************/
+/* Global Functions                                                           */
+/******************************************************************************/
+
+/**************************************************************************//**
+ * @brief Fills a channel configuration with defaults.
+ *
+ * @param[out] config Configuration to initialize.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelGetConfigDefaults(struct SerialChannelConfig *config)
+{
+    config->hw = NULL;
+    config->muxSetting = USART_RX_1_TX_0_XCK_1;
+    config->pinmuxPad0 = PINMUX_DEFAULT;
+    config->pinmuxPad1 = PINMUX_DEFAULT;
+    config->pinmuxPad2 = PINMUX_DEFAULT;
+    config->pinmuxPad3 = PINMUX_DEFAULT;
+    config->baudRate = 115200;
+    config->dmaTxChannel = SERIAL_CHANNEL_NO_DMA;
+    config->dmaRxChannel = SERIAL_CHANNEL_NO_DMA;
+    config->leanIsr = false;
+    config->rtsPin = SERIAL_CHANNEL_NO_PIN;
+    config->txPolicy = TX_POLICY_DROP_NEWEST;
+    config->txTimeoutMs = 20;
+    config->echoMode = ECHO_MODE_OFF;
+    config->line = NULL;
+    config->irqPriority = 10;
+    config->standbyWake = false;
+    config->gclkGenerator = GCLK_GENERATOR_0;
+}
+
+/**************************************************************************//**
+ * @brief Initializes a channel.
+ *
+ * Creates the semaphores first, then configures the USART, its handlers,
+ * flow control and DMAC channels, and kicks off reception.
+ *
+ * @param[in] ch     Channel from SERIAL_CHANNEL_DEFINE.
+ * @param[in] config Settings of the channel.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelInit(struct SerialChannel *ch, const struct SerialChannelConfig *config)
+{
+    ch->line = config->line;
+    ch->baudRate = config->baudRate;
+    ch->defaultBaudRate = config->baudRate;
+    ch->dmaTxChannel = config->dmaTxChannel;
+    ch->dmaRxChannel = config->dmaRxChannel;
+    ch->leanIsr = config->leanIsr;
+    ch->rtsPin = config->rtsPin;
+    ch->txPolicy = config->txPolicy;
+    ch->txTimeout = pdMS_TO_TICKS(config->txTimeoutMs);
+    ch->echoMode = config->echoMode;
+    ch->standbyWake = config->standbyWake;
+
+    ch->rxSemaphore = xSemaphoreCreateBinary();
+    configASSERT(ch->rxSemaphore);
+    ch->txSpaceSemaphore = xSemaphoreCreateBinary();
+    configASSERT(ch->txSpaceSemaphore);
+
+    /* Configure the USART and register callbacks */
+    configure_usart(ch, config);
+
+    /* The handlers and the tick hook see the channel once it is fully set up */
+    system_interrupt_enter_critical_section();
+    sercomChannels[_sercom_get_sercom_inst_index(ch->usart.hw)] = ch;
+    configure_usart_callbacks(ch);
+    if (ch->rtsPin != SERIAL_CHANNEL_NO_PIN)
+    {
+        configure_flow_control(ch);
+    }
+    if (ch->dmaTxChannel != SERIAL_CHANNEL_NO_DMA || ch->dmaRxChannel != SERIAL_CHANNEL_NO_DMA)
+    {
+        configure_dma(ch);
+    }
+
+    NVIC_SetPriority((IRQn_Type)_sercom_get_interrupt_vector(ch->usart.hw), config->irqPriority);
+
+    /* Kick off constant reading of characters */
+    if (ch->dmaRxChannel != SERIAL_CHANNEL_NO_DMA)
+    {
+        /* The DMAC moves damaged characters too: count them from the error interrupt */
+        ch->usart.hw->USART.INTENSET.reg = SERCOM_USART_INTFLAG_ERROR;
+        dma_rx_start(ch);
+    }
+    else if (ch->leanIsr)
+    {
+        ch->usart.hw->USART.INTENSET.reg = SERCOM_USART_INTFLAG_RXC;
+    }
+    else
+    {
+        usart_read_buffer_job(&ch->usart, &ch->latestRx, 1);
+    }
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Disables the channel's SERCOM.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelDeinit(struct SerialChannel *ch)
+{
+    usart_disable(&ch->usart);
+}
+
+/**************************************************************************//**
+ * @brief Writes len bytes with the channel's full-ring policy.
+ *
+ * @param[in] ch   Channel.
+ * @param[in] data Bytes to send.
+ * @param[in] len  Number of bytes to send.
+ *
+ * @return true if the data was queued, false if it was dropped.
+ *****************************************************************************/
+bool SerialChannelWrite(struct SerialChannel *ch, const uint8_t *data, size_t len)
+{
+    return SerialChannelWritePolicy(ch, data, len, ch->txPolicy, ch->txTimeout);
+}
+
+/**************************************************************************//**
+ * @brief Writes len bytes with an explicit full-ring policy.
+ *
+ * The data is copied into its own reservation of the TX ring, so tasks and
+ * interrupts may call this concurrently without interleaving their messages.
+ *
+ * @param[in] ch      Channel.
+ * @param[in] data    Bytes to send.
+ * @param[in] len     Number of bytes to send.
+ * @param[in] policy  Behaviour when the data does not fit.
+ * @param[in] timeout Ticks to wait under TX_POLICY_BLOCK.
+ *
+ * @return true if the data was queued, false if it was dropped.
+ *****************************************************************************/
+bool SerialChannelWritePolicy(struct SerialChannel *ch, const uint8_t *data, size_t len, enum eTxPolicy policy,
+                              TickType_t timeout)
+{
+    return tx_write(ch, TX_LANE_BULK, data, len, policy, timeout);
+}
+
+/**************************************************************************//**
+ * @brief Writes len bytes to one lane with the channel's full-ring policy.
+ *
+ * @param[in] ch   Channel.
+ * @param[in] lane Lane to queue the data in.
+ * @param[in] data Bytes to send.
+ * @param[in] len  Number of bytes to send.
+ *
+ * @return true if the data was queued, false if it was dropped.
+ *****************************************************************************/
+bool SerialChannelWriteLane(struct SerialChannel *ch, enum eTxLane lane, const uint8_t *data, size_t len)
+{
+    return tx_write(ch, lane, data, len, ch->txPolicy, ch->txTimeout);
+}
+
+/**************************************************************************//**
+ * @brief printf-style write to a channel.
+ *
+ * See SerialChannelVPrintf.
+ *
+ * @param[in] ch     Channel.
+ * @param[in] format printf format string.
+ *
+ * @return Number of characters queued, or -1 if the message was dropped.
+ *****************************************************************************/
+int SerialChannelPrintf(struct SerialChannel *ch, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = SerialChannelVPrintf(ch, format, args);
+    va_end(args);
+
+    return written;
+}
+
+/**************************************************************************//**
+ * @brief vprintf-style write to a channel.
+ *
+ * Formats straight into the TX ring without an intermediate buffer: a first
+ * pass measures the output, the message is reserved in the ring with the
+ * channel's policy, and a second pass writes it in place.
+ *
+ * @param[in] ch     Channel.
+ * @param[in] format printf format string (see console_format.h for the subset).
+ * @param[in] args   Arguments for the format.
+ *
+ * @return Number of characters queued, or -1 if the message was dropped.
+ *****************************************************************************/
+int SerialChannelVPrintf(struct SerialChannel *ch, const char *format, va_list args)
+{
+    return SerialChannelVPrintfLane(ch, TX_LANE_BULK, format, args);
+}
+
+/**************************************************************************//**
+ * @brief vprintf-style write to one lane of a channel.
+ *
+ * @param[in] ch     Channel.
+ * @param[in] lane   Lane to queue the message in.
+ * @param[in] format printf format string (see console_format.h for the subset).
+ * @param[in] args   Arguments for the format.
+ *
+ * @return Number of characters queued, or -1 if the message was dropped.
+ *****************************************************************************/
+int SerialChannelVPrintfLane(struct SerialChannel *ch, enum eTxLane lane, const char *format, va_list args)
+{
+    struct txFormatCursor cursor;
+    va_list measure;
+
+    va_copy(measure, args);
+    size_t len = console_vformat(NULL, NULL, format, measure);
+    va_end(measure);
+
+    if (len == 0)
+    {
+        return 0;
+    }
+    if (!tx_acquire(ch, lane, len, &cursor.res, ch->txPolicy, ch->txTimeout))
+    {
+        return -1;
+    }
+
+    cursor.offset = 0;
+    console_vformat(tx_format_sink, &cursor, format, args);
+    /* Pad if an argument changed between the passes, the reservation is committed whole */
+    while (cursor.offset < len)
+    {
+        tx_format_sink(&cursor, " ", 1);
+    }
+    tx_commit(ch, lane);
+
+    return (int)len;
+}
+
+/**************************************************************************//**
+ * @brief Reads a character from the RX ring.
+ *
+ * Lock-free: the receive interrupt is the only producer and the calling task
+ * the only consumer.
+ *
+ * @param[in]  ch     Channel.
+ * @param[out] rxChar Pointer where the received character will be stored.
+ *
+ * @return 0, or -1 if the ring is empty.
+ *****************************************************************************/
+int SerialChannelReadCharacter(struct SerialChannel *ch, uint8_t *rxChar)
+{
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+    uint32_t from = ch->rx.tail;
+#endif
+    int status = spsc_ring_get(&ch->rx, rxChar);
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+    timing_read(ch, from, (status == 0) ? 1 : 0);
+#endif
+    if (ch->rxFlowPaused)
+    {
+        rx_flow_update(ch);
+    }
+    return status;
+}
+
+/**************************************************************************//**
+ * @brief Reads a block of characters from the RX ring.
+ *
+ * Moves up to len bytes out of the ring with at most two memcpy calls.
+ *
+ * @param[in]  ch   Channel.
+ * @param[out] data Destination buffer.
+ * @param[in]  len  Size of the destination buffer.
+ *
+ * @return Number of bytes read (0 if the ring is empty).
+ *****************************************************************************/
+size_t SerialChannelRead(struct SerialChannel *ch, uint8_t *data, size_t len)
+{
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+    uint32_t from = ch->rx.tail;
+#endif
+    len = spsc_ring_get_range(&ch->rx, data, len);
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+    timing_read(ch, from, len);
+#endif
+    if (ch->rxFlowPaused)
+    {
+        rx_flow_update(ch);
+    }
+    return len;
+}
+
+/**************************************************************************//**
+ * @brief Blocks until the receive path publishes more data.
+ *
+ * The semaphore is given once per published burst, so drain the ring before
+ * waiting again.
+ *
+ * @param[in] ch      Channel.
+ * @param[in] timeout Ticks to wait.
+ *
+ * @return true if signalled, false on timeout.
+ *****************************************************************************/
+bool SerialChannelWaitForData(struct SerialChannel *ch, TickType_t timeout)
+{
+    bool signalled = xSemaphoreTake(ch->rxSemaphore, timeout) == pdTRUE;
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+    if (signalled)
+    {
+        uint32_t now = timing_now_us();
+        system_interrupt_enter_critical_section();
+        timing_record(ch->timing.wakeup, &ch->timing.wakeupMaxUs, now - ch->rxSignalUs);
+        system_interrupt_leave_critical_section();
+    }
+#endif
+    return signalled;
+}
+
+/**************************************************************************//**
+ * @brief Blocks until a complete line has been received and copies it out.
+ *
+ * The calling task is notified by the receive path once per completed line,
+ * so it does not run at all while the line is being typed.
+ *
+ * @param[in]  ch   Channel in cooked mode.
+ * @param[out] line Buffer that receives the null-terminated line.
+ * @param[in]  size Size of the buffer; longer lines are truncated.
+ *
+ * @return Length of the line copied to the buffer.
+ *****************************************************************************/
+size_t SerialChannelReadLine(struct SerialChannel *ch, char *line, size_t size)
+{
+    struct SerialLine *ln = ch->line;
+    uint8_t c;
+    size_t len = 0;
+
+    configASSERT(ln != NULL);
+    ln->reader = xTaskGetCurrentTaskHandle();
+    while (spsc_ring_empty(&ln->lines))
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+        if (!spsc_ring_empty(&ln->lines) && ln->doneIn - ln->doneOut <= SERIAL_LINE_TIMESTAMPS)
+        {
+            uint32_t now = timing_now_us();
+            system_interrupt_enter_critical_section();
+            timing_record(ch->timing.wakeup, &ch->timing.wakeupMaxUs,
+                          now - ln->doneUs[ln->doneOut & (SERIAL_LINE_TIMESTAMPS - 1)]);
+            system_interrupt_leave_critical_section();
+        }
+#endif
+    }
+
+    /* Lines are published whole, so the terminator is already in the ring */
+    while (spsc_ring_get(&ln->lines, &c) == 0 && c != '\0')
+    {
+        if (len + 1 < size)
+        {
+            line[len++] = (char)c;
+        }
+    }
+    if (size > 0)
+    {
+        line[len] = '\0';
+    }
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+    {
+        /* Lines completed while the ring of completion times was full were not stamped */
+        uint32_t now = timing_now_us();
+        system_interrupt_enter_critical_section();
+        if (ln->doneIn - ln->doneOut <= SERIAL_LINE_TIMESTAMPS)
+        {
+            timing_record(ch->timing.latency, &ch->timing.latencyMaxUs,
+                          now - ln->doneUs[ln->doneOut & (SERIAL_LINE_TIMESTAMPS - 1)]);
+        }
+        ln->doneOut++;
+        system_interrupt_leave_critical_section();
+    }
+#endif
+
+    if (ch->rxFlowPaused)
+    {
+        rx_flow_update(ch);
+    }
+    return len;
+}
+
+/**************************************************************************//**
+ * @brief Waits for a complete line without taking it.
+ *
+ * A notification left from a line that was already read may end the wait
+ * early; the result tells.
+ *
+ * @param[in] ch      Channel in cooked mode.
+ * @param[in] timeout Ticks to wait.
+ *
+ * @return true if a line is ready for SerialChannelReadLine.
+ *****************************************************************************/
+bool SerialChannelWaitForLine(struct SerialChannel *ch, TickType_t timeout)
+{
+    struct SerialLine *ln = ch->line;
+
+    configASSERT(ln != NULL);
+    ln->reader = xTaskGetCurrentTaskHandle();
+    if (spsc_ring_empty(&ln->lines))
+    {
+        ulTaskNotifyTake(pdTRUE, timeout);
+    }
+    return !spsc_ring_empty(&ln->lines);
+}
+
+/**************************************************************************//**
+ * @brief Detects the end of a burst of received characters.
+ *
+ * Called from the FreeRTOS tick hook. For every channel receiving through the
+ * DMAC: when received data has not been published yet and the DMA write offset
+ * has not moved for CONF_SERIAL_CONSOLE_RX_IDLE_TICKS ticks, the line is
+ * considered idle and the data is handed to the consumer without waiting for
+ * the watermark.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelTickHook(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    for (size_t i = 0; i < SERCOM_INST_NUM; i++)
+    {
+        struct SerialChannel *ch = sercomChannels[i];
+        bool idle = false;
+
+        if (ch == NULL || ch->dmaRxChannel == SERIAL_CHANNEL_NO_DMA)
+        {
+            continue;
+        }
+
+        system_interrupt_enter_critical_section();
+        size_t offset = dma_rx_write_offset(ch);
+        if (offset == ch->dmaRxPosition || offset != ch->dmaRxLastSeen)
+        {
+            ch->dmaRxLastSeen = offset;
+            ch->dmaRxQuietTicks = 0;
+        }
+        else if (++ch->dmaRxQuietTicks >= CONF_SERIAL_CONSOLE_RX_IDLE_TICKS)
+        {
+            ch->dmaRxQuietTicks = 0;
+            idle = dma_rx_publish(ch);
+        }
+        system_interrupt_leave_critical_section();
+
+        if (idle)
+        {
+            ch->stats.rxIdleWakeups++;
+            rx_signal(ch, &xHigherPriorityTaskWoken);
+        }
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**************************************************************************//**
+ * @brief Checks that standby cannot lose data and arms the start-bit wakeups.
+ *
+ * The RXS flag is set by every start bit, so seeing it here means a character
+ * may still be arriving: standby waits one character time after the last one.
+ * After a wakeup by a start bit that time has passed as well, and the
+ * character is checked: missing or damaged, it counts as a missed first byte.
+ * A channel without standbyWake would stop in standby and keeps the device
+ * awake. Call with interrupts disabled.
+ *
+ * @return true if every channel is idle; their RXS interrupts are then enabled.
+ *****************************************************************************/
+bool SerialChannelStandbyReady(void)
+{
+    TickType_t now = xTaskGetTickCountFromISR();
+
+    for (size_t i = 0; i < SERCOM_INST_NUM; i++)
+    {
+        struct SerialChannel *ch = sercomChannels[i];
+
+        if (ch == NULL)
+        {
+            continue;
+        }
+        if (!ch->standbyWake)
+        {
+            return false;
+        }
+
+        SercomUsart *const usart = &ch->usart.hw->USART;
+        /* One character plus a tick of rounding */
+        TickType_t characterTicks = pdMS_TO_TICKS(10 * 1000 / ch->baudRate) + 2;
+
+        if (usart->INTFLAG.reg & SERCOM_USART_INTFLAG_RXS)
+        {
+            usart->INTFLAG.reg = SERCOM_USART_INTFLAG_RXS;
+            ch->rxStartTick = now;
+        }
+        if (now - ch->rxStartTick < characterTicks)
+        {
+            return false;
+        }
+        if (ch->rxWakePending)
+        {
+            bool received = (ch->dmaRxChannel != SERIAL_CHANNEL_NO_DMA) ?
+                            dma_rx_write_offset(ch) != ch->rxWakeDmaOffset : ch->stats.rxBytes != ch->rxWakeBytes;
+            uint32_t errors = ch->stats.rxFramingErrors + ch->stats.rxParityErrors + ch->stats.rxBufferOverflows;
+
+            if (!received || errors != ch->rxWakeErrors)
+            {
+                ch->stats.rxWakeMissed++;
+            }
+            ch->rxWakePending = false;
+        }
+
+        if (tx_pending(ch) || (ch->stats.txBytes != 0 && !(usart->INTFLAG.reg & SERCOM_USART_INTFLAG_TXC)))
+        {
+            return false;
+        }
+        if (ch->dmaRxChannel != SERIAL_CHANNEL_NO_DMA && dma_rx_write_offset(ch) != ch->dmaRxPosition)
+        {
+            return false;
+        }
+    }
+
+    /* Nothing can be received until the wakeup: what arrives after it is the first character */
+    for (size_t i = 0; i < SERCOM_INST_NUM; i++)
+    {
+        struct SerialChannel *ch = sercomChannels[i];
+
+        if (ch == NULL)
+        {
+            continue;
+        }
+        ch->rxWakeBytes = ch->stats.rxBytes;
+        ch->rxWakeErrors = ch->stats.rxFramingErrors + ch->stats.rxParityErrors + ch->stats.rxBufferOverflows;
+        if (ch->dmaRxChannel != SERIAL_CHANNEL_NO_DMA)
+        {
+            ch->rxWakeDmaOffset = ch->dmaRxPosition;
+        }
+        ch->usart.hw->USART.INTENSET.reg = SERCOM_USART_INTFLAG_RXS;
+    }
+    return true;
+}
+
+/**************************************************************************//**
+ * @brief Disarms the start-bit wakeups and counts the start bits seen in standby.
+ *
+ * Runs before the SERCOM handlers, which never see RXS. A character whose
+ * start bit was seen is checked by the next SerialChannelStandbyReady()
+ * against the counters saved when standby was armed.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelStandbyLeave(void)
+{
+    TickType_t now = xTaskGetTickCountFromISR();
+
+    for (size_t i = 0; i < SERCOM_INST_NUM; i++)
+    {
+        struct SerialChannel *ch = sercomChannels[i];
+
+        if (ch == NULL)
+        {
+            continue;
+        }
+
+        SercomUsart *const usart = &ch->usart.hw->USART;
+        usart->INTENCLR.reg = SERCOM_USART_INTFLAG_RXS;
+        if (usart->INTFLAG.reg & SERCOM_USART_INTFLAG_RXS)
+        {
+            usart->INTFLAG.reg = SERCOM_USART_INTFLAG_RXS;
+            ch->stats.rxStartWakeups++;
+            ch->rxStartTick = now;
+            ch->rxWakePending = true;
+        }
+    }
+}
+
+/**************************************************************************//**
+ * @brief Copies the transfer counters of a channel.
+ *
+ * @param[in]  ch    Channel.
+ * @param[out] stats Structure that receives a snapshot of the counters.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelGetStats(struct SerialChannel *ch, struct SerialChannelStats *stats)
+{
+    system_interrupt_enter_critical_section();
+    *stats = ch->stats;
+    for (size_t lane = 0; lane < TX_LANES; lane++)
+    {
+        mpsc_ring_t *ring = tx_lane(ch, (enum eTxLane)lane);
+        stats->txQueued[lane] = ring->reserved - ring->ring.tail;
+    }
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Registers a function told about every receive error.
+ *
+ * @param[in] ch      Channel.
+ * @param[in] handler Called from the receive interrupt, or NULL.
+ * @param[in] ctx     Passed to the handler.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelSetErrorHandler(struct SerialChannel *ch, SerialChannelErrorHandler handler, void *ctx)
+{
+    system_interrupt_enter_critical_section();
+    ch->errorCtx = ctx;
+    ch->errorHandler = handler;
+    system_interrupt_leave_critical_section();
+}
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+/**************************************************************************//**
+ * @brief Copies the receive timing histograms of a channel.
+ *
+ * @param[in]  ch     Channel.
+ * @param[out] timing Structure that receives a snapshot of the histograms.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelGetTiming(struct SerialChannel *ch, struct SerialChannelTiming *timing)
+{
+    system_interrupt_enter_critical_section();
+    *timing = ch->timing;
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Clears the receive timing histograms of a channel.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelResetTiming(struct SerialChannel *ch)
+{
+    system_interrupt_enter_critical_section();
+    memset(&ch->timing, 0, sizeof(ch->timing));
+    system_interrupt_leave_critical_section();
+}
+#endif
+
+/**************************************************************************//**
+ * @brief Selects who echoes received characters.
+ *
+ * @param[in] ch   Channel.
+ * @param[in] mode The new echo mode.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelSetEchoMode(struct SerialChannel *ch, enum eEchoMode mode)
+{
+    ch->echoMode = mode;
+}
+
+/**************************************************************************//**
+ * @brief Gets the echo mode of a channel.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return The current echo mode.
+ *****************************************************************************/
+enum eEchoMode SerialChannelGetEchoMode(struct SerialChannel *ch)
+{
+    return ch->echoMode;
+}
+
+/**************************************************************************//**
+ * @brief Changes the baud rate of a channel.
+ *
+ * Waits until the queued output has left the shift register, then reprograms
+ * the enable-protected BAUD register with the SERCOM briefly disabled. The
+ * receive DMA channel, jobs and interrupt enables are kept.
+ *
+ * @param[in] ch       Channel.
+ * @param[in] baudRate New baud rate.
+ *
+ * @return false if the rate cannot be generated from the SERCOM clock.
+ *****************************************************************************/
+bool SerialChannelSetBaudRate(struct SerialChannel *ch, uint32_t baudRate)
+{
+    uint32_t clockHz = system_gclk_chan_get_hz(SERCOM0_GCLK_ID_CORE +
+                                               _sercom_get_sercom_inst_index(ch->usart.hw));
+    uint16_t baudVal;
+
+    if (baudRate == 0 ||
+        _sercom_get_async_baud_val(baudRate, clockHz, &baudVal, SERCOM_ASYNC_OPERATION_MODE_ARITHMETIC,
+                                   SERCOM_ASYNC_SAMPLE_NUM_16) != STATUS_OK)
+    {
+        return false;
+    }
+
+    tx_drain(ch);
+
+    usart_disable(&ch->usart);
+    ch->usart.hw->USART.BAUD.reg = baudVal;
+    usart_enable(&ch->usart);
+
+    system_interrupt_enter_critical_section();
+    ch->baudRate = baudRate;
+    ch->baudSwitchTick = xTaskGetTickCount();
+    ch->baudSwitchTxBytes = ch->stats.txBytes;
+    ch->baudSwitchRxBytes = ch->stats.rxBytes;
+    system_interrupt_leave_critical_section();
+    return true;
+}
+
+/**************************************************************************//**
+ * @brief Switches the baud rate and waits for the peer to confirm it.
+ *
+ * Anything received before the switch is discarded so that only an answer at
+ * the new rate counts. Without one within the timeout the channel falls back
+ * to its initial rate, which both sides know.
+ *
+ * @param[in] ch       Channel.
+ * @param[in] baudRate New baud rate.
+ * @param[in] timeout  Time the peer has to answer.
+ *
+ * @return true if the peer confirmed the new rate.
+ *****************************************************************************/
+bool SerialChannelNegotiateBaudRate(struct SerialChannel *ch, uint32_t baudRate, TickType_t timeout)
+{
+    TimeOut_t xTimeOut;
+
+    if (!SerialChannelSetBaudRate(ch, baudRate))
+    {
+        return false;
+    }
+
+    while (rx_take_confirmation(ch))
+    {
+        /* Drop input that arrived at the old rate */
+    }
+
+    vTaskSetTimeOutState(&xTimeOut);
+    do
+    {
+        if (rx_take_confirmation(ch))
+        {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    } while (xTaskCheckForTimeOut(&xTimeOut, &timeout) == pdFALSE);
+
+    SerialChannelSetBaudRate(ch, ch->defaultBaudRate);
+    return false;
+}
+
+/**************************************************************************//**
+ * @brief Gets the current baud rate of a channel.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return The current baud rate.
+ *****************************************************************************/
+uint32_t SerialChannelGetBaudRate(struct SerialChannel *ch)
+{
+    return ch->baudRate;
+}
+
+/**************************************************************************//**
+ * @brief Average throughput since the last baud rate change.
+ *
+ * @param[in]  ch               Channel.
+ * @param[out] txBytesPerSecond Bytes sent per second.
+ * @param[out] rxBytesPerSecond Bytes received per second.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialChannelGetThroughput(struct SerialChannel *ch, uint32_t *txBytesPerSecond, uint32_t *rxBytesPerSecond)
+{
+    system_interrupt_enter_critical_section();
+    uint32_t tx = ch->stats.txBytes - ch->baudSwitchTxBytes;
+    uint32_t rx = ch->stats.rxBytes - ch->baudSwitchRxBytes;
+    system_interrupt_leave_critical_section();
+    uint32_t ms = (uint32_t)(xTaskGetTickCount() - ch->baudSwitchTick) * portTICK_PERIOD_MS;
+
+    *txBytesPerSecond = (ms != 0) ? (uint32_t)(((uint64_t)tx * 1000) / ms) : 0;
+    *rxBytesPerSecond = (ms != 0) ? (uint32_t)(((uint64_t)rx * 1000) / ms) : 0;
+}
+
+/******************************************************************************/
+/* Local Functions                                                            */
+/******************************************************************************/
+
+/**************************************************************************//**
+ * @brief Configures the USART.
+ *
+ * Sets up the baud rate, multiplexer settings and pin multiplexing, then
+ * initializes and enables the USART.
+ *
+ * @param[in] ch     Channel.
+ * @param[in] config Settings of the channel.
+ *
+ * @return None.
+ *****************************************************************************/
+static void configure_usart(struct SerialChannel *ch, const struct SerialChannelConfig *config)
+{
+    struct usart_config config_usart;
+    usart_get_config_defaults(&config_usart);
+
+    config_usart.baudrate = config->baudRate;
+    config_usart.mux_setting = config->muxSetting;
+    config_usart.pinmux_pad0 = config->pinmuxPad0;
+    config_usart.pinmux_pad1 = config->pinmuxPad1;
+    config_usart.pinmux_pad2 = config->pinmuxPad2;
+    config_usart.pinmux_pad3 = config->pinmuxPad3;
+    config_usart.generator_source = config->gclkGenerator;
+    config_usart.run_in_standby = config->standbyWake;
+    config_usart.start_frame_detection_enable = config->standbyWake;
+    while (usart_init(&ch->usart, config->hw, &config_usart) != STATUS_OK)
+    {
+        // Optionally add error handling here.
+    }
+    /* RXS is only enabled for standby, see SerialChannelStandbyReady; keep ASF read jobs from enabling it */
+    ch->usart.start_frame_detection_enabled = false;
+
+    usart_enable(&ch->usart);
+}
+
+/**************************************************************************//**
+ * @brief Registers USART callbacks.
+ *
+ * Registers and enables the USART callbacks for the directions served by ASF
+ * jobs. With a lean channel the channel's own handler replaces the ASF one in
+ * the SERCOM handler table instead. With RX DMA and ASF jobs for the rest,
+ * the ASF handler is wrapped by one serving the SERCOM error interrupt, which
+ * the ASF driver does not handle. With CONF_SERIAL_CONSOLE_ISR_PROFILING the
+ * handler in use is wrapped by a cycle-counting one.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return None.
+ *****************************************************************************/
+static void configure_usart_callbacks(struct SerialChannel *ch)
+{
+    uint8_t instance = _sercom_get_sercom_inst_index(ch->usart.hw);
+
+    if (!ch->leanIsr && ch->dmaTxChannel == SERIAL_CHANNEL_NO_DMA)
+    {
+        usart_register_callback(&ch->usart, usart_write_callback, USART_CALLBACK_BUFFER_TRANSMITTED);
+        usart_enable_callback(&ch->usart, USART_CALLBACK_BUFFER_TRANSMITTED);
+    }
+    if (!ch->leanIsr && ch->dmaRxChannel == SERIAL_CHANNEL_NO_DMA)
+    {
+        usart_register_callback(&ch->usart, usart_read_callback, USART_CALLBACK_BUFFER_RECEIVED);
+        usart_enable_callback(&ch->usart, USART_CALLBACK_BUFFER_RECEIVED);
+        usart_register_callback(&ch->usart, usart_error_callback, USART_CALLBACK_ERROR);
+        usart_enable_callback(&ch->usart, USART_CALLBACK_ERROR);
+    }
+    if (!ch->leanIsr && ch->rtsPin != SERIAL_CHANNEL_NO_PIN)
+    {
+        usart_register_callback(&ch->usart, usart_cts_callback, USART_CALLBACK_CTS_INPUT_CHANGE);
+        usart_enable_callback(&ch->usart, USART_CALLBACK_CTS_INPUT_CHANGE);
+    }
+
+#if CONF_SERIAL_CONSOLE_ISR_PROFILING
+    _sercom_set_handler(instance, sercom_profiled_handler);
+#else
+    if (ch->leanIsr)
+    {
+        _sercom_set_handler(instance, sercom_lean_handler);
+    }
+    else if (ch->dmaRxChannel != SERIAL_CHANNEL_NO_DMA)
+    {
+        _sercom_set_handler(instance, sercom_error_handler);
+    }
+#endif
+}
+
+/**************************************************************************//**
+ * @brief Configures the DMAC channels used by a channel.
+ *
+ * The first channel to use the DMAC enables its clocks and points it at the
+ * descriptor and write-back sections. The TX channel moves one byte per SERCOM
+ * "data register empty" request and only interrupts at the end of a transfer.
+ * The RX channel moves one byte per "receive complete" request and interrupts
+ * at the end of every watermark-sized block.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return None.
+ *****************************************************************************/
+static void configure_dma(struct SerialChannel *ch)
+{
+    uint8_t instance = _sercom_get_sercom_inst_index(ch->usart.hw);
+
+    if (!dmaInitialized)
+    {
+        system_ahb_clock_set_mask(PM_AHBMASK_DMAC);
+        system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBB, PM_APBBMASK_DMAC);
+
+        DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;
+        DMAC->CTRL.reg = DMAC_CTRL_SWRST;
+        DMAC->BASEADDR.reg = (uint32_t)dmaDescriptorSection;
+        DMAC->WRBADDR.reg = (uint32_t)dmaWritebackSection;
+        DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+
+        NVIC_SetPriority(DMAC_IRQn, CONF_SERIAL_CONSOLE_DMA_IRQ_PRIORITY);
+        NVIC_EnableIRQ(DMAC_IRQn);
+        dmaInitialized = true;
+    }
+
+    if (ch->dmaTxChannel != SERIAL_CHANNEL_NO_DMA)
+    {
+        configASSERT(ch->dmaTxChannel < CONF_SERIAL_CONSOLE_DMA_CHANNELS);
+        dmaChannelOwners[ch->dmaTxChannel] = ch;
+        configure_dma_channel(ch->dmaTxChannel, SERCOM0_DMAC_ID_TX + 2 * instance, 0);
+    }
+    if (ch->dmaRxChannel != SERIAL_CHANNEL_NO_DMA)
+    {
+        configASSERT(ch->dmaRxChannel < CONF_SERIAL_CONSOLE_DMA_CHANNELS);
+        configASSERT(ch->dmaRxBlockCount > 0);
+        dmaChannelOwners[ch->dmaRxChannel] = ch;
+        /* RX runs at a higher level so a long TX transfer never delays a received byte */
+        configure_dma_channel(ch->dmaRxChannel, SERCOM0_DMAC_ID_RX + 2 * instance, 1);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Resets one DMAC channel and binds it to a peripheral trigger.
+ *
+ * @param[in] channel DMAC channel.
+ * @param[in] trigger Trigger source (one beat per request).
+ * @param[in] level   Arbitration level.
+ *
+ * @return None.
+ *****************************************************************************/
+static void configure_dma_channel(int8_t channel, uint8_t trigger, uint8_t level)
+{
+    system_interrupt_enter_critical_section();
+    DMAC->CHID.reg = DMAC_CHID_ID(channel);
+    DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+    DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(level) | DMAC_CHCTRLB_TRIGSRC(trigger) | DMAC_CHCTRLB_TRIGACT_BEAT;
+    DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL | DMAC_CHINTENSET_TERR;
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Returns the ring of a TX lane.
+ *
+ * @param[in] ch   Channel.
+ * @param[in] lane Lane.
+ *
+ * @return The lane's ring.
+ *****************************************************************************/
+static mpsc_ring_t *tx_lane(struct SerialChannel *ch, enum eTxLane lane)
+{
+    return (lane == TX_LANE_URGENT) ? &ch->txUrgent : &ch->tx;
+}
+
+/**************************************************************************//**
+ * @brief Copies one message into a TX lane.
+ *
+ * The data is copied into its own reservation of the lane, so tasks and
+ * interrupts may call this concurrently without interleaving their messages.
+ *
+ * @param[in] ch      Channel.
+ * @param[in] lane    Lane to queue the message in.
+ * @param[in] data    Bytes to send.
+ * @param[in] len     Number of bytes to send.
+ * @param[in] policy  Behaviour when the data does not fit.
+ * @param[in] timeout Ticks to wait under TX_POLICY_BLOCK.
+ *
+ * @return true if the data was queued, false if it was dropped.
+ *****************************************************************************/
+static bool tx_write(struct SerialChannel *ch, enum eTxLane lane, const uint8_t *data, size_t len,
+                     enum eTxPolicy policy, TickType_t timeout)
+{
+    mpsc_reservation_t res;
+
+    if (len == 0)
+    {
+        return true;
+    }
+    if (!tx_acquire(ch, lane, len, &res, policy, timeout))
+    {
+        return false;
+    }
+
+    mpsc_reservation_fill(&res, data);
+    tx_commit(ch, lane);
+    return true;
+}
+
+/**************************************************************************//**
+ * @brief Reserves room for one message in a TX lane according to a full-ring policy.
+ *
+ * If the message does not fit it is dropped and counted, after waiting for the
+ * transmitter (TX_POLICY_BLOCK) or evicting older queued messages
+ * (TX_POLICY_DROP_OLDEST, bulk lane only) failed to make room. Eviction
+ * needs a task outside a critical section; elsewhere the message is dropped. On success the
+ * caller writes the reservation and calls tx_commit.
+ *
+ * @param[in]  ch      Channel.
+ * @param[in]  lane    Lane to queue the message in.
+ * @param[in]  len     Length of the message, at least 1.
+ * @param[out] res     Reservation to fill in.
+ * @param[in]  policy  Behaviour when the message does not fit.
+ * @param[in]  timeout Ticks to wait under TX_POLICY_BLOCK.
+ *
+ * @return true if the room was reserved, false if the message was dropped.
+ *****************************************************************************/
+static bool tx_acquire(struct SerialChannel *ch, enum eTxLane lane, size_t len, mpsc_reservation_t *res,
+                       enum eTxPolicy policy, TickType_t timeout)
+{
+    /* Eviction moves the newer messages with interrupts enabled: only a task outside a
+     * critical section may do it, anywhere else the new message is dropped instead */
+    bool evict = policy == TX_POLICY_DROP_OLDEST && lane == TX_LANE_BULK && __get_IPSR() == 0 &&
+                 __get_PRIMASK() == 0;
+    bool queued = tx_reserve(ch, lane, len, res, evict);
+
+    /* Blocking is only possible from a task, and pointless if the message can never fit */
+    if (!queued && policy == TX_POLICY_BLOCK && timeout > 0 && __get_IPSR() == 0 &&
+        xTaskGetSchedulerState() == taskSCHEDULER_RUNNING && len <= spsc_ring_capacity(&tx_lane(ch, lane)->ring))
+    {
+        TimeOut_t timeOut;
+
+        vTaskSetTimeOutState(&timeOut);
+        system_interrupt_enter_critical_section();
+        ch->stats.txBlockedWrites++;
+        ch->txWaiters++;
+        system_interrupt_leave_critical_section();
+
+        while (!(queued = tx_reserve(ch, lane, len, res, false)) &&
+               xTaskCheckForTimeOut(&timeOut, &timeout) == pdFALSE &&
+               xSemaphoreTake(ch->txSpaceSemaphore, timeout) == pdTRUE)
+        {
+        }
+
+        system_interrupt_enter_critical_section();
+        ch->txWaiters--;
+        system_interrupt_leave_critical_section();
+        if (queued && ch->txWaiters > 0)
+        {
+            xSemaphoreGive(ch->txSpaceSemaphore); // Let the next waiter try the remaining room.
+        }
+    }
+
+    if (!queued)
+    {
+        tx_drop(ch, len);
+    }
+    return queued;
+}
+
+/**************************************************************************//**
+ * @brief Commits the caller's reservation of a TX lane.
+ *
+ * The last writer out hands the published data to the transmitter.
+ *
+ * @param[in] ch   Channel.
+ * @param[in] lane Lane the reservation belongs to.
+ *
+ * @return None.
+ *****************************************************************************/
+static void tx_commit(struct SerialChannel *ch, enum eTxLane lane)
+{
+    if (mpsc_ring_commit(tx_lane(ch, lane)))
+    {
+        tx_start(ch);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Format sink copying console_vformat output into a TX ring reservation.
+ *
+ * @param[in] ctx  The struct txFormatCursor being written.
+ * @param[in] data Formatted characters.
+ * @param[in] len  Number of characters.
+ *
+ * @return None.
+ *****************************************************************************/
+static void tx_format_sink(void *ctx, const char *data, size_t len)
+{
+    struct txFormatCursor *cursor = ctx;
+
+    cursor->offset += mpsc_reservation_write(&cursor->res, cursor->offset, (const uint8_t *)data, len);
+}
+
+/**************************************************************************//**
+ * @brief Reserves room for one message in a TX lane and records its boundary.
+ *
+ * Bulk message boundaries are kept for eviction and for switching to the
+ * urgent lane; the urgent lane is always drained completely, so it needs none.
+ *
+ * @param[in]  ch    Channel.
+ * @param[in]  lane  Lane to queue the message in.
+ * @param[in]  len   Length of the message.
+ * @param[out] res   Reservation to fill in.
+ * @param[in]  evict Drop the oldest queued bulk messages first if the message does not fit.
+ *
+ * @return true if the room was reserved.
+ *****************************************************************************/
+static bool tx_reserve(struct SerialChannel *ch, enum eTxLane lane, size_t len, mpsc_reservation_t *res, bool evict)
+{
+    mpsc_ring_t *ring = tx_lane(ch, lane);
+
+    if (evict)
+    {
+        tx_evict(ch, len);
+    }
+
+    system_interrupt_enter_critical_section();
+    bool reserved = mpsc_ring_reserve(ring, len, res);
+    if (reserved && lane == TX_LANE_URGENT)
+    {
+        ch->stats.txUrgentMessages++;
+    }
+    else if (reserved)
+    {
+        /* Forget messages the transmitter has finished with; the boundary at the tail
+         * stays, it tells the transmitter it may switch lanes */
+        uint32_t tail = ch->tx.ring.tail;
+        while (ch->txMessageCount > 0 && (int32_t)(ch->txMessageEnds[ch->txMessageFirst] - tail) < 0)
+        {
+            ch->txMessageFirst = (ch->txMessageFirst + 1) & (CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS - 1);
+            ch->txMessageCount--;
+        }
+        if (ch->txMessageCount == CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS)
+        {
+            ch->txMessageFirst = (ch->txMessageFirst + 1) & (CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS - 1);
+            ch->txMessageCount--;
+        }
+        ch->txMessageEnds[(ch->txMessageFirst + ch->txMessageCount++) & (CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS - 1)] =
+            ch->tx.reserved;
+    }
+    if (reserved && ring->reserved - ring->ring.tail > ch->stats.txQueuedPeak[lane])
+    {
+        ch->stats.txQueuedPeak[lane] = ring->reserved - ring->ring.tail;
+    }
+    system_interrupt_leave_critical_section();
+
+    return reserved;
+}
+
+/**************************************************************************//**
+ * @brief Makes room for len bytes by dropping the oldest queued whole messages.
+ *
+ * Only messages the transmitter has not started are candidates: the bytes in
+ * flight and the rest of the message they belong to stay. Newer messages are
+ * moved down over the dropped ones with interrupts enabled; meanwhile the
+ * transmitter stops in front of them and other writers find the ring full.
+ * Nothing is dropped unless enough room can be made, or while another writer
+ * holds a reservation. Must be called outside a critical section.
+ *
+ * @param[in] ch  Channel.
+ * @param[in] len Length of the message that needs room.
+ *
+ * @return None.
+ *****************************************************************************/
+static void tx_evict(struct SerialChannel *ch, size_t len)
+{
+    mpsc_discard_t discard;
+
+    system_interrupt_enter_critical_section();
+    size_t space = mpsc_ring_space(&ch->tx);
+    if (space >= len || len > spsc_ring_capacity(&ch->tx.ring) || ch->tx.writers != 0)
+    {
+        system_interrupt_leave_critical_section();
+        return;
+    }
+
+    /* End of the bytes owned by the DMAC; latestTx is already out of the ring */
+    uint32_t busy = ch->tx.ring.tail + ((ch->dmaTxLane == &ch->tx) ? ch->dmaTxInFlight : 0);
+    uint32_t from = 0;
+    uint32_t dropped = 0;
+    bool found = false;
+
+    for (uint32_t i = 0; i < ch->txMessageCount; i++)
+    {
+        uint32_t end = ch->txMessageEnds[(ch->txMessageFirst + i) & (CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS - 1)];
+
+        if (!found)
+        {
+            /* The first boundary at or after the transmitter starts the droppable region */
+            if ((int32_t)(end - busy) >= 0)
+            {
+                from = end;
+                found = true;
+            }
+            continue;
+        }
+
+        dropped++;
+        if (end - from >= len - space)
+        {
+            if (!mpsc_ring_discard_begin(&ch->tx, from, end, &discard))
+            {
+                break;
+            }
+
+            /* Remove the dropped boundaries and shift the newer ones down */
+            uint32_t shift = end - from;
+            for (uint32_t k = i + 1; k < ch->txMessageCount; k++)
+            {
+                uint32_t src = (ch->txMessageFirst + k) & (CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS - 1);
+                uint32_t dst = (ch->txMessageFirst + k - dropped) & (CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS - 1);
+                ch->txMessageEnds[dst] = ch->txMessageEnds[src] - shift;
+            }
+            ch->txMessageCount -= dropped;
+
+            ch->stats.txDropped += shift;
+            ch->stats.txDroppedMessages += dropped;
+            ch->stats.txEvictedMessages += dropped;
+            system_interrupt_leave_critical_section();
+
+            if (mpsc_ring_discard_end(&ch->tx, &discard))
+            {
+                tx_start(ch);
+            }
+            return;
+        }
+    }
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Counts a message dropped because it did not fit in the TX ring.
+ *
+ * @param[in] ch  Channel.
+ * @param[in] len Length of the message.
+ *
+ * @return None.
+ *****************************************************************************/
+static void tx_drop(struct SerialChannel *ch, size_t len)
+{
+    system_interrupt_enter_critical_section();
+    ch->stats.txDropped += len;
+    ch->stats.txDroppedMessages++;
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Wakes a writer blocked on a full TX ring. Called from the TX interrupts
+ *        after they released space.
+ *
+ * @param[in]  ch                        Channel.
+ * @param[out] pxHigherPriorityTaskWoken Set if a higher priority task was woken.
+ *
+ * @return None.
+ *****************************************************************************/
+static void tx_space_freed(struct SerialChannel *ch, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (ch->txWaiters > 0)
+    {
+        xSemaphoreGiveFromISR(ch->txSpaceSemaphore, pxHigherPriorityTaskWoken);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Waits until everything queued in the TX ring has been shifted out.
+ *
+ * Bounded by twice the time a full ring takes at the current rate, in case
+ * the peer holds CTS.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return None.
+ *****************************************************************************/
+static void tx_drain(struct SerialChannel *ch)
+{
+    size_t capacity = spsc_ring_capacity(&ch->tx.ring) + spsc_ring_capacity(&ch->txUrgent.ring);
+    TickType_t timeout = pdMS_TO_TICKS(20 + (capacity * 10 * 2 * 1000) / ch->baudRate);
+    TimeOut_t xTimeOut;
+
+    vTaskSetTimeOutState(&xTimeOut);
+    while (tx_pending(ch) || !(ch->usart.hw->USART.INTFLAG.reg & SERCOM_USART_INTFLAG_TXC))
+    {
+        if (xTaskCheckForTimeOut(&xTimeOut, &timeout) != pdFALSE)
+        {
+            break;
+        }
+        vTaskDelay(1);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Tells whether any lane holds output or a writer is still filling one.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return true if there is output left to transmit.
+ *****************************************************************************/
+static bool tx_pending(struct SerialChannel *ch)
+{
+    return !spsc_ring_empty(&ch->tx.ring) || ch->tx.writers != 0 ||
+           !spsc_ring_empty(&ch->txUrgent.ring) || ch->txUrgent.writers != 0;
+}
+
+/**************************************************************************//**
+ * @brief Tells whether the bulk lane's transmitter stands between two messages.
+ *
+ * True when everything published has been taken, or the tail sits on a
+ * recorded message end. When the boundary slots overflowed and merged two
+ * messages, the merged boundary is not seen and the switch waits for the next.
+ * Must be called with interrupts masked or from the transmit interrupts.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return true if another lane may be sent without splitting a bulk message.
+ *****************************************************************************/
+static bool tx_bulk_at_boundary(struct SerialChannel *ch)
+{
+    uint32_t tail = ch->tx.ring.tail;
+
+    if (tail == ch->tx.ring.head)
+    {
+        return true;
+    }
+    for (uint32_t i = 0; i < ch->txMessageCount; i++)
+    {
+        if (ch->txMessageEnds[(ch->txMessageFirst + i) & (CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS - 1)] == tail)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**************************************************************************//**
+ * @brief Picks the lane the transmitter takes its next bytes from.
+ *
+ * The urgent lane as long as it holds data and the bulk lane is between
+ * messages, the bulk lane otherwise. Must be called with interrupts masked or
+ * from the transmit interrupts.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return The lane's ring.
+ *****************************************************************************/
+static mpsc_ring_t *tx_select_lane(struct SerialChannel *ch)
+{
+    if (!spsc_ring_empty(&ch->txUrgent.ring) && (ch->txUrgentSending || tx_bulk_at_boundary(ch)))
+    {
+        if (!ch->txUrgentSending && !spsc_ring_empty(&ch->tx.ring))
+        {
+            ch->stats.txPreemptions++;
+        }
+        ch->txUrgentSending = true;
+        return &ch->txUrgent;
+    }
+
+    ch->txUrgentSending = false;
+    return &ch->tx;
+}
+
+/**************************************************************************//**
+ * @brief Takes the next byte to transmit one at a time (ASF jobs, lean handler).
+ *
+ * @param[in]  ch Channel.
+ * @param[out] c  The byte.
+ *
+ * @return 0, or -1 if both lanes are empty.
+ *****************************************************************************/
+static int tx_next_byte(struct SerialChannel *ch, uint8_t *c)
+{
+    return spsc_ring_get(&tx_select_lane(ch)->ring, c);
+}
+
+/**************************************************************************//**
+ * @brief Length of the next bulk DMA transfer.
+ *
+ * Whole messages only, so that the transfer ends where an urgent message may
+ * go out: the first message, plus the following ones while the transfer stays
+ * within CONF_SERIAL_CONSOLE_TX_BULK_BURST bytes.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return Bytes to send from the tail of the bulk lane, 0 if it is empty.
+ *****************************************************************************/
+static size_t tx_bulk_burst(struct SerialChannel *ch)
+{
+    uint32_t tail = ch->tx.ring.tail;
+    uint32_t head = ch->tx.ring.head;
+    uint32_t end = tail;
+
+    for (uint32_t i = 0; i < ch->txMessageCount && end != head; i++)
+    {
+        uint32_t next = ch->txMessageEnds[(ch->txMessageFirst + i) & (CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS - 1)];
+
+        if ((int32_t)(next - tail) <= 0)
+        {
+            continue; // Already sent
+        }
+        if ((int32_t)(next - head) > 0 || (end != tail && next - tail > CONF_SERIAL_CONSOLE_TX_BULK_BURST))
+        {
+            break;
+        }
+        end = next;
+    }
+    /* Every published byte belongs to a recorded message; send it all should that ever fail */
+    return (end != tail) ? end - tail : head - tail;
+}
+
+/**************************************************************************//**
+ * @brief Takes one unit of input (a line in cooked mode, else a character).
+ *
+ * @param[in] ch Channel.
+ *
+ * @return true if there was one.
+ *****************************************************************************/
+static bool rx_take_confirmation(struct SerialChannel *ch)
+{
+    uint8_t c;
+
+    if (ch->line == NULL)
+    {
+        return SerialChannelReadCharacter(ch, &c) == 0;
+    }
+
+    if (spsc_ring_empty(&ch->line->lines))
+    {
+        return false;
+    }
+    while (spsc_ring_get(&ch->line->lines, &c) == 0 && c != '\0')
+    {
+    }
+    return true;
+}
+
+/**************************************************************************//**
+ * @brief Receive path for one character taken from the SERCOM by an interrupt.
+ *
+ * Stores the character into the RX ring, echoes it in raw ECHO_MODE_ISR and
+ * signals the reader.
+ *
+ * @param[in]  ch                        Channel.
+ * @param[in]  c                         Received character.
+ * @param[out] pxHigherPriorityTaskWoken Set if a higher priority task was woken.
+ *
+ * @return None.
+ *****************************************************************************/
+static void rx_byte(struct SerialChannel *ch, uint8_t c, BaseType_t *pxHigherPriorityTaskWoken)
+{
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+    uint32_t now = timing_now_us();
+    uint32_t position = ch->rx.head;
+
+    timing_record(ch->timing.gap, &ch->timing.gapMaxUs, now - ch->rxLastByteUs);
+    ch->rxLastByteUs = now;
+    ch->rxTimestamps[position & ch->rx.mask] = now;
+#endif
+
+    ch->stats.rxBytes++;
+    ch->stats.isrBytes++;
+    if (spsc_ring_put(&ch->rx, c) != 0)
+    {
+        ch->stats.rxOverruns++;
+    }
+    if (ch->line == NULL && ch->echoMode == ECHO_MODE_ISR)
+    {
+        SerialChannelWrite(ch, &c, 1);
+    }
+    rx_signal(ch, pxHigherPriorityTaskWoken);
+}
+
+/**************************************************************************//**
+ * @brief Tells the reader that received data was published to the RX ring.
+ *
+ * In raw mode the semaphore is given once per published burst. In cooked mode
+ * the burst is run through the line discipline right here, and the reader is
+ * only notified when a line completes. Called from the receive interrupts.
+ *
+ * @param[in]  ch                        Channel.
+ * @param[out] pxHigherPriorityTaskWoken Set if a higher priority task was woken.
+ *
+ * @return None.
+ *****************************************************************************/
+static void rx_signal(struct SerialChannel *ch, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (ch->line != NULL)
+    {
+        rx_line_drain(ch, pxHigherPriorityTaskWoken);
+    }
+    else
+    {
+        ch->stats.rxWakeups++;
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+        ch->rxSignalUs = timing_now_us();
+#endif
+        xSemaphoreGiveFromISR(ch->rxSemaphore, pxHigherPriorityTaskWoken);
+    }
+
+    if (ch->rtsPin != SERIAL_CHANNEL_NO_PIN)
+    {
+        rx_flow_update(ch);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Runs the published RX bytes through the line discipline (cooked mode).
+ *
+ * The DMAC, SERCOM and tick interrupts all publish, and may preempt one
+ * another. The first one here becomes the only consumer of the RX ring and
+ * drains it with interrupts enabled; one arriving meanwhile leaves its bytes
+ * to it. The consumer looks at the ring again after letting go, so bytes
+ * published just before are not left behind.
+ *
+ * @param[in]  ch                        Channel in cooked mode.
+ * @param[out] pxHigherPriorityTaskWoken Set if a higher priority task was woken.
+ *
+ * @return None.
+ *****************************************************************************/
+static void rx_line_drain(struct SerialChannel *ch, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    uint8_t c;
+
+    while (!spsc_ring_empty(&ch->rx))
+    {
+        system_interrupt_enter_critical_section();
+        bool busy = ch->lineBusy;
+        ch->lineBusy = true;
+        system_interrupt_leave_critical_section();
+        if (busy)
+        {
+            return; // The interrupt we preempted is draining the ring
+        }
+
+        while (spsc_ring_get(&ch->rx, &c) == 0)
+        {
+            line_input(ch, c, pxHigherPriorityTaskWoken);
+        }
+        ch->lineBusy = false;
+    }
+}
+
+/**************************************************************************//**
+ * @brief Configures the RTS GPIO and starts watching CTS.
+ *
+ * RTS starts asserted (low). The CTS input is handled by the SERCOM itself,
+ * which holds the transmitter while the peer keeps CTS high; the CTS change
+ * interrupt is only used to count those pauses.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return None.
+ *****************************************************************************/
+static void configure_flow_control(struct SerialChannel *ch)
+{
+    struct port_config pin_conf;
+
+    port_get_config_defaults(&pin_conf);
+    pin_conf.direction = PORT_PIN_DIR_OUTPUT;
+    port_pin_set_config(ch->rtsPin, &pin_conf);
+    port_pin_set_output_level(ch->rtsPin, false);
+
+    ch->usart.hw->USART.INTFLAG.reg = SERCOM_USART_INTFLAG_CTSIC;
+    ch->usart.hw->USART.INTENSET.reg = SERCOM_USART_INTFLAG_CTSIC;
+}
+
+/**************************************************************************//**
+ * @brief Drives RTS from the fill level of the ring the reader drains.
+ *
+ * That is the RX ring in raw mode and the completed lines in cooked mode.
+ * Deasserts RTS at CONF_SERIAL_CONSOLE_RTS_PAUSE_PERCENT and asserts it again
+ * at CONF_SERIAL_CONSOLE_RTS_RESUME_PERCENT. Called by the receive path after
+ * publishing data and by the readers after draining while paused.
+ *
+ * @param[in] ch Channel with flow control.
+ *
+ * @return None.
+ *****************************************************************************/
+static void rx_flow_update(struct SerialChannel *ch)
+{
+    spsc_ring_t *ring = (ch->line != NULL) ? &ch->line->lines : &ch->rx;
+
+    system_interrupt_enter_critical_section();
+    size_t level = spsc_ring_size(ring) * 100;
+    size_t capacity = spsc_ring_capacity(ring);
+
+    if (!ch->rxFlowPaused && level >= capacity * CONF_SERIAL_CONSOLE_RTS_PAUSE_PERCENT)
+    {
+        port_pin_set_output_level(ch->rtsPin, true);
+        ch->rxFlowPaused = true;
+        ch->stats.rxFlowPauses++;
+    }
+    else if (ch->rxFlowPaused && level <= capacity * CONF_SERIAL_CONSOLE_RTS_RESUME_PERCENT)
+    {
+        port_pin_set_output_level(ch->rtsPin, false);
+        ch->rxFlowPaused = false;
+        ch->stats.rxFlowResumes++;
+    }
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Counts the peer holding our transmitter (CTS change interrupt).
+ *
+ * STATUS.CTS reports the level of the CTS pin: high means the peer asked us
+ * to stop.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return None.
+ *****************************************************************************/
+static void tx_flow_changed(struct SerialChannel *ch)
+{
+    SercomUsart *const usart = &ch->usart.hw->USART;
+
+    usart->INTFLAG.reg = SERCOM_USART_INTFLAG_CTSIC;
+    if (usart->STATUS.reg & SERCOM_USART_STATUS_CTS)
+    {
+        ch->stats.txFlowPauses++;
+    }
+}
+
+/**************************************************************************//**
+ * @brief Line discipline: handles one received character in cooked mode.
+ *
+ * Echoes printable characters (ECHO_MODE_ISR), erases on backspace/delete, recalls the
+ * previous line on the up arrow (ESC [ A or ESC O A) and hands the line to
+ * the reader on CR, LF or CR LF.
+ *
+ * @param[in]  ch                        Channel in cooked mode.
+ * @param[in]  c                         Received character.
+ * @param[out] pxHigherPriorityTaskWoken Set if a higher priority task was woken.
+ *
+ * @return None.
+ *****************************************************************************/
+static void line_input(struct SerialChannel *ch, uint8_t c, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    struct SerialLine *ln = ch->line;
+    bool afterCR = ln->lastCR;
+    ln->lastCR = (c == '\r');
+
+    if (ln->escape == 1)
+    {
+        ln->escape = (c == '[' || c == 'O') ? 2 : 0;
+        return;
+    }
+    if (ln->escape == 2)
+    {
+        ln->escape = 0;
+        if (c == 'A')
+        {
+            /* Replace the line being typed with the previous one */
+            if (ch->echoMode == ECHO_MODE_ISR)
+            {
+                SerialChannelPrintf(ch, "\x1b[2K\r>%s", ln->history);
+            }
+            ln->length = strlen(ln->history);
+            memcpy(ln->buffer, ln->history, ln->length);
+        }
+        return;
+    }
+
+    if (c == '\r' || c == '\n')
+    {
+        if (c == '\n' && afterCR)
+        {
+            return; // Second half of a CR LF
+        }
+
+        if (ch->echoMode == ECHO_MODE_ISR)
+        {
+            SerialChannelWrite(ch, (const uint8_t *)"\r\n", 2);
+        }
+        ln->buffer[ln->length] = '\0';
+        if (spsc_ring_space(&ln->lines) > ln->length)
+        {
+            spsc_ring_put_range(&ln->lines, (const uint8_t *)ln->buffer, ln->length + 1);
+            if (ln->length > 0)
+            {
+                memcpy(ln->history, ln->buffer, ln->length + 1);
+            }
+            ch->stats.rxLines++;
+            ch->stats.rxWakeups++;
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+            ln->doneUs[ln->doneIn & (SERIAL_LINE_TIMESTAMPS - 1)] = timing_now_us();
+            ln->doneIn++;
+#endif
+            if (ln->reader != NULL)
+            {
+                vTaskNotifyGiveFromISR(ln->reader, pxHigherPriorityTaskWoken);
+            }
+        }
+        else
+        {
+            ch->stats.rxLineDrops += ln->length + 1;
+        }
+        ln->length = 0;
+    }
+    else if (c == ASCII_BACKSPACE_CHAR || c == ASCII_DELETE_CHAR)
+    {
+        if (ln->length > 0)
+        {
+            ln->length--;
+            if (ch->echoMode == ECHO_MODE_ISR)
+            {
+                SerialChannelWrite(ch, (const uint8_t *)"\b \b", 3);
+            }
+        }
+    }
+    else if (c == ASCII_ESC_CHAR)
+    {
+        ln->escape = 1;
+    }
+    else if (c >= ' ' && c < ASCII_DELETE_CHAR)
+    {
+        if (ln->length < ln->size - 1)
+        {
+            ln->buffer[ln->length++] = (char)c;
+            if (ch->echoMode == ECHO_MODE_ISR)
+            {
+                SerialChannelWrite(ch, &c, 1);
+            }
+        }
+        else
+        {
+            ch->stats.rxLineDrops++;
+        }
+    }
+}
+
+/**************************************************************************//**
+ * @brief Starts transmitting published TX data if the transmitter is idle.
+ *
+ * Masks interrupts so that a task and the transmit completion interrupt can
+ * never start two transfers at once.
+ *
+ * @param[in] ch Channel.
+ *
+ * @return None.
+ *****************************************************************************/
+static void tx_start(struct SerialChannel *ch)
+{
+    system_interrupt_enter_critical_section();
+    if (ch->dmaTxChannel != SERIAL_CHANNEL_NO_DMA)
+    {
+        dma_tx_start(ch);
+    }
+    else if (ch->leanIsr)
+    {
+        /* The handler feeds DATA until the ring runs dry, then masks DRE again */
+        ch->usart.hw->USART.INTENSET.reg = SERCOM_USART_INTFLAG_DRE;
+    }
+    else if (usart_get_job_status(&ch->usart, USART_TRANSCEIVER_TX) == STATUS_OK &&
+             tx_next_byte(ch, &ch->latestTx) == 0) // Retrieve a character if TX is free.
+    {
+        ch->stats.txBytes++;
+        usart_write_buffer_job(&ch->usart, &ch->latestTx, 1);
+    }
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Starts a DMA transfer of the output pending in the TX lanes.
+ *
+ * The urgent lane goes out whole once the bulk lane is between messages;
+ * otherwise the bulk lane sends whole messages, up to
+ * CONF_SERIAL_CONSOLE_TX_BULK_BURST bytes, so that urgent output never waits
+ * long. The contiguous span at the tail of the lane goes out as the first
+ * block. If the data wraps, a second descriptor covering the start of the
+ * buffer is chained so it leaves in a single transfer. The bytes stay in the
+ * lane until the transfer completes. Must be called with interrupts masked or
+ * from the DMAC interrupt.
+ *
+ * @param[in] ch Channel transmitting through the DMAC.
+ *
+ * @return None.
+ *****************************************************************************/
+static void dma_tx_start(struct SerialChannel *ch)
+{
+    uint8_t *span;
+    size_t len, spanLen, wrapLen;
+    mpsc_ring_t *lane;
+    DmacDescriptor *desc = &dmaDescriptorSection[ch->dmaTxChannel];
+
+    if (ch->dmaTxInFlight != 0)
+    {
+        return; // The completion interrupt restarts the channel.
+    }
+
+    lane = tx_select_lane(ch);
+    len = (lane == &ch->tx) ? tx_bulk_burst(ch) : spsc_ring_size(&lane->ring);
+    if (len == 0)
+    {
+        return;
+    }
+    spanLen = spsc_ring_linear_read(&lane->ring, &span);
+    if (spanLen > len)
+    {
+        spanLen = len;
+    }
+    wrapLen = len - spanLen;
+
+    /* Source addresses are the end of the block when SRCINC is set */
+    desc->BTCNT.reg = (uint16_t)spanLen;
+    desc->SRCADDR.reg = (uint32_t)(span + spanLen);
+    desc->DSTADDR.reg = (uint32_t)&ch->usart.hw->USART.DATA.reg;
+
+    if (wrapLen != 0)
+    {
+        desc->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+                           DMAC_BTCTRL_BLOCKACT_NOACT;
+        desc->DESCADDR.reg = (uint32_t)&ch->dmaTxWrapDescriptor;
+
+        ch->dmaTxWrapDescriptor.BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE |
+                                             DMAC_BTCTRL_SRCINC | DMAC_BTCTRL_BLOCKACT_INT;
+        ch->dmaTxWrapDescriptor.BTCNT.reg = (uint16_t)wrapLen;
+        ch->dmaTxWrapDescriptor.SRCADDR.reg = (uint32_t)(lane->ring.buffer + wrapLen);
+        ch->dmaTxWrapDescriptor.DSTADDR.reg = desc->DSTADDR.reg;
+        ch->dmaTxWrapDescriptor.DESCADDR.reg = 0;
+        ch->stats.txDmaBlocks += 2;
+    }
+    else
+    {
+        desc->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC |
+                           DMAC_BTCTRL_BLOCKACT_INT;
+        desc->DESCADDR.reg = 0;
+        ch->stats.txDmaBlocks++;
+    }
+
+    ch->dmaTxInFlight = len;
+    ch->dmaTxLane = lane;
+
+    DMAC->CHID.reg = DMAC_CHID_ID(ch->dmaTxChannel);
+    DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+}
+
+/**************************************************************************//**
+ * @brief Starts the endless DMA reception into the RX ring.
+ *
+ * The ring is split into watermark-sized blocks whose descriptors are chained
+ * in a circle, so the DMAC keeps filling the ring without CPU involvement and
+ * interrupts once per block. Reception resumes at dmaRxPosition so the DMA
+ * write offset stays in step with the ring head.
+ *
+ * @param[in] ch Channel receiving through the DMAC.
+ *
+ * @return None.
+ *****************************************************************************/
+static void dma_rx_start(struct SerialChannel *ch)
+{
+    size_t first = ch->dmaRxPosition / ch->dmaRxBlockSize;
+    DmacDescriptor *section = &dmaDescriptorSection[ch->dmaRxChannel];
+
+    for (size_t block = 0; block < ch->dmaRxBlockCount; block++)
+    {
+        DmacDescriptor *desc = &ch->dmaRxDescriptors[block];
+        size_t next = (block + 1 < ch->dmaRxBlockCount) ? block + 1 : 0;
+
+        desc->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_DSTINC |
+                           DMAC_BTCTRL_BLOCKACT_INT;
+        desc->BTCNT.reg = (uint16_t)ch->dmaRxBlockSize;
+        desc->SRCADDR.reg = (uint32_t)&ch->usart.hw->USART.DATA.reg;
+        /* Destination addresses are the end of the block when DSTINC is set */
+        desc->DSTADDR.reg = (uint32_t)&ch->rx.buffer[(block + 1) * ch->dmaRxBlockSize];
+        desc->DESCADDR.reg = (uint32_t)&ch->dmaRxDescriptors[next];
+    }
+
+    /* The channel starts from its slot in the descriptor section: a copy of the
+     * block holding dmaRxPosition, shortened to start exactly there */
+    *section = ch->dmaRxDescriptors[first];
+    section->BTCNT.reg = (uint16_t)((first + 1) * ch->dmaRxBlockSize - ch->dmaRxPosition);
+    dmaWritebackSection[ch->dmaRxChannel] = *section;
+    ch->dmaRxLastSeen = ch->dmaRxPosition;
+    ch->dmaRxQuietTicks = 0;
+
+    DMAC->CHID.reg = DMAC_CHID_ID(ch->dmaRxChannel);
+    DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+}
+
+/**************************************************************************//**
+ * @brief Returns the offset in the RX ring the DMAC will write next.
+ *
+ * The remaining beat count is read from the ACTIVE register while the RX
+ * channel owns the bus, and from its write-back descriptor otherwise.
+ *
+ * @param[in] ch Channel receiving through the DMAC.
+ *
+ * @return Offset in [0, RX ring capacity).
+ *****************************************************************************/
+static size_t dma_rx_write_offset(struct SerialChannel *ch)
+{
+    const DmacDescriptor *wb = &dmaWritebackSection[ch->dmaRxChannel];
+    uint32_t active = DMAC->ACTIVE.reg;
+    uint32_t blockEnd = wb->DSTADDR.reg;
+    uint32_t remaining;
+    size_t size = spsc_ring_capacity(&ch->rx);
+
+    if ((active & DMAC_ACTIVE_ABUSY) &&
+        ((active & DMAC_ACTIVE_ID_Msk) >> DMAC_ACTIVE_ID_Pos) == (uint32_t)ch->dmaRxChannel)
+    {
+        remaining = (active & DMAC_ACTIVE_BTCNT_Msk) >> DMAC_ACTIVE_BTCNT_Pos;
+    }
+    else
+    {
+        remaining = wb->BTCNT.reg;
+    }
+
+    size_t offset = (size_t)(blockEnd - remaining - (uint32_t)ch->rx.buffer);
+    return (offset >= size) ? offset - size : offset;
+}
+
+/**************************************************************************//**
+ * @brief Publishes the bytes the DMAC has written since the last call.
+ *
+ * Advances the head of the RX ring up to the DMA write offset. If the consumer
+ * fell so far behind that unread data got overwritten, the loss is counted as
+ * an overrun. Must be called with interrupts masked.
+ *
+ * @param[in] ch Channel receiving through the DMAC.
+ *
+ * @return true if new bytes were published.
+ *****************************************************************************/
+static bool dma_rx_publish(struct SerialChannel *ch)
+{
+    size_t size = spsc_ring_capacity(&ch->rx);
+    size_t offset = dma_rx_write_offset(ch);
+    size_t received = (offset >= ch->dmaRxPosition) ? offset - ch->dmaRxPosition
+                                                    : offset + size - ch->dmaRxPosition;
+
+    if (received == 0)
+    {
+        return false;
+    }
+
+    size_t space = spsc_ring_space(&ch->rx);
+    if (received > space)
+    {
+        /* The DMAC already overwrote the oldest unread bytes; the reader skips them */
+        ch->stats.rxOverruns += received - space;
+    }
+
+    if (ch->line == NULL && ch->echoMode == ECHO_MODE_ISR)
+    {
+        size_t first = Min(received, size - ch->dmaRxPosition);
+        SerialChannelWrite(ch, &ch->rx.buffer[ch->dmaRxPosition], first);
+        SerialChannelWrite(ch, ch->rx.buffer, received - first);
+    }
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+    /* Arrival within the block is unknown: stamp the whole block now */
+    uint32_t now = timing_now_us();
+    timing_record(ch->timing.gap, &ch->timing.gapMaxUs, now - ch->rxLastByteUs);
+    ch->rxLastByteUs = now;
+    for (uint32_t position = ch->rx.head; position != ch->rx.head + received; position++)
+    {
+        ch->rxTimestamps[position & ch->rx.mask] = now;
+    }
+#endif
+
+    spsc_ring_produce(&ch->rx, received);
+    ch->stats.rxBytes += received;
+    ch->dmaRxPosition = offset;
+    ch->dmaRxLastSeen = offset;
+    return true;
+}
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+/**************************************************************************//**
+ * @brief Current time in microseconds, from the tick count and SysTick->VAL.
+ *
+ * Callable from tasks and interrupts. When SysTick has reloaded but its
+ * interrupt has not run yet (masked, or preempted by the caller), the tick
+ * count is one behind: the pending flag with a freshly reloaded counter
+ * detects that.
+ *
+ * @return Microseconds since the scheduler started, wrapping at 2^32.
+ *****************************************************************************/
+static uint32_t timing_now_us(void)
+{
+    uint32_t cyclesPerTick = SysTick->LOAD + 1;
+    TickType_t tick;
+    uint32_t val;
+    bool pending;
+
+    system_interrupt_enter_critical_section();
+    tick = xTaskGetTickCountFromISR();
+    val = SysTick->VAL;
+    pending = (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0;
+    system_interrupt_leave_critical_section();
+
+    if (pending && val > cyclesPerTick / 2)
+    {
+        tick++;
+    }
+    uint32_t cyclesPerUs = cyclesPerTick / (1000000 / configTICK_RATE_HZ);
+    return tick * (1000000 / configTICK_RATE_HZ) + (cyclesPerTick - 1 - val) / cyclesPerUs;
+}
+
+/**************************************************************************//**
+ * @brief Adds a sample to a power-of-two histogram.
+ *
+ * @param[in,out] histogram SERIAL_CHANNEL_TIMING_BUCKETS counters.
+ * @param[in,out] maxUs     Largest sample so far.
+ * @param[in]     us        Sample.
+ *
+ * @return None.
+ *****************************************************************************/
+static void timing_record(uint32_t *histogram, uint32_t *maxUs, uint32_t us)
+{
+    uint32_t bucket = (us < 2) ? 0 : 31 - (uint32_t)__builtin_clz(us);
+
+    histogram[Min(bucket, SERIAL_CHANNEL_TIMING_BUCKETS - 1)]++;
+    if (us > *maxUs)
+    {
+        *maxUs = us;
+    }
+}
+
+/**************************************************************************//**
+ * @brief Records the receive-to-read latency of bytes just read from the RX ring.
+ *
+ * @param[in] ch   Channel.
+ * @param[in] from RX ring tail before the read.
+ * @param[in] len  Bytes read.
+ *
+ * @return None.
+ *****************************************************************************/
+static void timing_read(struct SerialChannel *ch, uint32_t from, size_t len)
+{
+    uint32_t now = timing_now_us();
+
+    for (size_t i = 0; i < len; i++)
+    {
+        system_interrupt_enter_critical_section();
+        timing_record(ch->timing.latency, &ch->timing.latencyMaxUs,
+                      now - ch->rxTimestamps[(from + i) & ch->rx.mask]);
+        system_interrupt_leave_critical_section();
+    }
+}
+#endif
+
+/******************************************************************************/
+/* Callback Functions                                                         */
+/******************************************************************************/
+
+/**************************************************************************//**
+ * @brief Callback for USART receive.
+ *
+ * Invoked when the USART has received the requested character. Restarts the
+ * read job and hands the character to the receive path.
+ *
+ * @param[in] usart_module The channel's USART module.
+ *
+ * @return None.
+ *****************************************************************************/
+static void usart_read_callback(struct usart_module *const usart_module)
+{
+    struct SerialChannel *ch = (struct SerialChannel *)usart_module;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint8_t c = ch->latestRx;
+
+    usart_read_buffer_job(&ch->usart, &ch->latestRx, 1); // Restart reading
+    rx_byte(ch, c, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**************************************************************************//**
+ * @brief Callback for a USART receive error.
+ *
+ * The ASF handler reports one error class per call, clears only its flag and
+ * leaves the damaged character in DATA with the one-byte job still pending.
+ * This clears the other error flags too, drops a character with a framing or
+ * parity error so the job continues with the next one, and re-arms the job
+ * if it is no longer pending. After a buffer overflow the character in DATA
+ * is good and is read by the job as usual.
+ *
+ * @param[in] usart_module The channel's USART module.
+ *
+ * @return None.
+ *****************************************************************************/
+static void usart_error_callback(struct usart_module *const usart_module)
+{
+    struct SerialChannel *ch = (struct SerialChannel *)usart_module;
+    SercomUsart *const usart = &ch->usart.hw->USART;
+    uint8_t status = usart->STATUS.reg & SERIAL_CHANNEL_RX_ERRORS;
+
+    switch (ch->usart.rx_status)
+    {
+    case STATUS_ERR_BAD_FORMAT:
+        status |= SERCOM_USART_STATUS_FERR;
+        break;
+    case STATUS_ERR_BAD_DATA:
+        status |= SERCOM_USART_STATUS_PERR;
+        break;
+    case STATUS_ERR_OVERFLOW:
+        status |= SERCOM_USART_STATUS_BUFOVF;
+        break;
+    default:
+        break;
+    }
+    usart->STATUS.reg = status;
+    rx_error(ch, status);
+
+    if (status & (SERCOM_USART_STATUS_FERR | SERCOM_USART_STATUS_PERR))
+    {
+        (void)usart->DATA.reg;
+    }
+    if (ch->usart.remaining_rx_buffer_length == 0)
+    {
+        usart_read_buffer_job(&ch->usart, &ch->latestRx, 1);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Counts receive errors by class and tells the error handler.
+ *
+ * @param[in] ch     Channel.
+ * @param[in] status SERIAL_CHANNEL_RX_ERRORS bits of the SERCOM STATUS register.
+ *
+ * @return None.
+ *****************************************************************************/
+static void rx_error(struct SerialChannel *ch, uint8_t status)
+{
+    if (status & SERCOM_USART_STATUS_FERR)
+    {
+        ch->stats.rxFramingErrors++;
+    }
+    if (status & SERCOM_USART_STATUS_PERR)
+    {
+        ch->stats.rxParityErrors++;
+    }
+    if (status & SERCOM_USART_STATUS_BUFOVF)
+    {
+        ch->stats.rxBufferOverflows++;
+    }
+    if (status != 0 && ch->errorHandler != NULL)
+    {
+        ch->errorHandler(ch->errorCtx, status);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Callback for a change on the CTS input.
+ *
+ * The ASF handler masks CTSIC before calling back, so it is unmasked again here.
+ *
+ * @param[in] usart_module The channel's USART module.
+ *
+ * @return None.
+ *****************************************************************************/
+static void usart_cts_callback(struct usart_module *const usart_module)
+{
+    tx_flow_changed((struct SerialChannel *)usart_module);
+    usart_module->hw->USART.INTENSET.reg = SERCOM_USART_INTFLAG_CTSIC;
+}
+
+/**************************************************************************//**
+ * @brief Callback for USART transmit.
+ *
+ * Invoked when the USART has finished transmitting the requested byte. Starts
+ * another write job with the next byte of the TX lanes, if any, and wakes a
+ * writer blocked on the full ring.
+ *
+ * @param[in] usart_module The channel's USART module.
+ *
+ * @return None.
+ *****************************************************************************/
+static void usart_write_callback(struct usart_module *const usart_module)
+{
+    struct SerialChannel *ch = (struct SerialChannel *)usart_module;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    ch->stats.txInterrupts++;
+    if (tx_next_byte(ch, &ch->latestTx) != -1)
+    {
+        ch->stats.txBytes++;
+        ch->stats.isrBytes++;
+        usart_write_buffer_job(&ch->usart, &ch->latestTx, 1);
+        tx_space_freed(ch, &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**************************************************************************//**
+ * @brief Channel-owned SERCOM interrupt handler.
+ *
+ * Installed in the ASF SERCOM handler table in place of the usart driver's
+ * handler. Moves DATA straight to and from the rings: RXC pushes the received
+ * byte into the receive path, DRE feeds the next byte of the TX lanes and masks
+ * itself once both are empty. There are no jobs to re-arm and no callback
+ * dispatch. Directions served by the DMAC never enable their interrupt; with
+ * RX DMA the error interrupt reports the damaged characters instead.
+ *
+ * @param[in] instance SERCOM instance index.
+ *
+ * @return None.
+ *****************************************************************************/
+static void sercom_lean_handler(uint8_t instance)
+{
+    struct SerialChannel *ch = sercomChannels[instance];
+    SercomUsart *const usart = &ch->usart.hw->USART;
+    uint8_t flags = usart->INTFLAG.reg & usart->INTENSET.reg;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if (flags & SERCOM_USART_INTFLAG_RXC)
+    {
+        uint8_t status = usart->STATUS.reg & SERIAL_CHANNEL_RX_ERRORS;
+        uint8_t c = (uint8_t)usart->DATA.reg;
+
+        if (status != 0)
+        {
+            usart->STATUS.reg = status;
+            rx_error(ch, status);
+        }
+        /* A damaged character is dropped; after an overflow the character itself is good */
+        if (!(status & (SERCOM_USART_STATUS_FERR | SERCOM_USART_STATUS_PERR)))
+        {
+            rx_byte(ch, c, &xHigherPriorityTaskWoken);
+        }
+    }
+
+    if (flags & SERCOM_USART_INTFLAG_ERROR)
+    {
+        uint8_t status = usart->STATUS.reg & SERIAL_CHANNEL_RX_ERRORS;
+
+        usart->STATUS.reg = status;
+        usart->INTFLAG.reg = SERCOM_USART_INTFLAG_ERROR;
+        rx_error(ch, status);
+    }
+
+    if (flags & SERCOM_USART_INTFLAG_DRE)
+    {
+        uint8_t c;
+
+        ch->stats.txInterrupts++;
+        if (tx_next_byte(ch, &c) == 0)
+        {
+            usart->DATA.reg = c;
+            ch->stats.txBytes++;
+            ch->stats.isrBytes++;
+            tx_space_freed(ch, &xHigherPriorityTaskWoken);
+        }
+        else
+        {
+            usart->INTENCLR.reg = SERCOM_USART_INTFLAG_DRE;
+        }
+    }
+
+    if (flags & SERCOM_USART_INTFLAG_CTSIC)
+    {
+        tx_flow_changed(ch);
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**************************************************************************//**
+ * @brief ASF SERCOM handler wrapped with the error interrupt, for RX DMA channels.
+ *
+ * The ASF handler ignores the SERCOM ERROR interrupt flag, which would then
+ * fire forever; this one clears and counts the errors first.
+ *
+ * @param[in] instance SERCOM instance index.
+ *
+ * @return None.
+ *****************************************************************************/
+static void sercom_error_handler(uint8_t instance)
+{
+    struct SerialChannel *ch = sercomChannels[instance];
+    SercomUsart *const usart = &ch->usart.hw->USART;
+
+    if (usart->INTFLAG.reg & usart->INTENSET.reg & SERCOM_USART_INTFLAG_ERROR)
+    {
+        uint8_t status = usart->STATUS.reg & SERIAL_CHANNEL_RX_ERRORS;
+
+        usart->STATUS.reg = status;
+        usart->INTFLAG.reg = SERCOM_USART_INTFLAG_ERROR;
+        rx_error(ch, status);
+    }
+    _usart_interrupt_handler(instance);
+}
+
+#if CONF_SERIAL_CONSOLE_ISR_PROFILING
+/**************************************************************************//**
+ * @brief Cycle-counting wrapper around a channel's SERCOM handler.
+ *
+ * Times the handler in use (the lean one or ASF's _usart_interrupt_handler)
+ * with the SysTick down-counter, which runs at the core clock once the
+ * scheduler has started. Cycles per byte = isrCycles / isrBytes.
+ *
+ * @param[in] instance SERCOM instance index.
+ *
+ * @return None.
+ *****************************************************************************/
+static void sercom_profiled_handler(uint8_t instance)
+{
+    struct SerialChannel *ch = sercomChannels[instance];
+    uint32_t start = SysTick->VAL;
+
+    if (ch->leanIsr)
+    {
+        sercom_lean_handler(instance);
+    }
+    else if (ch->dmaRxChannel != SERIAL_CHANNEL_NO_DMA)
+    {
+        sercom_error_handler(instance);
+    }
+    else
+    {
+        _usart_interrupt_handler(instance);
+    }
+
+    uint32_t end = SysTick->VAL;
+    ch->stats.isrCalls++;
+    ch->stats.isrCycles += (start >= end) ? start - end : start + SysTick->LOAD + 1 - end;
+}
+#endif
+
+/**************************************************************************//**
+ * @brief DMAC interrupt handler.
+ *
+ * Services only the DMAC channels with a pending interrupt. On TX completion
+ * (or failure) it releases the transmitted bytes from the lane they came from and
+ * starts a new transfer with whatever was queued in the meantime, waking a
+ * writer blocked on the full ring. On RX block completion it publishes the
+ * received watermark worth of bytes and signals the reader once for the whole
+ * block.
+ *
+ * @return None.
+ *****************************************************************************/
+void DMAC_Handler(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint32_t pending = DMAC->INTSTATUS.reg;
+
+    while (pending != 0)
+    {
+        int8_t id = (int8_t)__builtin_ctz(pending);
+        struct SerialChannel *ch = (id < CONF_SERIAL_CONSOLE_DMA_CHANNELS) ? dmaChannelOwners[id] : NULL;
+        uint8_t flags;
+
+        pending &= pending - 1;
+
+        DMAC->CHID.reg = DMAC_CHID_ID(id);
+        flags = DMAC->CHINTFLAG.reg & (DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR);
+        DMAC->CHINTFLAG.reg = flags;
+        if (ch == NULL || flags == 0)
+        {
+            continue;
+        }
+
+        if (id == ch->dmaTxChannel)
+        {
+            ch->stats.txInterrupts++;
+            if (flags & DMAC_CHINTFLAG_TERR)
+            {
+                ch->stats.txDmaErrors++;
+            }
+
+            ch->stats.txBytes += ch->dmaTxInFlight;
+            spsc_ring_consume(&ch->dmaTxLane->ring, ch->dmaTxInFlight);
+            ch->dmaTxInFlight = 0;
+            dma_tx_start(ch);
+            tx_space_freed(ch, &xHigherPriorityTaskWoken);
+        }
+        else if (flags & DMAC_CHINTFLAG_TERR)
+        {
+            /* A bus error disables the channel: keep what arrived and resume after it */
+            ch->stats.rxDmaErrors++;
+            dma_rx_publish(ch);
+            dma_rx_start(ch);
+        }
+        else if (dma_rx_publish(ch))
+        {
+            rx_signal(ch, &xHigherPriorityTaskWoken);
+        }
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
@@ -0,0 +1,501 @@
+/**************************************************************************//**
+ * @file        SerialChannel.h
+ * @ingroup     Serial Console
+ * @brief       One UART on one SERCOM, with its own rings, transport, counters and wakeups.
+ * @details     A channel owns everything its hot paths touch: the RX ring and the
+ *				multi-writer TX rings (an urgent and a bulk lane), the transmit/receive state (ASF one-byte jobs,
+ *				the lean SERCOM handler or DMAC channels), the optional cooked-mode
+ *				line discipline, RTS/CTS state, semaphores and statistics. Channels
+ *				share nothing but the DMAC descriptor sections and its interrupt,
+ *				which only services the channels whose DMA interrupt is pending, so a
+ *				busy link cannot slow another one down.
+ *
+ *				Usage:
+ *				    SERIAL_CHANNEL_DEFINE(espLink, 1024, 1024, 64, 64);
+ *				    struct SerialChannelConfig config;
+ *				    SerialChannelGetConfigDefaults(&config);
+ *				    config.hw = SERCOM2;
+ *				    ...pads, baud rate, DMAC channels...
+ *				    SerialChannelInit(&espLink, &config);
+ *				    SerialChannelWrite(&espLink, data, len);
+ *
+ *				The serial console (SerialConsole.h) is the channel built from
+ *				conf_serial_console.h.
+ *
+ * @copyright
+ * @author
+ * @date        October 16, 2026
+ * @version		0.1
+ *****************************************************************************/
+
+#ifndef SERIAL_CHANNEL_H
+#define SERIAL_CHANNEL_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include <asf.h>
+#include <string.h>
+#include <stdarg.h>
+#include "spsc_ring.h"
+#include "mpsc_ring.h"
+#include "console_format.h"
+#include "conf_serial_console.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define SERIAL_CHANNEL_NO_DMA  (-1)   /**< dmaTxChannel/dmaRxChannel: move the bytes by interrupt */
+#define SERIAL_CHANNEL_NO_PIN  (0xFF) /**< rtsPin: no RTS/CTS flow control */
+#define SERIAL_CHANNEL_RX_ERRORS (SERCOM_USART_STATUS_FERR | SERCOM_USART_STATUS_PERR | SERCOM_USART_STATUS_BUFOVF) /**< STATUS bits reported to SerialChannelErrorHandler */
+#define SERIAL_CHANNEL_TIMING_BUCKETS 16 /**< Power-of-two buckets per receive timing histogram */
+#define SERIAL_LINE_TIMESTAMPS 8        /**< Queued lines whose completion time is kept (power of two) */
+
+/******************************************************************************
+ * Enumerations
+ ******************************************************************************/
+/** What a write does when its message does not fit in the TX ring */
+ enum eTxPolicy {
+	 TX_POLICY_BLOCK       = 0, /**< Wait up to a timeout for room, then drop the message (tasks only) */
+	 TX_POLICY_DROP_NEWEST = 1, /**< Drop the message being written */
+	 TX_POLICY_DROP_OLDEST = 2  /**< Drop the oldest whole messages not yet being transmitted (tasks only,
+	                                 interrupts and critical sections drop the newest) */
+ };
+
+/** Transmit lanes. The transmitter drains them in this order, switching only
+ *  between bulk messages, so an urgent message never splits a bulk one */
+ enum eTxLane {
+	 TX_LANE_URGENT = 0, /**< Fatal errors and alarms: sent ahead of everything queued in the bulk lane */
+	 TX_LANE_BULK   = 1, /**< Everything else: CLI output, logs, dumps */
+	 TX_LANES       = 2
+ };
+
+/** Where typed characters are echoed back to the terminal */
+ enum eEchoMode {
+	 ECHO_MODE_ISR  = 0, /**< The receive path echoes as characters arrive */
+	 ECHO_MODE_TASK = 1, /**< The reading task echoes (whole lines in cooked mode) */
+	 ECHO_MODE_OFF  = 2  /**< No echo, for machine clients */
+ };
+
+/******************************************************************************
+ * Structures
+ ******************************************************************************/
+/**
+ * Transfer counters of one channel, see SerialChannelGetStats().
+ */
+struct SerialChannelStats {
+	uint32_t txBytes;      /**< Bytes handed to the SERCOM */
+	uint32_t txInterrupts; /**< Transmit interrupts (per byte without DMA, per transfer with DMA) */
+	uint32_t txDmaBlocks;  /**< DMA blocks transferred (1 per transfer, 2 when the data wraps) */
+	uint32_t txDmaErrors;  /**< TX DMA transfers that ended with a bus error */
+	uint32_t txDropped;    /**< Bytes dropped because the TX ring was full */
+	uint32_t txDroppedMessages; /**< Messages dropped because the TX ring was full */
+	uint32_t txEvictedMessages; /**< Queued messages dropped by TX_POLICY_DROP_OLDEST writers */
+	uint32_t txBlockedWrites;   /**< Writes that had to wait for room under TX_POLICY_BLOCK */
+	uint32_t txUrgentMessages;  /**< Messages queued in the urgent lane */
+	uint32_t txPreemptions;     /**< Times urgent output went out ahead of queued bulk output */
+	uint32_t txQueued[TX_LANES];     /**< Bytes waiting per lane when the counters were copied */
+	uint32_t txQueuedPeak[TX_LANES]; /**< Most bytes ever waiting per lane */
+	uint32_t rxBytes;      /**< Bytes published to the RX ring */
+	uint32_t rxWakeups;    /**< Times the consumer was signalled */
+	uint32_t rxIdleWakeups; /**< Wakeups caused by the idle-line timeout instead of the watermark */
+	uint32_t rxLines;      /**< Complete lines handed to the reader in cooked mode */
+	uint32_t rxLineDrops;  /**< Characters dropped in cooked mode (line too long or line buffer full) */
+	uint32_t rxOverruns;   /**< Unread bytes lost because the RX ring overflowed */
+	uint32_t rxDmaErrors;  /**< RX DMA transfers that ended with a bus error */
+	uint32_t rxFramingErrors;   /**< Characters with a bad stop bit (FERR): noise, break or baud mismatch */
+	uint32_t rxParityErrors;    /**< Characters with a bad parity bit (PERR) */
+	uint32_t rxBufferOverflows; /**< Characters lost because the SERCOM was not read in time (BUFOVF) */
+	uint32_t rxFlowPauses;  /**< Times RTS was deasserted because the receive ring filled up */
+	uint32_t rxFlowResumes; /**< Times RTS was asserted again after the reader caught up */
+	uint32_t txFlowPauses;  /**< Times the peer deasserted CTS and held our transmitter */
+	uint32_t rxStartWakeups; /**< Start bits seen while the device was in standby */
+	uint32_t rxWakeMissed;  /**< Of those, characters that never arrived or arrived damaged */
+	uint32_t isrCalls;     /**< SERCOM handler invocations (CONF_SERIAL_CONSOLE_ISR_PROFILING) */
+	uint32_t isrBytes;     /**< Bytes moved by the SERCOM handler, either direction */
+	uint64_t isrCycles;    /**< CPU cycles spent in the SERCOM handler (CONF_SERIAL_CONSOLE_ISR_PROFILING) */
+};
+
+/** Told about receive errors, from the interrupt; status holds SERIAL_CHANNEL_RX_ERRORS bits */
+typedef void (*SerialChannelErrorHandler)(void *ctx, uint8_t status);
+
+/**
+ * Receive timing histograms of one channel, see SerialChannelGetTiming().
+ * Bucket 0 counts samples below 2 us, bucket i samples in [2^i, 2^(i+1)) us
+ * and the last bucket everything from 2^(SERIAL_CHANNEL_TIMING_BUCKETS - 1) us.
+ */
+struct SerialChannelTiming {
+	uint32_t latency[SERIAL_CHANNEL_TIMING_BUCKETS]; /**< Byte received to byte read (cooked mode: line completed to line read) */
+	uint32_t wakeup[SERIAL_CHANNEL_TIMING_BUCKETS];  /**< Reader signalled to reader running */
+	uint32_t gap[SERIAL_CHANNEL_TIMING_BUCKETS];     /**< Between consecutive received bytes (per block with RX DMA) */
+	uint32_t latencyMaxUs;  /**< Largest latency sample */
+	uint32_t wakeupMaxUs;   /**< Largest wakeup sample */
+	uint32_t gapMaxUs;      /**< Largest gap sample */
+};
+
+/**
+ * Cooked-mode state of a channel. Use SERIAL_LINE_DEFINE to create one.
+ */
+struct SerialLine {
+	spsc_ring_t lines;      /**< Completed lines, each terminated by '\0' (receive path -> reader) */
+	char *buffer;           /**< Line being assembled */
+	char *history;          /**< Previous line, recalled by the up arrow */
+	size_t size;            /**< Longest line, including the terminator */
+	size_t length;          /**< Characters in buffer */
+	uint8_t escape;         /**< Escape sequence state: 0 none, 1 after ESC, 2 after ESC [ or ESC O */
+	bool lastCR;            /**< Previous character was a CR, so a following LF is swallowed */
+	TaskHandle_t volatile reader; /**< Task blocked in SerialChannelReadLine */
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+	uint32_t doneUs[SERIAL_LINE_TIMESTAMPS]; /**< Completion time of the queued lines, oldest at doneOut */
+	volatile uint32_t doneIn;  /**< Lines completed */
+	uint32_t doneOut;          /**< Lines read */
+#endif
+};
+
+/**
+ * Settings of a channel, see SerialChannelGetConfigDefaults().
+ */
+struct SerialChannelConfig {
+	Sercom *hw;                 /**< SERCOM running the UART */
+	enum usart_signal_mux_settings muxSetting; /**< Pad assignment; flow control needs TX on PAD0, CTS on PAD3 */
+	uint32_t pinmuxPad0;        /**< Pin for PAD0, or PINMUX_UNUSED */
+	uint32_t pinmuxPad1;        /**< Pin for PAD1, or PINMUX_UNUSED */
+	uint32_t pinmuxPad2;        /**< Pin for PAD2, or PINMUX_UNUSED */
+	uint32_t pinmuxPad3;        /**< Pin for PAD3, or PINMUX_UNUSED */
+	uint32_t baudRate;          /**< Initial rate, and the fallback of SerialChannelNegotiateBaudRate */
+	int8_t dmaTxChannel;        /**< DMAC channel for transmission, or SERIAL_CHANNEL_NO_DMA */
+	int8_t dmaRxChannel;        /**< DMAC channel for reception, or SERIAL_CHANNEL_NO_DMA */
+	bool leanIsr;               /**< Serve the non-DMA directions from the lean SERCOM handler instead of ASF jobs */
+	uint8_t rtsPin;             /**< GPIO driving RTS (enables flow control), or SERIAL_CHANNEL_NO_PIN */
+	enum eTxPolicy txPolicy;    /**< Full-ring policy of SerialChannelWrite and SerialChannelPrintf */
+	uint32_t txTimeoutMs;       /**< Longest wait under TX_POLICY_BLOCK */
+	enum eEchoMode echoMode;    /**< Who echoes received characters */
+	struct SerialLine *line;    /**< Cooked-mode state (SERIAL_LINE_DEFINE), or NULL for a raw byte stream */
+	uint32_t irqPriority;       /**< NVIC priority of the SERCOM interrupt */
+	bool standbyWake;           /**< Keep the SERCOM running in standby and wake on a start bit */
+	enum gclk_generator gclkGenerator; /**< Clock of the SERCOM; with standbyWake, one that runs in standby on demand */
+};
+
+/**
+ * A channel. Use SERIAL_CHANNEL_DEFINE to create one; the members are private
+ * to SerialChannel.c.
+ */
+struct SerialChannel {
+	struct usart_module usart;  /**< ASF driver instance; first, so driver callbacks find the channel */
+	spsc_ring_t rx;             /**< Received bytes (ISR/DMA -> reader) */
+	mpsc_ring_t tx;             /**< Bulk lane: bytes to transmit (tasks/ISRs -> DMA/ISR) */
+	mpsc_ring_t txUrgent;       /**< Urgent lane, drained before tx between messages */
+	struct SerialLine *line;    /**< Cooked-mode state, NULL in raw mode */
+	volatile bool lineBusy;     /**< An interrupt is running rx through the line discipline */
+
+	uint32_t baudRate;          /**< Current line rate */
+	uint32_t defaultBaudRate;   /**< Rate restored when a switch is not confirmed */
+	int8_t dmaTxChannel;        /**< DMAC channel for transmission, or SERIAL_CHANNEL_NO_DMA */
+	int8_t dmaRxChannel;        /**< DMAC channel for reception, or SERIAL_CHANNEL_NO_DMA */
+	bool leanIsr;               /**< The lean SERCOM handler is installed */
+	uint8_t rtsPin;             /**< RTS GPIO, or SERIAL_CHANNEL_NO_PIN */
+	enum eTxPolicy txPolicy;    /**< Default full-ring policy */
+	TickType_t txTimeout;       /**< Default wait under TX_POLICY_BLOCK */
+	volatile enum eEchoMode echoMode; /**< Who echoes received characters */
+
+	uint8_t latestRx;           /**< Target of the one-byte ASF read job */
+	uint8_t latestTx;           /**< Source of the one-byte ASF write job */
+	SemaphoreHandle_t rxSemaphore;      /**< Given once per published burst (raw mode) */
+	SemaphoreHandle_t txSpaceSemaphore; /**< Given when the TX ring frees space while writers wait */
+	volatile uint32_t txWaiters;        /**< Writers blocked under TX_POLICY_BLOCK */
+
+	/** End positions (bulk ring counters) of the queued messages, oldest first. When
+	 *  full, the oldest two messages are merged into one unit. */
+	uint32_t txMessageEnds[CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS];
+	uint32_t txMessageFirst;    /**< Index of the oldest entry in txMessageEnds */
+	uint32_t txMessageCount;    /**< Entries in txMessageEnds */
+	bool txUrgentSending;       /**< The transmitter is draining the urgent lane */
+
+	/** Second TX descriptor, chained when the pending data wraps around the end of the ring */
+	DmacDescriptor dmaTxWrapDescriptor __attribute__((aligned(16)));
+	volatile size_t dmaTxInFlight;   /**< Bytes of dmaTxLane currently owned by the DMAC */
+	mpsc_ring_t *dmaTxLane;     /**< Lane of the transfer in flight */
+	DmacDescriptor *dmaRxDescriptors; /**< Circular chain, one descriptor per watermark-sized block of rx */
+	size_t dmaRxBlockSize;      /**< Bytes per RX block: the wakeup watermark */
+	size_t dmaRxBlockCount;     /**< Blocks in the RX ring */
+	size_t dmaRxPosition;       /**< Offset in rx up to which received data has been published */
+	size_t dmaRxLastSeen;       /**< DMA write offset observed on the previous tick */
+	uint32_t dmaRxQuietTicks;   /**< Ticks the DMA write offset has not moved while data is unpublished */
+
+	bool rxFlowPaused;          /**< RTS is deasserted */
+
+	bool standbyWake;           /**< Runs in standby with start-of-frame detection */
+	bool rxWakePending;         /**< A start bit was seen in standby, its character is not checked yet */
+	TickType_t rxStartTick;     /**< When the last start bit was noticed */
+	uint32_t rxWakeBytes;       /**< stats.rxBytes when standby was armed */
+	uint32_t rxWakeErrors;      /**< Receive errors counted by then */
+	size_t rxWakeDmaOffset;     /**< RX DMA write offset by then */
+
+	SerialChannelErrorHandler errorHandler; /**< Told about receive errors, or NULL */
+	void *errorCtx;             /**< Passed to errorHandler */
+
+	TickType_t baudSwitchTick;  /**< When baudRate took effect */
+	uint32_t baudSwitchTxBytes; /**< stats.txBytes at that time */
+	uint32_t baudSwitchRxBytes; /**< stats.rxBytes at that time */
+
+	struct SerialChannelStats stats; /**< Transfer counters */
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+	uint32_t *rxTimestamps;     /**< Arrival time in us of each RX ring byte, indexed like the ring */
+	uint32_t rxLastByteUs;      /**< Arrival of the previous byte */
+	volatile uint32_t rxSignalUs; /**< Last time the reader was signalled */
+	struct SerialChannelTiming timing; /**< Histograms */
+#endif
+};
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+#define SERIAL_CHANNEL_TIMESTAMPS_DEFINE(name, rxSize) static uint32_t name##_rxTimestamps[(rxSize)];
+#define SERIAL_CHANNEL_TIMESTAMPS_INIT(name) .rxTimestamps = name##_rxTimestamps,
+#else
+#define SERIAL_CHANNEL_TIMESTAMPS_DEFINE(name, rxSize)
+#define SERIAL_CHANNEL_TIMESTAMPS_INIT(name)
+#endif
+
+/** Defines a file-local channel named `name`. Ring sizes are powers of two (txSize
+ *  the bulk lane, urgentSize the urgent lane); the RX DMA watermark divides rxSize
+ *  (pass rxSize when the channel does not use RX DMA). */
+#define SERIAL_CHANNEL_DEFINE(name, rxSize, txSize, urgentSize, rxWatermark) \
+	_Static_assert(((rxSize) & ((rxSize) - 1)) == 0 && ((txSize) & ((txSize) - 1)) == 0 && \
+			((urgentSize) & ((urgentSize) - 1)) == 0, "Serial channel ring sizes must be powers of two"); \
+	_Static_assert((rxSize) % (rxWatermark) == 0, "The RX watermark must divide the RX ring size"); \
+	static uint8_t name##_rxStorage[(rxSize)]; \
+	static uint8_t name##_txStorage[(txSize)]; \
+	static uint8_t name##_txUrgentStorage[(urgentSize)]; \
+	COMPILER_ALIGNED(16) static DmacDescriptor name##_rxDescriptors[(rxSize) / (rxWatermark)]; \
+	SERIAL_CHANNEL_TIMESTAMPS_DEFINE(name, rxSize) \
+	static struct SerialChannel name = { \
+		SERIAL_CHANNEL_TIMESTAMPS_INIT(name) \
+		.rx = { name##_rxStorage, (rxSize) - 1, 0, 0 }, \
+		.tx = { { name##_txStorage, (txSize) - 1, 0, 0 }, 0, 0, false }, \
+		.txUrgent = { { name##_txUrgentStorage, (urgentSize) - 1, 0, 0 }, 0, 0, false }, \
+		.dmaRxDescriptors = name##_rxDescriptors, \
+		.dmaRxBlockSize = (rxWatermark), \
+		.dmaRxBlockCount = (rxSize) / (rxWatermark) }
+
+/** Defines a file-local cooked-mode state for lines of up to lineLength - 1
+ *  characters, with bufferSize bytes (a power of two) of completed lines */
+#define SERIAL_LINE_DEFINE(name, lineLength, bufferSize) \
+	_Static_assert(((bufferSize) & ((bufferSize) - 1)) == 0, "The line buffer size must be a power of two"); \
+	static uint8_t name##_storage[(bufferSize)]; \
+	static char name##_buffer[(lineLength)]; \
+	static char name##_history[(lineLength)]; \
+	static struct SerialLine name = { { name##_storage, (bufferSize) - 1, 0, 0 }, \
+		name##_buffer, name##_history, (lineLength), 0, 0, false, NULL }
+
+/******************************************************************************
+* Global Function Declarations
+******************************************************************************/
+/**
+ * @fn			void SerialChannelGetConfigDefaults(struct SerialChannelConfig *config)
+ * @brief		Fills a configuration with defaults: no SERCOM, 115200 baud, no DMA, ASF
+ *				jobs, no flow control, TX_POLICY_DROP_NEWEST, no echo, raw mode.
+ * @param[out]	config Configuration to initialize.
+ *****************************************************************************/
+void SerialChannelGetConfigDefaults(struct SerialChannelConfig *config);
+
+/**
+ * @fn			void SerialChannelInit(struct SerialChannel *ch, const struct SerialChannelConfig *config)
+ * @brief		Sets up the SERCOM as a UART, selects the transport and starts receiving.
+ * @param[in]	ch     Channel from SERIAL_CHANNEL_DEFINE.
+ * @param[in]	config Settings; copied, so the structure may live on the stack.
+ * @note		Call once per channel, before the channel is used from an interrupt.
+ *****************************************************************************/
+void SerialChannelInit(struct SerialChannel *ch, const struct SerialChannelConfig *config);
+
+/**
+ * @fn			void SerialChannelDeinit(struct SerialChannel *ch)
+ * @brief		Disables the channel's SERCOM.
+ *****************************************************************************/
+void SerialChannelDeinit(struct SerialChannel *ch);
+
+/**
+ * @fn			bool SerialChannelWrite(struct SerialChannel *ch, const uint8_t *data, size_t len)
+ * @brief		Queues len bytes with the channel's full-ring policy.
+ * @return		true if the data was queued, false if it was dropped
+ *****************************************************************************/
+bool SerialChannelWrite(struct SerialChannel *ch, const uint8_t *data, size_t len);
+
+/**
+ * @fn			bool SerialChannelWritePolicy(struct SerialChannel *ch, const uint8_t *data, size_t len,
+ *										  enum eTxPolicy policy, TickType_t timeout)
+ * @brief		Queues len bytes, whole or not at all, choosing what happens if the TX ring is full.
+ * @details		Tasks and interrupts may write concurrently; messages never interleave.
+ *				TX_POLICY_BLOCK waits at most timeout ticks; called from an interrupt or
+ *				before the scheduler starts it behaves as TX_POLICY_DROP_NEWEST.
+ * @return		true if the data was queued, false if it was dropped
+ *****************************************************************************/
+bool SerialChannelWritePolicy(struct SerialChannel *ch, const uint8_t *data, size_t len, enum eTxPolicy policy,
+                              TickType_t timeout);
+
+/**
+ * @fn			bool SerialChannelWriteLane(struct SerialChannel *ch, enum eTxLane lane, const uint8_t *data, size_t len)
+ * @brief		Queues len bytes in the given lane with the channel's full-ring policy.
+ * @details		SerialChannelWrite and SerialChannelWritePolicy use TX_LANE_BULK. Only the
+ *				bulk lane evicts under TX_POLICY_DROP_OLDEST; a full urgent lane drops
+ *				the new message instead.
+ * @return		true if the data was queued, false if it was dropped
+ *****************************************************************************/
+bool SerialChannelWriteLane(struct SerialChannel *ch, enum eTxLane lane, const uint8_t *data, size_t len);
+
+/**
+ * @fn			int SerialChannelPrintf(struct SerialChannel *ch, const char *format, ...)
+ * @brief		printf formatted straight into the TX ring (console_format.h subset).
+ * @return		Number of characters queued, or -1 if the message was dropped
+ *****************************************************************************/
+int SerialChannelPrintf(struct SerialChannel *ch, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @fn			int SerialChannelVPrintf(struct SerialChannel *ch, const char *format, va_list args)
+ * @brief		vprintf variant of SerialChannelPrintf.
+ *****************************************************************************/
+int SerialChannelVPrintf(struct SerialChannel *ch, const char *format, va_list args)
+    __attribute__((format(printf, 2, 0)));
+
+/**
+ * @fn			int SerialChannelVPrintfLane(struct SerialChannel *ch, enum eTxLane lane, const char *format, va_list args)
+ * @brief		SerialChannelVPrintf into the given lane.
+ *****************************************************************************/
+int SerialChannelVPrintfLane(struct SerialChannel *ch, enum eTxLane lane, const char *format, va_list args)
+    __attribute__((format(printf, 3, 0)));
+
+/**
+ * @fn			int SerialChannelReadCharacter(struct SerialChannel *ch, uint8_t *rxChar)
+ * @brief		Takes one received character (raw mode). Call from a single consumer task.
+ * @return		0, or -1 if nothing was received
+ *****************************************************************************/
+int SerialChannelReadCharacter(struct SerialChannel *ch, uint8_t *rxChar);
+
+/**
+ * @fn			size_t SerialChannelRead(struct SerialChannel *ch, uint8_t *data, size_t len)
+ * @brief		Takes up to len received characters (raw mode). Call from a single consumer task.
+ * @return		Number of characters read, 0 if nothing was received
+ *****************************************************************************/
+size_t SerialChannelRead(struct SerialChannel *ch, uint8_t *data, size_t len);
+
+/**
+ * @fn			bool SerialChannelWaitForData(struct SerialChannel *ch, TickType_t timeout)
+ * @brief		Blocks until the receive path publishes more data (raw mode).
+ * @return		true if signalled, false on timeout
+ *****************************************************************************/
+bool SerialChannelWaitForData(struct SerialChannel *ch, TickType_t timeout);
+
+/**
+ * @fn			size_t SerialChannelReadLine(struct SerialChannel *ch, char *line, size_t size)
+ * @brief		Blocks until the receive path has assembled a whole line (cooked mode).
+ * @param[out]	line Buffer that receives the null-terminated line
+ * @param[in]	size Size of the buffer; longer lines are truncated
+ * @return		Length of the line
+ *****************************************************************************/
+size_t SerialChannelReadLine(struct SerialChannel *ch, char *line, size_t size);
+
+/**
+ * @fn			bool SerialChannelWaitForLine(struct SerialChannel *ch, TickType_t timeout)
+ * @brief		Blocks until a whole line is ready, without taking it (cooked mode).
+ * @return		true if a line is ready, false on timeout
+ *****************************************************************************/
+bool SerialChannelWaitForLine(struct SerialChannel *ch, TickType_t timeout);
+
+/**
+ * @fn			void SerialChannelTickHook(void)
+ * @brief		Idle-line detection for every channel receiving through the DMAC.
+ * @note		Call from vApplicationTickHook.
+ *****************************************************************************/
+void SerialChannelTickHook(void);
+
+/**
+ * @fn			bool SerialChannelStandbyReady(void)
+ * @brief		Checks that standby cannot lose data of any channel and arms the start-bit wakeups.
+ * @details		False while output is queued or on the wire, received data is not
+ *				published yet, a character may still be arriving, or a channel cannot
+ *				run in standby. Call with interrupts disabled, right before sleeping.
+ *****************************************************************************/
+bool SerialChannelStandbyReady(void);
+
+/**
+ * @fn			void SerialChannelStandbyLeave(void)
+ * @brief		Disarms the start-bit wakeups and counts the start bits seen in standby.
+ * @note		Call with interrupts still disabled, after the tick count is stepped.
+ *****************************************************************************/
+void SerialChannelStandbyLeave(void);
+
+/**
+ * @fn			void SerialChannelGetStats(struct SerialChannel *ch, struct SerialChannelStats *stats)
+ * @brief		Copies the transfer counters of the channel.
+ *****************************************************************************/
+void SerialChannelGetStats(struct SerialChannel *ch, struct SerialChannelStats *stats);
+
+/**
+ * @fn			void SerialChannelSetErrorHandler(struct SerialChannel *ch, SerialChannelErrorHandler handler, void *ctx)
+ * @brief		Registers a function told about every receive error, e.g. to resynchronise a framed protocol.
+ * @details		Runs in the receive interrupt. With ASF jobs or the lean handler a character
+ *				with a framing or parity error is dropped; with RX DMA it is already in the
+ *				ring, so the handler is the only way to know it is damaged.
+ *****************************************************************************/
+void SerialChannelSetErrorHandler(struct SerialChannel *ch, SerialChannelErrorHandler handler, void *ctx);
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+/**
+ * @fn			void SerialChannelGetTiming(struct SerialChannel *ch, struct SerialChannelTiming *timing)
+ * @brief		Copies the receive timing histograms of the channel.
+ * @details		Timestamps combine the tick count with SysTick->VAL, so they are only
+ *				meaningful once the scheduler runs. With RX DMA a byte is stamped when
+ *				it is published (watermark or idle line), not when it arrived.
+ *****************************************************************************/
+void SerialChannelGetTiming(struct SerialChannel *ch, struct SerialChannelTiming *timing);
+
+/**
+ * @fn			void SerialChannelResetTiming(struct SerialChannel *ch)
+ * @brief		Clears the receive timing histograms of the channel.
+ *****************************************************************************/
+void SerialChannelResetTiming(struct SerialChannel *ch);
+#endif
+
+/**
+ * @fn			void SerialChannelSetEchoMode(struct SerialChannel *ch, enum eEchoMode mode)
+ * @brief		Selects who echoes received characters. Takes effect with the next one.
+ *****************************************************************************/
+void SerialChannelSetEchoMode(struct SerialChannel *ch, enum eEchoMode mode);
+
+/**
+ * @fn			enum eEchoMode SerialChannelGetEchoMode(struct SerialChannel *ch)
+ * @brief		Returns the channel's echo mode.
+ *****************************************************************************/
+enum eEchoMode SerialChannelGetEchoMode(struct SerialChannel *ch);
+
+/**
+ * @fn			bool SerialChannelSetBaudRate(struct SerialChannel *ch, uint32_t baudRate)
+ * @brief		Changes the baud rate once the queued output has been sent.
+ * @return		false, leaving the line untouched, if the rate cannot be generated
+ * @note		Call from a task. No handshake: see SerialChannelNegotiateBaudRate.
+ *****************************************************************************/
+bool SerialChannelSetBaudRate(struct SerialChannel *ch, uint32_t baudRate);
+
+/**
+ * @fn			bool SerialChannelNegotiateBaudRate(struct SerialChannel *ch, uint32_t baudRate, TickType_t timeout)
+ * @brief		Switches to baudRate and waits for the peer to confirm at the new rate.
+ * @details		The confirmation is a line (cooked mode) or a character (raw mode),
+ *				and is consumed. Without one the initial rate is restored.
+ * @return		true if confirmed
+ * @note		Call from the task that reads the channel.
+ *****************************************************************************/
+bool SerialChannelNegotiateBaudRate(struct SerialChannel *ch, uint32_t baudRate, TickType_t timeout);
+
+/**
+ * @fn			uint32_t SerialChannelGetBaudRate(struct SerialChannel *ch)
+ * @brief		Returns the current baud rate.
+ *****************************************************************************/
+uint32_t SerialChannelGetBaudRate(struct SerialChannel *ch);
+
+/**
+ * @fn			void SerialChannelGetThroughput(struct SerialChannel *ch, uint32_t *txBytesPerSecond,
+ *											uint32_t *rxBytesPerSecond)
+ * @brief		Average payload throughput since the last baud rate change (or start-up).
+ *****************************************************************************/
+void SerialChannelGetThroughput(struct SerialChannel *ch, uint32_t *txBytesPerSecond, uint32_t *rxBytesPerSecond);
+
+#endif /* SERIAL_CHANNEL_H */
@@ -5,8 +5,11 @@
  *              It initializes a UART channel and uses it to receive commands from the user
  *              as well as print debug information.
  * @details     The code in this file will:
- *              - Initialize a SERCOM port to operate as a UART channel at 115200 baud, 8N1.
- *              - Register callbacks for asynchronous reading and writing of characters.
+ *              - Build the console SerialChannel from conf_serial_console.h: SERCOM,
+ *                pins, baud rate, DMAC channels, handler and line discipline.
+ *              - Detect the host's baud rate from a sync character at start-up.
+ *              - Forward the console API to that channel (see SerialChannel.c for
+ *                the transmit and receive paths).
  *              - Initialize the CLI and Debug Logger data structures.
  * @copyright   
  * @author      
@@ -18,42 +21,99 @@
 /* Includes                                                                   */
 /******************************************************************************/
 #include "SerialConsole.h"
+#include "autobaud.h"
+#include "DebugLogger.h"
+#include "CrashLog.h"
 
 /******************************************************************************/
 /* Defines                                                                    */
 /******************************************************************************/
 #define RX_BUFFER_SIZE 512    /**< Size of the RX character buffer in bytes */
 #define TX_BUFFER_SIZE 512    /**< Size of the TX character buffer in bytes */
+#define TX_URGENT_BUFFER_SIZE 128 /**< Size of the urgent TX lane in bytes */
+
+#if CONF_SERIAL_CONSOLE_TOKENIZED_LOG
+#define LOG_TOKEN_RECORD_TAG 0xF0 /**< First byte of a tokenized record, plus the level; never starts a text line */
+/** A tokenized record framed like a LINK_CHANNEL_LOG frame */
+#define LOG_TOKEN_FRAME_SIZE (SERIAL_LINK_HEADER_SIZE + CONF_SERIAL_CONSOLE_LOG_TOKEN_RECORD_SIZE + SERIAL_LINK_CRC_SIZE)
+#if CONF_SERIAL_CONSOLE_LINK
+_Static_assert(CONF_SERIAL_CONSOLE_LOG_TOKEN_RECORD_SIZE <= CONF_SERIAL_LINK_MAX_PAYLOAD,
+               "A tokenized record must fit in one link frame");
+#endif
+#endif
+
+#if CONF_SERIAL_CONSOLE_USE_DMA_RX
+#define RX_WATERMARK CONF_SERIAL_CONSOLE_RX_WATERMARK /**< Bytes per RX DMA block */
+#else
+#define RX_WATERMARK RX_BUFFER_SIZE
+#endif
+
+#if CONF_SERIAL_CONSOLE_AUTOBAUD
+#define AUTOBAUD_TC          TC3                   /**< Timestamps the RX edges */
+#define AUTOBAUD_TC_GCLK_ID  TC3_GCLK_ID
+#define AUTOBAUD_TC_APB_MASK PM_APBCMASK_TC3
+#define AUTOBAUD_TC_EVU      EVSYS_ID_USER_TC3_EVU
+#define AUTOBAUD_EDGES       32                    /**< Edge timestamps kept while waiting for the sync character */
+#endif
+
+#if CONF_SERIAL_CONSOLE_STANDBY
+#define CONSOLE_GCLK_GENERATOR CONF_SERIAL_CONSOLE_STANDBY_GCLK_GENERATOR /**< Clock of the console SERCOM */
+#define STANDBY_RTC_HZ       32768                 /**< RTC count rate: OSCULP32K through GCLK generator 2 */
+#else
+#define CONSOLE_GCLK_GENERATOR GCLK_GENERATOR_0
+#endif
+
+#if CONF_SERIAL_CONSOLE_LINK
+#if CONF_SERIAL_CONSOLE_LINE_MODE
+#error "CONF_SERIAL_CONSOLE_LINK needs CONF_SERIAL_CONSOLE_LINE_MODE false"
+#endif
+#define LINK_CLI_RX_SIZE 256 /**< CLI input received over the link and not read yet */
+#endif
 
 /******************************************************************************/
 /* Structures and Enumerations                                                */
 /******************************************************************************/
-cbuf_handle_t cbufRx;         /**< Circular buffer handler for receiving characters */
-cbuf_handle_t cbufTx;         /**< Circular buffer handler for transmitting characters */
+SERIAL_CHANNEL_DEFINE(consoleChannel, RX_BUFFER_SIZE, TX_BUFFER_SIZE, TX_URGENT_BUFFER_SIZE, RX_WATERMARK); /**< The console UART */
 
-char latestRx;                /**< Holds the latest character received */
-char latestTx;                /**< Holds the latest character to be transmitted */
+#if CONF_SERIAL_CONSOLE_LINE_MODE
+SERIAL_LINE_DEFINE(consoleLine, CONF_SERIAL_CONSOLE_LINE_LENGTH, CONF_SERIAL_CONSOLE_LINE_BUFFER_SIZE); /**< Cooked-mode state */
+#endif
 
-/******************************************************************************/
-/* Callback Declarations                                                      */
-/******************************************************************************/
-void usart_write_callback(struct usart_module *const usart_module); /**< Callback for when writing is complete */
-void usart_read_callback(struct usart_module *const usart_module);  /**< Callback for when reading is complete */
+#if CONF_SERIAL_CONSOLE_STANDBY
+static struct SerialConsoleStandbyStats standbyStats; /**< Standby counters */
+static uint32_t standbyCarryUs; /**< Time slept or left of a tick that the tick count does not cover yet */
+#endif
+
+#if CONF_SERIAL_CONSOLE_LINK
+static struct SerialLink consoleLink;          /**< Frames multiplexed over the console UART */
+SPSC_RING_DEFINE(linkCliRx, LINK_CLI_RX_SIZE); /**< Payload of received CLI frames */
+static SemaphoreHandle_t linkCliRxSemaphore;   /**< Given for every received CLI frame */
+#endif
 
 /******************************************************************************/
 /* Local Function Declarations                                                */
 /******************************************************************************/
-static void configure_usart(void);
-static void configure_usart_callbacks(void);
+#if CONF_SERIAL_CONSOLE_LINK
+static void SerialConsoleLinkCliHandler(void *ctx, const uint8_t *payload, size_t len);
+#endif
+#if CONF_SERIAL_CONSOLE_AUTOBAUD
+static uint32_t SerialConsoleDetectBaudRate(void);
+#endif
+#if CONF_SERIAL_CONSOLE_STANDBY
+static void SerialConsoleStandbyInit(void);
+static uint32_t SerialConsoleRtcCount(void);
+#endif
+#if CONF_SERIAL_CONSOLE_TOKENIZED_LOG && !CONF_SERIAL_CONSOLE_LINK
+static void SerialConsoleWriteLogFrame(enum eDebugLogLevels level, uint8_t *frame, size_t len);
+#endif
+static void SerialConsoleVLog(enum eLogModule module, enum eDebugLogLevels level, const char *format, va_list args);
+static void SerialConsoleLogCount(uint32_t start);
 
 /******************************************************************************/
 /* Global Variables                                                           */
 /******************************************************************************/
-struct usart_module usart_instance;        /**< USART instance structure */
-char rxCharacterBuffer[RX_BUFFER_SIZE];      /**< Buffer to store received characters */
-char txCharacterBuffer[TX_BUFFER_SIZE];      /**< Buffer to store characters to be sent */
-enum eDebugLogLevels currentDebugLevel = LOG_INFO_LVL; /**< Default debug level */
-SemaphoreHandle_t xSemaphore = NULL;         /**< Semaphore for synchronizing access to the UART */
+uint8_t logModuleLevels[N_LOG_MODULES] = { [0 ... N_LOG_MODULES - 1] = LOG_INFO_LVL }; /**< Default debug levels */
+static uint8_t uartLogLevel = CONF_SERIAL_CONSOLE_UART_LOG_LEVEL; /**< Level of the UART sink */
 
 /******************************************************************************/
 /* Global Functions                                                           */
@@ -62,34 +122,88 @@ SemaphoreHandle_t xSemaphore = NULL;         /**< Semaphore for synchronizing ac
 /**************************************************************************//**
  * @brief Initializes the UART and registers callbacks.
  *
- * This function initializes circular buffers for RX and TX, configures the USART,
- * registers callbacks, creates a semaphore for synchronization, sets the SERCOM interrupt
- * priority, and starts the USART read job.
+ * This function translates conf_serial_console.h into a channel configuration
+ * (EDBG CDC pins, or the flow control pins with RTS on a GPIO) and brings the
+ * console channel up, at the rate of the host's sync character if one arrives.
  *
  * @return None.
  *****************************************************************************/
 void InitializeSerialConsole(void)
 {
-    /* Initialize circular buffers for RX and TX */
-    cbufRx = circular_buf_init((uint8_t *)rxCharacterBuffer, RX_BUFFER_SIZE);
-    cbufTx = circular_buf_init((uint8_t *)txCharacterBuffer, TX_BUFFER_SIZE);
+    struct SerialChannelConfig config;
+    uint32_t detectedBaudRate = 0;
+
+    CrashLogInit();
+    SerialChannelGetConfigDefaults(&config);
 
-    /* Configure the USART and register callbacks */
-    configure_usart();
-    configure_usart_callbacks();
+#if CONF_SERIAL_CONSOLE_AUTOBAUD
+    detectedBaudRate = SerialConsoleDetectBaudRate();
+#endif
 
-    /* Create a binary semaphore for synchronizing access to the UART */
-    xSemaphore = xSemaphoreCreateBinary();
-    configASSERT(xSemaphore);
+    config.hw = EDBG_CDC_MODULE;
+#if CONF_SERIAL_CONSOLE_FLOW_CONTROL
+    config.muxSetting = CONF_SERIAL_CONSOLE_FLOW_MUX_SETTING;
+    config.pinmuxPad0 = CONF_SERIAL_CONSOLE_FLOW_PINMUX_TX;
+    config.pinmuxPad1 = CONF_SERIAL_CONSOLE_FLOW_PINMUX_RX;
+    config.pinmuxPad2 = PINMUX_UNUSED; // RTS is a GPIO driven by the channel
+    config.pinmuxPad3 = CONF_SERIAL_CONSOLE_FLOW_PINMUX_CTS;
+    config.rtsPin = CONF_SERIAL_CONSOLE_RTS_PIN;
+#else
+    config.muxSetting = EDBG_CDC_SERCOM_MUX_SETTING;
+    config.pinmuxPad0 = EDBG_CDC_SERCOM_PINMUX_PAD0;
+    config.pinmuxPad1 = EDBG_CDC_SERCOM_PINMUX_PAD1;
+    config.pinmuxPad2 = EDBG_CDC_SERCOM_PINMUX_PAD2;
+    config.pinmuxPad3 = EDBG_CDC_SERCOM_PINMUX_PAD3;
+#endif
+    config.baudRate = (detectedBaudRate != 0) ? detectedBaudRate : CONF_SERIAL_CONSOLE_BAUD_RATE;
+#if CONF_SERIAL_CONSOLE_USE_DMA_TX
+    config.dmaTxChannel = CONF_SERIAL_CONSOLE_DMA_TX_CHANNEL;
+#endif
+#if CONF_SERIAL_CONSOLE_USE_DMA_RX
+    config.dmaRxChannel = CONF_SERIAL_CONSOLE_DMA_RX_CHANNEL;
+#endif
+    config.leanIsr = CONF_SERIAL_CONSOLE_LEAN_ISR;
+    config.txPolicy = CONF_SERIAL_CONSOLE_TX_POLICY;
+    config.txTimeoutMs = CONF_SERIAL_CONSOLE_TX_TIMEOUT_MS;
+#if CONF_SERIAL_CONSOLE_LINK
+    config.echoMode = ECHO_MODE_OFF; // An echo would corrupt the frames
+#else
+    config.echoMode = CONF_SERIAL_CONSOLE_ECHO_MODE;
+#endif
+#if CONF_SERIAL_CONSOLE_LINE_MODE
+    config.line = &consoleLine;
+#endif
+    config.irqPriority = 10;
+    config.standbyWake = CONF_SERIAL_CONSOLE_STANDBY;
+    config.gclkGenerator = CONSOLE_GCLK_GENERATOR;
 
-    /* Set the interrupt priority for SERCOM4 */
-    NVIC_SetPriority(SERCOM4_IRQn, 10);
+    SerialChannelInit(&consoleChannel, &config);
+#if CONF_SERIAL_CONSOLE_STANDBY
+    SerialConsoleStandbyInit();
+#endif
 
-    /* Kick off constant reading of characters */
-    usart_read_buffer_job(&usart_instance, (uint8_t *)&latestRx, 1);
+#if CONF_SERIAL_CONSOLE_LINK
+    linkCliRxSemaphore = xSemaphoreCreateBinary();
+    SerialLinkInit(&consoleLink, &consoleChannel);
+    SerialLinkSetHandler(&consoleLink, LINK_CHANNEL_CLI, SerialConsoleLinkCliHandler, NULL);
+    SerialLinkSetReliable(&consoleLink, CONF_SERIAL_CONSOLE_LINK_RELIABLE_CHANNEL);
+    SerialLinkStart(&consoleLink);
+#endif
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+    DebugLoggerInit();
+#endif
 
     // Additional initialization calls can be added here.
-	SerialConsoleWriteString("\r\n*** SERIAL CONSOLE INITIALIZED ***\r\n> ");
+	SerialConsolePrintf("\r\n*** SERIAL CONSOLE INITIALIZED at %lu baud (%s) ***\r\n> ",
+	                    (unsigned long)config.baudRate, (detectedBaudRate != 0) ? "detected" : "default");
+#if CONF_SERIAL_CONSOLE_CRASH_LOG
+    struct CrashLogFault fault;
+    size_t crashEntries;
+    if (CrashLogGetFault(&fault, &crashEntries))
+    {
+        SerialConsoleWriteString("*** The previous run crashed: see \"crashlog\" ***\r\n> ");
+    }
+#endif
 }
 
 /**************************************************************************//**
@@ -101,14 +215,14 @@ void InitializeSerialConsole(void)
  *****************************************************************************/
 void DeinitializeSerialConsole(void)
 {
-    usart_disable(&usart_instance);
+    SerialChannelDeinit(&consoleChannel);
 }
 
 /**************************************************************************//**
  * @brief Writes a string to the UART.
  *
- * This function sends a null-terminated string over the UART. It places each
- * character into the transmit circular buffer and initiates a write job if the USART is available.
+ * Queues the string with the CONF_SERIAL_CONSOLE_TX_POLICY policy, see
+ * SerialConsoleWritePolicy.
  *
  * @param[in] string Pointer to the null-terminated string to send.
  *
@@ -118,50 +232,392 @@ void SerialConsoleWriteString(char *string)
 {
     if (string != NULL)
     {
-        for (size_t iter = 0; iter < strlen(string); iter++)
-        {
-            circular_buf_put(cbufTx, string[iter]);
-        }
-
-        if (usart_get_job_status(&usart_instance, USART_TRANSCEIVER_TX) == STATUS_OK)
-        {
-            circular_buf_get(cbufTx, (uint8_t *)&latestTx); // Retrieve a character if TX is free.
-            usart_write_buffer_job(&usart_instance, (uint8_t *)&latestTx, 1);
-        }
+        SerialConsoleWrite((const uint8_t *)string, strlen(string));
     }
 }
 
 /**************************************************************************//**
- * @brief Reads a character from the RX buffer.
+ * @brief Writes a string to the UART with an explicit full-ring policy.
+ *
+ * @param[in] string  Pointer to the null-terminated string to send.
+ * @param[in] policy  Behaviour when the string does not fit.
+ * @param[in] timeout Ticks to wait under TX_POLICY_BLOCK.
+ *
+ * @return true if the string was queued, false if it was dropped.
+ *****************************************************************************/
+bool SerialConsoleWriteStringPolicy(char *string, enum eTxPolicy policy, TickType_t timeout)
+{
+    return string != NULL && SerialConsoleWritePolicy((const uint8_t *)string, strlen(string), policy, timeout);
+}
+
+/**************************************************************************//**
+ * @brief Writes len bytes to the UART.
+ *
+ * Queues the data with the CONF_SERIAL_CONSOLE_TX_POLICY policy, see
+ * SerialConsoleWritePolicy.
  *
- * This function retrieves a character from the RX circular buffer in a thread-safe manner.
+ * @param[in] data Bytes to send.
+ * @param[in] len  Number of bytes to send.
+ *
+ * @return true if the data was queued, false if it was dropped.
+ *****************************************************************************/
+bool SerialConsoleWrite(const uint8_t *data, size_t len)
+{
+#if CONF_SERIAL_CONSOLE_LINK
+    return SerialLinkSend(&consoleLink, LINK_CHANNEL_CLI, data, len);
+#else
+    return SerialChannelWrite(&consoleChannel, data, len);
+#endif
+}
+
+/**************************************************************************//**
+ * @brief Writes len bytes to the UART with an explicit full-ring policy.
+ *
+ * @param[in] data    Bytes to send.
+ * @param[in] len     Number of bytes to send.
+ * @param[in] policy  Behaviour when the data does not fit.
+ * @param[in] timeout Ticks to wait under TX_POLICY_BLOCK.
+ *
+ * With CONF_SERIAL_CONSOLE_LINK the data goes out as CLI frames, which never
+ * block: the policy and timeout are ignored.
+ *
+ * @return true if the data was queued, false if it was dropped.
+ *****************************************************************************/
+bool SerialConsoleWritePolicy(const uint8_t *data, size_t len, enum eTxPolicy policy, TickType_t timeout)
+{
+#if CONF_SERIAL_CONSOLE_LINK
+    (void)policy;
+    (void)timeout;
+    return SerialLinkSend(&consoleLink, LINK_CHANNEL_CLI, data, len);
+#else
+    return SerialChannelWritePolicy(&consoleChannel, data, len, policy, timeout);
+#endif
+}
+
+/**************************************************************************//**
+ * @brief printf-style write to the UART.
+ *
+ * See SerialConsoleVPrintf.
+ *
+ * @param[in] format printf format string.
+ *
+ * @return Number of characters queued, or -1 if the message was dropped.
+ *****************************************************************************/
+int SerialConsolePrintf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = SerialConsoleVPrintf(format, args);
+    va_end(args);
+
+    return written;
+}
+
+/**************************************************************************//**
+ * @brief vprintf-style write to the UART.
+ *
+ * @param[in] format printf format string (see console_format.h for the subset).
+ * @param[in] args   Arguments for the format.
+ *
+ * @return Number of characters queued, or -1 if the message was dropped.
+ *****************************************************************************/
+int SerialConsoleVPrintf(const char *format, va_list args)
+{
+#if CONF_SERIAL_CONSOLE_LINK
+    return SerialLinkVPrintf(&consoleLink, LINK_CHANNEL_CLI, format, args);
+#else
+    return SerialChannelVPrintf(&consoleChannel, format, args);
+#endif
+}
+
+/**************************************************************************//**
+ * @brief Reads a character from the RX buffer.
  *
  * @param[out] rxChar Pointer where the received character will be stored.
  *
- * @return Returns -1 if the buffer is empty, otherwise the character read.
+ * @return Returns -1 if the buffer is empty, otherwise 0.
  *****************************************************************************/
 int SerialConsoleReadCharacter(uint8_t *rxChar)
 {
-    vTaskSuspendAll();
-    int a = circular_buf_get(cbufRx, (uint8_t *)rxChar);
-    xTaskResumeAll();
-    return a;
+#if CONF_SERIAL_CONSOLE_LINK
+    return spsc_ring_get(&linkCliRx, rxChar);
+#else
+    return SerialChannelReadCharacter(&consoleChannel, rxChar);
+#endif
 }
 
+/**************************************************************************//**
+ * @brief Reads a block of characters from the RX buffer.
+ *
+ * @param[out] data Destination buffer.
+ * @param[in]  len  Size of the destination buffer.
+ *
+ * @return Number of bytes read (0 if the buffer is empty).
+ *****************************************************************************/
+size_t SerialConsoleRead(uint8_t *data, size_t len)
+{
+#if CONF_SERIAL_CONSOLE_LINK
+    return spsc_ring_get_range(&linkCliRx, data, len);
+#else
+    return SerialChannelRead(&consoleChannel, data, len);
+#endif
+}
+
+/**************************************************************************//**
+ * @brief Blocks until the receive path publishes more characters.
+ *
+ * @param[in] timeout Ticks to wait.
+ *
+ * @return true if signalled, false on timeout.
+ *****************************************************************************/
+bool SerialConsoleWaitForInput(TickType_t timeout)
+{
+#if CONF_SERIAL_CONSOLE_LINK
+    return xSemaphoreTake(linkCliRxSemaphore, timeout) == pdTRUE;
+#else
+    return SerialChannelWaitForData(&consoleChannel, timeout);
+#endif
+}
+
+#if CONF_SERIAL_CONSOLE_LINE_MODE
+/**************************************************************************//**
+ * @brief Blocks until a complete line has been received and copies it out.
+ *
+ * @param[out] line Buffer that receives the null-terminated line.
+ * @param[in]  size Size of the buffer; longer lines are truncated.
+ *
+ * @return Length of the line copied to the buffer.
+ *****************************************************************************/
+size_t SerialConsoleReadLine(char *line, size_t size)
+{
+    return SerialChannelReadLine(&consoleChannel, line, size);
+}
+
+/**************************************************************************//**
+ * @brief Waits for a complete line without taking it.
+ *
+ * @param[in] timeout Ticks to wait.
+ *
+ * @return true if a line is ready for SerialConsoleReadLine.
+ *****************************************************************************/
+bool SerialConsoleWaitForLine(TickType_t timeout)
+{
+    return SerialChannelWaitForLine(&consoleChannel, timeout);
+}
+#endif
+
+/**************************************************************************//**
+ * @brief Detects the end of a burst of received characters.
+ *
+ * Called from the FreeRTOS tick hook; runs the idle-line detection of every
+ * channel receiving through the DMAC, the console included.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialConsoleTickHook(void)
+{
+    SerialChannelTickHook();
+}
+
+/**************************************************************************//**
+ * @brief Tickless idle: sleeps in standby until a timeout is due or input arrives.
+ *
+ * SysTick stops in standby, so the RTC is set to fire one tick before the next
+ * task timeout and measures how long the device actually slept. The part of
+ * the current tick already elapsed and the remainder below a tick are carried
+ * over, so the tick count does not drift across sleeps. A start bit on the
+ * console wakes the device early through the SERCOM start-of-frame detection.
+ *
+ * @param[in] xExpectedIdleTime Ticks until the next task timeout.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialConsoleSleep(TickType_t xExpectedIdleTime)
+{
+#if CONF_SERIAL_CONSOLE_STANDBY
+    if (xExpectedIdleTime < CONF_SERIAL_CONSOLE_STANDBY_MIN_TICKS)
+    {
+        return;
+    }
+
+    __disable_irq();
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+    {
+        standbyStats.aborts++;
+        __enable_irq();
+        return;
+    }
+    if (!SerialChannelStandbyReady())
+    {
+        __enable_irq();
+        return;
+    }
+
+    /* Stop SysTick, remembering how far into the current tick it was */
+    uint32_t partialUs = (SysTick->LOAD - SysTick->VAL) / (system_gclk_gen_get_hz(GCLK_GENERATOR_0) / 1000000);
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+    uint32_t start = SerialConsoleRtcCount();
+    uint32_t counts = (uint32_t)((uint64_t)(xExpectedIdleTime - 1) * STANDBY_RTC_HZ / configTICK_RATE_HZ);
+    RTC->MODE0.COMP[0].reg = start + counts;
+    while (RTC->MODE0.STATUS.reg & RTC_STATUS_SYNCBUSY)
+    {
+    }
+    RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
+
+    system_set_sleepmode(SYSTEM_SLEEPMODE_STANDBY);
+    __DSB();
+    __WFI();
+
+    uint64_t sleptUs = (uint64_t)(SerialConsoleRtcCount() - start) * 1000000 / STANDBY_RTC_HZ;
+    uint64_t elapsedUs = standbyCarryUs + partialUs + sleptUs;
+    TickType_t ticks = (TickType_t)(elapsedUs / (1000000 / configTICK_RATE_HZ));
+
+    /* Stepping past the next timeout is not allowed: the rest is counted next time */
+    if (ticks > xExpectedIdleTime)
+    {
+        ticks = xExpectedIdleTime;
+    }
+    standbyCarryUs = (uint32_t)(elapsedUs - (uint64_t)ticks * (1000000 / configTICK_RATE_HZ));
+
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    vTaskStepTick(ticks);
+    SerialChannelStandbyLeave();
+
+    standbyStats.sleeps++;
+    standbyStats.asleepUs += sleptUs;
+    __enable_irq();
+#else
+    (void)xExpectedIdleTime;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief Copies the standby counters and estimates the average current.
+ *
+ * The estimate weights CONF_SERIAL_CONSOLE_STANDBY_UA and
+ * CONF_SERIAL_CONSOLE_ACTIVE_UA by the time spent asleep and awake.
+ *
+ * @param[out] stats Structure that receives a snapshot of the counters.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialConsoleGetStandbyStats(struct SerialConsoleStandbyStats *stats)
+{
+    struct SerialChannelStats channelStats;
+
+#if CONF_SERIAL_CONSOLE_STANDBY
+    system_interrupt_enter_critical_section();
+    *stats = standbyStats;
+    system_interrupt_leave_critical_section();
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+
+    stats->uptimeMs = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    uint64_t totalUs = (uint64_t)stats->uptimeMs * 1000;
+    uint64_t asleepUs = (stats->asleepUs < totalUs) ? stats->asleepUs : totalUs;
+    stats->averageUa = (totalUs != 0) ?
+                       (uint32_t)((asleepUs * CONF_SERIAL_CONSOLE_STANDBY_UA +
+                                   (totalUs - asleepUs) * CONF_SERIAL_CONSOLE_ACTIVE_UA) / totalUs) :
+                       CONF_SERIAL_CONSOLE_ACTIVE_UA;
+
+    SerialChannelGetStats(&consoleChannel, &channelStats);
+    stats->rxStartWakeups = channelStats.rxStartWakeups;
+    stats->rxWakeMissed = channelStats.rxWakeMissed;
+}
+
+/**************************************************************************//**
+ * @brief Copies the transfer counters of the console.
+ *
+ * @param[out] stats Structure that receives a snapshot of the counters.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialConsoleGetStats(struct SerialChannelStats *stats)
+{
+    SerialChannelGetStats(&consoleChannel, stats);
+}
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+/**************************************************************************//**
+ * @brief Copies the receive timing histograms of the console.
+ *
+ * @param[out] timing Structure that receives a snapshot of the histograms.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialConsoleGetRxTiming(struct SerialChannelTiming *timing)
+{
+    SerialChannelGetTiming(&consoleChannel, timing);
+}
+
+/**************************************************************************//**
+ * @brief Clears the receive timing histograms of the console.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialConsoleResetRxTiming(void)
+{
+    SerialChannelResetTiming(&consoleChannel);
+}
+#endif
+
+#if CONF_SERIAL_CONSOLE_LINK
+/**************************************************************************//**
+ * @brief Copies the frame counters of the console link.
+ *
+ * @param[out] stats Structure that receives a snapshot of the counters.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialConsoleGetLinkStats(struct SerialLinkStats *stats)
+{
+    SerialLinkGetStats(&consoleLink, stats);
+}
+
+/**************************************************************************//**
+ * @brief Queues data on a logical channel of the console link.
+ *
+ * @param[in] channel Logical channel.
+ * @param[in] data    Payload.
+ * @param[in] len     Payload length.
+ *
+ * @return true if every frame was queued.
+ *****************************************************************************/
+bool SerialConsoleLinkSend(enum eLinkChannel channel, const uint8_t *data, size_t len)
+{
+    return SerialLinkSend(&consoleLink, channel, data, len);
+}
+
+/**************************************************************************//**
+ * @brief Drops every Nth frame of the console link's reliable channel.
+ *
+ * @param[in] every N, 0 to send everything.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialConsoleSetLinkLossInjection(uint16_t every)
+{
+    SerialLinkSetLossInjection(&consoleLink, every);
+}
+#endif
+
 /**************************************************************************//**
  * @brief Gets the current debug log level.
  *
- * @return The current debug level.
+ * @return The current debug level, that of LOG_MODULE_APP.
  *****************************************************************************/
 enum eDebugLogLevels getLogLevel(void)
 {
-    return currentDebugLevel;
+    return getModuleLogLevel(LOG_MODULE_APP);
 }
 
 /**************************************************************************//**
  * @brief Sets the debug log level.
  *
- * This function sets the debug log level.
+ * This function sets the debug log level of every module.
  *
  * @param[in] debugLevel The debug level to set.
  *
@@ -169,127 +625,615 @@ enum eDebugLogLevels getLogLevel(void)
  *****************************************************************************/
 void setLogLevel(enum eDebugLogLevels debugLevel)
 {
-    currentDebugLevel = debugLevel;
+    for (size_t module = 0; module < N_LOG_MODULES; module++)
+    {
+        logModuleLevels[module] = (uint8_t)debugLevel;
+    }
+}
+
+/**************************************************************************//**
+ * @brief Gets the debug log level of one module.
+ *
+ * @param[in] module The module.
+ *
+ * @return Its debug level.
+ *****************************************************************************/
+enum eDebugLogLevels getModuleLogLevel(enum eLogModule module)
+{
+    return (enum eDebugLogLevels)logModuleLevels[module];
+}
+
+/**************************************************************************//**
+ * @brief Sets the debug log level of one module.
+ *
+ * @param[in] module     The module.
+ * @param[in] debugLevel The debug level to set.
+ *
+ * @return None.
+ *****************************************************************************/
+void setModuleLogLevel(enum eLogModule module, enum eDebugLogLevels debugLevel)
+{
+    logModuleLevels[module] = (uint8_t)debugLevel;
+}
+
+/**************************************************************************//**
+ * @brief Gets the level of the UART sink.
+ *
+ * @return Messages below this level are only kept in the log buffer.
+ *****************************************************************************/
+enum eDebugLogLevels getUartLogLevel(void)
+{
+    return (enum eDebugLogLevels)uartLogLevel;
+}
+
+/**************************************************************************//**
+ * @brief Sets the level of the UART sink.
+ *
+ * Module levels still decide what is logged at all; this one decides which
+ * of those messages are also sent over the UART.
+ *
+ * @param[in] debugLevel The debug level to set.
+ *
+ * @return None.
+ *****************************************************************************/
+void setUartLogLevel(enum eDebugLogLevels debugLevel)
+{
+    uartLogLevel = (uint8_t)debugLevel;
+}
+
+/**************************************************************************//**
+ * @brief Selects who echoes typed characters.
+ *
+ * @param[in] mode The new echo mode.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialConsoleSetEchoMode(enum eEchoMode mode)
+{
+#if CONF_SERIAL_CONSOLE_LINK
+    if (mode == ECHO_MODE_ISR)
+    {
+        return; // Raw echo on the wire would corrupt the frames
+    }
+#endif
+    SerialChannelSetEchoMode(&consoleChannel, mode);
+}
+
+/**************************************************************************//**
+ * @brief Gets the current echo mode.
+ *
+ * @return The current echo mode.
+ *****************************************************************************/
+enum eEchoMode SerialConsoleGetEchoMode(void)
+{
+    return SerialChannelGetEchoMode(&consoleChannel);
+}
+
+/**************************************************************************//**
+ * @brief Changes the console baud rate.
+ *
+ * @param[in] baudRate New baud rate.
+ *
+ * @return false if the rate cannot be generated from the SERCOM clock.
+ *****************************************************************************/
+bool SerialConsoleSetBaudRate(uint32_t baudRate)
+{
+    return SerialChannelSetBaudRate(&consoleChannel, baudRate);
+}
+
+/**************************************************************************//**
+ * @brief Switches the baud rate and waits for the peer to confirm it.
+ *
+ * Without a confirmation the console falls back to its start-up rate.
+ *
+ * @param[in] baudRate New baud rate.
+ * @param[in] timeout  Time the peer has to answer.
+ *
+ * @return true if the peer confirmed the new rate.
+ *****************************************************************************/
+bool SerialConsoleNegotiateBaudRate(uint32_t baudRate, TickType_t timeout)
+{
+    return SerialChannelNegotiateBaudRate(&consoleChannel, baudRate, timeout);
+}
+
+/**************************************************************************//**
+ * @brief Gets the current baud rate.
+ *
+ * @return The current baud rate.
+ *****************************************************************************/
+uint32_t SerialConsoleGetBaudRate(void)
+{
+    return SerialChannelGetBaudRate(&consoleChannel);
+}
+
+/**************************************************************************//**
+ * @brief Average throughput since the last baud rate change.
+ *
+ * @param[out] txBytesPerSecond Bytes sent per second.
+ * @param[out] rxBytesPerSecond Bytes received per second.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialConsoleGetThroughput(uint32_t *txBytesPerSecond, uint32_t *rxBytesPerSecond)
+{
+    SerialChannelGetThroughput(&consoleChannel, txBytesPerSecond, rxBytesPerSecond);
 }
 
 /**************************************************************************//**
  * @brief Logs a message at the specified debug level.
  *
  * This function formats a debug message and sends it over the UART if the specified
- * debug level is enabled.
+ * debug level is enabled for LOG_MODULE_APP. See SerialConsoleVLog.
  *
  * @param[in] level  The debug level for the message.
  * @param[in] format The format string for the message.
  * @param[in] ...    Variable arguments for the format string.
  *
+ * @note With CONF_SERIAL_CONSOLE_TOKENIZED_LOG the LogMessage macro replaces this
+ * function at the call sites; the parentheses keep it from expanding here.
+ *
  * @return None.
  *****************************************************************************/
-void LogMessage(enum eDebugLogLevels level, const char *format, ...)
+void (LogMessage)(enum eDebugLogLevels level, const char *format, ...)
 {
-    // Todo: Implement Debug Logger.
-    if (level < currentDebugLevel || level >= N_DEBUG_LEVELS)
+    va_list args;
+    va_start(args, format);
+    SerialConsoleVLog(LOG_MODULE_APP, level, format, args);
+    va_end(args);
+}
+
+/**************************************************************************//**
+ * @brief Logs a message if its level is enabled for the given module.
+ *
+ * Called by the LOG_xxx macros once they have checked the level.
+ *
+ * @param[in] module The module whose level filters the message.
+ * @param[in] level  The debug level for the message.
+ * @param[in] format The format string for the message.
+ * @param[in] ...    Variable arguments for the format string.
+ *
+ * @return None.
+ *****************************************************************************/
+void (LogModuleMessage)(enum eLogModule module, enum eDebugLogLevels level, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    SerialConsoleVLog(module, level, format, args);
+    va_end(args);
+}
+
+#if CONF_SERIAL_CONSOLE_TOKENIZED_LOG
+/**************************************************************************//**
+ * @brief Sends a tokenized message.
+ *
+ * Encodes the token and the arguments straight into a frame on the stack;
+ * nothing is formatted. Records longer than
+ * CONF_SERIAL_CONSOLE_LOG_TOKEN_RECORD_SIZE lose their last arguments.
+ *
+ * @param[in] module The module whose level filters the message.
+ * @param[in] level  The debug level for the message.
+ * @param[in] token  LOG_TOKEN_ID of the format string.
+ * @param[in] types  LOG_TOKEN_TYPES of the arguments.
+ * @param[in] ...    The arguments.
+ *
+ * @return None.
+ *****************************************************************************/
+void LogMessageToken(enum eLogModule module, enum eDebugLogLevels level, uint32_t token, uint32_t types, ...)
+{
+    uint8_t frame[LOG_TOKEN_FRAME_SIZE];
+    uint8_t *record = frame + SERIAL_LINK_HEADER_SIZE;
+
+    if (module >= N_LOG_MODULES || level < logModuleLevels[module] || level < uartLogLevel
+        || level >= N_DEBUG_LEVELS)
     {
-        return; // Do not log if level is lower than current or invalid.
+        return; // Tokenized messages are not kept in the log buffer: the UART is their only sink
     }
 
-    char buffer[512]; // Buffer to hold the formatted string.
+    uint32_t start = CONF_SERIAL_CONSOLE_LOG_PROFILING ? SysTick->VAL : 0;
+
     va_list args;
-    va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_start(args, types);
+    record[0] = (uint8_t)(LOG_TOKEN_RECORD_TAG + level);
+    size_t len = 1 + log_token_encode(record + 1, CONF_SERIAL_CONSOLE_LOG_TOKEN_RECORD_SIZE - 1, token, types, args);
     va_end(args);
 
-    SerialConsoleWriteString(buffer);
+#if CONF_SERIAL_CONSOLE_LINK
+    SerialLinkSend(&consoleLink, LINK_CHANNEL_LOG, record, len);
+#else
+    SerialConsoleWriteLogFrame(level, frame, len);
+#endif
+
+    SerialConsoleLogCount(start);
+}
+#endif
+
+/**************************************************************************//**
+ * @brief Sends a line formatted by the logger task.
+ *
+ * Takes the same route as LogMessage: the log channel of the console link, or
+ * the TX lane of the level with the channel's full-ring policy.
+ *
+ * @param[in] level Level of the message.
+ * @param[in] data  Formatted line.
+ * @param[in] len   Number of characters.
+ *
+ * @return true if the line was queued, false if it was dropped.
+ *****************************************************************************/
+bool SerialConsoleWriteLog(enum eDebugLogLevels level, const uint8_t *data, size_t len)
+{
+#if CONF_SERIAL_CONSOLE_LINK
+    (void)level;
+    return SerialLinkSend(&consoleLink, LINK_CHANNEL_LOG, data, len);
+#else
+    enum eTxLane lane = (level >= CONF_SERIAL_CONSOLE_URGENT_LOG_LEVEL) ? TX_LANE_URGENT : TX_LANE_BULK;
+    return SerialChannelWriteLane(&consoleChannel, lane, data, len);
+#endif
 }
 
 /******************************************************************************/
-/* Local Functions                                                          */
+/* Local Functions                                                            */
 /******************************************************************************/
-
 /**************************************************************************//**
- * @brief Configures the USART.
+ * @brief Logs a message for LogMessage and LogModuleMessage.
  *
- * This function sets up the USART configuration parameters such as baud rate,
- * multiplexer settings, and pin multiplexing, then initializes and enables the USART.
+ * With CONF_SERIAL_CONSOLE_LOG_BUFFER the message is captured into the log
+ * buffer, see DebugLogger.h; it also goes to the UART if its level reaches
+ * the UART sink's. With CONF_SERIAL_CONSOLE_DEFERRED_LOG the logger task
+ * formats it for the UART later. Messages at
+ * CONF_SERIAL_CONSOLE_URGENT_LOG_LEVEL and above are always formatted at once and
+ * go through the urgent TX lane, ahead of queued CLI output.
+ *
+ * @param[in] module The module whose level filters the message.
+ * @param[in] level  The debug level for the message.
+ * @param[in] format The format string for the message.
+ * @param[in] args   Arguments for the format string.
  *
  * @return None.
  *****************************************************************************/
-static void configure_usart(void)
+static void SerialConsoleVLog(enum eLogModule module, enum eDebugLogLevels level, const char *format, va_list args)
 {
-    struct usart_config config_usart;
-    usart_get_config_defaults(&config_usart);
+    if (module >= N_LOG_MODULES || level < logModuleLevels[module] || level >= N_DEBUG_LEVELS)
+    {
+        return; // Do not log if level is lower than current or invalid.
+    }
+
+    uint32_t start = CONF_SERIAL_CONSOLE_LOG_PROFILING ? SysTick->VAL : 0;
+    bool uart = level >= uartLogLevel;
+    bool now = uart && (!CONF_SERIAL_CONSOLE_DEFERRED_LOG || level >= CONF_SERIAL_CONSOLE_URGENT_LOG_LEVEL);
 
-    config_usart.baudrate = 115200;
-    config_usart.mux_setting = EDBG_CDC_SERCOM_MUX_SETTING;
-    config_usart.pinmux_pad0 = EDBG_CDC_SERCOM_PINMUX_PAD0;
-    config_usart.pinmux_pad1 = EDBG_CDC_SERCOM_PINMUX_PAD1;
-    config_usart.pinmux_pad2 = EDBG_CDC_SERCOM_PINMUX_PAD2;
-    config_usart.pinmux_pad3 = EDBG_CDC_SERCOM_PINMUX_PAD3;
-    while (usart_init(&usart_instance, EDBG_CDC_MODULE, &config_usart) != STATUS_OK)
+#if CONF_SERIAL_CONSOLE_LOG_BUFFER
+    va_list capture;
+    va_copy(capture, args);
+    DebugLoggerVCapture(module, level, uart && !now, format, capture);
+    va_end(capture);
+#endif
+
+    if (now)
     {
-        // Optionally add error handling here.
+        /* Formatted straight into the TX ring, no stack buffer needed */
+#if CONF_SERIAL_CONSOLE_LINK
+        SerialLinkVPrintf(&consoleLink, LINK_CHANNEL_LOG, format, args);
+#else
+        enum eTxLane lane = (level >= CONF_SERIAL_CONSOLE_URGENT_LOG_LEVEL) ? TX_LANE_URGENT : TX_LANE_BULK;
+        SerialChannelVPrintfLane(&consoleChannel, lane, format, args);
+#endif
     }
 
-    usart_enable(&usart_instance);
+    SerialConsoleLogCount(start);
 }
 
+#if CONF_SERIAL_CONSOLE_TOKENIZED_LOG && !CONF_SERIAL_CONSOLE_LINK
 /**************************************************************************//**
- * @brief Registers USART callbacks.
+ * @brief Frames a tokenized record for the plain text stream.
+ *
+ * Builds the same frame the console link would send on LINK_CHANNEL_LOG and
+ * puts a zero byte on either side, so the host can cut it out of the
+ * surrounding CLI text. The frame is queued with one write, whole or not at all.
  *
- * This function registers and enables the USART callbacks for both transmit and
- * receive events.
+ * @param[in] level Level of the message, selects the TX lane.
+ * @param[in] frame Record after SERIAL_LINK_HEADER_SIZE bytes, with room for the CRC.
+ * @param[in] len   Length of the record.
  *
  * @return None.
  *****************************************************************************/
-static void configure_usart_callbacks(void)
+static void SerialConsoleWriteLogFrame(enum eDebugLogLevels level, uint8_t *frame, size_t len)
 {
-    usart_register_callback(&usart_instance, usart_write_callback, USART_CALLBACK_BUFFER_TRANSMITTED);
-    usart_register_callback(&usart_instance, usart_read_callback, USART_CALLBACK_BUFFER_RECEIVED);
-    usart_enable_callback(&usart_instance, USART_CALLBACK_BUFFER_TRANSMITTED);
-    usart_enable_callback(&usart_instance, USART_CALLBACK_BUFFER_RECEIVED);
+    static uint8_t logFrameSeq; // Lets the host count lost records
+    uint8_t wire[1 + COBS_ENCODED_MAX(LOG_TOKEN_FRAME_SIZE) + 1];
+
+    frame[0] = LINK_CHANNEL_LOG;
+    system_interrupt_enter_critical_section();
+    frame[1] = logFrameSeq++;
+    system_interrupt_leave_critical_section();
+
+    size_t frameLen = SERIAL_LINK_HEADER_SIZE + len;
+    uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, frame, frameLen);
+    frame[frameLen++] = (uint8_t)crc;
+    frame[frameLen++] = (uint8_t)(crc >> 8);
+
+    wire[0] = 0;
+    size_t wireLen = 1 + cobs_encode(frame, frameLen, wire + 1);
+    wire[wireLen++] = 0;
+
+    enum eTxLane lane = (level >= CONF_SERIAL_CONSOLE_URGENT_LOG_LEVEL) ? TX_LANE_URGENT : TX_LANE_BULK;
+    SerialChannelWriteLane(&consoleChannel, lane, wire, wireLen);
 }
+#endif
 
-/******************************************************************************/
-/* Callback Functions                                                       */
-/******************************************************************************/
+/**************************************************************************//**
+ * @brief Ends the cost measurement of a LogMessage call.
+ *
+ * @param[in] start SysTick->VAL when the call started, 0 without
+ *                  CONF_SERIAL_CONSOLE_LOG_PROFILING.
+ *
+ * @return None.
+ *****************************************************************************/
+static void SerialConsoleLogCount(uint32_t start)
+{
+#if CONF_SERIAL_CONSOLE_LOG_PROFILING
+    /* SysTick counts down and reloads every tick */
+    uint32_t end = SysTick->VAL;
+    DebugLoggerCount((start >= end) ? start - end : start + SysTick->LOAD + 1 - end);
+#else
+    (void)start;
+    DebugLoggerCount(0);
+#endif
+}
 
+#if CONF_SERIAL_CONSOLE_LINK
 /**************************************************************************//**
- * @brief Callback for USART receive.
+ * @brief Receives CLI frames from the console link.
  *
- * This function is invoked when the USART has received the requested number of characters.
- * It stores the received character into the RX circular buffer, restarts the read job, and
- * gives a semaphore to unblock any tasks waiting for input.
+ * Runs in the link's receive task: queues the payload for SerialConsoleRead
+ * and wakes the CLI. Input that does not fit is dropped.
  *
- * @param[in] usart_module Pointer to the USART module structure.
+ * @param[in] ctx     Unused.
+ * @param[in] payload Characters typed on the host.
+ * @param[in] len     Number of characters.
  *
  * @return None.
  *****************************************************************************/
-void usart_read_callback(struct usart_module *const usart_module)
+static void SerialConsoleLinkCliHandler(void *ctx, const uint8_t *payload, size_t len)
+{
+    (void)ctx;
+
+    spsc_ring_put_range(&linkCliRx, payload, len);
+    xSemaphoreGive(linkCliRxSemaphore);
+}
+#endif
+
+#if CONF_SERIAL_CONSOLE_AUTOBAUD
+/**************************************************************************//**
+ * @brief Waits for the host's sync character and measures its baud rate.
+ *
+ * Runs before the SERCOM owns the RX pin. The pin is routed to its EIC line,
+ * whose event on either edge makes AUTOBAUD_TC capture its count; the capture
+ * and overflow flags are polled and the overflows extend the timestamps to 32
+ * bits. Every pair of new edges, the last AUTOBAUD_SYNC_EDGES go through
+ * autobaud_estimate(). A BREAK shortens the wait to a couple of characters at
+ * AUTOBAUD_MIN_BAUD after it, in case a sync character follows. The EIC line,
+ * event channel and TC are released afterwards, and the clocks this turned on
+ * are stopped again.
+ *
+ * @return The host's baud rate, or 0 if there was no sync character.
+ *****************************************************************************/
+static uint32_t SerialConsoleDetectBaudRate(void)
 {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    circular_buf_put(cbufRx, latestRx);
-	SerialConsoleWriteString((char[]){ latestRx, '\0' });
-    usart_read_buffer_job(&usart_instance, (uint8_t *)&latestRx, 1); // Restart reading
-    if (xSemaphore != NULL)
+    TcCount16 *const tc = &AUTOBAUD_TC->COUNT16;
+    const uint8_t extint = CONF_SERIAL_CONSOLE_AUTOBAUD_EXTINT;
+    const uint8_t rxPin = CONF_SERIAL_CONSOLE_AUTOBAUD_PINMUX >> 16;
+    const uint32_t senseShift = 4 * (extint % 8);
+    uint32_t clockHz = system_gclk_gen_get_hz(CONSOLE_GCLK_GENERATOR);
+    uint32_t deadline = (uint32_t)(((uint64_t)clockHz * CONF_SERIAL_CONSOLE_AUTOBAUD_TIMEOUT_MS / 1000) >> 16) + 1;
+    uint32_t edges[AUTOBAUD_EDGES];
+    uint32_t overflows = 0;
+    uint32_t baudRate = 0;
+    size_t count = 0;
+    bool inBreak = false;
+    bool eicEnabled;
+    bool eicClocked = system_gclk_chan_is_enabled(EIC_GCLK_ID);
+    bool evsysClocked = (PM->APBCMASK.reg & PM_APBCMASK_EVSYS) != 0;
+
+    /* Clocks: EIC edge detection, TC3 count at the SERCOM clock, event system registers */
+    struct system_gclk_chan_config gclkConfig;
+    system_gclk_chan_get_config_defaults(&gclkConfig);
+    gclkConfig.source_generator = CONSOLE_GCLK_GENERATOR;
+    system_gclk_chan_set_config(EIC_GCLK_ID, &gclkConfig);
+    system_gclk_chan_enable(EIC_GCLK_ID);
+    system_gclk_chan_set_config(AUTOBAUD_TC_GCLK_ID, &gclkConfig);
+    system_gclk_chan_enable(AUTOBAUD_TC_GCLK_ID);
+    system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBA, PM_APBAMASK_EIC);
+    system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_EVSYS | AUTOBAUD_TC_APB_MASK);
+
+    /* RX pin to the EIC, idle high even with nothing attached */
+    struct system_pinmux_config pinConfig;
+    system_pinmux_get_config_defaults(&pinConfig);
+    pinConfig.mux_position = CONF_SERIAL_CONSOLE_AUTOBAUD_PINMUX & 0xFFFF;
+    pinConfig.input_pull = SYSTEM_PINMUX_PIN_PULL_UP;
+    system_pinmux_pin_set_config(rxPin, &pinConfig);
+
+    /* EXTINT on both edges, as an event. CONFIG and EVCTRL are enable-protected. */
+    eicEnabled = (EIC->CTRL.reg & EIC_CTRL_ENABLE) != 0;
+    EIC->CTRL.reg &= ~EIC_CTRL_ENABLE;
+    while (EIC->STATUS.reg & EIC_STATUS_SYNCBUSY)
+    {
+    }
+    EIC->CONFIG[extint / 8].reg = (EIC->CONFIG[extint / 8].reg & ~(EIC_CONFIG_SENSE0_Msk << senseShift)) |
+                                  (EIC_CONFIG_SENSE0_BOTH << senseShift);
+    EIC->EVCTRL.reg |= 1UL << extint;
+    EIC->CTRL.reg |= EIC_CTRL_ENABLE;
+    while (EIC->STATUS.reg & EIC_STATUS_SYNCBUSY)
+    {
+    }
+
+    EVSYS->USER.reg = EVSYS_USER_USER(AUTOBAUD_TC_EVU) |
+                      EVSYS_USER_CHANNEL(CONF_SERIAL_CONSOLE_AUTOBAUD_EVSYS_CHANNEL + 1);
+    EVSYS->CHANNEL.reg = EVSYS_CHANNEL_CHANNEL(CONF_SERIAL_CONSOLE_AUTOBAUD_EVSYS_CHANNEL) |
+                         EVSYS_CHANNEL_EVGEN(EVSYS_ID_GEN_EIC_EXTINT_0 + extint) | EVSYS_CHANNEL_PATH_ASYNCHRONOUS;
+
+    /* Free-running 16-bit count at the SERCOM clock, capturing into CC0 on every event */
+    tc->CTRLA.reg = TC_CTRLA_SWRST;
+    while (tc->CTRLA.reg & TC_CTRLA_SWRST)
+    {
+    }
+    tc->CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER_DIV1;
+    tc->CTRLC.reg = TC_CTRLC_CPTEN0;
+    while (tc->STATUS.reg & TC_STATUS_SYNCBUSY)
+    {
+    }
+    tc->EVCTRL.reg = TC_EVCTRL_TCEI | TC_EVCTRL_EVACT_OFF;
+    tc->CTRLA.reg |= TC_CTRLA_ENABLE;
+    while (tc->STATUS.reg & TC_STATUS_SYNCBUSY)
     {
-        xSemaphoreGiveFromISR(xSemaphore, &xHigherPriorityTaskWoken);
-        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     }
+
+    while (baudRate == 0 && overflows < deadline)
+    {
+        uint8_t flags = tc->INTFLAG.reg;
+
+        if (flags & TC_INTFLAG_ERR)
+        {
+            /* A capture was overwritten: the edges no longer pair up, start over */
+            tc->INTFLAG.reg = TC_INTFLAG_ERR;
+            count = 0;
+        }
+        else if (flags & TC_INTFLAG_MC0)
+        {
+            uint16_t capture = tc->CC[0].reg;
+            /* The flags were read first: a small capture with an overflow pending comes after it */
+            uint32_t high = ((flags & TC_INTFLAG_OVF) && capture < 0x8000) ? overflows + 1 : overflows;
+
+            /* Runs start on a falling edge: begin only while the line is low */
+            if (count > 0 || !port_pin_get_input_level(rxPin))
+            {
+                if (count == AUTOBAUD_EDGES)
+                {
+                    /* Keep an even number of edges so index 0 stays a falling edge */
+                    memmove(edges, &edges[AUTOBAUD_EDGES - (AUTOBAUD_SYNC_EDGES - 2)],
+                            (AUTOBAUD_SYNC_EDGES - 2) * sizeof(edges[0]));
+                    count = AUTOBAUD_SYNC_EDGES - 2;
+                }
+                edges[count++] = (high << 16) | capture;
+
+                if (inBreak && (count % 2) == 0)
+                {
+                    /* End of a BREAK: a sync character may follow right away */
+                    uint32_t grace = (uint32_t)(((uint64_t)clockHz * 2 * 10 / AUTOBAUD_MIN_BAUD) >> 16) + 1;
+                    deadline = (overflows + grace < deadline) ? overflows + grace : deadline;
+                    inBreak = false;
+                }
+                if (count >= AUTOBAUD_SYNC_EDGES && (count % 2) == 0)
+                {
+                    baudRate = autobaud_estimate(&edges[count - AUTOBAUD_SYNC_EDGES], AUTOBAUD_SYNC_EDGES, clockHz);
+                }
+            }
+        }
+
+        if (flags & TC_INTFLAG_OVF)
+        {
+            tc->INTFLAG.reg = TC_INTFLAG_OVF;
+            overflows++;
+            if ((count % 2) == 1 && autobaud_is_break((overflows << 16) - edges[count - 1], clockHz))
+            {
+                inBreak = true;
+            }
+        }
+    }
+
+    /* Release the TC, the event channel and the EXTINT line; the SERCOM takes the pin next */
+    tc->CTRLA.reg = TC_CTRLA_SWRST;
+    while (tc->CTRLA.reg & TC_CTRLA_SWRST)
+    {
+    }
+    EVSYS->USER.reg = EVSYS_USER_USER(AUTOBAUD_TC_EVU);
+    EVSYS->CHANNEL.reg = EVSYS_CHANNEL_CHANNEL(CONF_SERIAL_CONSOLE_AUTOBAUD_EVSYS_CHANNEL);
+    EIC->CTRL.reg &= ~EIC_CTRL_ENABLE;
+    while (EIC->STATUS.reg & EIC_STATUS_SYNCBUSY)
+    {
+    }
+    EIC->EVCTRL.reg &= ~(1UL << extint);
+    EIC->CONFIG[extint / 8].reg &= ~(EIC_CONFIG_SENSE0_Msk << senseShift);
+    if (eicEnabled)
+    {
+        EIC->CTRL.reg |= EIC_CTRL_ENABLE;
+        while (EIC->STATUS.reg & EIC_STATUS_SYNCBUSY)
+        {
+        }
+    }
+    system_gclk_chan_disable(AUTOBAUD_TC_GCLK_ID);
+    system_apb_clock_clear_mask(SYSTEM_CLOCK_APB_APBC, AUTOBAUD_TC_APB_MASK);
+    /* Stop the EIC and event system clocks too, unless something else was using them */
+    if (!eicEnabled)
+    {
+        if (!eicClocked)
+        {
+            system_gclk_chan_disable(EIC_GCLK_ID);
+        }
+        system_apb_clock_clear_mask(SYSTEM_CLOCK_APB_APBA, PM_APBAMASK_EIC);
+    }
+    if (!evsysClocked)
+    {
+        system_apb_clock_clear_mask(SYSTEM_CLOCK_APB_APBC, PM_APBCMASK_EVSYS);
+    }
+
+    return baudRate;
 }
+#endif
 
+#if CONF_SERIAL_CONSOLE_STANDBY
 /**************************************************************************//**
- * @brief Callback for USART transmit.
- *
- * This function is invoked when the USART has finished transmitting the requested bytes.
- * It retrieves the next character from the TX circular buffer and starts another write job if available.
+ * @brief Starts the RTC that times standby and wakes the device from it.
  *
- * @param[in] usart_module Pointer to the USART module structure.
+ * 32-bit counter at 32.768 kHz from GCLK generator 2 (OSCULP32K, running in
+ * standby), with compare 0 as the wakeup. OSCULP32K is only accurate to a
+ * few percent, and so is the tick count across sleeps.
  *
  * @return None.
  *****************************************************************************/
-void usart_write_callback(struct usart_module *const usart_module)
+static void SerialConsoleStandbyInit(void)
+{
+    struct system_gclk_chan_config gclkConfig;
+    system_gclk_chan_get_config_defaults(&gclkConfig);
+    gclkConfig.source_generator = GCLK_GENERATOR_2;
+    system_gclk_chan_set_config(RTC_GCLK_ID, &gclkConfig);
+    system_gclk_chan_enable(RTC_GCLK_ID);
+    system_apb_clock_set_mask(SYSTEM_CLOCK_APB_APBA, PM_APBAMASK_RTC);
+
+    RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_SWRST;
+    while (RTC->MODE0.CTRL.reg & RTC_MODE0_CTRL_SWRST)
+    {
+    }
+    RTC->MODE0.CTRL.reg = RTC_MODE0_CTRL_MODE_COUNT32 | RTC_MODE0_CTRL_PRESCALER_DIV1;
+    RTC->MODE0.INTENSET.reg = RTC_MODE0_INTENSET_CMP0;
+    RTC->MODE0.CTRL.reg |= RTC_MODE0_CTRL_ENABLE;
+    while (RTC->MODE0.STATUS.reg & RTC_STATUS_SYNCBUSY)
+    {
+    }
+
+    NVIC_EnableIRQ(RTC_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief Reads the RTC counter.
+ *
+ * @return Counts at STANDBY_RTC_HZ.
+ *****************************************************************************/
+static uint32_t SerialConsoleRtcCount(void)
 {
-    if (circular_buf_get(cbufTx, (uint8_t *)&latestTx) != -1)
+    RTC->MODE0.READREQ.reg = RTC_READREQ_RREQ | RTC_READREQ_ADDR(0x10);
+    while (RTC->MODE0.STATUS.reg & RTC_STATUS_SYNCBUSY)
     {
-        usart_write_buffer_job(&usart_instance, (uint8_t *)&latestTx, 1);
     }
+    return RTC->MODE0.COUNT.reg;
+}
+
+/**************************************************************************//**
+ * @brief RTC interrupt: the standby wakeup compare matched.
+ *
+ * @return None.
+ *****************************************************************************/
+void RTC_Handler(void)
+{
+    RTC->MODE0.INTFLAG.reg = RTC_MODE0_INTFLAG_CMP0;
 }
+#endif
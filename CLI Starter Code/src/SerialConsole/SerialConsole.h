@@ -13,6 +13,7 @@
  *				--Initialize a SERCOM port (SERCOM # ) to be an UART channel operating at 115200 baud/second, 8N1
  *				--Register callbacks for the device to read and write characters asycnhronously as required by the CLI
  *				--Initialize the CLI and Debug Logger datastructures
+ *				The console is the SerialChannel (SerialChannel.h) built from conf_serial_console.h.
  *
  *				Usage:
  *
@@ -29,10 +30,9 @@
  /******************************************************************************
   * Includes
   ******************************************************************************/
- #include <asf.h>
- #include <string.h>
- #include <stdarg.h>
- #include "circular_buffer.h"
+ #include "SerialChannel.h"
+ #include "SerialLink.h"
+ #include "log_token.h"
  
  /******************************************************************************
   * Enumerations
@@ -47,6 +47,31 @@
 	 N_DEBUG_LEVELS  = 6  /**< Maximum number of log levels */
  };
 
+/** Parts of the firmware with their own runtime log level, see LOG_INFO() */
+ enum eLogModule {
+	 LOG_MODULE_APP     = 0, /**< main and application code, and plain LogMessage calls */
+	 LOG_MODULE_CONSOLE = 1, /**< Serial console and channels */
+	 LOG_MODULE_CLI     = 2, /**< Command line */
+	 LOG_MODULE_LINK    = 3, /**< Framed serial link */
+	 N_LOG_MODULES      = 4  /**< Number of modules */
+ };
+
+/******************************************************************************
+ * Structures
+ ******************************************************************************/
+/**
+ * Standby accounting of the console, see SerialConsoleGetStandbyStats().
+ */
+struct SerialConsoleStandbyStats {
+	uint32_t sleeps;         /**< Times the device entered standby */
+	uint32_t aborts;         /**< Standby abandoned because a task became ready meanwhile */
+	uint64_t asleepUs;       /**< Time spent in standby, measured by the RTC */
+	uint32_t uptimeMs;       /**< Time since the scheduler started */
+	uint32_t averageUa;      /**< Average supply current estimated from the time asleep */
+	uint32_t rxStartWakeups; /**< Start bits seen in standby */
+	uint32_t rxWakeMissed;   /**< Of those, first characters lost or damaged */
+};
+
 /******************************************************************************
 * Global Function Declarations
 ******************************************************************************/
@@ -72,25 +97,234 @@ void DeinitializeSerialConsole(void);
  * @fn			void SerialConsoleWriteString(char * string)
  * @brief		Writes a string to be written to the uart. Copies the string to a ring buffer that 
  * 				is used to hold the text send to the uart
- * @details		Uses the ringbuffer 'cbufTx', which in turn uses the array 'txCharacterBuffer'
+ * @details		Uses the console TX ring with the CONF_SERIAL_CONSOLE_TX_POLICY policy
  * @note			Use to send a string of characters to the user via UART
  *****************************************************************************/
 void SerialConsoleWriteString(char * string);
 
-extern cbuf_handle_t cbufRx;
+/**
+ * @fn			bool SerialConsoleWriteStringPolicy(char *string, enum eTxPolicy policy, TickType_t timeout)
+ * @brief		Writes a string to the uart, choosing what happens if the TX ring is full.
+ * @details		The string is queued whole or not at all, and is only scanned once for its length. TX_POLICY_BLOCK waits at most timeout ticks;
+ *				called from an interrupt or before the scheduler starts it behaves as TX_POLICY_DROP_NEWEST.
+ * @param[in]	string  Null-terminated string to send
+ * @param[in]	policy  Behaviour when the string does not fit
+ * @param[in]	timeout Ticks to wait under TX_POLICY_BLOCK
+ * @return		true if the string was queued, false if it was dropped
+ *****************************************************************************/
+bool SerialConsoleWriteStringPolicy(char *string, enum eTxPolicy policy, TickType_t timeout);
+
+/**
+ * @fn			bool SerialConsoleWrite(const uint8_t *data, size_t len)
+ * @brief		Writes len bytes to the uart without scanning for a terminator.
+ * @details		Uses the console TX ring with the CONF_SERIAL_CONSOLE_TX_POLICY policy
+ * @param[in]	data Bytes to send
+ * @param[in]	len  Number of bytes to send
+ * @return		true if the data was queued, false if it was dropped
+ *****************************************************************************/
+bool SerialConsoleWrite(const uint8_t *data, size_t len);
+
+/**
+ * @fn			bool SerialConsoleWritePolicy(const uint8_t *data, size_t len, enum eTxPolicy policy, TickType_t timeout)
+ * @brief		Writes len bytes to the uart, choosing what happens if the TX ring is full.
+ * @details		See SerialConsoleWriteStringPolicy.
+ * @param[in]	data    Bytes to send
+ * @param[in]	len     Number of bytes to send
+ * @param[in]	policy  Behaviour when the data does not fit
+ * @param[in]	timeout Ticks to wait under TX_POLICY_BLOCK
+ * @return		true if the data was queued, false if it was dropped
+ *****************************************************************************/
+bool SerialConsoleWritePolicy(const uint8_t *data, size_t len, enum eTxPolicy policy, TickType_t timeout);
+
+/**
+ * @fn			int SerialConsolePrintf(const char *format, ...)
+ * @brief		printf to the uart, formatted straight into the console TX ring.
+ * @details		No intermediate buffer: the output is measured, reserved in the TX ring and then
+ *				formatted in place. Supports the console_format.h subset (no floating point).
+ * @param[in]	format printf format string
+ * @return		Number of characters queued, or -1 if the message was dropped
+ *****************************************************************************/
+int SerialConsolePrintf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @fn			int SerialConsoleVPrintf(const char *format, va_list args)
+ * @brief		vprintf variant of SerialConsolePrintf.
+ * @param[in]	format printf format string
+ * @param[in]	args   Arguments for the format
+ * @return		Number of characters queued, or -1 if the message was dropped
+ *****************************************************************************/
+int SerialConsoleVPrintf(const char *format, va_list args) __attribute__((format(printf, 1, 0)));
 
 /**
  * @fn			int SerialConsoleReadCharacter(uint8_t *rxChar)
  * @brief		Reads a character from the RX ring buffer and stores it on the pointer given as an argument.
  *				Also, returns -1 if there is no characters on the buffer
  *				This buffer has values added to it when the UART receives ASCII characters from the terminal
- * @details		Uses the ringbuffer 'cbufTx', which in turn uses the array 'txCharacterBuffer'
+ * @details		Uses the console's lock-free RX ring. Safe against the receive interrupt without locking;
+ *				call from a single consumer task only.
  * @param[in]	Pointer to a character. This function will return the character from the RX buffer into this pointer
  * @return		Returns -1 if there are no characters in the buffer
  * @note			Use to receive characters from the RX buffer (FIFO)
  *****************************************************************************/
 int SerialConsoleReadCharacter(uint8_t *rxChar);
 
+/**
+ * @fn			size_t SerialConsoleRead(uint8_t *data, size_t len)
+ * @brief		Reads up to len characters from the RX ring buffer in one operation.
+ * @param[out]	data Buffer that receives the characters
+ * @param[in]	len  Size of the buffer
+ * @return		Number of characters read, 0 if the buffer is empty
+ *****************************************************************************/
+size_t SerialConsoleRead(uint8_t *data, size_t len);
+
+#if CONF_SERIAL_CONSOLE_LINE_MODE
+/**
+ * @fn			size_t SerialConsoleReadLine(char *line, size_t size)
+ * @brief		Blocks until the line discipline completes a line and copies it out.
+ * @details		Echo, backspace and the up-arrow recall of the previous line are handled in the
+ *				receive path; the calling task is woken by a task notification once per line.
+ *				Call from a single task only.
+ * @param[out]	line Buffer that receives the null-terminated line, without the line ending
+ * @param[in]	size Size of the buffer; longer lines are truncated
+ * @return		Length of the line copied to the buffer
+ *****************************************************************************/
+size_t SerialConsoleReadLine(char *line, size_t size);
+
+/**
+ * @fn			bool SerialConsoleWaitForLine(TickType_t timeout)
+ * @brief		Blocks until the line discipline has completed a line, without taking it.
+ * @return		true if a line is ready for SerialConsoleReadLine, false on timeout
+ *****************************************************************************/
+bool SerialConsoleWaitForLine(TickType_t timeout);
+#endif
+
+/**
+ * @fn			void SerialConsoleTickHook(void)
+ * @brief		Idle-line detection for the DMA receiver.
+ * @note		Call from vApplicationTickHook. Does nothing when DMA reception is disabled.
+ *****************************************************************************/
+void SerialConsoleTickHook(void);
+
+/**
+ * @fn			void SerialConsoleSleep(TickType_t xExpectedIdleTime)
+ * @brief		Tickless idle: enters standby until the next task timeout or a start bit on the console.
+ * @details		Does nothing unless CONF_SERIAL_CONSOLE_STANDBY is set, the idle time is at least
+ *				CONF_SERIAL_CONSOLE_STANDBY_MIN_TICKS and no serial channel has data in flight.
+ *				The RTC times the sleep and the tick count is stepped by what it measured.
+ * @note		Call from portSUPPRESS_TICKS_AND_SLEEP (vApplicationSleep in main.c).
+ *****************************************************************************/
+void SerialConsoleSleep(TickType_t xExpectedIdleTime);
+
+/**
+ * @fn			void SerialConsoleGetStandbyStats(struct SerialConsoleStandbyStats *stats)
+ * @brief		Copies the standby counters and the estimated average current.
+ * @param[out]	stats Structure that receives the counters.
+ *****************************************************************************/
+void SerialConsoleGetStandbyStats(struct SerialConsoleStandbyStats *stats);
+
+/**
+ * @fn			bool SerialConsoleWaitForInput(TickType_t timeout)
+ * @brief		Blocks until the receive path publishes more characters (raw mode).
+ * @details		Signalled once per published burst: drain the ring with SerialConsoleRead before waiting again.
+ * @param[in]	timeout Ticks to wait
+ * @return		true if signalled, false on timeout
+ *****************************************************************************/
+bool SerialConsoleWaitForInput(TickType_t timeout);
+
+/**
+ * @fn			void SerialConsoleGetStats(struct SerialChannelStats *stats)
+ * @brief		Copies the transfer counters of the console into the given structure.
+ * @param[out]	stats Structure that receives the counters.
+ * @note		Interrupts per transmitted kilobyte = txInterrupts * 1024 / txBytes.
+ *****************************************************************************/
+void SerialConsoleGetStats(struct SerialChannelStats *stats);
+
+#if CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+/**
+ * @fn			void SerialConsoleGetRxTiming(struct SerialChannelTiming *timing)
+ * @brief		Copies the receive timing histograms of the console (CONF_SERIAL_CONSOLE_RX_TIMESTAMPS).
+ * @param[out]	timing Structure that receives the histograms.
+ * @note		A slow latency with a fast wakeup points at the reading task; a slow
+ *				wakeup at the scheduling of the reader after the interrupt signalled it.
+ *****************************************************************************/
+void SerialConsoleGetRxTiming(struct SerialChannelTiming *timing);
+
+/**
+ * @fn			void SerialConsoleResetRxTiming(void)
+ * @brief		Clears the receive timing histograms of the console.
+ *****************************************************************************/
+void SerialConsoleResetRxTiming(void);
+#endif
+
+#if CONF_SERIAL_CONSOLE_LINK
+/**
+ * @fn			void SerialConsoleGetLinkStats(struct SerialLinkStats *stats)
+ * @brief		Copies the frame counters of the console link (CONF_SERIAL_CONSOLE_LINK).
+ * @param[out]	stats Structure that receives a snapshot of the counters.
+ *****************************************************************************/
+void SerialConsoleGetLinkStats(struct SerialLinkStats *stats);
+
+/**
+ * @fn			bool SerialConsoleLinkSend(enum eLinkChannel channel, const uint8_t *data, size_t len)
+ * @brief		Queues data on a logical channel of the console link, see SerialLinkSend.
+ * @details		CONF_SERIAL_CONSOLE_LINK_RELIABLE_CHANNEL is delivered reliably and in order.
+ *****************************************************************************/
+bool SerialConsoleLinkSend(enum eLinkChannel channel, const uint8_t *data, size_t len);
+
+/**
+ * @fn			void SerialConsoleSetLinkLossInjection(uint16_t every)
+ * @brief		Drops every Nth frame of the reliable channel (0 for none) to exercise retransmissions.
+ *****************************************************************************/
+void SerialConsoleSetLinkLossInjection(uint16_t every);
+#endif
+
+/**
+ * @fn			void SerialConsoleSetEchoMode(enum eEchoMode mode)
+ * @brief		Selects who echoes typed characters. Takes effect with the next received character.
+ * @param[in]	mode New echo mode
+ *****************************************************************************/
+void SerialConsoleSetEchoMode(enum eEchoMode mode);
+
+/**
+ * @fn			enum eEchoMode SerialConsoleGetEchoMode(void)
+ * @brief		Returns the current echo mode.
+ *****************************************************************************/
+enum eEchoMode SerialConsoleGetEchoMode(void);
+
+/**
+ * @fn			bool SerialConsoleSetBaudRate(uint32_t baudRate)
+ * @brief		Changes the console baud rate once the queued output has been sent.
+ * @param[in]	baudRate New baud rate; at most the SERCOM clock / 16.
+ * @return		false, leaving the line untouched, if the rate cannot be generated.
+ * @note		Call from a task. No handshake: see SerialConsoleNegotiateBaudRate.
+ *****************************************************************************/
+bool SerialConsoleSetBaudRate(uint32_t baudRate);
+
+/**
+ * @fn			bool SerialConsoleNegotiateBaudRate(uint32_t baudRate, TickType_t timeout)
+ * @brief		Switches to baudRate and waits for the peer to confirm at the new rate.
+ * @param[in]	baudRate New baud rate.
+ * @param[in]	timeout  Time the peer has to send a line (cooked mode) or a character (raw
+ *						 mode) at the new rate. The confirmation is consumed.
+ * @return		true if confirmed; otherwise the console is back at its start-up rate.
+ * @note		Call from the task that reads the console.
+ *****************************************************************************/
+bool SerialConsoleNegotiateBaudRate(uint32_t baudRate, TickType_t timeout);
+
+/**
+ * @fn			uint32_t SerialConsoleGetBaudRate(void)
+ * @brief		Returns the current baud rate.
+ *****************************************************************************/
+uint32_t SerialConsoleGetBaudRate(void);
+
+/**
+ * @fn			void SerialConsoleGetThroughput(uint32_t *txBytesPerSecond, uint32_t *rxBytesPerSecond)
+ * @brief		Average payload throughput since the last baud rate change (or start-up).
+ * @param[out]	txBytesPerSecond Bytes sent per second.
+ * @param[out]	rxBytesPerSecond Bytes received per second.
+ *****************************************************************************/
+void SerialConsoleGetThroughput(uint32_t *txBytesPerSecond, uint32_t *rxBytesPerSecond);
+
 /**
  * @fn			LogMessage
  * @brief		Logs a message at the specified debug level.
@@ -100,16 +334,76 @@ int SerialConsoleReadCharacter(uint8_t *rxChar);
  * @param   	...    The “...” in C denotes a variable list. Please refer to https://www.cprogramming.com/tutorial/c/lesson17.html 
  * 					   for more information. In this argument, we expect the variables that you would normally use in a vsprintf 
  * 					   (please see example on https://www.tutorialspoint.com/c_standard_library/c_function_vsprintf.htm). 
- * @note
+ * @note		Levels at CONF_SERIAL_CONSOLE_URGENT_LOG_LEVEL and above use the urgent TX lane,
+ *				so they go out ahead of queued CLI output. Lower levels are formatted
+ *				later by the logger task with CONF_SERIAL_CONSOLE_DEFERRED_LOG, and kept
+ *				for "dmesg" with CONF_SERIAL_CONSOLE_LOG_BUFFER, so the format must be a
+ *				string literal (or otherwise stay valid). Messages below the UART sink's
+ *				level (setUartLogLevel) are only kept in the log buffer.
+ *				Filtered by the level of LOG_MODULE_APP; prefer the LOG_xxx macros,
+ *				which skip the call and its arguments when the level is off.
  *****************************************************************************/
 void LogMessage(enum eDebugLogLevels level, const char *format, ...);
 
+/**
+ * @fn			void LogModuleMessage(enum eLogModule module, enum eDebugLogLevels level, const char *format, ...)
+ * @brief		LogMessage filtered by the level of the given module.
+ *****************************************************************************/
+void LogModuleMessage(enum eLogModule module, enum eDebugLogLevels level, const char *format, ...);
+
+#if CONF_SERIAL_CONSOLE_TOKENIZED_LOG
+/**
+ * @fn			void LogMessageToken(enum eLogModule module, enum eDebugLogLevels level, uint32_t token, uint32_t types, ...)
+ * @brief		Sends a tokenized message (CONF_SERIAL_CONSOLE_TOKENIZED_LOG), see log_token.h.
+ * @details		Called by the LogMessage and LogModuleMessage macros. The record is
+ *
+ *				    0xF0 + level | token and arguments (log_token_encode)
+ *
+ *				and goes out as the payload of a LINK_CHANNEL_LOG frame: on the console
+ *				link, or on its own between two zero bytes in the plain text stream, in
+ *				the TX lane LogMessage would use. tools/log_decode.py turns it back
+ *				into text.
+ * @param[in]	module Module whose level filters the message
+ * @param[in]	level  Level of the message
+ * @param[in]	token  LOG_TOKEN_ID of the format string
+ * @param[in]	types  LOG_TOKEN_TYPES of the arguments
+ *****************************************************************************/
+void LogMessageToken(enum eLogModule module, enum eDebugLogLevels level, uint32_t token, uint32_t types, ...);
+
+/** Compile-time check of a tokenized message's arguments against its format */
+static inline void __attribute__((format(printf, 1, 2))) LogMessageCheck(const char *format, ...)
+{
+	(void)format;
+}
+
+/**
+ * LogModuleMessage with the format moved into LOG_TOKEN_SECTION: only its token and
+ * the arguments reach the UART. The format must be a string literal.
+ */
+#define LogModuleMessage(module, level, format, ...) \
+	do { \
+		static const char logFormat[] __attribute__((section(LOG_TOKEN_SECTION), used)) = format; \
+		if (0) { \
+			LogMessageCheck(format, ##__VA_ARGS__); \
+		} \
+		LogMessageToken((module), (level), LOG_TOKEN_ID(logFormat), LOG_TOKEN_TYPES(__VA_ARGS__), ##__VA_ARGS__); \
+	} while (0)
+#define LogMessage(level, format, ...) LogModuleMessage(LOG_MODULE_APP, level, format, ##__VA_ARGS__)
+#endif
+
+/**
+ * @fn			bool SerialConsoleWriteLog(enum eDebugLogLevels level, const uint8_t *data, size_t len)
+ * @brief		Sends a formatted log line the way LogMessage would (link log channel or TX lane of the level).
+ * @return		true if the line was queued, false if it was dropped
+ *****************************************************************************/
+bool SerialConsoleWriteLog(enum eDebugLogLevels level, const uint8_t *data, size_t len);
+
 /**
  * @fn			eDebugLogLevels getLogLevel(void)
  * @brief		Sets the level of debug to print to the console to the given argument.
  *				Debug logs below the given level will not be allowed to be printed on the system
  * @param[in]   debugLevel The debug level to be set for the debug logger
- * @note
+ * @note		Sets the level of every module, see setModuleLogLevel.
  *****************************************************************************/
 void setLogLevel(enum eDebugLogLevels debugLevel);
 
@@ -118,10 +412,70 @@ void setLogLevel(enum eDebugLogLevels debugLevel);
  * @brief		Gets the level of debug to print to the console to the given argument.
  *				Debug logs below the given level will not be allowed to be printed on the system
  * @return		Returns the current debug level of the system.
- * @note
+ * @note		The level of LOG_MODULE_APP, which LogMessage uses.
  *****************************************************************************/
 enum eDebugLogLevels getLogLevel(void);
 
+/**
+ * @fn			void setModuleLogLevel(enum eLogModule module, enum eDebugLogLevels debugLevel)
+ * @brief		Sets the runtime log level of one module.
+ *****************************************************************************/
+void setModuleLogLevel(enum eLogModule module, enum eDebugLogLevels debugLevel);
+
+/**
+ * @fn			enum eDebugLogLevels getModuleLogLevel(enum eLogModule module)
+ * @brief		Gets the runtime log level of one module.
+ *****************************************************************************/
+enum eDebugLogLevels getModuleLogLevel(enum eLogModule module);
+
+/**
+ * @fn			void setUartLogLevel(enum eDebugLogLevels debugLevel)
+ * @brief		Sets the level of the UART sink: logged messages below it are only kept in
+ *				the log buffer (CONF_SERIAL_CONSOLE_LOG_BUFFER, see "dmesg").
+ *****************************************************************************/
+void setUartLogLevel(enum eDebugLogLevels debugLevel);
+
+/**
+ * @fn			enum eDebugLogLevels getUartLogLevel(void)
+ * @brief		Gets the level of the UART sink.
+ *****************************************************************************/
+enum eDebugLogLevels getUartLogLevel(void);
+
+/******************************************************************************
+* Global Variables
+******************************************************************************/
+extern uint8_t logModuleLevels[N_LOG_MODULES]; /**< Runtime level of each module, read by the LOG_xxx macros */
+
+/******************************************************************************
+* Macros
+******************************************************************************/
+/**
+ * LOG_INFO(), LOG_DEBUG(), LOG_WARNING(), LOG_ERROR() and LOG_FATAL() log for the
+ * module named by LOG_MODULE, which each file defines before using them:
+ *
+ *     #define LOG_MODULE LOG_MODULE_CLI
+ *     LOG_WARNING("Unknown command %s\r\n", name);
+ *
+ * Levels below CONF_SERIAL_CONSOLE_LOG_BUILD_LEVEL compile to nothing. The others
+ * cost one load and compare against the module's runtime level, and their
+ * arguments are only evaluated when the message is logged.
+ */
+#define LOG_ENABLED(module, level) \
+	((level) >= CONF_SERIAL_CONSOLE_LOG_BUILD_LEVEL && (level) >= logModuleLevels[(module)])
+
+#define LOG_AT(level, ...) \
+	do { \
+		if (LOG_ENABLED(LOG_MODULE, (level))) { \
+			LogModuleMessage(LOG_MODULE, (level), __VA_ARGS__); \
+		} \
+	} while (0)
+
+#define LOG_INFO(...)       LOG_AT(LOG_INFO_LVL, __VA_ARGS__)    /**< Logs an INFO message for LOG_MODULE */
+#define LOG_DEBUG(...)      LOG_AT(LOG_DEBUG_LVL, __VA_ARGS__)   /**< Logs a DEBUG message for LOG_MODULE */
+#define LOG_WARNING(...)    LOG_AT(LOG_WARNING_LVL, __VA_ARGS__) /**< Logs a WARNING message for LOG_MODULE */
+#define LOG_ERROR(...)      LOG_AT(LOG_ERROR_LVL, __VA_ARGS__)   /**< Logs an ERROR message for LOG_MODULE */
+#define LOG_FATAL(...)      LOG_AT(LOG_FATAL_LVL, __VA_ARGS__)   /**< Logs a FATAL message for LOG_MODULE */
+
 
 /******************************************************************************
 * Local Functions
@@ -0,0 +1,1074 @@
+/**************************************************************************//**
+ * @file        SerialLink.c
+ * @ingroup     Serial Console
+ * @brief       Framed binary transport multiplexing logical channels over a SerialChannel.
+ * @details     The code in this file will:
+ *              - Queue outgoing payloads per logical channel in multi-writer rings,
+ *                so tasks and interrupts can send without blocking.
+ *              - Pick the next frame by channel priority, add header, sequence number
+ *                and CRC16, COBS-encode it and hand it to the channel in one write.
+ *              - Split the received byte stream at the zero delimiters, decode and
+ *                check each frame and dispatch its payload to the channel's handler.
+ *              - Run selective repeat on the reliable channel: a window of frames
+ *                in flight, cumulative and selective ACKs, retransmission on holes
+ *                and on an RTT-based timeout, in-order delivery at the receiver.
+ * @copyright
+ * @author
+ * @date        October 16, 2026
+ * @version     0.1
+ *****************************************************************************/
+
+/******************************************************************************/
+/* Includes                                                                   */
+/******************************************************************************/
+#include "SerialLink.h"
+
+/******************************************************************************/
+/* Defines                                                                    */
+/******************************************************************************/
+#define LINK_RX_CHUNK_SIZE 32 /**< Bytes moved out of the channel's RX ring per read */
+#define LINK_WINDOW_MASK   (CONF_SERIAL_LINK_WINDOW - 1) /**< seq to window slot */
+
+#if CONF_SERIAL_LINK_MAX_PAYLOAD > 255 || CONF_SERIAL_LINK_MAX_PAYLOAD + 1 > CONF_SERIAL_LINK_QUEUE_SIZE
+#error "CONF_SERIAL_LINK_MAX_PAYLOAD must be at most 255 and leave room for one frame in a queue"
+#endif
+
+#if (CONF_SERIAL_LINK_QUEUE_SIZE & (CONF_SERIAL_LINK_QUEUE_SIZE - 1)) != 0
+#error "CONF_SERIAL_LINK_QUEUE_SIZE must be a power of two"
+#endif
+
+/* The sack bitmap covers the window after the next expected frame */
+#if CONF_SERIAL_LINK_WINDOW < 1 || CONF_SERIAL_LINK_WINDOW > 16 || \
+    (CONF_SERIAL_LINK_WINDOW & (CONF_SERIAL_LINK_WINDOW - 1)) != 0
+#error "CONF_SERIAL_LINK_WINDOW must be a power of two between 1 and 16"
+#endif
+
+/******************************************************************************/
+/* Structures and Enumerations                                                */
+/******************************************************************************/
+/** Default transmit priority of each logical channel, higher first */
+static const uint8_t linkDefaultPriority[N_LINK_CHANNELS] = {
+    [LINK_CHANNEL_CONTROL] = 3,
+    [LINK_CHANNEL_CLI] = 2,
+    [LINK_CHANNEL_LOG] = 1,
+    [LINK_CHANNEL_TELEMETRY] = 2,
+    [LINK_CHANNEL_BULK] = 0,
+};
+
+/** Write position of SerialLinkVPrintf inside its reservation */
+struct linkFormatCursor {
+    mpsc_reservation_t res; /**< Reserved queue space, after the length byte */
+    size_t offset;          /**< Characters written so far */
+};
+
+/******************************************************************************/
+/* Local Function Declarations                                                */
+/******************************************************************************/
+static bool link_reserve(struct SerialLink *link, enum eLinkChannel channel, size_t len, mpsc_reservation_t *res);
+static void link_commit(struct SerialLink *link, enum eLinkChannel channel);
+static void link_format_sink(void *ctx, const char *data, size_t len);
+static bool link_tx_next(struct SerialLink *link, enum eLinkChannel *channel);
+static void link_tx_frame(struct SerialLink *link, enum eLinkChannel channel);
+static void link_tx_wire(struct SerialLink *link, uint8_t header, uint8_t seq, size_t len);
+static void link_rx_frame(struct SerialLink *link);
+static void link_arq_service(struct SerialLink *link);
+static void link_arq_transmit(struct SerialLink *link, uint8_t seq, bool retransmit);
+static void link_arq_send_ack(struct SerialLink *link);
+static void link_arq_acknowledge(struct SerialLink *link, uint8_t next, uint16_t sack);
+static void link_arq_rtt_sample(struct SerialLinkArq *arq, TickType_t rtt);
+static TickType_t link_arq_wait(struct SerialLink *link);
+static void link_arq_receive(struct SerialLink *link, uint8_t header, uint8_t seq, const uint8_t *payload, size_t len);
+static void link_control(struct SerialLink *link, const uint8_t *payload, size_t len);
+static void link_rx_bytes(struct SerialLink *link, const uint8_t *bytes, size_t n);
+static void link_tx_task(void *pvParameters);
+static void link_rx_task(void *pvParameters);
+static void link_line_error(void *ctx, uint8_t status);
+
+/******************************************************************************/
+/* Global Functions                                                           */
+/******************************************************************************/
+
+/**************************************************************************//**
+ * @brief Binds a link to a channel and sets the default priorities.
+ *
+ * @param[in] link    Link to initialize.
+ * @param[in] channel Channel in raw mode carrying the frames.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialLinkInit(struct SerialLink *link, struct SerialChannel *channel)
+{
+    memset(link, 0, sizeof(*link));
+    link->channel = channel;
+
+    for (size_t i = 0; i < N_LINK_CHANNELS; i++)
+    {
+        link->queues[i].ring.buffer = link->queueStorage[i];
+        link->queues[i].ring.mask = CONF_SERIAL_LINK_QUEUE_SIZE - 1;
+        link->priority[i] = linkDefaultPriority[i];
+    }
+
+    link->arq.channel = N_LINK_CHANNELS;
+    link->arq.rto = pdMS_TO_TICKS(CONF_SERIAL_LINK_RTO_INITIAL_MS);
+
+    SerialChannelSetErrorHandler(channel, link_line_error, link);
+}
+
+/**************************************************************************//**
+ * @brief Registers the receiver of a logical channel.
+ *
+ * @param[in] link    Link.
+ * @param[in] channel Logical channel.
+ * @param[in] handler Called with the payload of every valid frame, or NULL.
+ * @param[in] ctx     Passed to the handler.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialLinkSetHandler(struct SerialLink *link, enum eLinkChannel channel, SerialLinkHandler handler, void *ctx)
+{
+    link->handlerCtx[channel] = ctx;
+    link->handlers[channel] = handler;
+}
+
+/**************************************************************************//**
+ * @brief Changes the transmit priority of a logical channel.
+ *
+ * @param[in] link     Link.
+ * @param[in] channel  Logical channel.
+ * @param[in] priority New priority, higher goes first.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialLinkSetPriority(struct SerialLink *link, enum eLinkChannel channel, uint8_t priority)
+{
+    link->priority[channel] = priority;
+}
+
+/**************************************************************************//**
+ * @brief Makes a logical channel reliable.
+ *
+ * @param[in] link    Link, not started yet.
+ * @param[in] channel Logical channel; the peer must use the same one.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialLinkSetReliable(struct SerialLink *link, enum eLinkChannel channel)
+{
+    link->arq.channel = (uint8_t)channel;
+}
+
+/**************************************************************************//**
+ * @brief Skips every Nth transmission on the reliable channel.
+ *
+ * The skipped frame is handled as sent, so the receiver sees a loss and the
+ * retransmission logic has to recover it.
+ *
+ * @param[in] link  Link.
+ * @param[in] every N, 0 to send everything.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialLinkSetLossInjection(struct SerialLink *link, uint16_t every)
+{
+    system_interrupt_enter_critical_section();
+    link->arq.lossEvery = every;
+    link->arq.lossCount = 0;
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Creates the transmit and receive tasks of a link.
+ *
+ * @param[in] link Initialized link.
+ *
+ * @return false if a task could not be created.
+ *****************************************************************************/
+bool SerialLinkStart(struct SerialLink *link)
+{
+    if (xTaskCreate(link_tx_task, "LINK_TX", CONF_SERIAL_LINK_TASK_SIZE, link, CONF_SERIAL_LINK_TASK_PRIORITY,
+                    &link->txTask) != pdPASS)
+    {
+        return false;
+    }
+    return xTaskCreate(link_rx_task, "LINK_RX", CONF_SERIAL_LINK_TASK_SIZE, link, CONF_SERIAL_LINK_TASK_PRIORITY,
+                       &link->rxTask) == pdPASS;
+}
+
+/**************************************************************************//**
+ * @brief Queues data on a logical channel, one frame per CONF_SERIAL_LINK_MAX_PAYLOAD bytes.
+ *
+ * @param[in] link    Link.
+ * @param[in] channel Logical channel.
+ * @param[in] data    Payload.
+ * @param[in] len     Payload length.
+ *
+ * @return true if every frame was queued.
+ *****************************************************************************/
+bool SerialLinkSend(struct SerialLink *link, enum eLinkChannel channel, const uint8_t *data, size_t len)
+{
+    bool queued = true;
+
+    do
+    {
+        size_t chunk = Min(len, (size_t)CONF_SERIAL_LINK_MAX_PAYLOAD);
+        mpsc_reservation_t res;
+
+        if (link_reserve(link, channel, chunk, &res))
+        {
+            mpsc_reservation_fill(&res, data);
+            link_commit(link, channel);
+        }
+        else
+        {
+            queued = false;
+        }
+        data += chunk;
+        len -= chunk;
+    } while (len > 0);
+
+    return queued;
+}
+
+/**************************************************************************//**
+ * @brief printf into one frame of a logical channel.
+ *
+ * See SerialLinkVPrintf.
+ *
+ * @param[in] link    Link.
+ * @param[in] channel Logical channel.
+ * @param[in] format  printf format string.
+ *
+ * @return Number of characters queued, or -1 if the frame was dropped.
+ *****************************************************************************/
+int SerialLinkPrintf(struct SerialLink *link, enum eLinkChannel channel, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = SerialLinkVPrintf(link, channel, format, args);
+    va_end(args);
+
+    return written;
+}
+
+/**************************************************************************//**
+ * @brief vprintf into one frame of a logical channel.
+ *
+ * Like SerialChannelVPrintf: the output is measured, the frame is reserved in
+ * the channel's queue and the output is formatted in place, cut off at
+ * CONF_SERIAL_LINK_MAX_PAYLOAD characters.
+ *
+ * @param[in] link    Link.
+ * @param[in] channel Logical channel.
+ * @param[in] format  printf format string (see console_format.h for the subset).
+ * @param[in] args    Arguments for the format.
+ *
+ * @return Number of characters queued, or -1 if the frame was dropped.
+ *****************************************************************************/
+int SerialLinkVPrintf(struct SerialLink *link, enum eLinkChannel channel, const char *format, va_list args)
+{
+    struct linkFormatCursor cursor;
+    va_list measure;
+
+    va_copy(measure, args);
+    size_t len = Min(console_vformat(NULL, NULL, format, measure), (size_t)CONF_SERIAL_LINK_MAX_PAYLOAD);
+    va_end(measure);
+
+    if (!link_reserve(link, channel, len, &cursor.res))
+    {
+        return -1;
+    }
+
+    cursor.offset = 0;
+    console_vformat(link_format_sink, &cursor, format, args);
+    /* Pad if an argument changed between the passes, the frame is committed whole */
+    while (cursor.offset < len)
+    {
+        link_format_sink(&cursor, " ", 1);
+    }
+    link_commit(link, channel);
+
+    return (int)len;
+}
+
+/**************************************************************************//**
+ * @brief Copies the counters of a link.
+ *
+ * @param[in]  link  Link.
+ * @param[out] stats Structure that receives a snapshot of the counters.
+ *
+ * @return None.
+ *****************************************************************************/
+void SerialLinkGetStats(struct SerialLink *link, struct SerialLinkStats *stats)
+{
+    const struct SerialLinkArq *arq = &link->arq;
+
+    system_interrupt_enter_critical_section();
+    *stats = link->stats;
+    stats->inFlight = (uint8_t)(arq->txNext - arq->txBase);
+    stats->srttMs = arq->srtt * portTICK_PERIOD_MS;
+    stats->rttvarMs = arq->rttvar * portTICK_PERIOD_MS;
+    stats->rtoMs = arq->rto * portTICK_PERIOD_MS;
+    system_interrupt_leave_critical_section();
+
+    stats->window = (arq->channel < N_LINK_CHANNELS) ? CONF_SERIAL_LINK_WINDOW : 0;
+}
+
+/******************************************************************************/
+/* Local Functions                                                            */
+/******************************************************************************/
+
+/**************************************************************************//**
+ * @brief Reserves one frame in a logical channel's queue and writes its length byte.
+ *
+ * @param[in]  link    Link.
+ * @param[in]  channel Logical channel.
+ * @param[in]  len     Payload length, at most CONF_SERIAL_LINK_MAX_PAYLOAD.
+ * @param[out] res     Reservation for the payload.
+ *
+ * @return false, counting the drop, if the queue is full.
+ *****************************************************************************/
+static bool link_reserve(struct SerialLink *link, enum eLinkChannel channel, size_t len, mpsc_reservation_t *res)
+{
+    uint8_t length = (uint8_t)len;
+
+    if (!mpsc_ring_reserve(&link->queues[channel], len + 1, res))
+    {
+        system_interrupt_enter_critical_section();
+        link->stats.txQueueDrops++;
+        system_interrupt_leave_critical_section();
+        return false;
+    }
+
+    /* The payload follows the length byte */
+    mpsc_reservation_write(res, 0, &length, 1);
+    if (res->firstLen > 1)
+    {
+        res->first++;
+        res->firstLen--;
+    }
+    else
+    {
+        res->first = res->second + (1 - res->firstLen);
+        res->firstLen = res->secondLen - (1 - res->firstLen);
+        res->secondLen = 0;
+    }
+    return true;
+}
+
+/**************************************************************************//**
+ * @brief Commits a frame and wakes the transmit task.
+ *
+ * @param[in] link    Link.
+ * @param[in] channel Logical channel the frame was reserved in.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_commit(struct SerialLink *link, enum eLinkChannel channel)
+{
+    if (!mpsc_ring_commit(&link->queues[channel]) || link->txTask == NULL)
+    {
+        return;
+    }
+
+    if (__get_IPSR() != 0)
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(link->txTask, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+    else
+    {
+        xTaskNotifyGive(link->txTask);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Format sink copying console_vformat output into a frame reservation.
+ *
+ * @param[in] ctx  The struct linkFormatCursor being written.
+ * @param[in] data Formatted characters.
+ * @param[in] len  Number of characters.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_format_sink(void *ctx, const char *data, size_t len)
+{
+    struct linkFormatCursor *cursor = ctx;
+
+    cursor->offset += mpsc_reservation_write(&cursor->res, cursor->offset, (const uint8_t *)data, len);
+}
+
+/**************************************************************************//**
+ * @brief Selects the logical channel whose frame goes out next.
+ *
+ * @param[in]  link    Link.
+ * @param[out] channel Highest priority channel with a queued frame; the lowest
+ *                     number wins a tie.
+ *
+ * @return false if every queue is empty or blocked by a full window.
+ *****************************************************************************/
+static bool link_tx_next(struct SerialLink *link, enum eLinkChannel *channel)
+{
+    bool found = false;
+
+    for (size_t i = 0; i < N_LINK_CHANNELS; i++)
+    {
+        /* The reliable channel waits for room in its window */
+        if (i == link->arq.channel && (uint8_t)(link->arq.txNext - link->arq.txBase) >= CONF_SERIAL_LINK_WINDOW)
+        {
+            continue;
+        }
+        if (!spsc_ring_empty(&link->queues[i].ring) && (!found || link->priority[i] > link->priority[*channel]))
+        {
+            *channel = (enum eLinkChannel)i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+/**************************************************************************//**
+ * @brief Sends the oldest frame of a logical channel.
+ *
+ * A frame of the reliable channel is moved into the window first, where it
+ * stays until acknowledged.
+ *
+ * @param[in] link    Link.
+ * @param[in] channel Logical channel with a queued frame.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_tx_frame(struct SerialLink *link, enum eLinkChannel channel)
+{
+    spsc_ring_t *queue = &link->queues[channel].ring;
+    uint8_t len;
+
+    spsc_ring_get(queue, &len);
+    if (channel == link->arq.channel)
+    {
+        struct SerialLinkArq *arq = &link->arq;
+        uint8_t seq = arq->txNext++;
+        uint8_t slot = seq & LINK_WINDOW_MASK;
+
+        spsc_ring_get_range(queue, arq->txPayload[slot], len);
+        arq->txLength[slot] = len;
+        arq->txRetransmitted[slot] = false;
+        arq->txSacked[slot] = false;
+        link_arq_transmit(link, seq, false);
+    }
+    else
+    {
+        spsc_ring_get_range(queue, &link->txFrame[SERIAL_LINK_HEADER_SIZE], len);
+        link_tx_wire(link, (uint8_t)channel, link->txSeq[channel]++, len);
+    }
+
+    system_interrupt_enter_critical_section();
+    link->stats.txPayloadBytes += len;
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Frames the payload waiting in txFrame and writes it to the channel.
+ *
+ * Adds header, sequence number and CRC, encodes the frame into txWire and
+ * writes it as one message, waiting for room in the TX ring so no frame is
+ * lost once dequeued.
+ *
+ * @param[in] link   Link.
+ * @param[in] header Header byte: logical channel and flags.
+ * @param[in] seq    Sequence number.
+ * @param[in] len    Payload length, the payload is at txFrame + SERIAL_LINK_HEADER_SIZE.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_tx_wire(struct SerialLink *link, uint8_t header, uint8_t seq, size_t len)
+{
+    link->txFrame[0] = header;
+    link->txFrame[1] = seq;
+    size_t frameLen = SERIAL_LINK_HEADER_SIZE + len;
+    uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, link->txFrame, frameLen);
+    link->txFrame[frameLen++] = (uint8_t)crc;
+    link->txFrame[frameLen++] = (uint8_t)(crc >> 8);
+
+    size_t wireLen = cobs_encode(link->txFrame, frameLen, link->txWire);
+    link->txWire[wireLen++] = 0;
+
+    SerialChannelWritePolicy(link->channel, link->txWire, wireLen, TX_POLICY_BLOCK, portMAX_DELAY);
+
+    system_interrupt_enter_critical_section();
+    link->stats.txFrames++;
+    link->stats.txWireBytes += wireLen;
+    system_interrupt_leave_critical_section();
+}
+
+/**************************************************************************//**
+ * @brief Checks and dispatches the frame collected in rxWire.
+ *
+ * @param[in] link Link.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_rx_frame(struct SerialLink *link)
+{
+    size_t len = cobs_decode(link->rxWire, link->rxWireLength, link->rxWire);
+    const uint8_t *frame = link->rxWire;
+
+    if (len < SERIAL_LINK_HEADER_SIZE + SERIAL_LINK_CRC_SIZE)
+    {
+        link->stats.rxFramingErrors++;
+        return;
+    }
+    /* rxWire decodes to a few bytes more than a frame; such a payload would
+     * overrun a pong in txFrame or a receive window slot */
+    if (len > SERIAL_LINK_FRAME_MAX)
+    {
+        link->stats.rxOverlong++;
+        return;
+    }
+
+    len -= SERIAL_LINK_CRC_SIZE;
+    uint16_t crc = (uint16_t)(frame[len] | (frame[len + 1] << 8));
+    if (crc16_ccitt(CRC16_CCITT_INIT, frame, len) != crc)
+    {
+        link->stats.rxCrcErrors++;
+        return;
+    }
+
+    uint8_t channel = frame[0] & SERIAL_LINK_CHANNEL_MASK;
+    const uint8_t *payload = &frame[SERIAL_LINK_HEADER_SIZE];
+    len -= SERIAL_LINK_HEADER_SIZE;
+
+    link->stats.rxFrames++;
+    link->stats.rxPayloadBytes += len;
+    if (channel >= N_LINK_CHANNELS)
+    {
+        link->stats.rxUnhandled++;
+        return;
+    }
+
+    if (frame[0] & (SERIAL_LINK_FLAG_ACK | SERIAL_LINK_FLAG_RELIABLE))
+    {
+        if (channel != link->arq.channel)
+        {
+            link->stats.rxUnhandled++;
+        }
+        else if (frame[0] & SERIAL_LINK_FLAG_ACK)
+        {
+            if (len == SERIAL_LINK_ACK_SIZE)
+            {
+                /* Latest ACK wins, it is cumulative */
+                system_interrupt_enter_critical_section();
+                link->arq.ackNext = payload[0];
+                link->arq.ackSack = (uint16_t)(payload[1] | (payload[2] << 8));
+                link->arq.ackReceived = true;
+                system_interrupt_leave_critical_section();
+                xTaskNotifyGive(link->txTask);
+            }
+        }
+        else
+        {
+            link_arq_receive(link, frame[0], frame[1], payload, len);
+        }
+        return;
+    }
+
+    /* Sequence numbers only count losses; the first frame sets the expectation */
+    if (link->rxSeqValid[channel])
+    {
+        link->stats.rxSeqGaps += (uint8_t)(frame[1] - link->rxSeq[channel]);
+    }
+    link->rxSeq[channel] = frame[1] + 1;
+    link->rxSeqValid[channel] = true;
+
+    if (channel == LINK_CHANNEL_CONTROL && len > 0 && payload[0] == LINK_CONTROL_PING)
+    {
+        link_control(link, payload, len);
+    }
+    else if (link->handlers[channel] != NULL)
+    {
+        link->handlers[channel](link->handlerCtx[channel], payload, len);
+    }
+    else
+    {
+        link->stats.rxUnhandled++;
+    }
+}
+
+/**************************************************************************//**
+ * @brief Answers a ping on the control channel.
+ *
+ * @param[in] link    Link.
+ * @param[in] payload The ping, LINK_CONTROL_PING followed by the peer's bytes.
+ * @param[in] len     Length of the ping.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_control(struct SerialLink *link, const uint8_t *payload, size_t len)
+{
+    mpsc_reservation_t res;
+    const uint8_t pong = LINK_CONTROL_PONG;
+
+    if (link_reserve(link, LINK_CHANNEL_CONTROL, len, &res))
+    {
+        mpsc_reservation_write(&res, 0, &pong, 1);
+        mpsc_reservation_write(&res, 1, payload + 1, len - 1);
+        link_commit(link, LINK_CHANNEL_CONTROL);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Runs the sender side of the reliable channel.
+ *
+ * Sends a pending ACK, applies the latest ACK from the peer and retransmits
+ * the oldest frame when its timeout has expired. Called by the transmit task
+ * before every new frame, so these go out ahead of queued data.
+ *
+ * @param[in] link Link.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_arq_service(struct SerialLink *link)
+{
+    struct SerialLinkArq *arq = &link->arq;
+    bool ackPending, ackReceived;
+    uint8_t ackNext;
+    uint16_t ackSack;
+
+    if (arq->channel >= N_LINK_CHANNELS)
+    {
+        return;
+    }
+
+    system_interrupt_enter_critical_section();
+    ackPending = arq->ackPending;
+    ackReceived = arq->ackReceived;
+    ackNext = arq->ackNext;
+    ackSack = arq->ackSack;
+    arq->ackPending = false;
+    arq->ackReceived = false;
+    system_interrupt_leave_critical_section();
+
+    if (ackPending)
+    {
+        link_arq_send_ack(link);
+    }
+    if (ackReceived)
+    {
+        link_arq_acknowledge(link, ackNext, ackSack);
+    }
+
+    if (arq->txBase != arq->txNext &&
+        xTaskGetTickCount() - arq->txSent[arq->txBase & LINK_WINDOW_MASK] >= arq->rto)
+    {
+        /* Back off until an ACK gets through */
+        arq->rto = Min(arq->rto * 2, pdMS_TO_TICKS(CONF_SERIAL_LINK_RTO_MAX_MS));
+        system_interrupt_enter_critical_section();
+        link->stats.txTimeouts++;
+        system_interrupt_leave_critical_section();
+        link_arq_transmit(link, arq->txBase, true);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Sends or resends a frame of the window.
+ *
+ * @param[in] link       Link.
+ * @param[in] seq        Sequence number of a frame in flight.
+ * @param[in] retransmit The frame was sent before.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_arq_transmit(struct SerialLink *link, uint8_t seq, bool retransmit)
+{
+    struct SerialLinkArq *arq = &link->arq;
+    uint8_t slot = seq & LINK_WINDOW_MASK;
+    uint8_t header = arq->channel | SERIAL_LINK_FLAG_RELIABLE;
+    bool inject;
+
+    arq->txRetransmitted[slot] |= retransmit;
+    arq->txSent[slot] = xTaskGetTickCount();
+    if (!arq->txSynced)
+    {
+        header |= SERIAL_LINK_FLAG_SYNC;
+    }
+
+    system_interrupt_enter_critical_section();
+    inject = arq->lossEvery != 0 && ++arq->lossCount >= arq->lossEvery;
+    if (inject)
+    {
+        arq->lossCount = 0;
+        link->stats.txInjectedLosses++;
+    }
+    if (retransmit)
+    {
+        link->stats.txRetransmits++;
+    }
+    system_interrupt_leave_critical_section();
+
+    if (!inject)
+    {
+        memcpy(&link->txFrame[SERIAL_LINK_HEADER_SIZE], arq->txPayload[slot], arq->txLength[slot]);
+        link_tx_wire(link, header, seq, arq->txLength[slot]);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Tells the peer which frames of the reliable channel arrived.
+ *
+ * @param[in] link Link.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_arq_send_ack(struct SerialLink *link)
+{
+    uint8_t *payload = &link->txFrame[SERIAL_LINK_HEADER_SIZE];
+
+    system_interrupt_enter_critical_section();
+    payload[0] = link->arq.rxNext;
+    payload[1] = (uint8_t)link->arq.rxSack;
+    payload[2] = (uint8_t)(link->arq.rxSack >> 8);
+    system_interrupt_leave_critical_section();
+
+    link_tx_wire(link, link->arq.channel | SERIAL_LINK_FLAG_ACK, 0, SERIAL_LINK_ACK_SIZE);
+}
+
+/**************************************************************************//**
+ * @brief Applies an ACK to the window.
+ *
+ * Slides the window up to the next expected frame, marks the selectively
+ * acknowledged frames and resends the holes below the highest of them. The
+ * RTT sample comes from the most recently sent frame the ACK newly covers,
+ * which is the one that triggered it: frames released after waiting for a
+ * hole to fill would overstate the round trip.
+ *
+ * @param[in] link Link.
+ * @param[in] next Next seq the peer expects: everything before it arrived.
+ * @param[in] sack Bit i: the peer holds seq next + 1 + i.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_arq_acknowledge(struct SerialLink *link, uint8_t next, uint16_t sack)
+{
+    struct SerialLinkArq *arq = &link->arq;
+    TickType_t now = xTaskGetTickCount();
+    uint8_t inFlight = arq->txNext - arq->txBase;
+    uint8_t acked = next - arq->txBase;
+    TickType_t newestAge = portMAX_DELAY;
+    bool newestRetransmitted = true;
+
+    if (acked > inFlight)
+    {
+        return; // Stale, or for frames never sent
+    }
+    arq->txSynced = true;
+
+    /* Frames covered for the first time, cumulatively or selectively */
+    for (uint8_t i = 0; i < inFlight; i++)
+    {
+        uint8_t slot = (uint8_t)(arq->txBase + i) & LINK_WINDOW_MASK;
+        bool covered = (i < acked) || (i > acked && (sack & (1u << (i - acked - 1))));
+
+        if (covered && !arq->txSacked[slot])
+        {
+            arq->txSacked[slot] = true;
+            if (now - arq->txSent[slot] < newestAge)
+            {
+                newestAge = now - arq->txSent[slot];
+                newestRetransmitted = arq->txRetransmitted[slot];
+            }
+        }
+    }
+    if (newestAge != portMAX_DELAY && !newestRetransmitted)
+    {
+        link_arq_rtt_sample(arq, newestAge);
+    }
+    arq->txBase = next;
+    inFlight -= acked;
+
+    /* Holes below the highest selectively acknowledged frame were lost, unless
+     * they were resent less than a round trip ago */
+    uint8_t highest = 0;
+    for (uint8_t i = 1; i < inFlight; i++)
+    {
+        if (sack & (1u << (i - 1)))
+        {
+            highest = i;
+        }
+    }
+    TickType_t recent = arq->rttValid ? arq->srtt + 1 : arq->rto;
+    for (uint8_t i = 0; i < highest; i++)
+    {
+        uint8_t seq = next + i;
+        uint8_t slot = seq & LINK_WINDOW_MASK;
+
+        if (!arq->txSacked[slot] && now - arq->txSent[slot] >= recent)
+        {
+            link_arq_transmit(link, seq, true);
+        }
+    }
+}
+
+/**************************************************************************//**
+ * @brief Updates the RTT estimate and the retransmission timeout (RFC 6298).
+ *
+ * @param[in] arq Reliable channel state.
+ * @param[in] rtt Measured round trip, in ticks.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_arq_rtt_sample(struct SerialLinkArq *arq, TickType_t rtt)
+{
+    if (!arq->rttValid)
+    {
+        arq->srtt = rtt;
+        arq->rttvar = rtt / 2;
+        arq->rttValid = true;
+    }
+    else
+    {
+        TickType_t delta = (arq->srtt > rtt) ? arq->srtt - rtt : rtt - arq->srtt;
+        arq->rttvar = (3 * arq->rttvar + delta) / 4;
+        arq->srtt = (7 * arq->srtt + rtt) / 8;
+    }
+
+    TickType_t rto = arq->srtt + Max(4 * arq->rttvar, (TickType_t)1);
+    rto = Max(rto, pdMS_TO_TICKS(CONF_SERIAL_LINK_RTO_MIN_MS));
+    arq->rto = Min(rto, pdMS_TO_TICKS(CONF_SERIAL_LINK_RTO_MAX_MS));
+}
+
+/**************************************************************************//**
+ * @brief Time the transmit task may sleep before a retransmission is due.
+ *
+ * @param[in] link Link.
+ *
+ * @return Ticks until the oldest frame in flight times out, portMAX_DELAY if none.
+ *****************************************************************************/
+static TickType_t link_arq_wait(struct SerialLink *link)
+{
+    struct SerialLinkArq *arq = &link->arq;
+
+    if (arq->channel >= N_LINK_CHANNELS || arq->txBase == arq->txNext)
+    {
+        return portMAX_DELAY;
+    }
+
+    TickType_t elapsed = xTaskGetTickCount() - arq->txSent[arq->txBase & LINK_WINDOW_MASK];
+    return (elapsed >= arq->rto) ? 0 : arq->rto - elapsed;
+}
+
+/**************************************************************************//**
+ * @brief Receives a frame of the reliable channel.
+ *
+ * Hands it to the handler if it is the next one expected, followed by any
+ * buffered frames it unblocks; buffers it if it is ahead within the window;
+ * drops it if it was received before. Every frame is answered with an ACK.
+ *
+ * @param[in] link    Link.
+ * @param[in] header  Header byte of the frame.
+ * @param[in] seq     Sequence number of the frame.
+ * @param[in] payload Payload.
+ * @param[in] len     Payload length.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_arq_receive(struct SerialLink *link, uint8_t header, uint8_t seq, const uint8_t *payload, size_t len)
+{
+    struct SerialLinkArq *arq = &link->arq;
+    SerialLinkHandler handler = link->handlers[arq->channel];
+    void *ctx = link->handlerCtx[arq->channel];
+    bool sync = (header & SERIAL_LINK_FLAG_SYNC) != 0;
+    uint8_t ahead = seq - arq->rxNext;
+
+    /* link_rx_frame drops longer frames; rxPayload and rxLength rely on it */
+    configASSERT(len <= CONF_SERIAL_LINK_MAX_PAYLOAD);
+
+    /* A sender starts at seq 0 and flags its frames until it sees an ACK, so
+     * its first frames may be lost without the count being lost; the wire
+     * keeps the order, so a flagged frame after unflagged ones means the peer
+     * restarted. Without a flag, the first frame seen has to start the count. */
+    if (!arq->rxSynced || (sync && !arq->rxPeerSyncing))
+    {
+        system_interrupt_enter_critical_section();
+        arq->rxNext = sync ? 0 : seq;
+        arq->rxSack = 0;
+        system_interrupt_leave_critical_section();
+        arq->rxSynced = true;
+        link->stats.rxResyncs++;
+        ahead = seq - arq->rxNext;
+    }
+    arq->rxPeerSyncing = sync;
+
+    if (ahead == 0)
+    {
+        if (handler != NULL)
+        {
+            handler(ctx, payload, len);
+        }
+        else
+        {
+            link->stats.rxUnhandled++;
+        }
+        system_interrupt_enter_critical_section();
+        arq->rxNext++;
+        system_interrupt_leave_critical_section();
+
+        /* Bit 0 of rxSack is now rxNext itself */
+        while (arq->rxSack & 1)
+        {
+            uint8_t slot = arq->rxNext & LINK_WINDOW_MASK;
+            if (handler != NULL)
+            {
+                handler(ctx, arq->rxPayload[slot], arq->rxLength[slot]);
+            }
+            system_interrupt_enter_critical_section();
+            arq->rxSack >>= 1;
+            arq->rxNext++;
+            system_interrupt_leave_critical_section();
+        }
+        system_interrupt_enter_critical_section();
+        arq->rxSack >>= 1;
+        system_interrupt_leave_critical_section();
+    }
+    else if (ahead < CONF_SERIAL_LINK_WINDOW && !(arq->rxSack & (1u << (ahead - 1))))
+    {
+        uint8_t slot = seq & LINK_WINDOW_MASK;
+        memcpy(arq->rxPayload[slot], payload, len);
+        arq->rxLength[slot] = (uint8_t)len;
+        system_interrupt_enter_critical_section();
+        arq->rxSack |= 1u << (ahead - 1);
+        system_interrupt_leave_critical_section();
+        link->stats.rxOutOfOrder++;
+    }
+    else
+    {
+        link->stats.rxDuplicates++;
+    }
+
+    system_interrupt_enter_critical_section();
+    arq->ackPending = true;
+    system_interrupt_leave_critical_section();
+    xTaskNotifyGive(link->txTask);
+}
+
+/******************************************************************************/
+/* Tasks                                                                      */
+/******************************************************************************/
+
+/**************************************************************************//**
+ * @brief Transmit task: sends queued frames by priority.
+ *
+ * Re-evaluates the priorities after every frame, so an urgent frame queued
+ * during a bulk burst goes out next, and serves ACKs and retransmissions of
+ * the reliable channel in between. Sleeps until notified or until the
+ * oldest unacknowledged frame times out.
+ *
+ * @param[in] pvParameters The struct SerialLink.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_tx_task(void *pvParameters)
+{
+    struct SerialLink *link = pvParameters;
+    enum eLinkChannel channel = LINK_CHANNEL_CONTROL;
+
+    for (;;)
+    {
+        link_arq_service(link);
+        while (link_tx_next(link, &channel))
+        {
+            link_tx_frame(link, channel);
+            link_arq_service(link);
+        }
+        ulTaskNotifyTake(pdTRUE, link_arq_wait(link));
+    }
+}
+
+/**************************************************************************//**
+ * @brief Receive task: hands the bytes of the channel to link_rx_bytes().
+ *
+ * Drains the channel a chunk at a time and only blocks when it is empty.
+ *
+ * @param[in] pvParameters The struct SerialLink.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_rx_task(void *pvParameters)
+{
+    struct SerialLink *link = pvParameters;
+    uint8_t chunk[LINK_RX_CHUNK_SIZE];
+
+    for (;;)
+    {
+        size_t n = SerialChannelRead(link->channel, chunk, sizeof(chunk));
+        if (n == 0)
+        {
+            SerialChannelWaitForData(link->channel, portMAX_DELAY);
+            continue;
+        }
+        link_rx_bytes(link, chunk, n);
+    }
+}
+
+/**************************************************************************//**
+ * @brief Splits bytes read from the channel into frames at the delimiters.
+ *
+ * @param[in] link  The link.
+ * @param[in] bytes Bytes in the order they were received.
+ * @param[in] n     Number of bytes.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_rx_bytes(struct SerialLink *link, const uint8_t *bytes, size_t n)
+{
+    link->stats.rxWireBytes += n;
+
+    /* A character was lost or damaged: resync at the next delimiter
+     * rather than wait for the CRC to reject the frame */
+    if (link->rxLineError)
+    {
+        link->rxLineError = false;
+        if (!link->rxDiscard)
+        {
+            link->stats.rxLineErrors++;
+            link->rxDiscard = true;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        if (bytes[i] == 0)
+        {
+            if (!link->rxDiscard && link->rxWireLength > 0)
+            {
+                link_rx_frame(link);
+            }
+            link->rxWireLength = 0;
+            link->rxDiscard = false;
+        }
+        else if (link->rxWireLength < sizeof(link->rxWire))
+        {
+            link->rxWire[link->rxWireLength++] = bytes[i];
+        }
+        else if (!link->rxDiscard)
+        {
+            link->stats.rxOverlong++;
+            link->rxDiscard = true;
+        }
+    }
+}
+
+/**************************************************************************//**
+ * @brief Error handler of the channel, from its receive interrupt.
+ *
+ * @param[in] ctx    The struct SerialLink.
+ * @param[in] status Receive error flags, unused: every class breaks the frame.
+ *
+ * @return None.
+ *****************************************************************************/
+static void link_line_error(void *ctx, uint8_t status)
+{
+    struct SerialLink *link = ctx;
+
+    (void)status;
+    link->rxLineError = true;
+}
@@ -0,0 +1,288 @@
+/**************************************************************************//**
+ * @file        SerialLink.h
+ * @ingroup     Serial Console
+ * @brief       Framed binary transport multiplexing logical channels over a SerialChannel.
+ * @details     Every frame on the wire is
+ *
+ *				    COBS( header | seq | payload | crc16 ) 0x00
+ *
+ *				header: logical channel in the low nibble, SERIAL_LINK_FLAG_* in the upper one.
+ *				seq:    per logical channel sequence number, lets the receiver count lost frames.
+ *				crc16:  CRC-16/CCITT-FALSE of header, seq and payload, little endian.
+ *
+ *				The zero delimiter resynchronises the receiver after noise or a lost
+ *				byte; frames with a bad CRC are counted and dropped. Each logical
+ *				channel has its own queue and priority: the transmit task always sends
+ *				the oldest frame of the highest priority non-empty queue next, so an
+ *				urgent frame waits for at most the frame on the wire plus what is
+ *				already in the UART's TX ring. Received frames are handed to the
+ *				handler registered for their channel, in the receive task.
+ *
+ *				The control channel answers LINK_CONTROL_PING with LINK_CONTROL_PONG
+ *				carrying the same bytes, so the peer can measure round trips.
+ *
+ *				One logical channel can be made reliable (SerialLinkSetReliable): its
+ *				frames carry SERIAL_LINK_FLAG_RELIABLE and seq becomes a selective
+ *				repeat sequence number. Up to CONF_SERIAL_LINK_WINDOW frames are in
+ *				flight; the receiver answers every frame with a SERIAL_LINK_FLAG_ACK
+ *				frame whose payload is
+ *
+ *				    next expected seq | sack bitmap (16 bit, little endian)
+ *
+ *				where bit i marks seq next + 1 + i as received out of order. The
+ *				sender retransmits the holes below the highest selectively acked
+ *				frame at once, and the oldest frame when its retransmission timeout
+ *				(smoothed RTT + 4 * RTT variance, doubled on every expiry) runs out.
+ *				The receiver buffers out of order frames and hands them to the
+ *				handler in sequence, each exactly once. Frames carry
+ *				SERIAL_LINK_FLAG_SYNC until the sender sees its first ACK, so a
+ *				receiver adopts the sequence numbers of a peer that restarted,
+ *				counting from 0 even when the first frames were lost.
+ *
+ *				Usage:
+ *				    static struct SerialLink link;
+ *				    SerialLinkInit(&link, &espChannel); // A raw channel, echo off
+ *				    SerialLinkSetHandler(&link, LINK_CHANNEL_TELEMETRY, onTelemetry, NULL);
+ *				    SerialLinkStart(&link);
+ *				    SerialLinkSend(&link, LINK_CHANNEL_BULK, data, len);
+ *
+ * @copyright
+ * @author
+ * @date        October 16, 2026
+ * @version		0.1
+ *****************************************************************************/
+
+#ifndef SERIAL_LINK_H
+#define SERIAL_LINK_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+#include "SerialChannel.h"
+#include "cobs.h"
+#include "crc16.h"
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+#define SERIAL_LINK_CHANNEL_MASK   0x0F /**< Logical channel bits of the header byte */
+#define SERIAL_LINK_HEADER_SIZE    2    /**< header + seq */
+#define SERIAL_LINK_CRC_SIZE       2    /**< Trailing CRC16 */
+#define SERIAL_LINK_FLAG_RELIABLE  0x10 /**< Data frame of the reliable channel, to be acknowledged */
+#define SERIAL_LINK_FLAG_ACK       0x20 /**< Acknowledgement of the reliable channel */
+#define SERIAL_LINK_FLAG_SYNC      0x40 /**< The sender has not been acknowledged since it started */
+#define SERIAL_LINK_ACK_SIZE       3    /**< Payload of an ACK frame: next expected seq + sack bitmap */
+/** Largest decoded frame */
+#define SERIAL_LINK_FRAME_MAX      (SERIAL_LINK_HEADER_SIZE + CONF_SERIAL_LINK_MAX_PAYLOAD + SERIAL_LINK_CRC_SIZE)
+/** Largest encoded frame, including the delimiter */
+#define SERIAL_LINK_WIRE_MAX       (COBS_ENCODED_MAX(SERIAL_LINK_FRAME_MAX) + 1)
+
+/******************************************************************************
+ * Enumerations
+ ******************************************************************************/
+/** Logical channels multiplexed over one link */
+ enum eLinkChannel {
+	 LINK_CHANNEL_CONTROL   = 0, /**< Link management (ping) */
+	 LINK_CHANNEL_CLI       = 1, /**< Command line input and output */
+	 LINK_CHANNEL_LOG       = 2, /**< Debug log messages */
+	 LINK_CHANNEL_TELEMETRY = 3, /**< Periodic sensor and state reports */
+	 LINK_CHANNEL_BULK      = 4, /**< Large transfers (files, firmware) */
+	 N_LINK_CHANNELS        = 5  /**< Number of logical channels */
+ };
+
+/** First payload byte of a control frame */
+ enum eLinkControl {
+	 LINK_CONTROL_PING = 0x01, /**< Request a LINK_CONTROL_PONG with the same bytes */
+	 LINK_CONTROL_PONG = 0x02  /**< Answer to a LINK_CONTROL_PING */
+ };
+
+/******************************************************************************
+ * Structures
+ ******************************************************************************/
+/** Receives the payload of one frame. Runs in the link's receive task. */
+typedef void (*SerialLinkHandler)(void *ctx, const uint8_t *payload, size_t len);
+
+/**
+ * Counters of a link, see SerialLinkGetStats().
+ */
+struct SerialLinkStats {
+	uint32_t txFrames;        /**< Frames handed to the channel */
+	uint32_t txPayloadBytes;  /**< Payload bytes in those frames */
+	uint32_t txWireBytes;     /**< Bytes on the wire for them, framing included */
+	uint32_t txQueueDrops;    /**< Frames dropped because their queue was full */
+	uint32_t rxFrames;        /**< Valid frames received */
+	uint32_t rxPayloadBytes;  /**< Payload bytes in those frames */
+	uint32_t rxWireBytes;     /**< Bytes read from the channel */
+	uint32_t rxCrcErrors;     /**< Frames dropped for a CRC mismatch */
+	uint32_t rxFramingErrors; /**< Frames dropped because they were not valid COBS or too short */
+	uint32_t rxOverlong;      /**< Frames dropped for exceeding SERIAL_LINK_WIRE_MAX or CONF_SERIAL_LINK_MAX_PAYLOAD */
+	uint32_t rxLineErrors;    /**< Frames dropped because the UART reported a receive error in them */
+	uint32_t rxUnhandled;     /**< Valid frames for a channel without a handler */
+	uint32_t rxSeqGaps;       /**< Frames the peer sent that never arrived, from sequence numbers */
+
+	/* Reliable channel */
+	uint32_t txRetransmits;   /**< Frames sent again, after a timeout or a hole in the sack bitmap */
+	uint32_t txTimeouts;      /**< Retransmission timeouts */
+	uint32_t txInjectedLosses; /**< Frames not sent on purpose, see SerialLinkSetLossInjection */
+	uint32_t rxDuplicates;    /**< Frames received again, acknowledged and dropped */
+	uint32_t rxOutOfOrder;    /**< Frames buffered until the ones before them arrived */
+	uint32_t rxResyncs;       /**< Times the receiver adopted the peer's sequence numbers */
+	uint8_t window;           /**< Frames allowed in flight */
+	uint8_t inFlight;         /**< Frames sent and not acknowledged yet */
+	uint32_t srttMs;          /**< Smoothed round trip time */
+	uint32_t rttvarMs;        /**< Round trip time variance */
+	uint32_t rtoMs;           /**< Current retransmission timeout */
+};
+
+/**
+ * State of the reliable channel of a link, see SerialLinkSetReliable().
+ * The sender half belongs to the transmit task, the receiver half to the
+ * receive task; they talk through the acknowledgement mailboxes.
+ */
+struct SerialLinkArq {
+	uint8_t channel;                          /**< Reliable logical channel, N_LINK_CHANNELS if none */
+
+	/* Sender */
+	uint8_t txLength[CONF_SERIAL_LINK_WINDOW];  /**< Payload length of each frame in flight */
+	uint8_t txPayload[CONF_SERIAL_LINK_WINDOW][CONF_SERIAL_LINK_MAX_PAYLOAD]; /**< Copies kept for retransmission */
+	TickType_t txSent[CONF_SERIAL_LINK_WINDOW]; /**< Last transmission of each frame */
+	bool txRetransmitted[CONF_SERIAL_LINK_WINDOW]; /**< No RTT sample from it (Karn) */
+	bool txSacked[CONF_SERIAL_LINK_WINDOW];   /**< Received out of order by the peer */
+	uint8_t txBase;                           /**< Oldest unacknowledged seq */
+	uint8_t txNext;                           /**< Seq of the next new frame */
+	bool txSynced;                            /**< An ACK has been received */
+	bool rttValid;                            /**< srtt holds a sample */
+	TickType_t srtt;                          /**< Smoothed round trip time */
+	TickType_t rttvar;                        /**< Round trip time variance */
+	TickType_t rto;                           /**< Retransmission timeout */
+	uint16_t lossEvery;                       /**< Drop every Nth transmission, 0 for none */
+	uint16_t lossCount;                       /**< Transmissions since the last injected loss */
+
+	/* Receiver */
+	uint8_t rxPayload[CONF_SERIAL_LINK_WINDOW][CONF_SERIAL_LINK_MAX_PAYLOAD]; /**< Frames received out of order */
+	uint8_t rxLength[CONF_SERIAL_LINK_WINDOW];  /**< Their payload lengths */
+	uint8_t rxNext;                           /**< Next seq to hand to the handler */
+	uint16_t rxSack;                          /**< Bit i: seq rxNext + 1 + i is buffered */
+	bool rxSynced;                            /**< rxNext was learned from a frame */
+	bool rxPeerSyncing;                       /**< The last frame carried SERIAL_LINK_FLAG_SYNC */
+
+	/* Mailboxes between the tasks */
+	bool ackPending;                          /**< The receiver wants an ACK sent */
+	bool ackReceived;                         /**< An ACK arrived for the sender */
+	uint8_t ackNext;                          /**< Its next expected seq */
+	uint16_t ackSack;                         /**< Its sack bitmap */
+};
+
+/**
+ * A link. Allocate statically and call SerialLinkInit; the members are private
+ * to SerialLink.c.
+ */
+struct SerialLink {
+	struct SerialChannel *channel;            /**< Raw channel carrying the frames */
+	mpsc_ring_t queues[N_LINK_CHANNELS];       /**< Per channel frames: length byte + payload */
+	uint8_t queueStorage[N_LINK_CHANNELS][CONF_SERIAL_LINK_QUEUE_SIZE]; /**< Storage of queues */
+	uint8_t priority[N_LINK_CHANNELS];        /**< Higher is sent first */
+	uint8_t txSeq[N_LINK_CHANNELS];           /**< Next sequence number to send */
+	uint8_t rxSeq[N_LINK_CHANNELS];           /**< Next sequence number expected */
+	bool rxSeqValid[N_LINK_CHANNELS];         /**< rxSeq was learned from a frame */
+	SerialLinkHandler handlers[N_LINK_CHANNELS]; /**< Receivers of each channel */
+	void *handlerCtx[N_LINK_CHANNELS];        /**< Their contexts */
+
+	TaskHandle_t txTask;                      /**< Encodes and sends queued frames */
+	TaskHandle_t rxTask;                      /**< Decodes and dispatches received frames */
+	uint8_t txFrame[SERIAL_LINK_FRAME_MAX];   /**< Frame being sent, decoded */
+	uint8_t txWire[SERIAL_LINK_WIRE_MAX];     /**< Frame being sent, encoded */
+	uint8_t rxWire[SERIAL_LINK_WIRE_MAX];     /**< Frame being received, decoded in place */
+	size_t rxWireLength;                      /**< Bytes in rxWire */
+	bool rxDiscard;                           /**< The frame being received is bad, skip to the delimiter */
+	volatile bool rxLineError;                /**< The UART reported a receive error since the last read */
+
+	struct SerialLinkArq arq;                 /**< Reliable channel */
+
+	struct SerialLinkStats stats;             /**< Counters */
+};
+
+/******************************************************************************
+* Global Function Declarations
+******************************************************************************/
+/**
+ * @fn			void SerialLinkInit(struct SerialLink *link, struct SerialChannel *channel)
+ * @brief		Binds a link to a channel and sets the default priorities.
+ * @details		Defaults, highest first: control; CLI and telemetry; log; bulk.
+ * @param[in]	link    Link to initialize.
+ * @param[in]	channel Initialized channel in raw mode with echo off; the link becomes its only reader.
+ *****************************************************************************/
+void SerialLinkInit(struct SerialLink *link, struct SerialChannel *channel);
+
+/**
+ * @fn			void SerialLinkSetHandler(struct SerialLink *link, enum eLinkChannel channel, SerialLinkHandler handler, void *ctx)
+ * @brief		Registers the receiver of a logical channel (NULL to drop its frames).
+ *****************************************************************************/
+void SerialLinkSetHandler(struct SerialLink *link, enum eLinkChannel channel, SerialLinkHandler handler, void *ctx);
+
+/**
+ * @fn			void SerialLinkSetPriority(struct SerialLink *link, enum eLinkChannel channel, uint8_t priority)
+ * @brief		Changes the transmit priority of a logical channel; higher goes first.
+ * @note		Strict priority: a busy high priority channel starves the lower ones.
+ *****************************************************************************/
+void SerialLinkSetPriority(struct SerialLink *link, enum eLinkChannel channel, uint8_t priority);
+
+/**
+ * @fn			void SerialLinkSetReliable(struct SerialLink *link, enum eLinkChannel channel)
+ * @brief		Delivers the frames of a logical channel reliably and in order (see the file header).
+ * @details		Call before SerialLinkStart; the peer must make the same channel reliable.
+ *				The sender's queue is only drained while the window has room, so
+ *				SerialLinkSend on this channel fails once CONF_SERIAL_LINK_WINDOW
+ *				frames are unacknowledged and the queue has filled up behind them.
+ *****************************************************************************/
+void SerialLinkSetReliable(struct SerialLink *link, enum eLinkChannel channel);
+
+/**
+ * @fn			void SerialLinkSetLossInjection(struct SerialLink *link, uint16_t every)
+ * @brief		Skips every Nth transmission on the reliable channel, to exercise the retransmissions.
+ * @param[in]	every N, 0 to send everything.
+ *****************************************************************************/
+void SerialLinkSetLossInjection(struct SerialLink *link, uint16_t every);
+
+/**
+ * @fn			bool SerialLinkStart(struct SerialLink *link)
+ * @brief		Creates the transmit and receive tasks.
+ * @details		Frames queued before the start are sent once the scheduler runs.
+ * @return		false if a task could not be created.
+ *****************************************************************************/
+bool SerialLinkStart(struct SerialLink *link);
+
+/**
+ * @fn			bool SerialLinkSend(struct SerialLink *link, enum eLinkChannel channel, const uint8_t *data, size_t len)
+ * @brief		Queues data on a logical channel, split into frames of CONF_SERIAL_LINK_MAX_PAYLOAD bytes.
+ * @details		Never blocks; callable from tasks and interrupts. Each frame is queued whole
+ *				or dropped when its queue is full.
+ * @return		true if every frame was queued.
+ *****************************************************************************/
+bool SerialLinkSend(struct SerialLink *link, enum eLinkChannel channel, const uint8_t *data, size_t len);
+
+/**
+ * @fn			int SerialLinkPrintf(struct SerialLink *link, enum eLinkChannel channel, const char *format, ...)
+ * @brief		printf formatted straight into one frame of a channel's queue (console_format.h subset).
+ * @details		Output beyond CONF_SERIAL_LINK_MAX_PAYLOAD characters is cut off.
+ * @return		Number of characters queued, or -1 if the frame was dropped.
+ *****************************************************************************/
+int SerialLinkPrintf(struct SerialLink *link, enum eLinkChannel channel, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @fn			int SerialLinkVPrintf(struct SerialLink *link, enum eLinkChannel channel, const char *format, va_list args)
+ * @brief		vprintf variant of SerialLinkPrintf.
+ *****************************************************************************/
+int SerialLinkVPrintf(struct SerialLink *link, enum eLinkChannel channel, const char *format, va_list args)
+    __attribute__((format(printf, 3, 0)));
+
+/**
+ * @fn			void SerialLinkGetStats(struct SerialLink *link, struct SerialLinkStats *stats)
+ * @brief		Copies the counters of a link.
+ * @note		Goodput = txPayloadBytes / txWireBytes, retransmissions and ACKs count as overhead;
+ *				frame loss = rxSeqGaps / (rxFrames + rxSeqGaps) on the unreliable channels.
+ *****************************************************************************/
+void SerialLinkGetStats(struct SerialLink *link, struct SerialLinkStats *stats);
+
+#endif /* SERIAL_LINK_H */
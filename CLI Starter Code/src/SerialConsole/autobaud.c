@@ -0,0 +1,92 @@
+/**************************************************************************//**
+* @file        autobaud.c
+* @ingroup     Serial Console
+* @brief       Baud rate estimation from the edges of a sync character.
+* @details     See autobaud.h. Every bit of a candidate run is checked against the
+*				average over the run, so one late edge cannot pull the estimate and
+*				a run containing a BREAK or a character other than 0x55 is rejected.
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+ #include "autobaud.h"
+
+ // Private Data
+
+ static const uint32_t standardRates[] = {
+	 1200, 2400, 4800, 9600, 14400, 19200, 28800, 38400, 57600,
+	 76800, 115200, 230400, 250000, 460800, 500000, 921600, 1000000
+ };
+
+ // Private Functions
+
+ /// True if the nine bit times from edges[0] fit the average within AUTOBAUD_BIT_TOLERANCE
+ static bool is_sync_run(const uint32_t * edges)
+ {
+	 uint32_t span = edges[AUTOBAUD_SYNC_EDGES - 1] - edges[0];
+	 uint32_t slack = span * AUTOBAUD_BIT_TOLERANCE / 100;
+
+	 if(span < AUTOBAUD_SYNC_EDGES - 1)
+	 {
+		 return false;
+	 }
+	 for(size_t i = 1; i < AUTOBAUD_SYNC_EDGES; i++)
+	 {
+		 // Compare bit * 9 with span to stay in integers
+		 uint32_t bit = (edges[i] - edges[i - 1]) * (AUTOBAUD_SYNC_EDGES - 1);
+
+		 if(bit + slack < span || bit > span + slack)
+		 {
+			 return false;
+		 }
+	 }
+	 return true;
+ }
+
+ // APIs
+
+ uint32_t autobaud_estimate(const uint32_t * edges, size_t count, uint32_t clockHz)
+ {
+	 // Runs start on a falling edge, so on an even index
+	 for(size_t start = 0; start + AUTOBAUD_SYNC_EDGES <= count; start += 2)
+	 {
+		 if(!is_sync_run(&edges[start]))
+		 {
+			 continue;
+		 }
+
+		 uint32_t span = edges[start + AUTOBAUD_SYNC_EDGES - 1] - edges[start];
+		 uint32_t baud = (uint32_t)(((uint64_t)clockHz * (AUTOBAUD_SYNC_EDGES - 1) + span / 2) / span);
+
+		 if(baud < AUTOBAUD_MIN_BAUD * (100 - AUTOBAUD_SNAP_TOLERANCE) / 100)
+		 {
+			 continue;
+		 }
+		 baud = autobaud_snap(baud);
+		 return (baud <= clockHz / 16) ? baud : 0;
+	 }
+	 return 0;
+ }
+
+ bool autobaud_is_break(uint32_t lowTicks, uint32_t clockHz)
+ {
+	 // Start bit, 8 data bits and a stop bit, all low
+	 return (uint64_t)lowTicks * AUTOBAUD_MIN_BAUD >= (uint64_t)clockHz * 10;
+ }
+
+ uint32_t autobaud_snap(uint32_t baud)
+ {
+	 for(size_t i = 0; i < sizeof(standardRates) / sizeof(standardRates[0]); i++)
+	 {
+		 uint32_t slack = standardRates[i] * AUTOBAUD_SNAP_TOLERANCE / 100;
+
+		 if(baud + slack >= standardRates[i] && baud <= standardRates[i] + slack)
+		 {
+			 return standardRates[i];
+		 }
+	 }
+	 return baud;
+ }
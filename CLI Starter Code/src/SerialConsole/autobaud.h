@@ -0,0 +1,54 @@
+/**************************************************************************//**
+* @file        autobaud.h
+* @ingroup     Serial Console
+* @brief       Baud rate estimation from the edges of a sync character.
+* @details     The host sends 0x55 ('U'): start bit, 1010 1010, stop bit, i.e. ten
+*				alternating bits and ten edges spanning nine bit times. The caller
+*				timestamps every edge of the RX line with a free-running timer, the
+*				first one being a falling edge from idle, and the estimator looks for
+*				a run of ten evenly spaced edges. Anything before the sync character,
+*				a BREAK included, only shifts where the run starts.
+*
+*				No hardware access, so it can be fed synthetic edge timings:
+*				    uint32_t edges[AUTOBAUD_SYNC_EDGES];
+*				    for(int i = 0; i < AUTOBAUD_SYNC_EDGES; i++) edges[i] = i * 834; // 9600 Bd at 8 MHz
+*				    uint32_t baud = autobaud_estimate(edges, AUTOBAUD_SYNC_EDGES, 8000000); // 9600
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef AUTOBAUD_H_
+#define AUTOBAUD_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/// Edges of the sync character, from the falling edge of its start bit to the rising edge of its stop bit
+#define AUTOBAUD_SYNC_EDGES      10
+
+/// Slowest rate detected; a low level longer than a character at this rate is a BREAK
+#define AUTOBAUD_MIN_BAUD        1200
+
+/// Largest deviation of one bit from the average bit time of the run, in percent
+#define AUTOBAUD_BIT_TOLERANCE   25
+
+/// Largest deviation from a standard rate that still snaps to it, in percent
+#define AUTOBAUD_SNAP_TOLERANCE  4
+
+/// Estimate the baud rate from count edge timestamps of a timer running at clockHz
+/// edges[0] must be a falling edge, and edges must alternate from there
+/// Returns the rate of the first run of AUTOBAUD_SYNC_EDGES evenly spaced edges, snapped
+/// to a standard rate when close to one, or 0 if there is none or it is above clockHz / 16
+uint32_t autobaud_estimate(const uint32_t * edges, size_t count, uint32_t clockHz);
+
+/// True if the line stayed low for lowTicks of a timer running at clockHz long enough to be a BREAK
+bool autobaud_is_break(uint32_t lowTicks, uint32_t clockHz);
+
+/// The standard rate within AUTOBAUD_SNAP_TOLERANCE of baud, or baud itself if there is none
+uint32_t autobaud_snap(uint32_t baud);
+
+#endif //AUTOBAUD_H_
@@ -0,0 +1,71 @@
+/**************************************************************************//**
+* @file        cobs.c
+* @ingroup     Serial Console
+* @brief       Consistent Overhead Byte Stuffing.
+* @details     See cobs.h. Both directions make a single pass without lookahead:
+*				the encoder back-fills each code byte once its run is known.
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+ #include "cobs.h"
+
+ // APIs
+
+ size_t cobs_encode(const uint8_t * src, size_t len, uint8_t * dst)
+ {
+	 uint8_t * code = dst;   // Where the code byte of the current run goes
+	 uint8_t * out = dst + 1;
+	 uint8_t run = 1;
+
+	 for(size_t i = 0; i < len; i++)
+	 {
+		 if(src[i] != 0)
+		 {
+			 *out++ = src[i];
+			 run++;
+		 }
+		 if(src[i] == 0 || run == 0xFF)
+		 {
+			 *code = run;
+			 code = out++;
+			 run = 1;
+		 }
+	 }
+	 *code = run;
+
+	 return (size_t)(out - dst);
+ }
+
+ size_t cobs_decode(const uint8_t * src, size_t len, uint8_t * dst)
+ {
+	 size_t in = 0, out = 0;
+
+	 while(in < len)
+	 {
+		 uint8_t run = src[in++];
+
+		 if(run == 0 || in + run - 1 > len)
+		 {
+			 return 0;
+		 }
+		 for(uint8_t i = 1; i < run; i++)
+		 {
+			 if(src[in] == 0)
+			 {
+				 return 0;
+			 }
+			 dst[out++] = src[in++];
+		 }
+		 // A short run stands for a zero, except at the very end of the frame
+		 if(run != 0xFF && in < len)
+		 {
+			 dst[out++] = 0;
+		 }
+	 }
+
+	 return out;
+ }
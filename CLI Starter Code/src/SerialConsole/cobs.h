@@ -0,0 +1,39 @@
+/**************************************************************************//**
+* @file        cobs.h
+* @ingroup     Serial Console
+* @brief       Consistent Overhead Byte Stuffing.
+* @details     Encodes a block so that it contains no zero byte, which leaves 0x00
+*				free to delimit frames on a byte stream. The overhead is one byte per
+*				started 254 bytes of input, so a receiver that lost sync only has to
+*				wait for the next zero to find the start of a frame again.
+*
+*				Usage:
+*				    uint8_t wire[COBS_ENCODED_MAX(sizeof(frame)) + 1];
+*				    size_t n = cobs_encode(frame, sizeof(frame), wire);
+*				    wire[n++] = 0; // Delimiter
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef COBS_H_
+#define COBS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// Worst-case encoded size of len bytes, without the delimiter
+#define COBS_ENCODED_MAX(len)    ((len) + (len) / 254 + 1)
+
+/// Encode len bytes of src into dst (COBS_ENCODED_MAX(len) bytes)
+/// Returns the encoded length, never containing a zero byte
+size_t cobs_encode(const uint8_t * src, size_t len, uint8_t * dst);
+
+/// Decode len bytes of src (one frame without its delimiter) into dst (len bytes)
+/// src and dst may be the same buffer
+/// Returns the decoded length, or 0 if src is not valid COBS
+size_t cobs_decode(const uint8_t * src, size_t len, uint8_t * dst);
+
+#endif //COBS_H_
@@ -0,0 +1,513 @@
+/**************************************************************************//**
+* @file        console_format.c
+* @ingroup     Serial Console
+* @brief       Minimal printf-style formatter writing through a sink.
+* @details     See console_format.h. Numbers are converted with 32-bit divisions
+*				whenever the value fits, so only %ll conversions of large values pull
+*				in the 64-bit division helpers. Arguments come from a va_list or,
+*				for deferred messages, from the words of console_capture; one
+*				specification parser serves formatting and capture.
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+ #include <stdbool.h>
+ #include <string.h>
+
+ #include "console_format.h"
+
+ // Private Types
+
+ typedef struct {
+	 console_format_sink_t sink;
+	 void * ctx;
+	 size_t count;
+ } format_out_t;
+
+ enum format_length {
+	 LENGTH_INT,
+	 LENGTH_CHAR,
+	 LENGTH_SHORT,
+	 LENGTH_LONG,
+	 LENGTH_LLONG,
+	 LENGTH_SIZE
+ };
+
+ /// Where the arguments come from, and where console_capture records them
+ typedef struct {
+	 va_list ap;               ///< Arguments, unless replay is set
+	 bool replay;              ///< Take the arguments from words (console_wformat)
+	 const uint32_t * words;   ///< Captured arguments
+	 size_t count;             ///< Captured words left
+	 const char * strings;     ///< Copies of the captured %s arguments
+	 uint32_t * record;        ///< console_capture: destination of the fetched words, or NULL
+	 size_t recordMax;         ///< Room in record
+	 size_t recorded;          ///< Words fetched so far, stored or not
+ } format_args_t;
+
+ /// One parsed conversion specification
+ typedef struct {
+	 bool left, zero, plus, space, alt;
+	 int width;
+	 int precision;            ///< -1 if omitted
+	 enum format_length length;
+ } format_spec_t;
+
+ // Private Functions
+
+ static void arg_record(format_args_t * a, uint32_t word)
+ {
+	 if(a->record != NULL)
+	 {
+		 if(a->recorded < a->recordMax)
+		 {
+			 a->record[a->recorded] = word;
+		 }
+		 a->recorded++;
+	 }
+ }
+
+ static uint32_t arg_word(format_args_t * a)
+ {
+	 if(a->count == 0)
+	 {
+		 return 0;
+	 }
+	 a->count--;
+	 return *a->words++;
+ }
+
+ /// Next integer argument of the given length, converted like printf does
+ static unsigned long long arg_integer(format_args_t * a, enum format_length length, bool is_signed)
+ {
+	 unsigned long long value;
+
+	 if(!a->replay)
+	 {
+		 switch(length)
+		 {
+		 case LENGTH_LONG:
+			 value = is_signed ? (unsigned long long)va_arg(a->ap, long) : va_arg(a->ap, unsigned long);
+			 break;
+		 case LENGTH_LLONG:
+			 value = va_arg(a->ap, unsigned long long);
+			 break;
+		 case LENGTH_SIZE:
+			 value = is_signed ? (unsigned long long)va_arg(a->ap, ptrdiff_t) : va_arg(a->ap, size_t);
+			 break;
+		 default:
+			 value = is_signed ? (unsigned long long)va_arg(a->ap, int) : va_arg(a->ap, unsigned int);
+			 break;
+		 }
+		 arg_record(a, (uint32_t)value);
+		 if(length == LENGTH_LLONG)
+		 {
+			 arg_record(a, (uint32_t)(value >> 32));
+		 }
+	 }
+	 else
+	 {
+		 value = arg_word(a);
+		 if(length == LENGTH_LLONG)
+		 {
+			 value |= (unsigned long long)arg_word(a) << 32;
+		 }
+		 else if(is_signed)
+		 {
+			 value = (unsigned long long)(long long)(int32_t)value;
+		 }
+	 }
+
+	 switch(length)
+	 {
+	 case LENGTH_CHAR:  return is_signed ? (unsigned long long)(long long)(signed char)value : (unsigned char)value;
+	 case LENGTH_SHORT: return is_signed ? (unsigned long long)(long long)(short)value : (unsigned short)value;
+	 default:           return value;
+	 }
+ }
+
+ static uintptr_t arg_pointer(format_args_t * a)
+ {
+	 if(a->replay)
+	 {
+		 return arg_word(a);
+	 }
+
+	 uintptr_t value = (uintptr_t)va_arg(a->ap, void *);
+	 arg_record(a, (uint32_t)value);
+	 return value;
+ }
+
+ static const char * arg_string(format_args_t * a)
+ {
+	 if(a->replay)
+	 {
+		 uint32_t offset = (a->count == 0) ? UINT32_MAX : arg_word(a);
+		 return (offset == UINT32_MAX) ? NULL : a->strings + offset;
+	 }
+	 return va_arg(a->ap, const char *);
+ }
+
+ /// Parse flags, width, precision and length after a '%', fetching * arguments
+ /// Returns the conversion character
+ static const char * parse_spec(const char * format, format_spec_t * spec, format_args_t * a)
+ {
+	 spec->left = spec->zero = spec->plus = spec->space = spec->alt = false;
+	 for(;; format++)
+	 {
+		 if(*format == '-')      spec->left = true;
+		 else if(*format == '0') spec->zero = true;
+		 else if(*format == '+') spec->plus = true;
+		 else if(*format == ' ') spec->space = true;
+		 else if(*format == '#') spec->alt = true;
+		 else break;
+	 }
+
+	 spec->width = 0;
+	 if(*format == '*')
+	 {
+		 spec->width = (int)arg_integer(a, LENGTH_INT, true);
+		 if(spec->width < 0)
+		 {
+			 spec->left = true;
+			 spec->width = -spec->width;
+		 }
+		 format++;
+	 }
+	 while(*format >= '0' && *format <= '9')
+	 {
+		 spec->width = spec->width * 10 + (*format++ - '0');
+	 }
+
+	 spec->precision = -1;
+	 if(*format == '.')
+	 {
+		 format++;
+		 spec->precision = 0;
+		 if(*format == '*')
+		 {
+			 spec->precision = (int)arg_integer(a, LENGTH_INT, true);
+			 if(spec->precision < 0)
+			 {
+				 spec->precision = -1; // A negative precision is taken as omitted
+			 }
+			 format++;
+		 }
+		 while(*format >= '0' && *format <= '9')
+		 {
+			 spec->precision = spec->precision * 10 + (*format++ - '0');
+		 }
+	 }
+
+	 spec->length = LENGTH_INT;
+	 if(*format == 'h')
+	 {
+		 spec->length = (*++format == 'h') ? (format++, LENGTH_CHAR) : LENGTH_SHORT;
+	 }
+	 else if(*format == 'l')
+	 {
+		 spec->length = (*++format == 'l') ? (format++, LENGTH_LLONG) : LENGTH_LONG;
+	 }
+	 else if(*format == 'z' || *format == 't')
+	 {
+		 spec->length = LENGTH_SIZE;
+		 format++;
+	 }
+
+	 return format;
+ }
+
+ static void out(format_out_t * o, const char * data, size_t len)
+ {
+	 if(len == 0)
+	 {
+		 return;
+	 }
+	 if(o->sink != NULL)
+	 {
+		 o->sink(o->ctx, data, len);
+	 }
+	 o->count += len;
+ }
+
+ static void out_pad(format_out_t * o, char c, int n)
+ {
+	 static const char spaces[] = "                ";
+	 static const char zeros[] = "0000000000000000";
+	 const char * pad = (c == '0') ? zeros : spaces;
+
+	 while(n > 0)
+	 {
+		 int chunk = (n > (int)(sizeof(spaces) - 1)) ? (int)(sizeof(spaces) - 1) : n;
+		 out(o, pad, (size_t)chunk);
+		 n -= chunk;
+	 }
+ }
+
+ /// Emit [padding] prefix [zeros] body [padding]
+ static void out_field(format_out_t * o, const char * prefix, size_t prefixLen, const char * body,
+		 size_t bodyLen, size_t zeros, int width, bool left)
+ {
+	 int pad = width - (int)(prefixLen + zeros + bodyLen);
+
+	 if(!left)
+	 {
+		 out_pad(o, ' ', pad);
+	 }
+	 out(o, prefix, prefixLen);
+	 out_pad(o, '0', (int)zeros);
+	 out(o, body, bodyLen);
+	 if(left)
+	 {
+		 out_pad(o, ' ', pad);
+	 }
+ }
+
+ /// Convert value to digits at the end of buf, returns the first digit
+ static char * convert(unsigned long long value, unsigned base, bool upper, char * end)
+ {
+	 const char * digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	 char * p = end;
+
+	 while(value > UINT32_MAX)
+	 {
+		 *--p = digits[value % base];
+		 value /= base;
+	 }
+
+	 uint32_t v = (uint32_t)value;
+	 do
+	 {
+		 *--p = digits[v % base];
+		 v /= base;
+	 } while(v != 0);
+
+	 return p;
+ }
+
+ /// Format with the arguments of a; shared by console_vformat and console_wformat
+ static size_t format_args(console_format_sink_t sink, void * ctx, const char * format, format_args_t * a)
+ {
+	 format_out_t o = { sink, ctx, 0 };
+	 const char * run = format;
+	 format_spec_t f;
+
+	 while(*format != '\0')
+	 {
+		 if(*format != '%')
+		 {
+			 format++;
+			 continue;
+		 }
+
+		 out(&o, run, (size_t)(format - run));
+		 const char * spec = format;
+		 format = parse_spec(format + 1, &f, a);
+
+		 // Conversion
+		 char buf[24];
+		 char * end = buf + sizeof(buf);
+		 char * body;
+		 const char * prefix = "";
+		 size_t prefixLen = 0;
+		 unsigned long long value;
+		 unsigned base = 10;
+		 bool upper = false;
+
+		 switch(*format)
+		 {
+		 case 'd':
+		 case 'i':
+		 {
+			 long long sv = (long long)arg_integer(a, f.length, true);
+			 value = (sv < 0) ? 0ULL - (unsigned long long)sv : (unsigned long long)sv;
+			 prefix = (sv < 0) ? "-" : f.plus ? "+" : f.space ? " " : "";
+			 prefixLen = strlen(prefix);
+			 goto number;
+		 }
+
+		 case 'x':
+		 case 'X':
+		 case 'o':
+		 case 'u':
+			 value = arg_integer(a, f.length, false);
+			 base = (*format == 'u') ? 10 : (*format == 'o') ? 8 : 16;
+			 upper = (*format == 'X');
+			 if(f.alt && value != 0 && base != 10)
+			 {
+				 prefix = (base == 8) ? "0" : upper ? "0X" : "0x";
+				 prefixLen = strlen(prefix);
+			 }
+			 goto number;
+
+		 case 'p':
+			 value = arg_pointer(a);
+			 base = 16;
+			 prefix = "0x";
+			 prefixLen = 2;
+			 goto number;
+
+		 number:
+		 {
+			 body = (f.precision == 0 && value == 0) ? end : convert(value, base, upper, end);
+			 size_t bodyLen = (size_t)(end - body);
+			 size_t zeros = 0;
+
+			 if(f.precision >= 0 && (size_t)f.precision > bodyLen)
+			 {
+				 zeros = (size_t)f.precision - bodyLen;
+			 }
+			 else if(f.precision < 0 && f.zero && !f.left && f.width > (int)(prefixLen + bodyLen))
+			 {
+				 zeros = (size_t)f.width - prefixLen - bodyLen;
+			 }
+			 out_field(&o, prefix, prefixLen, body, bodyLen, zeros, f.width, f.left);
+			 break;
+		 }
+
+		 case 'c':
+			 buf[0] = (char)arg_integer(a, LENGTH_INT, true);
+			 out_field(&o, "", 0, buf, 1, 0, f.width, f.left);
+			 break;
+
+		 case 's':
+		 {
+			 const char * s = arg_string(a);
+			 if(s == NULL)
+			 {
+				 s = "(null)";
+			 }
+			 size_t sLen = 0;
+			 while(s[sLen] != '\0' && (f.precision < 0 || sLen < (size_t)f.precision))
+			 {
+				 sLen++;
+			 }
+			 out_field(&o, "", 0, s, sLen, 0, f.width, f.left);
+			 break;
+		 }
+
+		 case '%':
+			 out(&o, "%", 1);
+			 break;
+
+		 default:
+			 // Unknown conversion: print the specification as written
+			 if(*format == '\0')
+			 {
+				 run = spec;
+				 continue;
+			 }
+			 out(&o, spec, (size_t)(format + 1 - spec));
+			 break;
+		 }
+
+		 run = ++format;
+	 }
+
+	 out(&o, run, (size_t)(format - run));
+	 return o.count;
+ }
+
+ // APIs
+
+ size_t console_vformat(console_format_sink_t sink, void * ctx, const char * format, va_list args)
+ {
+	 format_args_t a = { .replay = false };
+
+	 va_copy(a.ap, args);
+	 size_t count = format_args(sink, ctx, format, &a);
+	 va_end(a.ap);
+
+	 return count;
+ }
+
+ size_t console_capture(const char * format, va_list args, uint32_t * words, size_t maxWords, char * strings,
+		 size_t stringsSize, size_t * stringsLen)
+ {
+	 format_args_t a = { .replay = false, .record = words, .recordMax = maxWords };
+	 format_spec_t f;
+	 size_t used = 0;
+	 size_t needed = 0;
+
+	 va_copy(a.ap, args);
+	 while((format = strchr(format, '%')) != NULL)
+	 {
+		 format = parse_spec(format + 1, &f, &a);
+		 switch(*format)
+		 {
+		 case 'd':
+		 case 'i':
+		 case 'c':
+			 arg_integer(&a, (*format == 'c') ? LENGTH_INT : f.length, true);
+			 break;
+
+		 case 'x':
+		 case 'X':
+		 case 'o':
+		 case 'u':
+			 arg_integer(&a, f.length, false);
+			 break;
+
+		 case 'p':
+			 arg_pointer(&a);
+			 break;
+
+		 case 's':
+		 {
+			 // The caller's string may be gone by the time the message is formatted: copy it
+			 const char * s = va_arg(a.ap, const char *);
+			 uint32_t offset = UINT32_MAX;
+			 if(s != NULL)
+			 {
+				 size_t sMax = (f.precision < 0) ? SIZE_MAX : (size_t)f.precision;
+				 size_t sLen = 0;
+				 if(used < stringsSize)
+				 {
+					 while(s[sLen] != '\0' && used + sLen + 1 < stringsSize && sLen < sMax)
+					 {
+						 strings[used + sLen] = s[sLen];
+						 sLen++;
+					 }
+					 strings[used + sLen] = '\0';
+					 offset = (uint32_t)used;
+					 used += sLen + 1;
+				 }
+				 else if(stringsSize > 0)
+				 {
+					 offset = (uint32_t)(stringsSize - 1); // No room left: truncated to the last terminator
+				 }
+				 while(s[sLen] != '\0' && sLen < sMax)
+				 {
+					 sLen++; // Cut short: count what it needed
+				 }
+				 needed += sLen + 1;
+			 }
+			 arg_record(&a, offset);
+			 break;
+		 }
+
+		 case '\0':
+			 format--; // Dangling '%' at the end
+			 break;
+
+		 default:
+			 break; // %% and unknown conversions take no argument
+		 }
+		 format++;
+	 }
+	 va_end(a.ap);
+
+	 *stringsLen = needed;
+	 return a.recorded;
+ }
+
+ size_t console_wformat(console_format_sink_t sink, void * ctx, const char * format, const uint32_t * words,
+		 size_t count, const char * strings)
+ {
+	 format_args_t a = { .replay = true, .words = words, .count = count, .strings = strings };
+
+	 return format_args(sink, ctx, format, &a);
+ }
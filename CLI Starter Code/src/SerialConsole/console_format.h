@@ -0,0 +1,56 @@
+/**************************************************************************//**
+* @file        console_format.h
+* @ingroup     Serial Console
+* @brief       Minimal printf-style formatter writing through a sink.
+* @details     Formats without an intermediate buffer: literal runs and converted
+*				fields are handed to a sink callback as they are produced, and a NULL
+*				sink only counts the output. Formatting the same arguments twice (once
+*				to size, once to write) lets the caller format straight into reserved
+*				ring space.
+*
+*				console_capture and console_wformat split a message in two for
+*				deferred logging: the caller copies the arguments into 32-bit words
+*				without converting anything, and another task formats them later.
+*
+*				Conversions: %d %i %u %x %X %o %c %s %p %%
+*				Flags:       - 0 + space #    Width/precision: number or *
+*				Lengths:     hh h l ll z t
+*				Floating point is not supported (as with newlib-nano's printf).
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef CONSOLE_FORMAT_H_
+#define CONSOLE_FORMAT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+/// Receives len bytes of formatted output
+typedef void (*console_format_sink_t)(void * ctx, const char * data, size_t len);
+
+/// Format `format` with `args` into `sink` (NULL to only count)
+/// Returns the number of characters produced
+size_t console_vformat(console_format_sink_t sink, void * ctx, const char * format, va_list args);
+
+/// Copy the arguments `format` consumes from `args` into words, without converting them:
+/// one word per argument, two (low first) for %ll. %s strings are copied into `strings`,
+/// null-terminated and truncated to fit (to nothing once it is full), and their word holds
+/// the offset of the copy; only a NULL pointer replays as (null).
+/// Stores at most maxWords words and stringsSize bytes; *stringsLen receives the bytes the strings
+/// need, which may exceed stringsSize
+/// Returns the number of words the arguments need, which may exceed maxWords
+size_t console_capture(const char * format, va_list args, uint32_t * words, size_t maxWords, char * strings,
+		size_t stringsSize, size_t * stringsLen);
+
+/// Format `format` with the words and strings of console_capture into `sink` (NULL to only count)
+/// Words missing at the end read as 0
+/// Returns the number of characters produced
+size_t console_wformat(console_format_sink_t sink, void * ctx, const char * format, const uint32_t * words,
+		size_t count, const char * strings);
+
+#endif //CONSOLE_FORMAT_H_
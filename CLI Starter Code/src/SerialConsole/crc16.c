@@ -0,0 +1,35 @@
+/**************************************************************************//**
+* @file        crc16.c
+* @ingroup     Serial Console
+* @brief       CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection).
+* @details     See crc16.h. Check value: crc16_ccitt(0xFFFF, "123456789", 9) == 0x29B1.
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+ #include "crc16.h"
+
+ // Private Data
+
+ /// CRC of each 4-bit value shifted through the top nibble
+ static const uint16_t crcNibble[16] = {
+	 0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+ };
+
+ // APIs
+
+ uint16_t crc16_ccitt(uint16_t crc, const uint8_t * data, size_t len)
+ {
+	 while(len--)
+	 {
+		 crc = (uint16_t)((crc << 4) ^ crcNibble[(crc >> 12) ^ (*data >> 4)]);
+		 crc = (uint16_t)((crc << 4) ^ crcNibble[(crc >> 12) ^ (*data & 0x0F)]);
+		 data++;
+	 }
+
+	 return crc;
+ }
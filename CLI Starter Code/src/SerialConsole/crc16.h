@@ -0,0 +1,30 @@
+/**************************************************************************//**
+* @file        crc16.h
+* @ingroup     Serial Console
+* @brief       CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection).
+* @details     Nibble-table implementation: 32 bytes of flash and two lookups per
+*				byte, a middle ground between the 512-byte table and the bitwise loop.
+*
+*				Usage:
+*				    uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, data, len);
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// Start value of a new CRC
+#define CRC16_CCITT_INIT    0xFFFF
+
+/// Continue crc over len bytes of data
+/// Returns the updated CRC; pass it back in to checksum data in pieces
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t * data, size_t len);
+
+#endif //CRC16_H_
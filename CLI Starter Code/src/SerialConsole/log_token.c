@@ -0,0 +1,111 @@
+/**************************************************************************//**
+* @file        log_token.c
+* @ingroup     Serial Console
+* @brief       Tokenized log records: a format string ID plus the raw arguments.
+* @details     See log_token.h. Nothing is converted to text: small numbers take
+*				one byte, and the format string never leaves the host.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+ #include <string.h>
+ #include "log_token.h"
+
+ // Private Functions
+
+ /// Append value as a base-128 varint, low group first
+ /// Returns the bytes written, 0 if it does not fit
+ static size_t log_token_varint(uint8_t * buf, size_t size, uint64_t value)
+ {
+	 size_t len = 0;
+
+	 do
+	 {
+		 if(len == size)
+		 {
+			 return 0;
+		 }
+		 uint8_t group = (uint8_t)(value & 0x7F);
+		 value >>= 7;
+		 buf[len++] = (value != 0) ? (uint8_t)(group | 0x80) : group;
+	 } while(value != 0);
+
+	 return len;
+ }
+
+ /// Map signed to unsigned so that small magnitudes stay short: 0, -1, 1, -2 -> 0, 1, 2, 3
+ static uint64_t log_token_zigzag(int64_t value)
+ {
+	 return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+ }
+
+ // APIs
+
+ size_t log_token_encode(uint8_t * buf, size_t size, uint32_t token, uint32_t types, va_list args)
+ {
+	 size_t len = log_token_varint(buf, size, token);
+	 size_t count = types & 0x0F;
+
+	 for(size_t i = 0; i < count && len != 0; i++)
+	 {
+		 size_t written = 0;
+
+		 switch((types >> (4 + 2 * i)) & 0x03)
+		 {
+		 case LOG_TOKEN_INT32:
+			 written = log_token_varint(buf + len, size - len, log_token_zigzag(va_arg(args, int)));
+			 break;
+
+		 case LOG_TOKEN_INT64:
+			 written = log_token_varint(buf + len, size - len, log_token_zigzag(va_arg(args, long long)));
+			 break;
+
+		 case LOG_TOKEN_DOUBLE:
+		 {
+			 double value = va_arg(args, double);
+			 if(size - len >= sizeof(value))
+			 {
+				 memcpy(buf + len, &value, sizeof(value)); // Cortex-M is little endian
+				 written = sizeof(value);
+			 }
+			 break;
+		 }
+
+		 default: // LOG_TOKEN_STRING
+		 {
+			 const char * s = va_arg(args, const char *);
+			 if(len == size)
+			 {
+				 break;
+			 }
+			 if(s == NULL)
+			 {
+				 buf[len] = LOG_TOKEN_NULL_STRING;
+				 written = 1;
+				 break;
+			 }
+			 size_t room = size - len - 1;
+			 size_t sLen = 0;
+			 while(s[sLen] != '\0' && sLen < room && sLen < LOG_TOKEN_NULL_STRING - 1)
+			 {
+				 sLen++;
+			 }
+			 buf[len] = (uint8_t)sLen;
+			 memcpy(buf + len + 1, s, sLen);
+			 written = 1 + sLen;
+			 break;
+		 }
+		 }
+
+		 if(written == 0)
+		 {
+			 break;
+		 }
+		 len += written;
+	 }
+
+	 return len;
+ }
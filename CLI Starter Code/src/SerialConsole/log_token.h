@@ -0,0 +1,91 @@
+/**************************************************************************//**
+* @file        log_token.h
+* @ingroup     Serial Console
+* @brief       Tokenized log records: a format string ID plus the raw arguments.
+* @details     The format strings of tokenized messages live in the .log_fmt
+*				section, which the linker script keeps in the ELF but never loads
+*				into flash. A string's address in that section is its token, so the
+*				device only sends
+*
+*				    token (varint) | arguments
+*
+*				and tools/log_decode.py rebuilds the text from the ELF. Each argument
+*				is encoded by its C type, picked at compile time by LOG_TOKEN_TYPES:
+*
+*				    integers and pointers: zigzag varint of the value (1 to 10 bytes)
+*				    float, double:         8 bytes, little endian
+*				    strings:               length byte (0xFF for NULL) and the characters
+*
+*				At most LOG_TOKEN_MAX_ARGS arguments per message.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef LOG_TOKEN_H_
+#define LOG_TOKEN_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+/// Section holding the format strings, see the linker script
+#define LOG_TOKEN_SECTION       ".log_fmt"
+
+/// Most arguments one message can carry
+#define LOG_TOKEN_MAX_ARGS      8
+
+/// Argument types: 2 bits each above the 4-bit argument count of a types word
+#define LOG_TOKEN_INT32         0u
+#define LOG_TOKEN_INT64         1u
+#define LOG_TOKEN_DOUBLE        2u
+#define LOG_TOKEN_STRING        3u
+
+/// Length byte of a NULL string
+#define LOG_TOKEN_NULL_STRING   0xFF
+
+/// Token of a format string placed in LOG_TOKEN_SECTION
+#define LOG_TOKEN_ID(format)    ((uint32_t)(uintptr_t)(format))
+
+/// Type of one argument after the default promotions
+#define LOG_TOKEN_ARG_TYPE(x) _Generic((x) + 0, \
+		char *: LOG_TOKEN_STRING, \
+		const char *: LOG_TOKEN_STRING, \
+		float: LOG_TOKEN_DOUBLE, \
+		double: LOG_TOKEN_DOUBLE, \
+		long long: LOG_TOKEN_INT64, \
+		unsigned long long: LOG_TOKEN_INT64, \
+		default: LOG_TOKEN_INT32)
+
+/// Types word of an argument list: the count in bits 0-3, argument i in bits 4 + 2i
+#define LOG_TOKEN_TYPES(...) LOG_TOKEN_CAT(LOG_TOKEN_TYPES_, LOG_TOKEN_COUNT(__VA_ARGS__))(__VA_ARGS__)
+
+#define LOG_TOKEN_CAT(a, b)     LOG_TOKEN_CAT_(a, b)
+#define LOG_TOKEN_CAT_(a, b)    a ## b
+#define LOG_TOKEN_COUNT(...)    LOG_TOKEN_COUNT_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_TOKEN_COUNT_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define LOG_TOKEN_ARG(x, i)     (LOG_TOKEN_ARG_TYPE(x) << (4 + 2 * (i)))
+
+#define LOG_TOKEN_TYPES_0()                     0u
+#define LOG_TOKEN_TYPES_1(a)                    (1u | LOG_TOKEN_ARG(a, 0))
+#define LOG_TOKEN_TYPES_2(a, b)                 (2u | LOG_TOKEN_ARG(a, 0) | LOG_TOKEN_ARG(b, 1))
+#define LOG_TOKEN_TYPES_3(a, b, c)              (3u | LOG_TOKEN_ARG(a, 0) | LOG_TOKEN_ARG(b, 1) | LOG_TOKEN_ARG(c, 2))
+#define LOG_TOKEN_TYPES_4(a, b, c, d)           (4u | LOG_TOKEN_ARG(a, 0) | LOG_TOKEN_ARG(b, 1) | LOG_TOKEN_ARG(c, 2) \
+		| LOG_TOKEN_ARG(d, 3))
+#define LOG_TOKEN_TYPES_5(a, b, c, d, e)        (5u | LOG_TOKEN_ARG(a, 0) | LOG_TOKEN_ARG(b, 1) | LOG_TOKEN_ARG(c, 2) \
+		| LOG_TOKEN_ARG(d, 3) | LOG_TOKEN_ARG(e, 4))
+#define LOG_TOKEN_TYPES_6(a, b, c, d, e, f)     (6u | LOG_TOKEN_ARG(a, 0) | LOG_TOKEN_ARG(b, 1) | LOG_TOKEN_ARG(c, 2) \
+		| LOG_TOKEN_ARG(d, 3) | LOG_TOKEN_ARG(e, 4) | LOG_TOKEN_ARG(f, 5))
+#define LOG_TOKEN_TYPES_7(a, b, c, d, e, f, g)  (7u | LOG_TOKEN_ARG(a, 0) | LOG_TOKEN_ARG(b, 1) | LOG_TOKEN_ARG(c, 2) \
+		| LOG_TOKEN_ARG(d, 3) | LOG_TOKEN_ARG(e, 4) | LOG_TOKEN_ARG(f, 5) | LOG_TOKEN_ARG(g, 6))
+#define LOG_TOKEN_TYPES_8(a, b, c, d, e, f, g, h) (8u | LOG_TOKEN_ARG(a, 0) | LOG_TOKEN_ARG(b, 1) | LOG_TOKEN_ARG(c, 2) \
+		| LOG_TOKEN_ARG(d, 3) | LOG_TOKEN_ARG(e, 4) | LOG_TOKEN_ARG(f, 5) | LOG_TOKEN_ARG(g, 6) | LOG_TOKEN_ARG(h, 7))
+
+/// Encode token and the arguments described by `types` into buf (size bytes)
+/// A string that does not fit is cut; the arguments after a number that does not fit are left out
+/// Returns the number of bytes written
+size_t log_token_encode(uint8_t * buf, size_t size, uint32_t token, uint32_t types, va_list args);
+
+#endif //LOG_TOKEN_H_
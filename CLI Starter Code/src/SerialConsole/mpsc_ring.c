@@ -0,0 +1,167 @@
+/**************************************************************************//**
+* @file        mpsc_ring.c
+* @ingroup     Serial Console
+* @brief       Multi-producer/single-consumer byte ring built on spsc_ring.
+* @details     See mpsc_ring.h. Only the reservation bookkeeping runs inside the
+*				critical section; the data copies do not, neither a writer's nor the
+*				move of a discard, so the interrupt latency they add is independent
+*				of the number of bytes.
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+ #include <string.h>
+
+ #include "mpsc_ring.h"
+
+ // Private Functions
+
+ /// Free space seen by producers: reserved but uncommitted bytes are already taken
+ static inline size_t reserve_space(const mpsc_ring_t * ring)
+ {
+	 uint32_t tail = __atomic_load_n(&ring->ring.tail, __ATOMIC_ACQUIRE);
+
+	 if(ring->discarding)
+	 {
+		 return 0;
+	 }
+
+	 return spsc_ring_capacity(&ring->ring) - (ring->reserved - tail);
+ }
+
+ // APIs
+
+ bool mpsc_ring_reserve(mpsc_ring_t * ring, size_t len, mpsc_reservation_t * res)
+ {
+	 uint32_t start;
+
+	 MPSC_RING_ENTER_CRITICAL();
+	 if(len == 0 || len > reserve_space(ring))
+	 {
+		 MPSC_RING_LEAVE_CRITICAL();
+		 return false;
+	 }
+	 start = ring->reserved;
+	 ring->reserved = start + len;
+	 ring->writers++;
+	 MPSC_RING_LEAVE_CRITICAL();
+
+	 size_t offset = start & ring->ring.mask;
+	 size_t first = spsc_ring_capacity(&ring->ring) - offset;
+	 if(first > len)
+	 {
+		 first = len;
+	 }
+
+	 res->first = &ring->ring.buffer[offset];
+	 res->firstLen = first;
+	 res->second = ring->ring.buffer;
+	 res->secondLen = len - first;
+
+	 return true;
+ }
+
+ bool mpsc_ring_commit(mpsc_ring_t * ring)
+ {
+	 bool published = false;
+
+	 MPSC_RING_ENTER_CRITICAL();
+	 // With no reservation outstanding, everything reserved so far has been
+	 // written: the last writer out publishes it all in one go.
+	 if(--ring->writers == 0 && ring->ring.head != ring->reserved)
+	 {
+		 __atomic_store_n(&ring->ring.head, ring->reserved, __ATOMIC_RELEASE);
+		 published = true;
+	 }
+	 MPSC_RING_LEAVE_CRITICAL();
+
+	 return published;
+ }
+
+ void mpsc_reservation_fill(const mpsc_reservation_t * res, const uint8_t * data)
+ {
+	 memcpy(res->first, data, res->firstLen);
+	 memcpy(res->second, data + res->firstLen, res->secondLen);
+ }
+
+ size_t mpsc_reservation_write(const mpsc_reservation_t * res, size_t offset, const uint8_t * data, size_t len)
+ {
+	 size_t total = res->firstLen + res->secondLen;
+
+	 if(offset >= total)
+	 {
+		 return 0;
+	 }
+	 if(len > total - offset)
+	 {
+		 len = total - offset;
+	 }
+
+	 size_t first = 0;
+	 if(offset < res->firstLen)
+	 {
+		 first = res->firstLen - offset;
+		 if(first > len)
+		 {
+			 first = len;
+		 }
+		 memcpy(res->first + offset, data, first);
+	 }
+	 if(len > first)
+	 {
+		 memcpy(res->second + (offset + first - res->firstLen), data + first, len - first);
+	 }
+
+	 return len;
+ }
+
+ size_t mpsc_ring_space(const mpsc_ring_t * ring)
+ {
+	 MPSC_RING_ENTER_CRITICAL();
+	 size_t space = reserve_space(ring);
+	 MPSC_RING_LEAVE_CRITICAL();
+
+	 return space;
+ }
+
+ bool mpsc_ring_discard_begin(mpsc_ring_t * ring, uint32_t from, uint32_t to, mpsc_discard_t * discard)
+ {
+	 MPSC_RING_ENTER_CRITICAL();
+	 if(ring->writers != 0 || ring->discarding)
+	 {
+		 MPSC_RING_LEAVE_CRITICAL();
+		 return false;
+	 }
+
+	 // [from, head) now belongs to nobody: the consumer stops at from and
+	 // producers cannot reserve, so the move needs no lock.
+	 discard->from = from;
+	 discard->to = to;
+	 discard->head = ring->ring.head;
+	 ring->discarding = true;
+	 __atomic_store_n(&ring->ring.head, from, __ATOMIC_RELEASE);
+	 MPSC_RING_LEAVE_CRITICAL();
+
+	 return true;
+ }
+
+ bool mpsc_ring_discard_end(mpsc_ring_t * ring, const mpsc_discard_t * discard)
+ {
+	 uint32_t head = discard->head - (discard->to - discard->from);
+
+	 for(uint32_t src = discard->to, dst = discard->from; src != discard->head; src++, dst++)
+	 {
+		 ring->ring.buffer[dst & ring->ring.mask] = ring->ring.buffer[src & ring->ring.mask];
+	 }
+
+	 MPSC_RING_ENTER_CRITICAL();
+	 ring->reserved = head;
+	 __atomic_store_n(&ring->ring.head, head, __ATOMIC_RELEASE);
+	 ring->discarding = false;
+	 MPSC_RING_LEAVE_CRITICAL();
+
+	 return head != discard->from;
+ }
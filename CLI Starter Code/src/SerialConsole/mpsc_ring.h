@@ -0,0 +1,106 @@
+/**************************************************************************//**
+* @file        mpsc_ring.h
+* @ingroup     Serial Console
+* @brief       Multi-producer/single-consumer byte ring built on spsc_ring.
+* @details     Any number of tasks and interrupts may write concurrently through
+*				per-writer reservations: a writer claims a contiguous region of the
+*				ring with interrupts masked for a few instructions, copies its data
+*				with interrupts enabled, then commits. Reservations never overlap, so
+*				every message stays intact even when an interrupt writes in the middle
+*				of a task's copy. Committed data is published to the consumer once
+*				the last outstanding writer commits, which keeps the published region
+*				free of holes.
+*
+*				The consumer side is the embedded spsc_ring: use spsc_ring_get,
+*				spsc_ring_linear_read, spsc_ring_consume, ... on &ring->ring.
+*
+*				Usage:
+*				    MPSC_RING_DEFINE(txRing, 512);
+*				    mpsc_reservation_t res;
+*				    if(mpsc_ring_reserve(&txRing, len, &res))
+*				    {
+*				        mpsc_reservation_fill(&res, data);
+*				        if(mpsc_ring_commit(&txRing)) { ...start the consumer... }
+*				    }
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef MPSC_RING_H_
+#define MPSC_RING_H_
+
+#include "spsc_ring.h"
+
+/// Critical section guarding the reservation counters. Defaults to masking
+/// interrupts through ASF; define both macros beforehand to use another lock.
+#ifndef MPSC_RING_ENTER_CRITICAL
+#  include <asf.h>
+#  define MPSC_RING_ENTER_CRITICAL()    system_interrupt_enter_critical_section()
+#  define MPSC_RING_LEAVE_CRITICAL()    system_interrupt_leave_critical_section()
+#endif
+
+/// Ring control block. Use MPSC_RING_DEFINE to create one together with its storage.
+typedef struct {
+	spsc_ring_t ring;          ///< Published data; ring.head only moves on the last commit
+	volatile uint32_t reserved; ///< Total bytes ever reserved by producers
+	volatile uint32_t writers;  ///< Reservations not committed yet
+	volatile bool discarding;   ///< A discard is moving data: no reservations until it ends
+} mpsc_ring_t;
+
+/// A region claimed by one writer: at most two segments when it wraps around the storage
+typedef struct {
+	uint8_t * first;    ///< Start of the first segment
+	size_t firstLen;    ///< Bytes in the first segment
+	uint8_t * second;   ///< Start of the wrapped segment (storage start)
+	size_t secondLen;   ///< Bytes in the wrapped segment, 0 if the region does not wrap
+} mpsc_reservation_t;
+
+/// A discard in progress, see mpsc_ring_discard_begin
+typedef struct {
+	uint32_t from;      ///< Start of the discarded bytes (ring counters)
+	uint32_t to;        ///< End of the discarded bytes
+	uint32_t head;      ///< Published end before the discard
+} mpsc_discard_t;
+
+/// Defines a file-local, statically allocated ring named `name` holding `capacity` bytes
+/// Requires: capacity is a power of two
+#define MPSC_RING_DEFINE(name, capacity) \
+	_Static_assert(((capacity) & ((capacity) - 1)) == 0 && (capacity) > 0, \
+			"MPSC ring capacity must be a power of two"); \
+	static uint8_t name##_storage[(capacity)]; \
+	static mpsc_ring_t name = { { name##_storage, (capacity) - 1, 0, 0 }, 0, 0, false }
+
+/// Producer: claim len contiguous bytes of the ring (all or nothing)
+/// Returns true and fills *res on success, false if the ring lacks the space
+bool mpsc_ring_reserve(mpsc_ring_t * ring, size_t len, mpsc_reservation_t * res);
+
+/// Producer: mark the caller's reservation as written
+/// Returns true if this commit published data, i.e. the consumer should be kicked
+bool mpsc_ring_commit(mpsc_ring_t * ring);
+
+/// Producer: copy len bytes (the reserved length) into a reservation
+void mpsc_reservation_fill(const mpsc_reservation_t * res, const uint8_t * data);
+
+/// Producer: copy len bytes into a reservation starting offset bytes in
+/// Returns the number of bytes copied, clipped to the end of the reservation
+size_t mpsc_reservation_write(const mpsc_reservation_t * res, size_t offset, const uint8_t * data, size_t len);
+
+/// Returns the number of bytes that can still be reserved
+size_t mpsc_ring_space(const mpsc_ring_t * ring);
+
+/// Start removing the published bytes [from, to) (ring counters): withdraws [from, head)
+/// from the consumer and refuses reservations until mpsc_ring_discard_end.
+/// Requires: from <= to <= head, and the consumer is not reading at or after `from`;
+/// call in the same critical section as the checks that chose from and to
+/// Returns false, leaving the ring untouched, while any reservation or discard is outstanding
+bool mpsc_ring_discard_begin(mpsc_ring_t * ring, uint32_t from, uint32_t to, mpsc_discard_t * discard);
+
+/// Finish a discard: move the newer data down over the discarded bytes, then publish it
+/// again. The move runs outside the critical section; call this outside any other.
+/// Returns true if data was published, i.e. the consumer should be kicked
+bool mpsc_ring_discard_end(mpsc_ring_t * ring, const mpsc_discard_t * discard);
+
+#endif //MPSC_RING_H_
@@ -0,0 +1,212 @@
+/**************************************************************************//**
+* @file        spsc_ring.c
+* @ingroup     Serial Console
+* @brief       Lock-free single-producer/single-consumer byte ring.
+* @details     See spsc_ring.h. Each side reads the other side's counter with acquire
+*				ordering and publishes its own counter with release ordering, so data
+*				copied into (or out of) the storage is visible before the counter moves.
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+ #include <string.h>
+
+ #include "spsc_ring.h"
+
+ // Private Functions
+
+ static inline uint32_t load_acquire(const volatile uint32_t * counter)
+ {
+	 return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+ }
+
+ static inline void store_release(volatile uint32_t * counter, uint32_t value)
+ {
+	 __atomic_store_n(counter, value, __ATOMIC_RELEASE);
+ }
+
+ /// Consumer side view of the stored data. If the producer published more than
+ /// the capacity (a DMA engine that cannot be held off), the oldest bytes were
+ /// overwritten: the tail skips over them.
+ static inline size_t consumer_size(spsc_ring_t * ring, uint32_t * tail)
+ {
+	 uint32_t head = load_acquire(&ring->head);
+	 size_t size = head - *tail;
+
+	 if(size > spsc_ring_capacity(ring))
+	 {
+		 size = spsc_ring_capacity(ring);
+		 *tail = head - size;
+		 store_release(&ring->tail, *tail);
+	 }
+
+	 return size;
+ }
+
+ /// Producer side view of the free space (none while an overrun is pending)
+ static inline size_t producer_space(const spsc_ring_t * ring, uint32_t head)
+ {
+	 size_t size = head - load_acquire(&ring->tail);
+
+	 return (size < spsc_ring_capacity(ring)) ? spsc_ring_capacity(ring) - size : 0;
+ }
+
+ // APIs
+
+ void spsc_ring_reset(spsc_ring_t * ring)
+ {
+	 ring->head = 0;
+	 ring->tail = 0;
+ }
+
+ size_t spsc_ring_size(const spsc_ring_t * ring)
+ {
+	 size_t size = load_acquire(&ring->head) - load_acquire(&ring->tail);
+
+	 return (size > spsc_ring_capacity(ring)) ? spsc_ring_capacity(ring) : size;
+ }
+
+ size_t spsc_ring_space(const spsc_ring_t * ring)
+ {
+	 return spsc_ring_capacity(ring) - spsc_ring_size(ring);
+ }
+
+ bool spsc_ring_empty(const spsc_ring_t * ring)
+ {
+	 return spsc_ring_size(ring) == 0;
+ }
+
+ bool spsc_ring_full(const spsc_ring_t * ring)
+ {
+	 return spsc_ring_size(ring) == spsc_ring_capacity(ring);
+ }
+
+ int spsc_ring_put(spsc_ring_t * ring, uint8_t data)
+ {
+	 uint32_t head = ring->head;
+
+	 if(producer_space(ring, head) == 0)
+	 {
+		 return -1;
+	 }
+
+	 ring->buffer[head & ring->mask] = data;
+	 store_release(&ring->head, head + 1);
+
+	 return 0;
+ }
+
+ size_t spsc_ring_put_range(spsc_ring_t * ring, const uint8_t * data, size_t len)
+ {
+	 uint32_t head = ring->head;
+	 size_t space = producer_space(ring, head);
+
+	 if(len > space)
+	 {
+		 len = space;
+	 }
+	 if(len == 0)
+	 {
+		 return 0;
+	 }
+
+	 // At most two copies: up to the end of the storage, then from its start
+	 size_t offset = head & ring->mask;
+	 size_t first = spsc_ring_capacity(ring) - offset;
+	 if(first > len)
+	 {
+		 first = len;
+	 }
+	 memcpy(&ring->buffer[offset], data, first);
+	 memcpy(ring->buffer, data + first, len - first);
+
+	 store_release(&ring->head, head + len);
+
+	 return len;
+ }
+
+ size_t spsc_ring_linear_write(spsc_ring_t * ring, uint8_t ** data)
+ {
+	 uint32_t head = ring->head;
+	 size_t space = producer_space(ring, head);
+	 size_t offset = head & ring->mask;
+	 size_t linear = spsc_ring_capacity(ring) - offset;
+
+	 *data = &ring->buffer[offset];
+
+	 return (linear < space) ? linear : space;
+ }
+
+ void spsc_ring_produce(spsc_ring_t * ring, size_t len)
+ {
+	 store_release(&ring->head, ring->head + len);
+ }
+
+ int spsc_ring_get(spsc_ring_t * ring, uint8_t * data)
+ {
+	 uint32_t tail = ring->tail;
+
+	 if(consumer_size(ring, &tail) == 0)
+	 {
+		 return -1;
+	 }
+
+	 *data = ring->buffer[tail & ring->mask];
+	 store_release(&ring->tail, tail + 1);
+
+	 return 0;
+ }
+
+ size_t spsc_ring_peek(spsc_ring_t * ring, uint8_t * data, size_t len)
+ {
+	 uint32_t tail = ring->tail;
+	 size_t size = consumer_size(ring, &tail);
+
+	 if(len > size)
+	 {
+		 len = size;
+	 }
+	 if(len == 0)
+	 {
+		 return 0;
+	 }
+
+	 size_t offset = tail & ring->mask;
+	 size_t first = spsc_ring_capacity(ring) - offset;
+	 if(first > len)
+	 {
+		 first = len;
+	 }
+	 memcpy(data, &ring->buffer[offset], first);
+	 memcpy(data + first, ring->buffer, len - first);
+
+	 return len;
+ }
+
+ size_t spsc_ring_get_range(spsc_ring_t * ring, uint8_t * data, size_t len)
+ {
+	 len = spsc_ring_peek(ring, data, len);
+	 spsc_ring_consume(ring, len);
+
+	 return len;
+ }
+
+ size_t spsc_ring_linear_read(spsc_ring_t * ring, uint8_t ** data)
+ {
+	 uint32_t tail = ring->tail;
+	 size_t size = consumer_size(ring, &tail);
+	 size_t offset = tail & ring->mask;
+	 size_t linear = spsc_ring_capacity(ring) - offset;
+
+	 *data = &ring->buffer[offset];
+
+	 return (linear < size) ? linear : size;
+ }
+
+ void spsc_ring_consume(spsc_ring_t * ring, size_t len)
+ {
+	 store_release(&ring->tail, ring->tail + len);
+ }
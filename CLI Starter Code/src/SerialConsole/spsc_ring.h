@@ -0,0 +1,113 @@
+/**************************************************************************//**
+* @file        spsc_ring.h
+* @ingroup     Serial Console
+* @brief       Lock-free single-producer/single-consumer byte ring.
+* @details     Statically allocated ring with a power-of-two capacity fixed at compile time.
+*				Head and tail are free-running 32-bit counters indexed with a mask: the
+*				producer only writes head, the consumer only writes tail, and each side
+*				publishes its counter with release ordering after touching the data. One
+*				interrupt and one task can therefore exchange data without suspending the
+*				scheduler or masking interrupts.
+*
+*				A producer that cannot be held off (e.g. a DMA engine writing in place) may
+*				publish more than the free space; the consumer then skips the overwritten
+*				oldest bytes on its next access.
+*
+*				Producer side:  spsc_ring_put, spsc_ring_put_range, spsc_ring_linear_write,
+*				                spsc_ring_produce
+*				Consumer side:  spsc_ring_get, spsc_ring_get_range, spsc_ring_peek,
+*				                spsc_ring_linear_read, spsc_ring_consume
+*				Either side:    spsc_ring_size, spsc_ring_space, spsc_ring_empty, spsc_ring_full
+*
+*				Usage:
+*				    SPSC_RING_DEFINE(rxRing, 512);
+*				    spsc_ring_put(&rxRing, byte);        // ISR
+*				    spsc_ring_get(&rxRing, &byte);       // task
+*
+* @copyright
+* @author
+* @date        October 16, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/// Ring control block. Use SPSC_RING_DEFINE to create one together with its storage.
+typedef struct {
+	uint8_t * buffer;       ///< Storage, capacity bytes long
+	uint32_t mask;          ///< capacity - 1
+	volatile uint32_t head; ///< Total bytes ever produced (written by the producer only)
+	volatile uint32_t tail; ///< Total bytes ever consumed (written by the consumer only)
+} spsc_ring_t;
+
+/// Defines a file-local, statically allocated ring named `name` holding `capacity` bytes
+/// Requires: capacity is a power of two
+#define SPSC_RING_DEFINE(name, capacity) \
+	_Static_assert(((capacity) & ((capacity) - 1)) == 0 && (capacity) > 0, \
+			"SPSC ring capacity must be a power of two"); \
+	static uint8_t name##_storage[(capacity)]; \
+	static spsc_ring_t name = { name##_storage, (capacity) - 1, 0, 0 }
+
+/// Empty the ring. Only valid while neither side is using it.
+void spsc_ring_reset(spsc_ring_t * ring);
+
+/// Returns the number of bytes the ring can hold
+static inline size_t spsc_ring_capacity(const spsc_ring_t * ring)
+{
+	return ring->mask + 1;
+}
+
+/// Returns the number of bytes stored
+size_t spsc_ring_size(const spsc_ring_t * ring);
+
+/// Returns the number of bytes that can still be produced
+size_t spsc_ring_space(const spsc_ring_t * ring);
+
+/// Returns true if the ring is empty
+bool spsc_ring_empty(const spsc_ring_t * ring);
+
+/// Returns true if the ring is full
+bool spsc_ring_full(const spsc_ring_t * ring);
+
+/// Producer: add one byte
+/// Returns 0 on success, -1 if the ring is full
+int spsc_ring_put(spsc_ring_t * ring, uint8_t data);
+
+/// Producer: copy up to len bytes in (at most two memcpy segments); data that does not fit is rejected
+/// Returns the number of bytes stored
+size_t spsc_ring_put_range(spsc_ring_t * ring, const uint8_t * data, size_t len);
+
+/// Producer: get the largest free block writable without wrapping
+/// Returns the number of contiguous bytes writable at *data; commit them with spsc_ring_produce
+size_t spsc_ring_linear_write(spsc_ring_t * ring, uint8_t ** data);
+
+/// Producer: publish len bytes that were written in place after the head
+/// Requires: len <= spsc_ring_space(ring)
+void spsc_ring_produce(spsc_ring_t * ring, size_t len);
+
+/// Consumer: retrieve one byte
+/// Returns 0 on success, -1 if the ring is empty
+int spsc_ring_get(spsc_ring_t * ring, uint8_t * data);
+
+/// Consumer: copy up to len bytes out without removing them
+/// Returns the number of bytes copied
+size_t spsc_ring_peek(spsc_ring_t * ring, uint8_t * data, size_t len);
+
+/// Consumer: retrieve up to len bytes
+/// Returns the number of bytes read
+size_t spsc_ring_get_range(spsc_ring_t * ring, uint8_t * data, size_t len);
+
+/// Consumer: get the largest block of stored data readable without wrapping
+/// Returns the number of contiguous bytes starting at *data; release them with spsc_ring_consume
+size_t spsc_ring_linear_read(spsc_ring_t * ring, uint8_t ** data);
+
+/// Consumer: release len bytes once they have been consumed in place
+/// Requires: len <= spsc_ring_size(ring)
+void spsc_ring_consume(spsc_ring_t * ring, size_t len);
+
+#endif //SPSC_RING_H_
@@ -38,17 +38,26 @@
  * http://www.freertos.org/a00110.html.
  */
 
+#include "conf_serial_console.h"
+
 #if defined (__GNUC__) || defined (__ICCARM__)
 #  include <gclk.h>
 #  include <stdint.h>
 void assert_triggered( const char * file, uint32_t line );
+#  if CONF_SERIAL_CONSOLE_STANDBY
+void vApplicationSleep( uint32_t xExpectedIdleTime );
+#  endif
 #endif
 
 
 
 #define configUSE_PREEMPTION                    1
 #define configUSE_IDLE_HOOK                     0
-#define configUSE_TICK_HOOK                     0
+#define configUSE_TICK_HOOK                     1
+#if CONF_SERIAL_CONSOLE_STANDBY
+#define configUSE_TICKLESS_IDLE                 2	// Standby from the idle task, see SerialConsoleSleep
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vApplicationSleep( xExpectedIdleTime )
+#endif
 #define configPRIO_BITS                         2
 #define configCPU_CLOCK_HZ                      ( system_gclk_gen_get_hz(GCLK_GENERATOR_0) )
 #define configTICK_RATE_HZ                      ( ( portTickType ) 1000 )
@@ -100,9 +109,10 @@ to exclude the API function. */
 
 
 /* Normal assert() semantics without relying on the provision of an assert.h
-header file. */
+header file. vAssertCalled (main.c) records the crash, see CrashLog.h. */
+void vAssertCalled( void );
 #define configASSERT( x ) \
-        if( ( x ) == 0 ) { taskDISABLE_INTERRUPTS(); for( ;; ); }
+        if( ( x ) == 0 ) { vAssertCalled(); }
 
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
 standard names - or at least those used in the unmodified vector table. */
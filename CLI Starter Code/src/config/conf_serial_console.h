@@ -0,0 +1,408 @@
+/**************************************************************************//**
+ * @file        conf_serial_console.h
+ * @ingroup     Serial Console
+ * @brief       Build-time configuration for the Serial Console driver.
+ * @details     Every option can be overridden from the compiler command line
+ *              (e.g. -DCONF_SERIAL_CONSOLE_USE_DMA_TX=false).
+ *****************************************************************************/
+
+#ifndef CONF_SERIAL_CONSOLE_H_INCLUDED
+#define CONF_SERIAL_CONSOLE_H_INCLUDED
+
+/******************************************************************************
+ * Line settings
+ ******************************************************************************/
+/** Baud rate at start-up when none is detected, see CONF_SERIAL_CONSOLE_AUTOBAUD */
+#ifndef CONF_SERIAL_CONSOLE_BAUD_RATE
+#  define CONF_SERIAL_CONSOLE_BAUD_RATE         115200
+#endif
+
+/** How long the peer has to answer at the new rate after "baud <rate>", in milliseconds */
+#ifndef CONF_SERIAL_CONSOLE_BAUD_CONFIRM_MS
+#  define CONF_SERIAL_CONSOLE_BAUD_CONFIRM_MS   3000
+#endif
+
+/******************************************************************************
+ * Transmit path
+ ******************************************************************************/
+/** Send the console TX ring through the DMAC instead of one usart_write_buffer_job per byte */
+#ifndef CONF_SERIAL_CONSOLE_USE_DMA_TX
+#  define CONF_SERIAL_CONSOLE_USE_DMA_TX        true
+#endif
+
+/** DMAC channel used for the console transmitter */
+#ifndef CONF_SERIAL_CONSOLE_DMA_TX_CHANNEL
+#  define CONF_SERIAL_CONSOLE_DMA_TX_CHANNEL    0
+#endif
+
+/** What SerialConsoleWriteString and LogMessage do when the console TX ring is full (enum eTxPolicy) */
+#ifndef CONF_SERIAL_CONSOLE_TX_POLICY
+#  define CONF_SERIAL_CONSOLE_TX_POLICY         TX_POLICY_DROP_NEWEST
+#endif
+
+/** Longest wait for room in the TX ring under TX_POLICY_BLOCK, in milliseconds */
+#ifndef CONF_SERIAL_CONSOLE_TX_TIMEOUT_MS
+#  define CONF_SERIAL_CONSOLE_TX_TIMEOUT_MS     20
+#endif
+
+/** Queued message boundaries remembered for TX_POLICY_DROP_OLDEST and lane switches (power of two) */
+#ifndef CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS
+#  define CONF_SERIAL_CONSOLE_TX_MESSAGE_SLOTS  16
+#endif
+
+/** Most bulk bytes one TX DMA transfer carries beyond its first message: bounds how long urgent output waits */
+#ifndef CONF_SERIAL_CONSOLE_TX_BULK_BURST
+#  define CONF_SERIAL_CONSOLE_TX_BULK_BURST     64
+#endif
+
+/** LogMessage sends messages at or above this level through the urgent TX lane (enum eDebugLogLevels) */
+#ifndef CONF_SERIAL_CONSOLE_URGENT_LOG_LEVEL
+#  define CONF_SERIAL_CONSOLE_URGENT_LOG_LEVEL  LOG_FATAL_LVL
+#endif
+
+/******************************************************************************
+ * Receive path
+ ******************************************************************************/
+/** DMA received bytes straight into the RX ring instead of re-arming a one-byte read job */
+#ifndef CONF_SERIAL_CONSOLE_USE_DMA_RX
+#  define CONF_SERIAL_CONSOLE_USE_DMA_RX        true
+#endif
+
+/** DMAC channel used for the console receiver */
+#ifndef CONF_SERIAL_CONSOLE_DMA_RX_CHANNEL
+#  define CONF_SERIAL_CONSOLE_DMA_RX_CHANNEL    1
+#endif
+
+/** Wake the consumer after this many received bytes (must divide the RX buffer size) */
+#ifndef CONF_SERIAL_CONSOLE_RX_WATERMARK
+#  define CONF_SERIAL_CONSOLE_RX_WATERMARK      32
+#endif
+
+/** Wake the consumer once the line has been quiet for this many RTOS ticks */
+#ifndef CONF_SERIAL_CONSOLE_RX_IDLE_TICKS
+#  define CONF_SERIAL_CONSOLE_RX_IDLE_TICKS     2
+#endif
+
+/** Who echoes typed characters back at start-up (enum eEchoMode), see the "echo" command */
+#ifndef CONF_SERIAL_CONSOLE_ECHO_MODE
+#  define CONF_SERIAL_CONSOLE_ECHO_MODE         ECHO_MODE_ISR
+#endif
+
+/** Cooked input: echo, backspace and line assembly happen in the receive path and
+ *  the reader is woken once per complete line (SerialConsoleReadLine) */
+#ifndef CONF_SERIAL_CONSOLE_LINE_MODE
+#  define CONF_SERIAL_CONSOLE_LINE_MODE         true
+#endif
+
+/** Longest line assembled in cooked mode, including the terminator */
+#ifndef CONF_SERIAL_CONSOLE_LINE_LENGTH
+#  define CONF_SERIAL_CONSOLE_LINE_LENGTH       100
+#endif
+
+/** Bytes of completed lines waiting for the reader (power of two) */
+#ifndef CONF_SERIAL_CONSOLE_LINE_BUFFER_SIZE
+#  define CONF_SERIAL_CONSOLE_LINE_BUFFER_SIZE  256
+#endif
+
+/******************************************************************************
+ * Flow control
+ ******************************************************************************/
+/** RTS/CTS hardware flow control. The SERCOM transmitter honours CTS by itself;
+ *  RTS is a GPIO deasserted when the ring the reader drains (the RX ring, or the
+ *  completed lines in cooked mode) fills up. Needs TX on PAD0, so the console
+ *  moves off the EDBG CDC pins to the ones below. */
+#ifndef CONF_SERIAL_CONSOLE_FLOW_CONTROL
+#  define CONF_SERIAL_CONSOLE_FLOW_CONTROL      false
+#endif
+
+/** SERCOM4 pads with flow control: TX on PAD0, RX on PAD1, CTS on PAD3. PAD2
+ *  (the SERCOM's own RTS, which only tracks its two-byte FIFO) stays unused. */
+#ifndef CONF_SERIAL_CONSOLE_FLOW_MUX_SETTING
+#  define CONF_SERIAL_CONSOLE_FLOW_MUX_SETTING  USART_RX_1_TX_0_RTS_2_CTS_3
+#endif
+#ifndef CONF_SERIAL_CONSOLE_FLOW_PINMUX_TX
+#  define CONF_SERIAL_CONSOLE_FLOW_PINMUX_TX    PINMUX_PB08D_SERCOM4_PAD0
+#endif
+#ifndef CONF_SERIAL_CONSOLE_FLOW_PINMUX_RX
+#  define CONF_SERIAL_CONSOLE_FLOW_PINMUX_RX    PINMUX_PB09D_SERCOM4_PAD1
+#endif
+#ifndef CONF_SERIAL_CONSOLE_FLOW_PINMUX_CTS
+#  define CONF_SERIAL_CONSOLE_FLOW_PINMUX_CTS   PINMUX_PB11D_SERCOM4_PAD3
+#endif
+
+/** GPIO driving RTS (active low: low = send, high = pause) */
+#ifndef CONF_SERIAL_CONSOLE_RTS_PIN
+#  define CONF_SERIAL_CONSOLE_RTS_PIN           PIN_PB10
+#endif
+
+/** Deassert RTS once the receive ring is this full, in percent. Leave room for
+ *  what the peer sends after RTS drops plus one RX watermark of unpublished DMA data. */
+#ifndef CONF_SERIAL_CONSOLE_RTS_PAUSE_PERCENT
+#  define CONF_SERIAL_CONSOLE_RTS_PAUSE_PERCENT  75
+#endif
+
+/** Assert RTS again once the reader has drained the receive ring to this level, in percent */
+#ifndef CONF_SERIAL_CONSOLE_RTS_RESUME_PERCENT
+#  define CONF_SERIAL_CONSOLE_RTS_RESUME_PERCENT 25
+#endif
+
+/******************************************************************************
+ * Baud rate detection
+ ******************************************************************************/
+/** Wait for a 0x55 ('U') from the host at start-up and run the console at its rate.
+ *  A BREAK in front of it is skipped; a BREAK alone, or no sync character within
+ *  the timeout, keeps CONF_SERIAL_CONSOLE_BAUD_RATE. The edges are timestamped by
+ *  TC3 through the EIC and event system and polled by the CPU, which keeps up
+ *  to about 460800 Bd at the 48 MHz main clock (115200 Bd from OSC8M with
+ *  CONF_SERIAL_CONSOLE_STANDBY). Off by default: the CPU busy-waits for the
+ *  whole timeout before the scheduler starts when no host sends the character. */
+#ifndef CONF_SERIAL_CONSOLE_AUTOBAUD
+#  define CONF_SERIAL_CONSOLE_AUTOBAUD          false
+#endif
+
+/** How long start-up waits for the sync character, in milliseconds */
+#ifndef CONF_SERIAL_CONSOLE_AUTOBAUD_TIMEOUT_MS
+#  define CONF_SERIAL_CONSOLE_AUTOBAUD_TIMEOUT_MS 2000
+#endif
+
+/** The console RX pin routed to the EIC, and its EXTINT line */
+#if CONF_SERIAL_CONSOLE_FLOW_CONTROL
+#  ifndef CONF_SERIAL_CONSOLE_AUTOBAUD_PINMUX
+#    define CONF_SERIAL_CONSOLE_AUTOBAUD_PINMUX PINMUX_PB09A_EIC_EXTINT9
+#  endif
+#  ifndef CONF_SERIAL_CONSOLE_AUTOBAUD_EXTINT
+#    define CONF_SERIAL_CONSOLE_AUTOBAUD_EXTINT 9
+#  endif
+#else
+#  ifndef CONF_SERIAL_CONSOLE_AUTOBAUD_PINMUX
+#    define CONF_SERIAL_CONSOLE_AUTOBAUD_PINMUX PINMUX_PB11A_EIC_EXTINT11
+#  endif
+#  ifndef CONF_SERIAL_CONSOLE_AUTOBAUD_EXTINT
+#    define CONF_SERIAL_CONSOLE_AUTOBAUD_EXTINT 11
+#  endif
+#endif
+
+/** Event system channel carrying the RX edges to TC3 during detection */
+#ifndef CONF_SERIAL_CONSOLE_AUTOBAUD_EVSYS_CHANNEL
+#  define CONF_SERIAL_CONSOLE_AUTOBAUD_EVSYS_CHANNEL 0
+#endif
+
+/******************************************************************************
+ * Standby
+ ******************************************************************************/
+/** Enter standby from the idle task while no serial channel has data in flight.
+ *  The console SERCOM keeps running on demand and its start-of-frame detection
+ *  wakes the device on the first start bit, early enough to receive that
+ *  character. The RTC times the sleep (see "power"). Also turns on tickless idle
+ *  (FreeRTOSConfig.h) and keeps OSC8M and GCLK5 running in standby (conf_clocks.h). */
+#ifndef CONF_SERIAL_CONSOLE_STANDBY
+#  define CONF_SERIAL_CONSOLE_STANDBY           false
+#endif
+
+/** Shortest idle time worth entering standby for, in ticks (at least 2) */
+#ifndef CONF_SERIAL_CONSOLE_STANDBY_MIN_TICKS
+#  define CONF_SERIAL_CONSOLE_STANDBY_MIN_TICKS 5
+#endif
+
+/** Clock of the console SERCOM (and of baud rate detection) with standby: on
+ *  OSC8M, which starts within a start bit, unlike the DPLL behind generator 0.
+ *  Limits the console to 500000 Bd. */
+#ifndef CONF_SERIAL_CONSOLE_STANDBY_GCLK_GENERATOR
+#  define CONF_SERIAL_CONSOLE_STANDBY_GCLK_GENERATOR GCLK_GENERATOR_5
+#endif
+
+/** Supply current awake and in standby, in microamperes, for the estimate of
+ *  "power". Typical SAMD21 figures at 48 MHz and with the RTC on OSCULP32K;
+ *  measure the board. */
+#ifndef CONF_SERIAL_CONSOLE_ACTIVE_UA
+#  define CONF_SERIAL_CONSOLE_ACTIVE_UA         3500
+#endif
+#ifndef CONF_SERIAL_CONSOLE_STANDBY_UA
+#  define CONF_SERIAL_CONSOLE_STANDBY_UA        5
+#endif
+
+/******************************************************************************
+ * SERCOM interrupt
+ ******************************************************************************/
+/** Serve the directions not handled by the DMAC from a console-owned SERCOM
+ *  handler (DATA <-> rings on DRE/RXC) instead of ASF one-byte jobs and callbacks */
+#ifndef CONF_SERIAL_CONSOLE_LEAN_ISR
+#  define CONF_SERIAL_CONSOLE_LEAN_ISR          false
+#endif
+
+/** Count the CPU cycles spent in the console SERCOM handler (see "constats") */
+#ifndef CONF_SERIAL_CONSOLE_ISR_PROFILING
+#  define CONF_SERIAL_CONSOLE_ISR_PROFILING     false
+#endif
+
+/** Timestamp every received byte and build histograms of receive-to-read latency,
+ *  reader wakeup and inter-byte gaps (see "rxtime"). Costs 4 bytes of RAM per RX
+ *  ring byte and a timestamp per byte in the receive interrupt */
+#ifndef CONF_SERIAL_CONSOLE_RX_TIMESTAMPS
+#  define CONF_SERIAL_CONSOLE_RX_TIMESTAMPS     false
+#endif
+
+/******************************************************************************
+ * DMAC
+ ******************************************************************************/
+/** NVIC priority of the DMAC interrupt (same as the console SERCOM) */
+#ifndef CONF_SERIAL_CONSOLE_DMA_IRQ_PRIORITY
+#  define CONF_SERIAL_CONSOLE_DMA_IRQ_PRIORITY  10
+#endif
+
+/** DMAC channels covered by the descriptor sections, shared by all serial channels */
+#ifndef CONF_SERIAL_CONSOLE_DMA_CHANNELS
+#  define CONF_SERIAL_CONSOLE_DMA_CHANNELS      4
+#endif
+
+/******************************************************************************
+ * Debug logger
+ ******************************************************************************/
+/** LOG_xxx calls below this level (enum eDebugLogLevels) compile to nothing; the
+ *  rest are filtered at runtime by the level of their module (see "loglevel") */
+#ifndef CONF_SERIAL_CONSOLE_LOG_BUILD_LEVEL
+#  define CONF_SERIAL_CONSOLE_LOG_BUILD_LEVEL   LOG_INFO_LVL
+#endif
+
+/** LogMessage sends a token for its format string plus the encoded arguments instead
+ *  of text (log_token.h); the format strings stay in the ELF and tools/log_decode.py
+ *  rebuilds the messages on the host. Formats must be string literals. */
+#ifndef CONF_SERIAL_CONSOLE_TOKENIZED_LOG
+#  define CONF_SERIAL_CONSOLE_TOKENIZED_LOG     false
+#endif
+
+/** Largest tokenized record in bytes (level, token and arguments); later arguments are left out */
+#ifndef CONF_SERIAL_CONSOLE_LOG_TOKEN_RECORD_SIZE
+#  define CONF_SERIAL_CONSOLE_LOG_TOKEN_RECORD_SIZE 48
+#endif
+
+/** Keep every message that passes its module's level in a RAM buffer of fixed-size,
+ *  timestamped entries (format pointer and raw arguments, nothing formatted), read
+ *  back by "dmesg". The UART is then only one sink, with its own level (see
+ *  CONF_SERIAL_CONSOLE_UART_LOG_LEVEL). Tokenized messages are not kept. */
+#ifndef CONF_SERIAL_CONSOLE_LOG_BUFFER
+#  define CONF_SERIAL_CONSOLE_LOG_BUFFER        (!CONF_SERIAL_CONSOLE_TOKENIZED_LOG)
+#endif
+
+/** Entries of the log buffer (power of two); the oldest is overwritten. An entry takes
+ *  20 bytes + 4 per CONF_SERIAL_CONSOLE_LOG_MAX_ARGS + CONF_SERIAL_CONSOLE_LOG_MAX_STRINGS */
+#ifndef CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES
+#  define CONF_SERIAL_CONSOLE_LOG_BUFFER_ENTRIES 32
+#endif
+
+/** Start-up level of the UART sink: messages below it are only kept in the log buffer.
+ *  Changed at runtime with "loglevel uart <level>". */
+#ifndef CONF_SERIAL_CONSOLE_UART_LOG_LEVEL
+#  define CONF_SERIAL_CONSOLE_UART_LOG_LEVEL    LOG_INFO_LVL
+#endif
+
+/** LogMessage does not format for the UART: a low-priority logger task formats the
+ *  entries of the log buffer and sends them. Messages at
+ *  CONF_SERIAL_CONSOLE_URGENT_LOG_LEVEL and above are still formatted at once.
+ *  Needs CONF_SERIAL_CONSOLE_LOG_BUFFER. */
+#ifndef CONF_SERIAL_CONSOLE_DEFERRED_LOG
+#  define CONF_SERIAL_CONSOLE_DEFERRED_LOG      CONF_SERIAL_CONSOLE_LOG_BUFFER
+#endif
+
+/** Argument words kept per message (a long long takes two); the rest print as 0 or (null) */
+#ifndef CONF_SERIAL_CONSOLE_LOG_MAX_ARGS
+#  define CONF_SERIAL_CONSOLE_LOG_MAX_ARGS      8
+#endif
+
+/** Bytes of %s copies kept per message (at most 255), terminators included */
+#ifndef CONF_SERIAL_CONSOLE_LOG_MAX_STRINGS
+#  define CONF_SERIAL_CONSOLE_LOG_MAX_STRINGS   48
+#endif
+
+/** Longest line the logger task sends, time prefix included; longer lines are cut */
+#ifndef CONF_SERIAL_CONSOLE_LOG_LINE_LENGTH
+#  define CONF_SERIAL_CONSOLE_LOG_LINE_LENGTH   128
+#endif
+
+/** Stack of the logger task, in words */
+#ifndef CONF_SERIAL_CONSOLE_LOG_TASK_SIZE
+#  define CONF_SERIAL_CONSOLE_LOG_TASK_SIZE     200
+#endif
+
+/** Priority of the logger task: below the CLI so logging never delays it */
+#ifndef CONF_SERIAL_CONSOLE_LOG_TASK_PRIORITY
+#  define CONF_SERIAL_CONSOLE_LOG_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
+#endif
+
+/** Count the CPU cycles of every LogMessage call (SysTick), shown by "logstats" */
+#ifndef CONF_SERIAL_CONSOLE_LOG_PROFILING
+#  define CONF_SERIAL_CONSOLE_LOG_PROFILING     true
+#endif
+
+/** Keep a fault record and the last log messages in RAM that survives a reset
+ *  (.noinit), written by the fault hooks and the HardFault handler, and report it
+ *  on the next boot (see "crashlog") */
+#ifndef CONF_SERIAL_CONSOLE_CRASH_LOG
+#  define CONF_SERIAL_CONSOLE_CRASH_LOG         true
+#endif
+
+/** Log messages copied into the crash record, taken from the log buffer */
+#ifndef CONF_SERIAL_CONSOLE_CRASH_LOG_ENTRIES
+#  define CONF_SERIAL_CONSOLE_CRASH_LOG_ENTRIES 8
+#endif
+
+/** Reset once the crash is recorded; false spins instead, for a debugger to attach */
+#ifndef CONF_SERIAL_CONSOLE_CRASH_RESET
+#  define CONF_SERIAL_CONSOLE_CRASH_RESET       true
+#endif
+
+/******************************************************************************
+ * Framed link
+ ******************************************************************************/
+/** Run the console UART as a SerialLink: COBS frames with a CRC16 that multiplex
+ *  the CLI, log, telemetry and bulk channels instead of plain text. Needs
+ *  CONF_SERIAL_CONSOLE_LINE_MODE false, the CLI reads its input from CLI frames. */
+#ifndef CONF_SERIAL_CONSOLE_LINK
+#  define CONF_SERIAL_CONSOLE_LINK              false
+#endif
+
+/** Largest payload of one frame in bytes (at most 255); longer writes are split */
+#ifndef CONF_SERIAL_LINK_MAX_PAYLOAD
+#  define CONF_SERIAL_LINK_MAX_PAYLOAD          128
+#endif
+
+/** Bytes queued per logical channel (power of two), each frame takes payload + 1 */
+#ifndef CONF_SERIAL_LINK_QUEUE_SIZE
+#  define CONF_SERIAL_LINK_QUEUE_SIZE           256
+#endif
+
+/** Stack of each of the two link tasks, in words */
+#ifndef CONF_SERIAL_LINK_TASK_SIZE
+#  define CONF_SERIAL_LINK_TASK_SIZE            200
+#endif
+
+/** Priority of the link tasks (same as the CLI task) */
+#ifndef CONF_SERIAL_LINK_TASK_PRIORITY
+#  define CONF_SERIAL_LINK_TASK_PRIORITY        (configMAX_PRIORITIES - 1)
+#endif
+
+/** Frames in flight on the reliable channel (power of two, at most 16). Sender and
+ *  receiver each keep this many payloads: 2 * window * MAX_PAYLOAD bytes of RAM */
+#ifndef CONF_SERIAL_LINK_WINDOW
+#  define CONF_SERIAL_LINK_WINDOW               8
+#endif
+
+/** Retransmission timeout before the first round trip has been measured */
+#ifndef CONF_SERIAL_LINK_RTO_INITIAL_MS
+#  define CONF_SERIAL_LINK_RTO_INITIAL_MS       250
+#endif
+
+/** Bounds of the retransmission timeout */
+#ifndef CONF_SERIAL_LINK_RTO_MIN_MS
+#  define CONF_SERIAL_LINK_RTO_MIN_MS           20
+#endif
+#ifndef CONF_SERIAL_LINK_RTO_MAX_MS
+#  define CONF_SERIAL_LINK_RTO_MAX_MS           2000
+#endif
+
+/** Logical channel the console link delivers reliably (game data, animations) */
+#ifndef CONF_SERIAL_CONSOLE_LINK_RELIABLE_CHANNEL
+#  define CONF_SERIAL_CONSOLE_LINK_RELIABLE_CHANNEL LINK_CHANNEL_BULK
+#endif
+
+#endif /* CONF_SERIAL_CONSOLE_H_INCLUDED */
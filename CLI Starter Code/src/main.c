@@ -33,6 +33,7 @@
  */
 #include <asf.h>
 #include "SerialConsole/SerialConsole.h"
+#include "SerialConsole/CrashLog.h"
 #include "CliThread.h"
 /******************************************************************************
  * Includes
@@ -49,7 +50,6 @@
 /******************************************************************************
  * Variables
  ******************************************************************************/
-static char bufferPrint[64];			  ///< Buffer for daemon task
 static TaskHandle_t cliTaskHandle = NULL; //!< CLI task handle
 
 #define MAX_RX_BUFFER_LENGTH 5
@@ -98,8 +98,7 @@ int main(void)
 static void StartTasks(void)
 {
 
-	snprintf(bufferPrint, 64, "Heap before starting tasks: %d\r\n", xPortGetFreeHeapSize());
-	SerialConsoleWriteString(bufferPrint);
+	SerialConsolePrintf("Heap before starting tasks: %u\r\n", (unsigned)xPortGetFreeHeapSize());
 
 	// CODE HERE: Initialize any Tasks in your system here
 
@@ -108,8 +107,7 @@ static void StartTasks(void)
 		SerialConsoleWriteString("ERR: CLI task could not be initialized!\r\n");
 	}
 
-	snprintf(bufferPrint, 64, "Heap after starting CLI: %d\r\n", xPortGetFreeHeapSize());
-	SerialConsoleWriteString(bufferPrint);
+	SerialConsolePrintf("Heap after starting CLI: %u\r\n", (unsigned)xPortGetFreeHeapSize());
 }
 
 /**************************************************************************/
@@ -131,16 +129,32 @@ void vApplicationDaemonTaskStartupHook(void *ucParameterToPass) // vApplicationD
 	StartTasks();
 }
 
+void vApplicationTickHook(void)
+{
+	SerialConsoleTickHook();
+}
+
+#if CONF_SERIAL_CONSOLE_STANDBY
+void vApplicationSleep(TickType_t xExpectedIdleTime)
+{
+	SerialConsoleSleep(xExpectedIdleTime);
+}
+#endif
+
 void vApplicationMallocFailedHook(void)
 {
 	SerialConsoleWriteString("Error on memory allocation on FREERTOS!\r\n");
-	while (1)
-		;
+	CrashLogPanic(CRASH_MALLOC_FAILED, NULL, __builtin_return_address(0));
 }
 
-void vApplicationStackOverflowHook(void)
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
 {
+	(void)xTask;
 	SerialConsoleWriteString("Error on stack overflow on FREERTOS!\r\n");
-	while (1)
-		;
+	CrashLogPanic(CRASH_STACK_OVERFLOW, pcTaskName, __builtin_return_address(0));
+}
+
+void vAssertCalled(void)
+{
+	CrashLogPanic(CRASH_ASSERT, NULL, __builtin_return_address(0));
 }
@@ -0,0 +1,294 @@
+/**************************************************************************//**
+* @file        asf.h
+* @brief       Host stand-in for the ASF and FreeRTOS declarations SerialChannel.c uses.
+* @details     Found ahead of the project's asf.h by the tests that build the
+*				unmodified SerialChannel.c. The SERCOM USART and DMAC registers
+*				keep their names, bit positions and layout of fields; they are
+*				plain memory here, which channel_harness.h turns into a simulated
+*				SERCOM and DMAC. The functions are implemented there as well.
+*				Register and descriptor addresses are stored in 32-bit registers,
+*				so the tests are linked without PIE to keep static data below 4 GiB.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef ASF_H
+#define ASF_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* compiler.h, status_codes.h */
+#define COMPILER_ALIGNED(a)    __attribute__((aligned(a)))
+#define Min(a, b)              (((a) < (b)) ? (a) : (b))
+#define Max(a, b)              (((a) > (b)) ? (a) : (b))
+
+enum status_code {
+	STATUS_OK             = 0x00,
+	STATUS_BUSY           = 0x05,
+	STATUS_ERR_BAD_DATA   = 0x13,
+	STATUS_ERR_BAD_FORMAT = 0x1A,
+	STATUS_ERR_OVERFLOW   = 0x1E,
+	STATUS_ERR_DENIED     = 0x1C,
+};
+
+/* FreeRTOS */
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef void * TaskHandle_t;
+typedef struct TestSemaphore * SemaphoreHandle_t;
+typedef struct {
+	TickType_t start; ///< Tick count when the wait began
+} TimeOut_t;
+
+#define pdFALSE                 0
+#define pdTRUE                  1
+#define configTICK_RATE_HZ      1000
+#define portTICK_PERIOD_MS      1
+#define portMAX_DELAY           0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define configASSERT(x)         assert(x)
+#define portYIELD_FROM_ISR(x)   (void)(x)
+#define taskSCHEDULER_RUNNING   2
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t timeout);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t * woken);
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+BaseType_t xTaskGetSchedulerState(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+void vTaskSetTimeOutState(TimeOut_t * timeOut);
+BaseType_t xTaskCheckForTimeOut(TimeOut_t * timeOut, TickType_t * remaining);
+void vTaskDelay(TickType_t ticks);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t * woken);
+
+/* system_interrupt.h, CMSIS */
+typedef int IRQn_Type;
+#define DMAC_IRQn               6
+#define SERCOM0_IRQn            9
+
+uint32_t __get_IPSR(void);
+uint32_t __get_PRIMASK(void);
+void system_interrupt_enter_critical_section(void);
+void system_interrupt_leave_critical_section(void);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+void NVIC_EnableIRQ(IRQn_Type irq);
+
+/* clock.h, gclk.h */
+enum gclk_generator {
+	GCLK_GENERATOR_0 = 0,
+	GCLK_GENERATOR_1 = 1,
+};
+enum system_clock_apb_bus {
+	SYSTEM_CLOCK_APB_APBB = 1,
+};
+#define PM_AHBMASK_DMAC         (1u << 5)
+#define PM_APBBMASK_DMAC        (1u << 4)
+#define SERCOM0_GCLK_ID_CORE    20
+
+void system_ahb_clock_set_mask(uint32_t mask);
+void system_apb_clock_set_mask(enum system_clock_apb_bus bus, uint32_t mask);
+uint32_t system_gclk_chan_get_hz(uint8_t channel);
+
+/* port.h, pinmux.h */
+enum port_pin_dir {
+	PORT_PIN_DIR_INPUT  = 0,
+	PORT_PIN_DIR_OUTPUT = 1,
+};
+struct port_config {
+	enum port_pin_dir direction; ///< Input or output
+};
+#define PINMUX_DEFAULT          0
+#define PINMUX_UNUSED           0xFFFFFFFF
+
+void port_get_config_defaults(struct port_config * config);
+void port_pin_set_config(uint8_t pin, const struct port_config * config);
+void port_pin_set_output_level(uint8_t pin, bool level);
+
+/* component/sercom.h: the USART registers SerialChannel.c touches, with their bits */
+typedef struct { volatile uint32_t reg; } TestReg32;
+typedef struct { volatile uint16_t reg; } TestReg16;
+typedef struct { volatile uint8_t reg; } TestReg8;
+
+typedef struct {
+	TestReg32 CTRLA;
+	TestReg32 CTRLB;
+	TestReg16 BAUD;
+	TestReg8  INTENCLR;
+	TestReg8  INTENSET;
+	TestReg8  INTFLAG;
+	TestReg16 STATUS;
+	TestReg16 DATA;
+} SercomUsart;
+
+typedef union {
+	SercomUsart USART;
+} Sercom;
+
+#define SERCOM_INST_NUM              6
+#define SERCOM_USART_INTFLAG_DRE     (1u << 0)
+#define SERCOM_USART_INTFLAG_TXC     (1u << 1)
+#define SERCOM_USART_INTFLAG_RXC     (1u << 2)
+#define SERCOM_USART_INTFLAG_RXS     (1u << 3)
+#define SERCOM_USART_INTFLAG_CTSIC   (1u << 4)
+#define SERCOM_USART_INTFLAG_RXBRK   (1u << 5)
+#define SERCOM_USART_INTFLAG_ERROR   (1u << 7)
+#define SERCOM_USART_INTENCLR_CTSIC  SERCOM_USART_INTFLAG_CTSIC
+#define SERCOM_USART_STATUS_PERR     (1u << 0)
+#define SERCOM_USART_STATUS_FERR     (1u << 1)
+#define SERCOM_USART_STATUS_BUFOVF   (1u << 2)
+#define SERCOM_USART_STATUS_CTS      (1u << 3)
+#define SERCOM_USART_STATUS_MASK     0x003Fu
+#define SERCOM_USART_DATA_MASK       0x01FFu
+#define SERCOM0_DMAC_ID_RX           1
+#define SERCOM0_DMAC_ID_TX           2
+
+extern Sercom testSercom[SERCOM_INST_NUM];
+#define SERCOM0                 (&testSercom[0])
+#define SERCOM1                 (&testSercom[1])
+#define SERCOM2                 (&testSercom[2])
+#define SERCOM3                 (&testSercom[3])
+#define SERCOM4                 (&testSercom[4])
+#define SERCOM5                 (&testSercom[5])
+
+/* component/dmac.h */
+typedef struct {
+	TestReg16 BTCTRL;
+	TestReg16 BTCNT;
+	TestReg32 SRCADDR;
+	TestReg32 DSTADDR;
+	TestReg32 DESCADDR;
+} DmacDescriptor;
+
+typedef struct {
+	TestReg16 CTRL;
+	TestReg32 BASEADDR;
+	TestReg32 WRBADDR;
+	TestReg32 ACTIVE;
+	TestReg32 INTSTATUS;
+	TestReg8  CHID;
+	TestReg8  CHCTRLA;
+	TestReg32 CHCTRLB;
+	TestReg8  CHINTENCLR;
+	TestReg8  CHINTENSET;
+	TestReg8  CHINTFLAG;
+} Dmac;
+
+#define DMAC_CTRL_SWRST              (1u << 0)
+#define DMAC_CTRL_DMAENABLE          (1u << 1)
+#define DMAC_CTRL_LVLEN(value)       (0xF00u & ((value) << 8))
+#define DMAC_ACTIVE_ID_Pos           8
+#define DMAC_ACTIVE_ID_Msk           (0x1Fu << DMAC_ACTIVE_ID_Pos)
+#define DMAC_ACTIVE_ABUSY            (1u << 15)
+#define DMAC_ACTIVE_BTCNT_Pos        16
+#define DMAC_ACTIVE_BTCNT_Msk        (0xFFFFu << DMAC_ACTIVE_BTCNT_Pos)
+#define DMAC_CHID_ID(value)          (0xFu & (value))
+#define DMAC_CHCTRLA_SWRST           (1u << 0)
+#define DMAC_CHCTRLA_ENABLE          (1u << 1)
+#define DMAC_CHCTRLB_LVL(value)      (0x60u & ((value) << 5))
+#define DMAC_CHCTRLB_TRIGSRC_Pos     8
+#define DMAC_CHCTRLB_TRIGSRC(value)  (0x3F00u & ((value) << DMAC_CHCTRLB_TRIGSRC_Pos))
+#define DMAC_CHCTRLB_TRIGACT_BEAT    (2u << 22)
+#define DMAC_CHINTENSET_TERR         (1u << 0)
+#define DMAC_CHINTENSET_TCMPL        (1u << 1)
+#define DMAC_CHINTFLAG_TERR          (1u << 0)
+#define DMAC_CHINTFLAG_TCMPL         (1u << 1)
+#define DMAC_BTCTRL_VALID            (1u << 0)
+#define DMAC_BTCTRL_BLOCKACT_NOACT   (0u << 3)
+#define DMAC_BTCTRL_BLOCKACT_INT     (1u << 3)
+#define DMAC_BTCTRL_BEATSIZE_BYTE    (0u << 8)
+#define DMAC_BTCTRL_SRCINC           (1u << 10)
+#define DMAC_BTCTRL_DSTINC           (1u << 11)
+
+/// Every access to DMAC goes through the simulator, which applies the previous one first
+Dmac * test_dmac_access(void);
+#define DMAC                    (test_dmac_access())
+
+/* sercom.h, sercom_interrupt.h */
+enum sercom_asynchronous_operation_mode {
+	SERCOM_ASYNC_OPERATION_MODE_ARITHMETIC = 0,
+};
+enum sercom_asynchronous_sample_num {
+	SERCOM_ASYNC_SAMPLE_NUM_16 = 0,
+};
+typedef void (*sercom_handler_t)(uint8_t instance);
+
+uint8_t _sercom_get_sercom_inst_index(Sercom * const hw);
+IRQn_Type _sercom_get_interrupt_vector(Sercom * const hw);
+void _sercom_set_handler(const uint8_t instance, const sercom_handler_t interrupt_handler);
+enum status_code _sercom_get_async_baud_val(const uint32_t baudrate, const uint32_t peripheral_clock,
+                                            uint16_t * const baudval,
+                                            enum sercom_asynchronous_operation_mode mode,
+                                            enum sercom_asynchronous_sample_num sample_num);
+
+/* usart.h, usart_interrupt.h */
+enum usart_signal_mux_settings {
+	USART_RX_1_TX_0_XCK_1       = (1u << 20),
+	USART_RX_1_TX_0_RTS_2_CTS_3 = (1u << 20) | (2u << 16),
+};
+enum usart_callback {
+	USART_CALLBACK_BUFFER_TRANSMITTED,
+	USART_CALLBACK_BUFFER_RECEIVED,
+	USART_CALLBACK_ERROR,
+	USART_CALLBACK_CTS_INPUT_CHANGE,
+	USART_CALLBACK_N,
+};
+enum usart_transceiver_type {
+	USART_TRANSCEIVER_RX,
+	USART_TRANSCEIVER_TX,
+};
+
+struct usart_module;
+typedef void (*usart_callback_t)(struct usart_module * const module);
+
+struct usart_config {
+	uint32_t baudrate;
+	enum usart_signal_mux_settings mux_setting;
+	uint32_t pinmux_pad0;
+	uint32_t pinmux_pad1;
+	uint32_t pinmux_pad2;
+	uint32_t pinmux_pad3;
+	enum gclk_generator generator_source;
+	bool run_in_standby;
+	bool start_frame_detection_enable;
+};
+
+struct usart_module {
+	Sercom * hw;
+	bool receiver_enabled;
+	bool transmitter_enabled;
+	bool start_frame_detection_enabled;
+	usart_callback_t callback[USART_CALLBACK_N];
+	uint8_t * tx_buffer_ptr;
+	uint8_t * rx_buffer_ptr;
+	uint16_t remaining_tx_buffer_length;
+	uint16_t remaining_rx_buffer_length;
+	uint8_t callback_reg_mask;
+	uint8_t callback_enable_mask;
+	volatile enum status_code rx_status;
+	volatile enum status_code tx_status;
+};
+
+void usart_get_config_defaults(struct usart_config * const config);
+enum status_code usart_init(struct usart_module * const module, Sercom * const hw,
+                            const struct usart_config * const config);
+void usart_enable(const struct usart_module * const module);
+void usart_disable(const struct usart_module * const module);
+void usart_register_callback(struct usart_module * const module, usart_callback_t callback_func,
+                             enum usart_callback callback_type);
+void usart_enable_callback(struct usart_module * const module, enum usart_callback callback_type);
+enum status_code usart_write_buffer_job(struct usart_module * const module, uint8_t * tx_data, uint16_t length);
+enum status_code usart_read_buffer_job(struct usart_module * const module, uint8_t * rx_data, uint16_t length);
+enum status_code usart_get_job_status(struct usart_module * const module,
+                                      enum usart_transceiver_type transceiver_type);
+void _usart_interrupt_handler(uint8_t instance);
+
+#endif //ASF_H
@@ -0,0 +1,1100 @@
+/**************************************************************************//**
+* @file        channel_harness.h
+* @brief       A simulated SERCOM USART and DMAC, for the host tests of SerialChannel.c.
+* @details     Include right after SerialChannel.c, built over the host asf.h.
+*				The simulator keeps the state of the hardware and shows it in the
+*				registers: INTFLAG, STATUS and DATA read what the SERCOM holds,
+*				INTENSET/INTENCLR set and clear the interrupt mask, INTFLAG and
+*				STATUS clear the flags written as 1, and a write to DATA queues a
+*				character. Writes to the SERCOM take effect at the driver's next
+*				call into ASF or FreeRTOS, or when it returns to the simulator;
+*				every DMAC access is applied before the next one, so the banked
+*				channel registers behind CHID work as on the device. A character
+*				read from DATA cannot be seen: the one in DATA is taken when a
+*				handler ran with RXC pending and enabled, as the channel's handlers
+*				and the ASF driver always read it then.
+*
+*				Each SERCOM shifts one character out per 10 bit times once DATA
+*				holds one, to a peer that records it. With the RTS/CTS pads the
+*				transmitter honours CTS, which the test drives: the character being
+*				shifted out completes, the next one waits. Received characters go
+*				through a two-character buffer, BUFOVF when it overflows. The
+*				DMAC moves one byte per SERCOM trigger, follows the descriptor
+*				chain from the descriptor section, keeps the write-back section
+*				current and raises TCMPL at the end of a block with BLOCKACT_INT.
+*
+*				Interrupts are taken between two simulated events and never
+*				nest: a handler runs to completion, then the next pending one.
+*				Tasks are the test itself; a task that blocks (vTaskDelay,
+*				xSemaphoreTake) runs the simulator meanwhile. Handler calls are
+*				counted per SERCOM and for the DMAC, and so is the work of the
+*				SERCOM path: register writes, by the channel and by the ASF driver
+*				model, ASF jobs started and ASF callbacks. The FreeRTOS tick runs
+*				SerialChannelTickHook every millisecond. The nesting of critical
+*				sections is tracked, to tell work done with interrupts masked.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef CHANNEL_HARNESS_H_
+#define CHANNEL_HARNESS_H_
+
+#include <string.h>
+
+#define HARNESS_SENTINEL8      0x40u   ///< Unused bit of INTFLAG/INTENSET/INTENCLR/CHINTxxx: cleared by a write
+#define HARNESS_SENTINEL16     0x8000u ///< Unused bit of STATUS and DATA: cleared by a write
+#define HARNESS_SENTINEL32     0x80000000u ///< Unused bit of CHCTRLB: cleared by a write
+#define HARNESS_PEER_BYTES     (1u << 18) ///< Characters a peer records (power of two)
+#define HARNESS_TICK_NS        1000000u   ///< FreeRTOS tick
+#define HARNESS_WAIT_NS        10000u     ///< Step of a task blocked in the simulator
+#define HARNESS_FOREVER_NS     60000000000ull ///< Wait for a notification that means the test hangs
+#define HARNESS_IRQ_LIMIT      100000u    ///< Handler calls in a row that mean an interrupt storm
+
+/// One SERCOM USART and the device at the other end of its wire
+struct TestUart {
+	struct usart_module * module; ///< ASF driver instance, from usart_init
+	sercom_handler_t handler;     ///< Entry of the SERCOM handler table
+	uint64_t charNs;              ///< Time of one character, 8N1
+	bool enabled;                 ///< usart_enable
+	bool flowControl;             ///< RTS/CTS pads: the transmitter honours CTS
+	uint8_t intenset;             ///< Enabled interrupts
+	uint8_t events;               ///< TXC, CTSIC and ERROR, until written as 1
+	uint16_t status;              ///< PERR, FERR and BUFOVF, until written as 1
+
+	bool txHolding;               ///< DATA holds a character for the shift register
+	uint8_t txHold;               ///< That character
+	bool txShifting;              ///< A character is being shifted out
+	uint8_t txShift;              ///< That character
+	uint64_t txDoneNs;            ///< End of its stop bit
+	bool cts;                     ///< CTS is high: the peer holds the transmitter
+
+	uint8_t rxBuffer[2];          ///< Received characters, oldest first
+	uint8_t rxCount;              ///< Characters in rxBuffer
+	bool rxTaken;                 ///< The ASF driver read DATA in the current handler call
+
+	uint8_t peerRx[HARNESS_PEER_BYTES]; ///< What the peer received from us
+	uint32_t peerRxCount;         ///< Characters the peer received
+	const uint8_t * peerTxData;   ///< What the peer sends us, or NULL for harness_peer_byte()
+	uint32_t peerTxLeft;          ///< Characters the peer still has to send us
+	uint32_t peerTxCount;         ///< Characters the peer started sending
+	bool peerTxBusy;              ///< A character of the peer is on the wire
+	uint64_t peerTxDoneNs;        ///< Its arrival
+	uint8_t peerRtsPin;           ///< Our RTS GPIO, watched by the peer, or SERIAL_CHANNEL_NO_PIN
+	uint64_t peerReactNs;         ///< How long the peer takes to see RTS change
+
+	uint32_t irqs;                ///< SERCOM handler calls
+	uint32_t callbacks;           ///< Callbacks of the ASF driver into the channel
+	uint32_t jobs;                ///< ASF buffer jobs started
+	uint32_t regWrites;           ///< Register writes, by the channel and by the ASF driver
+	uint32_t txLost;              ///< Characters written to a full DATA register
+	uint32_t rxLost;              ///< Characters lost to BUFOVF
+};
+
+/// One DMAC channel
+struct TestDmaChannel {
+	bool enabled;                 ///< CHCTRLA.ENABLE
+	uint8_t intenset;             ///< Enabled interrupts
+	uint8_t flags;                ///< TCMPL and TERR, until written as 1
+	uint32_t ctrlb;               ///< CHCTRLB: trigger source and level
+	DmacDescriptor desc;          ///< Descriptor being executed
+	uint16_t beats;               ///< Beats of desc done
+};
+
+/// A GPIO output
+struct TestPin {
+	bool level;                   ///< Current level
+	bool previous;                ///< Level before the last change
+	uint64_t changedNs;           ///< Time of the last change
+};
+
+Sercom testSercom[SERCOM_INST_NUM];
+static Dmac testDmac;
+
+uint64_t testNowNs;               ///< Simulated time
+static struct TestUart testUart[SERCOM_INST_NUM];
+static struct TestDmaChannel testDma[CONF_SERIAL_CONSOLE_DMA_CHANNELS];
+static struct TestPin testPin[256];
+static bool testDmacEnabled;      ///< DMAC CTRL.DMAENABLE
+static uint8_t testDmaView;       ///< Channel the banked DMAC registers show
+static uint32_t testDmacIrqs;     ///< DMAC handler calls
+static uint64_t testNextTickNs;   ///< Time of the next FreeRTOS tick
+static bool testInInterrupt;      ///< A handler is running
+static uint32_t testCriticalDepth;    ///< Nesting of the critical sections entered
+static uint32_t testCriticalDepthMax; ///< Deepest nesting so far: work done inside another critical section
+
+/// Binary semaphores and task notifications
+struct TestSemaphore {
+	bool given;
+};
+static struct TestSemaphore testSemaphores[16];
+static size_t testSemaphoreCount;
+static uint32_t testNotifications;
+static uint32_t testNotifyGives; ///< Task notifications given
+static uint8_t testTaskHandle;
+
+static void harness_run(uint64_t ns);
+
+/// Address of a simulated object, as the 32-bit DMAC registers hold it
+static uint32_t harness_address(const volatile void * p)
+{
+	assert((uintptr_t)p <= UINT32_MAX); // Link without PIE
+	return (uint32_t)(uintptr_t)p;
+}
+
+/// The peer's view of a GPIO: it takes peerReactNs to notice a change
+static bool harness_peer_sees(struct TestUart * u, uint8_t pin)
+{
+	struct TestPin * p = &testPin[pin];
+
+	return (testNowNs - p->changedNs >= u->peerReactNs) ? p->level : p->previous;
+}
+
+/// Character n the peers send
+static uint8_t harness_peer_byte(uint32_t n)
+{
+	return (uint8_t)(n * 7u + (n >> 8));
+}
+
+/// SERCOM flags as INTFLAG shows them
+static uint8_t uart_flags(struct TestUart * u)
+{
+	uint8_t flags = u->events;
+
+	if(u->enabled && !u->txHolding)
+	{
+		flags |= SERCOM_USART_INTFLAG_DRE;
+	}
+	if(u->rxCount > 0)
+	{
+		flags |= SERCOM_USART_INTFLAG_RXC;
+	}
+	return flags;
+}
+
+/// A write to DATA
+static void uart_write_data(struct TestUart * u, uint8_t c)
+{
+	if(u->txHolding)
+	{
+		u->txLost++;
+		return;
+	}
+	u->txHold = c;
+	u->txHolding = true;
+	u->events &= ~SERCOM_USART_INTFLAG_TXC;
+}
+
+/// Takes the oldest received character out of the buffer
+static uint8_t uart_read_data(struct TestUart * u)
+{
+	uint8_t c = u->rxBuffer[0];
+
+	assert(u->rxCount > 0);
+	u->rxBuffer[0] = u->rxBuffer[1];
+	u->rxCount--;
+	return c;
+}
+
+/// Moves DATA to the shift register when it is free and CTS allows
+static bool uart_tx_kick(struct TestUart * u)
+{
+	if(!u->enabled || u->txShifting || !u->txHolding || (u->flowControl && u->cts))
+	{
+		return false;
+	}
+	u->txShift = u->txHold;
+	u->txHolding = false;
+	u->txShifting = true;
+	u->txDoneNs = testNowNs + u->charNs;
+	return true;
+}
+
+/// Resets a DMAC channel
+static void dma_reset(struct TestDmaChannel * c)
+{
+	memset(c, 0, sizeof(*c));
+}
+
+/// Fetches the first descriptor of a channel from the descriptor section
+static void dma_enable(unsigned id)
+{
+	struct TestDmaChannel * c = &testDma[id];
+	DmacDescriptor * section = (DmacDescriptor *)(uintptr_t)testDmac.BASEADDR.reg;
+	DmacDescriptor * writeback = (DmacDescriptor *)(uintptr_t)testDmac.WRBADDR.reg;
+
+	assert(section != NULL && writeback != NULL);
+	c->desc = section[id];
+	assert(c->desc.BTCTRL.reg & DMAC_BTCTRL_VALID);
+	c->beats = 0;
+	c->enabled = true;
+	writeback[id] = c->desc;
+}
+
+/// Moves one byte for a channel whose trigger is pending
+static bool dma_beat(unsigned id)
+{
+	struct TestDmaChannel * c = &testDma[id];
+	unsigned trigger = (c->ctrlb >> DMAC_CHCTRLB_TRIGSRC_Pos) & 0x3F;
+	struct TestUart * u = &testUart[(trigger - 1) / 2];
+	bool transmit = (trigger % 2) == 0;
+	uint16_t count = c->desc.BTCNT.reg;
+	uint16_t btctrl = c->desc.BTCTRL.reg;
+	DmacDescriptor * writeback = (DmacDescriptor *)(uintptr_t)testDmac.WRBADDR.reg;
+
+	if(!testDmacEnabled || !c->enabled || trigger == 0 || !u->enabled ||
+	   (transmit ? u->txHolding : u->rxCount == 0))
+	{
+		return false;
+	}
+
+	/* Incremented addresses point past the end of the block */
+	if(transmit)
+	{
+		assert((btctrl & DMAC_BTCTRL_SRCINC) && c->desc.DSTADDR.reg == harness_address(&u->module->hw->USART.DATA));
+		uart_write_data(u, *((uint8_t *)(uintptr_t)c->desc.SRCADDR.reg - count + c->beats));
+	}
+	else
+	{
+		assert((btctrl & DMAC_BTCTRL_DSTINC) && c->desc.SRCADDR.reg == harness_address(&u->module->hw->USART.DATA));
+		*((uint8_t *)(uintptr_t)c->desc.DSTADDR.reg - count + c->beats) = uart_read_data(u);
+	}
+
+	writeback[id] = c->desc;
+	writeback[id].BTCNT.reg = (uint16_t)(count - ++c->beats);
+	if(c->beats == count)
+	{
+		if(btctrl & DMAC_BTCTRL_BLOCKACT_INT)
+		{
+			c->flags |= DMAC_CHINTFLAG_TCMPL;
+		}
+		if(c->desc.DESCADDR.reg != 0)
+		{
+			c->desc = *(DmacDescriptor *)(uintptr_t)c->desc.DESCADDR.reg;
+			c->beats = 0;
+			writeback[id] = c->desc;
+		}
+		else
+		{
+			c->enabled = false;
+		}
+	}
+	return true;
+}
+
+/// Lets the hardware do what it does at this instant: the DMAC serves its
+/// triggers, higher levels first, and the transmitters load their shift registers
+static void harness_settle(void)
+{
+	bool progress;
+
+	do
+	{
+		progress = false;
+		for(unsigned i = 0; i < SERCOM_INST_NUM; i++)
+		{
+			progress |= uart_tx_kick(&testUart[i]);
+		}
+		for(int level = 3; level >= 0 && !progress; level--)
+		{
+			for(unsigned id = 0; id < CONF_SERIAL_CONSOLE_DMA_CHANNELS && !progress; id++)
+			{
+				if(((testDma[id].ctrlb >> 5) & 3) == (unsigned)level)
+				{
+					progress = dma_beat(id);
+				}
+			}
+		}
+	} while(progress);
+}
+
+/// Applies what the code wrote to the registers since they were last refreshed
+static void harness_apply(void)
+{
+	for(unsigned i = 0; i < SERCOM_INST_NUM; i++)
+	{
+		SercomUsart * r = &testSercom[i].USART;
+		struct TestUart * u = &testUart[i];
+
+		if(!(r->INTENSET.reg & HARNESS_SENTINEL8))
+		{
+			u->intenset |= r->INTENSET.reg;
+			u->regWrites++;
+		}
+		if(!(r->INTENCLR.reg & HARNESS_SENTINEL8))
+		{
+			u->intenset &= ~r->INTENCLR.reg;
+			u->regWrites++;
+		}
+		if(!(r->INTFLAG.reg & HARNESS_SENTINEL8))
+		{
+			u->events &= ~r->INTFLAG.reg;
+			u->regWrites++;
+		}
+		if(!(r->STATUS.reg & HARNESS_SENTINEL16))
+		{
+			u->status &= ~r->STATUS.reg;
+			u->regWrites++;
+		}
+		if(!(r->DATA.reg & HARNESS_SENTINEL16))
+		{
+			uart_write_data(u, (uint8_t)r->DATA.reg);
+			u->regWrites++;
+		}
+	}
+
+	struct TestDmaChannel * c = &testDma[testDmaView];
+	if(testDmac.CTRL.reg & DMAC_CTRL_SWRST)
+	{
+		for(unsigned id = 0; id < CONF_SERIAL_CONSOLE_DMA_CHANNELS; id++)
+		{
+			dma_reset(&testDma[id]);
+		}
+	}
+	testDmacEnabled = (testDmac.CTRL.reg & DMAC_CTRL_DMAENABLE) != 0;
+	if(testDmac.CHCTRLA.reg & DMAC_CHCTRLA_SWRST)
+	{
+		dma_reset(c);
+	}
+	else if((testDmac.CHCTRLA.reg & DMAC_CHCTRLA_ENABLE) && !c->enabled)
+	{
+		dma_enable(testDmaView);
+	}
+	else if(!(testDmac.CHCTRLA.reg & DMAC_CHCTRLA_ENABLE))
+	{
+		c->enabled = false;
+	}
+	if(!(testDmac.CHCTRLB.reg & HARNESS_SENTINEL32))
+	{
+		c->ctrlb = testDmac.CHCTRLB.reg;
+	}
+	if(!(testDmac.CHINTENSET.reg & HARNESS_SENTINEL8))
+	{
+		c->intenset |= testDmac.CHINTENSET.reg;
+	}
+	if(!(testDmac.CHINTENCLR.reg & HARNESS_SENTINEL8))
+	{
+		c->intenset &= ~testDmac.CHINTENCLR.reg;
+	}
+	if(!(testDmac.CHINTFLAG.reg & HARNESS_SENTINEL8))
+	{
+		c->flags &= ~testDmac.CHINTFLAG.reg;
+	}
+}
+
+/// Shows the state of the hardware in the registers
+static void harness_refresh(void)
+{
+	for(unsigned i = 0; i < SERCOM_INST_NUM; i++)
+	{
+		SercomUsart * r = &testSercom[i].USART;
+		struct TestUart * u = &testUart[i];
+
+		r->INTENSET.reg = u->intenset | HARNESS_SENTINEL8;
+		r->INTENCLR.reg = u->intenset | HARNESS_SENTINEL8;
+		r->INTFLAG.reg = uart_flags(u) | HARNESS_SENTINEL8;
+		r->STATUS.reg = u->status | (u->cts ? SERCOM_USART_STATUS_CTS : 0) | HARNESS_SENTINEL16;
+		r->DATA.reg = (u->rxCount > 0 ? u->rxBuffer[0] : 0) | HARNESS_SENTINEL16;
+	}
+
+	uint32_t pending = 0;
+	for(unsigned id = 0; id < CONF_SERIAL_CONSOLE_DMA_CHANNELS; id++)
+	{
+		if(testDma[id].flags & testDma[id].intenset)
+		{
+			pending |= 1u << id;
+		}
+	}
+	testDmaView = testDmac.CHID.reg & 0xF;
+	assert(testDmaView < CONF_SERIAL_CONSOLE_DMA_CHANNELS);
+	struct TestDmaChannel * c = &testDma[testDmaView];
+	testDmac.CTRL.reg = testDmacEnabled ? DMAC_CTRL_DMAENABLE : 0;
+	testDmac.INTSTATUS.reg = pending;
+	testDmac.ACTIVE.reg = 0; // The write-back section is always current
+	testDmac.CHCTRLA.reg = c->enabled ? DMAC_CHCTRLA_ENABLE : 0;
+	testDmac.CHCTRLB.reg = c->ctrlb | HARNESS_SENTINEL32;
+	testDmac.CHINTENSET.reg = c->intenset | HARNESS_SENTINEL8;
+	testDmac.CHINTENCLR.reg = c->intenset | HARNESS_SENTINEL8;
+	testDmac.CHINTFLAG.reg = c->flags | HARNESS_SENTINEL8;
+}
+
+/// Applies the register writes, lets the hardware react and shows the result
+static void harness_sync(void)
+{
+	harness_apply();
+	harness_settle();
+	harness_refresh();
+}
+
+Dmac * test_dmac_access(void)
+{
+	harness_sync();
+	return &testDmac;
+}
+
+/// Runs one handler as an interrupt
+static void harness_interrupt(void (*handler)(uint8_t), uint8_t instance)
+{
+	assert(!testInInterrupt);
+	testInInterrupt = true;
+	harness_sync();
+	handler(instance);
+	harness_sync();
+	testInInterrupt = false;
+}
+
+static void harness_dmac_handler(uint8_t instance)
+{
+	(void)instance;
+	DMAC_Handler();
+}
+
+static void harness_tick_handler(uint8_t instance)
+{
+	(void)instance;
+	SerialChannelTickHook();
+}
+
+/// Takes the pending interrupts until there is none
+static void harness_interrupts(void)
+{
+	if(testInInterrupt)
+	{
+		return;
+	}
+	for(unsigned calls = 0; ; calls++)
+	{
+		bool taken = false;
+
+		assert(calls < HARNESS_IRQ_LIMIT);
+		harness_sync();
+		for(unsigned i = 0; i < SERCOM_INST_NUM && !taken; i++)
+		{
+			struct TestUart * u = &testUart[i];
+			uint8_t pending = uart_flags(u) & u->intenset;
+
+			if(u->module == NULL || pending == 0)
+			{
+				continue;
+			}
+			u->irqs++;
+			u->rxTaken = false;
+			harness_interrupt(u->handler, (uint8_t)i);
+			if((pending & SERCOM_USART_INTFLAG_RXC) && !u->rxTaken)
+			{
+				uart_read_data(u); // The channel's handler read DATA
+				harness_sync();
+			}
+			taken = true;
+		}
+		if(!taken && testDmac.INTSTATUS.reg != 0)
+		{
+			testDmacIrqs++;
+			harness_interrupt(harness_dmac_handler, 0);
+			taken = true;
+		}
+		if(!taken)
+		{
+			return;
+		}
+	}
+}
+
+/// Starts the peer's next character when RTS lets it
+static void harness_peer_send(struct TestUart * u)
+{
+	if(u->peerTxBusy || u->peerTxLeft == 0 ||
+	   (u->peerRtsPin != SERIAL_CHANNEL_NO_PIN && harness_peer_sees(u, u->peerRtsPin)))
+	{
+		return;
+	}
+	u->peerTxBusy = true;
+	u->peerTxDoneNs = testNowNs + u->charNs;
+	u->peerTxLeft--;
+}
+
+/// Time of the next event of a SERCOM and its peer, if before limit
+static uint64_t harness_next_event(struct TestUart * u, uint64_t limit)
+{
+	if(u->txShifting && u->txDoneNs < limit)
+	{
+		limit = u->txDoneNs;
+	}
+	if(u->peerTxBusy && u->peerTxDoneNs < limit)
+	{
+		limit = u->peerTxDoneNs;
+	}
+	/* A peer held by RTS looks again when it notices a change */
+	if(!u->peerTxBusy && u->peerTxLeft > 0 && u->peerRtsPin != SERIAL_CHANNEL_NO_PIN)
+	{
+		uint64_t seen = testPin[u->peerRtsPin].changedNs + u->peerReactNs;
+		if(seen > testNowNs && seen < limit)
+		{
+			limit = seen;
+		}
+	}
+	return limit;
+}
+
+/// Completes what happens at testNowNs on a SERCOM and its wire
+static void harness_uart_events(struct TestUart * u)
+{
+	if(u->txShifting && u->txDoneNs == testNowNs)
+	{
+		u->peerRx[u->peerRxCount++ & (HARNESS_PEER_BYTES - 1)] = u->txShift;
+		u->txShifting = false;
+		harness_sync();
+		if(!u->txShifting && !u->txHolding)
+		{
+			u->events |= SERCOM_USART_INTFLAG_TXC;
+		}
+	}
+	if(u->peerTxBusy && u->peerTxDoneNs == testNowNs)
+	{
+		u->peerTxBusy = false;
+		if(u->rxCount < 2)
+		{
+			u->rxBuffer[u->rxCount++] = (u->peerTxData != NULL) ? u->peerTxData[u->peerTxCount]
+			                                                    : harness_peer_byte(u->peerTxCount);
+		}
+		else
+		{
+			u->status |= SERCOM_USART_STATUS_BUFOVF;
+			u->events |= SERCOM_USART_INTFLAG_ERROR;
+			u->rxLost++;
+		}
+		u->peerTxCount++;
+		harness_sync();
+	}
+}
+
+/// Advances the simulated time by ns, taking every event and interrupt on the way
+static void harness_run(uint64_t ns)
+{
+	uint64_t end = testNowNs + ns;
+
+	for(;;)
+	{
+		harness_interrupts();
+		for(unsigned i = 0; i < SERCOM_INST_NUM; i++)
+		{
+			harness_peer_send(&testUart[i]);
+		}
+
+		uint64_t next = Min(end, testNextTickNs);
+		for(unsigned i = 0; i < SERCOM_INST_NUM; i++)
+		{
+			next = harness_next_event(&testUart[i], next);
+		}
+		if(next > end)
+		{
+			break;
+		}
+		testNowNs = next;
+		for(unsigned i = 0; i < SERCOM_INST_NUM; i++)
+		{
+			harness_uart_events(&testUart[i]);
+		}
+		if(testNowNs == testNextTickNs)
+		{
+			testNextTickNs += HARNESS_TICK_NS;
+			harness_interrupt(harness_tick_handler, 0);
+		}
+		if(testNowNs == end)
+		{
+			harness_interrupts();
+			break;
+		}
+	}
+}
+
+/// Drives the CTS input of a SERCOM, as the peer's RTS: true holds our transmitter
+static void harness_set_cts(unsigned sercom, bool high)
+{
+	struct TestUart * u = &testUart[sercom];
+
+	harness_sync();
+	if(u->cts != high)
+	{
+		u->cts = high;
+		if(u->flowControl)
+		{
+			u->events |= SERCOM_USART_INTFLAG_CTSIC;
+		}
+	}
+	harness_interrupts();
+}
+
+/// Resets the simulated hardware and time; the channels must be initialized again
+static void harness_reset(void)
+{
+	memset(testSercom, 0, sizeof(testSercom));
+	memset(&testDmac, 0, sizeof(testDmac));
+	memset(testUart, 0, sizeof(testUart));
+	memset(testDma, 0, sizeof(testDma));
+	memset(testPin, 0, sizeof(testPin));
+	for(unsigned i = 0; i < SERCOM_INST_NUM; i++)
+	{
+		testUart[i].peerRtsPin = SERIAL_CHANNEL_NO_PIN;
+	}
+	memset(sercomChannels, 0, sizeof(sercomChannels));
+	memset(dmaChannelOwners, 0, sizeof(dmaChannelOwners));
+	dmaInitialized = false;
+	memset(testSemaphores, 0, sizeof(testSemaphores));
+	testSemaphoreCount = 0;
+	testNotifications = 0;
+	testNotifyGives = 0;
+	testDmacEnabled = false;
+	testDmaView = 0;
+	testDmacIrqs = 0;
+	testCriticalDepth = 0;
+	testCriticalDepthMax = 0;
+	testNowNs = 0;
+	testNextTickNs = HARNESS_TICK_NS;
+	harness_refresh();
+}
+
+/* FreeRTOS */
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+	assert(testSemaphoreCount < sizeof(testSemaphores) / sizeof(testSemaphores[0]));
+	return &testSemaphores[testSemaphoreCount++];
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t timeout)
+{
+	uint64_t waitedNs = 0;
+
+	harness_sync();
+	while(!semaphore->given && waitedNs < (uint64_t)timeout * HARNESS_TICK_NS)
+	{
+		harness_run(HARNESS_WAIT_NS);
+		waitedNs += HARNESS_WAIT_NS;
+	}
+	harness_sync();
+	bool given = semaphore->given;
+	semaphore->given = false;
+	return given ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+	harness_sync();
+	semaphore->given = true;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t * woken)
+{
+	harness_sync();
+	semaphore->given = true;
+	*woken = pdTRUE;
+	return pdTRUE;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	harness_sync();
+	return (TickType_t)(testNowNs / HARNESS_TICK_NS);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+	return xTaskGetTickCount();
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+	return taskSCHEDULER_RUNNING;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return &testTaskHandle;
+}
+
+void vTaskSetTimeOutState(TimeOut_t * timeOut)
+{
+	timeOut->start = xTaskGetTickCount();
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t * timeOut, TickType_t * remaining)
+{
+	TickType_t now = xTaskGetTickCount();
+	TickType_t elapsed = now - timeOut->start;
+
+	if(*remaining == portMAX_DELAY)
+	{
+		return pdFALSE;
+	}
+	if(elapsed >= *remaining)
+	{
+		*remaining = 0;
+		return pdTRUE;
+	}
+	*remaining -= elapsed;
+	timeOut->start = now;
+	return pdFALSE;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+	harness_sync();
+	harness_run((uint64_t)ticks * HARNESS_TICK_NS);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout)
+{
+	uint64_t waitedNs = 0;
+	uint32_t value;
+
+	harness_sync();
+	while(testNotifications == 0 && (timeout == portMAX_DELAY || waitedNs < (uint64_t)timeout * HARNESS_TICK_NS))
+	{
+		assert(waitedNs < HARNESS_FOREVER_NS); // Nothing will ever come
+		harness_run(HARNESS_WAIT_NS);
+		waitedNs += HARNESS_WAIT_NS;
+	}
+	harness_sync();
+	value = testNotifications;
+	testNotifications = clear ? 0 : value - (value != 0);
+	return value;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t * woken)
+{
+	(void)task;
+	harness_sync();
+	testNotifications++;
+	testNotifyGives++;
+	*woken = pdTRUE;
+}
+
+/* Interrupt control and clocks: sync points, the simulator never interrupts a task; critical sections
+ * only count their nesting */
+void system_interrupt_enter_critical_section(void)
+{
+	harness_sync();
+	testCriticalDepth++;
+	testCriticalDepthMax = Max(testCriticalDepthMax, testCriticalDepth);
+}
+
+void system_interrupt_leave_critical_section(void)
+{
+	assert(testCriticalDepth > 0);
+	testCriticalDepth--;
+	harness_sync();
+}
+
+/// Exception number while a handler runs
+uint32_t __get_IPSR(void)
+{
+	return testInInterrupt ? 16u + SERCOM0_IRQn : 0;
+}
+
+/// Interrupts are masked inside a critical section
+uint32_t __get_PRIMASK(void)
+{
+	return testCriticalDepth > 0;
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+	(void)irq;
+	(void)priority;
+	harness_sync();
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+	(void)irq;
+	harness_sync();
+}
+
+void system_ahb_clock_set_mask(uint32_t mask)
+{
+	(void)mask;
+	harness_sync();
+}
+
+void system_apb_clock_set_mask(enum system_clock_apb_bus bus, uint32_t mask)
+{
+	(void)bus;
+	(void)mask;
+	harness_sync();
+}
+
+uint32_t system_gclk_chan_get_hz(uint8_t channel)
+{
+	(void)channel;
+	return 48000000u;
+}
+
+/* GPIO */
+void port_get_config_defaults(struct port_config * config)
+{
+	config->direction = PORT_PIN_DIR_INPUT;
+}
+
+void port_pin_set_config(uint8_t pin, const struct port_config * config)
+{
+	(void)pin;
+	(void)config;
+	harness_sync();
+}
+
+void port_pin_set_output_level(uint8_t pin, bool level)
+{
+	struct TestPin * p = &testPin[pin];
+
+	harness_sync();
+	if(p->level != level)
+	{
+		p->previous = p->level;
+		p->level = level;
+		p->changedNs = testNowNs;
+	}
+}
+
+/* SERCOM */
+uint8_t _sercom_get_sercom_inst_index(Sercom * const hw)
+{
+	assert(hw >= testSercom && hw < testSercom + SERCOM_INST_NUM);
+	return (uint8_t)(hw - testSercom);
+}
+
+IRQn_Type _sercom_get_interrupt_vector(Sercom * const hw)
+{
+	return SERCOM0_IRQn + _sercom_get_sercom_inst_index(hw);
+}
+
+void _sercom_set_handler(const uint8_t instance, const sercom_handler_t interrupt_handler)
+{
+	harness_sync();
+	testUart[instance].handler = interrupt_handler;
+}
+
+enum status_code _sercom_get_async_baud_val(const uint32_t baudrate, const uint32_t peripheral_clock,
+                                            uint16_t * const baudval,
+                                            enum sercom_asynchronous_operation_mode mode,
+                                            enum sercom_asynchronous_sample_num sample_num)
+{
+	(void)mode;
+	(void)sample_num;
+	if(baudrate * 16ull > peripheral_clock)
+	{
+		return STATUS_ERR_BAD_DATA;
+	}
+	*baudval = (uint16_t)(65536ull - 65536ull * 16 * baudrate / peripheral_clock);
+	return STATUS_OK;
+}
+
+/* USART driver: usart.c and usart_interrupt.c, on the simulated SERCOM */
+void usart_get_config_defaults(struct usart_config * const config)
+{
+	memset(config, 0, sizeof(*config));
+	config->baudrate = 9600;
+	config->mux_setting = USART_RX_1_TX_0_XCK_1;
+}
+
+enum status_code usart_init(struct usart_module * const module, Sercom * const hw,
+                            const struct usart_config * const config)
+{
+	struct TestUart * u = &testUart[_sercom_get_sercom_inst_index(hw)];
+
+	harness_sync();
+	memset(module, 0, sizeof(*module));
+	module->hw = hw;
+	module->receiver_enabled = true;
+	module->transmitter_enabled = true;
+	module->start_frame_detection_enabled = config->start_frame_detection_enable;
+	module->tx_status = STATUS_OK;
+	module->rx_status = STATUS_OK;
+
+	u->module = module;
+	u->handler = _usart_interrupt_handler;
+	u->charNs = (10ull * 1000000000u + config->baudrate / 2) / config->baudrate;
+	u->flowControl = config->mux_setting == USART_RX_1_TX_0_RTS_2_CTS_3;
+	u->enabled = false;
+	u->intenset = 0;
+	u->events = 0;
+	harness_refresh();
+	return STATUS_OK;
+}
+
+void usart_enable(const struct usart_module * const module)
+{
+	harness_sync();
+	testUart[_sercom_get_sercom_inst_index(module->hw)].enabled = true;
+	harness_sync();
+}
+
+void usart_disable(const struct usart_module * const module)
+{
+	harness_sync();
+	testUart[_sercom_get_sercom_inst_index(module->hw)].enabled = false;
+	harness_sync();
+}
+
+void usart_register_callback(struct usart_module * const module, usart_callback_t callback_func,
+                             enum usart_callback callback_type)
+{
+	module->callback[callback_type] = callback_func;
+	module->callback_reg_mask |= (uint8_t)(1u << callback_type);
+}
+
+void usart_enable_callback(struct usart_module * const module, enum usart_callback callback_type)
+{
+	module->callback_enable_mask |= (uint8_t)(1u << callback_type);
+}
+
+enum status_code usart_write_buffer_job(struct usart_module * const module, uint8_t * tx_data, uint16_t length)
+{
+	harness_sync();
+	if(length == 0 || module->remaining_tx_buffer_length > 0)
+	{
+		return (length == 0) ? STATUS_ERR_DENIED : STATUS_BUSY;
+	}
+	struct TestUart * u = &testUart[_sercom_get_sercom_inst_index(module->hw)];
+	module->remaining_tx_buffer_length = length;
+	module->tx_buffer_ptr = tx_data;
+	module->tx_status = STATUS_BUSY;
+	u->intenset |= SERCOM_USART_INTFLAG_DRE;
+	u->jobs++;
+	u->regWrites++;
+	harness_sync();
+	return STATUS_OK;
+}
+
+enum status_code usart_read_buffer_job(struct usart_module * const module, uint8_t * rx_data, uint16_t length)
+{
+	harness_sync();
+	if(length == 0 || module->remaining_rx_buffer_length > 0)
+	{
+		return (length == 0) ? STATUS_ERR_DENIED : STATUS_BUSY;
+	}
+	struct TestUart * u = &testUart[_sercom_get_sercom_inst_index(module->hw)];
+	module->remaining_rx_buffer_length = length;
+	module->rx_buffer_ptr = rx_data;
+	module->rx_status = STATUS_BUSY;
+	u->intenset |= SERCOM_USART_INTFLAG_RXC;
+	u->jobs++;
+	u->regWrites++;
+	harness_sync();
+	return STATUS_OK;
+}
+
+enum status_code usart_get_job_status(struct usart_module * const module,
+                                      enum usart_transceiver_type transceiver_type)
+{
+	return (transceiver_type == USART_TRANSCEIVER_TX) ? module->tx_status : module->rx_status;
+}
+
+/// Calls back into the code under test, with the registers up to date on both sides
+static void usart_callback(struct usart_module * const module, enum usart_callback type)
+{
+	if(module->callback_reg_mask & module->callback_enable_mask & (1u << type))
+	{
+		testUart[_sercom_get_sercom_inst_index(module->hw)].callbacks++;
+		harness_sync();
+		module->callback[type](module);
+		harness_sync();
+	}
+}
+
+/// _usart_interrupt_handler of ASF, step for step
+void _usart_interrupt_handler(uint8_t instance)
+{
+	struct TestUart * u = &testUart[instance];
+	struct usart_module * module = u->module;
+
+	harness_sync();
+	uint8_t status = uart_flags(u) & u->intenset;
+
+	if(status & SERCOM_USART_INTFLAG_DRE)
+	{
+		if(module->remaining_tx_buffer_length)
+		{
+			uart_write_data(u, *module->tx_buffer_ptr++);
+			u->regWrites++;
+			if(--module->remaining_tx_buffer_length == 0)
+			{
+				u->intenset &= ~SERCOM_USART_INTFLAG_DRE;
+				u->intenset |= SERCOM_USART_INTFLAG_TXC;
+				u->regWrites += 2;
+			}
+		}
+		else
+		{
+			u->intenset &= ~SERCOM_USART_INTFLAG_DRE;
+			u->regWrites++;
+		}
+	}
+
+	if(status & SERCOM_USART_INTFLAG_TXC)
+	{
+		u->intenset &= ~SERCOM_USART_INTFLAG_TXC;
+		u->regWrites++;
+		module->tx_status = STATUS_OK;
+		usart_callback(module, USART_CALLBACK_BUFFER_TRANSMITTED);
+	}
+
+	if(status & SERCOM_USART_INTFLAG_RXC)
+	{
+		if(module->remaining_rx_buffer_length)
+		{
+			uint8_t error = u->status & (SERCOM_USART_STATUS_PERR | SERCOM_USART_STATUS_FERR |
+			                             SERCOM_USART_STATUS_BUFOVF);
+			if(error)
+			{
+				if(error & SERCOM_USART_STATUS_FERR)
+				{
+					module->rx_status = STATUS_ERR_BAD_FORMAT;
+					u->status &= ~SERCOM_USART_STATUS_FERR;
+				}
+				else if(error & SERCOM_USART_STATUS_BUFOVF)
+				{
+					module->rx_status = STATUS_ERR_OVERFLOW;
+					u->status &= ~SERCOM_USART_STATUS_BUFOVF;
+				}
+				else
+				{
+					module->rx_status = STATUS_ERR_BAD_DATA;
+					u->status &= ~SERCOM_USART_STATUS_PERR;
+				}
+				u->regWrites++;
+				usart_callback(module, USART_CALLBACK_ERROR);
+			}
+			else
+			{
+				*module->rx_buffer_ptr++ = uart_read_data(u);
+				u->rxTaken = true;
+				if(--module->remaining_rx_buffer_length == 0)
+				{
+					u->intenset &= ~SERCOM_USART_INTFLAG_RXC;
+					u->regWrites++;
+					module->rx_status = STATUS_OK;
+					usart_callback(module, USART_CALLBACK_BUFFER_RECEIVED);
+				}
+			}
+		}
+		else
+		{
+			u->intenset &= ~SERCOM_USART_INTFLAG_RXC;
+			u->regWrites++;
+		}
+	}
+
+	if(status & SERCOM_USART_INTFLAG_CTSIC)
+	{
+		u->intenset &= ~SERCOM_USART_INTFLAG_CTSIC;
+		u->events &= ~SERCOM_USART_INTFLAG_CTSIC;
+		u->regWrites += 2;
+		usart_callback(module, USART_CALLBACK_CTS_INPUT_CHANGE);
+	}
+	harness_refresh();
+}
+
+#endif //CHANNEL_HARNESS_H_
@@ -0,0 +1,186 @@
+/**************************************************************************//**
+* @file        link_harness.h
+* @brief       Two SerialLinks over a simulated UART, for the host tests of SerialLink.c.
+* @details     Include right after SerialLink.c, whose local functions the
+*				harness calls in place of the transmit and receive tasks. Each
+*				direction of the wire sends one byte per WIRE_BYTE_US and delivers
+*				it WIRE_LATENCY_US after its stop bit; a frame written to it can be
+*				damaged with a given probability, one byte flipped, which the
+*				receiver then drops on its CRC or framing.
+*
+*				harness_step() advances the clock by HARNESS_STEP_US and runs
+*				both links: the receive side drains the wire like link_rx_task,
+*				the transmit side runs the loop of link_tx_task while a whole
+*				frame fits in the simulated TX ring. Where the task would block in
+*				a write to a full ring, the harness holds the transmit side back
+*				until there is room instead, so the priorities are re-evaluated at
+*				the same points.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef LINK_HARNESS_H_
+#define LINK_HARNESS_H_
+
+#define WIRE_BAUD          115200u                        ///< Line rate, 8N1
+#define WIRE_BYTE_US       (10u * 1000000u / WIRE_BAUD)   ///< Time of one character on the wire
+#define WIRE_LATENCY_US    500u                           ///< Stop bit to the peer's receive task
+#define WIRE_TX_RING       512u                           ///< TX ring of the console channel
+#define WIRE_QUEUE         (1u << 14)                     ///< Bytes written and not read yet (power of two)
+#define HARNESS_STEP_US    100u                           ///< Simulated time between two runs of the links
+
+/// One direction of the wire
+struct TestWire {
+	uint8_t data[WIRE_QUEUE];    ///< Bytes written
+	uint32_t doneUs[WIRE_QUEUE]; ///< End of each byte's stop bit
+	uint32_t head;               ///< Bytes ever written
+	uint32_t sent;               ///< Bytes ever shifted out completely
+	uint32_t tail;               ///< Bytes ever read
+	uint32_t busyUs;             ///< End of the last byte's stop bit
+};
+
+uint32_t testNowUs;
+
+static struct TestWire testWire[2];
+static struct SerialChannel testChannel[2] = { { 0 }, { 1 } };
+static struct SerialLink testLink[2];
+static unsigned testLossPercent; ///< Chance that a frame is damaged on the wire
+static uint32_t testRandom;      ///< xorshift32 state
+static uint32_t testDamaged;     ///< Frames damaged so far
+
+/// Deterministic pseudo-random numbers, so a failure can be replayed
+static uint32_t harness_random(void)
+{
+	testRandom ^= testRandom << 13;
+	testRandom ^= testRandom >> 17;
+	testRandom ^= testRandom << 5;
+	return testRandom;
+}
+
+/// Bytes of a wire still waiting in the sender's TX ring or shift register
+static uint32_t harness_tx_backlog(struct TestWire * wire)
+{
+	while(wire->sent != wire->head && wire->doneUs[wire->sent & (WIRE_QUEUE - 1)] <= testNowUs)
+	{
+		wire->sent++;
+	}
+	return wire->head - wire->sent;
+}
+
+size_t SerialChannelRead(struct SerialChannel * ch, uint8_t * data, size_t len)
+{
+	struct TestWire * wire = &testWire[ch->id ^ 1];
+	size_t n = 0;
+
+	while(n < len && wire->tail != wire->head &&
+	      wire->doneUs[wire->tail & (WIRE_QUEUE - 1)] + WIRE_LATENCY_US <= testNowUs)
+	{
+		data[n++] = wire->data[wire->tail++ & (WIRE_QUEUE - 1)];
+	}
+	return n;
+}
+
+bool SerialChannelWaitForData(struct SerialChannel * ch, TickType_t timeout)
+{
+	(void)ch;
+	(void)timeout;
+	return false;
+}
+
+bool SerialChannelWritePolicy(struct SerialChannel * ch, const uint8_t * data, size_t len, enum eTxPolicy policy,
+                              TickType_t timeout)
+{
+	struct TestWire * wire = &testWire[ch->id];
+	size_t damaged = len;
+
+	(void)policy;
+	(void)timeout;
+	assert(wire->head - wire->tail + len <= WIRE_QUEUE);
+	if(harness_random() % 100 < testLossPercent)
+	{
+		damaged = harness_random() % len;
+		testDamaged++;
+	}
+
+	wire->busyUs = Max(wire->busyUs, testNowUs);
+	for(size_t i = 0; i < len; i++)
+	{
+		uint32_t slot = wire->head++ & (WIRE_QUEUE - 1);
+		wire->busyUs += WIRE_BYTE_US;
+		wire->doneUs[slot] = wire->busyUs;
+		wire->data[slot] = (i == damaged) ? (uint8_t)(data[i] ^ (1 + harness_random() % 255)) : data[i];
+	}
+	return true;
+}
+
+void SerialChannelSetErrorHandler(struct SerialChannel * ch, SerialChannelErrorHandler handler, void * ctx)
+{
+	(void)ch;
+	(void)handler;
+	(void)ctx;
+}
+
+/// Resets the clock and the wire and initializes both links; frames are damaged with lossPercent % chance
+static void harness_init(unsigned lossPercent, uint32_t seed)
+{
+	testNowUs = 0;
+	memset(testWire, 0, sizeof(testWire));
+	testLossPercent = lossPercent;
+	testRandom = seed | 1;
+	testDamaged = 0;
+	for(unsigned i = 0; i < 2; i++)
+	{
+		SerialLinkInit(&testLink[i], &testChannel[i]);
+	}
+}
+
+/// Receive side of link i: what link_rx_task does with the bytes that have arrived
+static void harness_rx(unsigned i)
+{
+	uint8_t chunk[LINK_RX_CHUNK_SIZE];
+	size_t n;
+
+	while((n = SerialChannelRead(&testChannel[i], chunk, sizeof(chunk))) != 0)
+	{
+		link_rx_bytes(&testLink[i], chunk, n);
+	}
+}
+
+/// Transmit side of link i: the loop of link_tx_task, for as long as a frame fits in the TX ring
+static bool harness_tx_room(unsigned i)
+{
+	return harness_tx_backlog(&testWire[i]) + SERIAL_LINK_WIRE_MAX <= WIRE_TX_RING;
+}
+
+static void harness_tx(unsigned i)
+{
+	struct SerialLink * link = &testLink[i];
+	enum eLinkChannel channel = LINK_CHANNEL_CONTROL;
+
+	if(!harness_tx_room(i))
+	{
+		return;
+	}
+	link_arq_service(link);
+	while(harness_tx_room(i) && link_tx_next(link, &channel))
+	{
+		link_tx_frame(link, channel);
+		link_arq_service(link);
+	}
+}
+
+/// Advances the clock by one step and runs both links
+static void harness_step(void)
+{
+	testNowUs += HARNESS_STEP_US;
+	for(unsigned i = 0; i < 2; i++)
+	{
+		harness_rx(i);
+		harness_tx(i);
+	}
+}
+
+#endif //LINK_HARNESS_H_
@@ -0,0 +1,94 @@
+/**************************************************************************//**
+* @file        link_test_stubs.h
+* @brief       Host stand-ins for SerialChannel.h and the FreeRTOS/ASF calls of SerialLink.c.
+* @details     Force-included (-include) ahead of the link sources. Defining
+*				SERIAL_CHANNEL_H keeps the real header, which needs asf.h, out;
+*				this one declares the part of it SerialLink.c uses and link_harness.h
+*				implements it over a simulated wire. The tick count follows the
+*				simulated clock, the tasks are never started: the harness calls
+*				their steps itself.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef LINK_TEST_STUBS_H_
+#define LINK_TEST_STUBS_H_
+
+#define SERIAL_CHANNEL_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+
+/* One task and no interrupts: nothing to mask */
+#define MPSC_RING_ENTER_CRITICAL()
+#define MPSC_RING_LEAVE_CRITICAL()
+
+#include "spsc_ring.h"
+#include "mpsc_ring.h"
+#include "console_format.h"
+#include "conf_serial_console.h"
+
+/* FreeRTOS */
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef void * TaskHandle_t;
+
+#define pdFALSE                0
+#define pdTRUE                 1
+#define pdPASS                 1
+#define portMAX_DELAY          0xFFFFFFFFu
+#define portTICK_PERIOD_MS     1
+#define pdMS_TO_TICKS(ms)      ((TickType_t)(ms))
+#define configMAX_PRIORITIES   5
+#define configASSERT(x)        assert(x)
+#define portYIELD_FROM_ISR(x)  (void)(x)
+
+/// Simulated time in microseconds, advanced by the harness
+extern uint32_t testNowUs;
+
+static inline TickType_t xTaskGetTickCount(void) { return testNowUs / 1000u; }
+static inline void xTaskNotifyGive(TaskHandle_t task) { (void)task; }
+static inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) { (void)task; (void)woken; }
+static inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) { (void)clear; (void)wait; return 0; }
+static inline BaseType_t xTaskCreate(void (*task)(void *), const char *name, uint32_t stack, void *param,
+                                     uint32_t priority, TaskHandle_t *handle)
+{
+	(void)task; (void)name; (void)stack; (void)param; (void)priority;
+	*handle = handle;
+	return pdPASS;
+}
+
+/* ASF */
+#define Min(a, b)              (((a) < (b)) ? (a) : (b))
+#define Max(a, b)              (((a) > (b)) ? (a) : (b))
+
+static inline uint32_t __get_IPSR(void) { return 0; }
+static inline void system_interrupt_enter_critical_section(void) { }
+static inline void system_interrupt_leave_critical_section(void) { }
+
+/* SerialChannel.h */
+enum eTxPolicy {
+	TX_POLICY_BLOCK = 0
+};
+
+/// A simulated UART: id is the direction of the wire it transmits on
+struct SerialChannel {
+	unsigned id;
+};
+
+typedef void (*SerialChannelErrorHandler)(void *ctx, uint8_t status);
+
+size_t SerialChannelRead(struct SerialChannel *ch, uint8_t *data, size_t len);
+bool SerialChannelWaitForData(struct SerialChannel *ch, TickType_t timeout);
+bool SerialChannelWritePolicy(struct SerialChannel *ch, const uint8_t *data, size_t len, enum eTxPolicy policy,
+                              TickType_t timeout);
+void SerialChannelSetErrorHandler(struct SerialChannel *ch, SerialChannelErrorHandler handler, void *ctx);
+
+#endif //LINK_TEST_STUBS_H_
@@ -0,0 +1,24 @@
+/**************************************************************************//**
+* @file        mpsc_test_lock.h
+* @brief       Mutex standing in for the interrupt mask of mpsc_ring on the host.
+* @details     Force-included (-include) into test_mpsc_ring and mpsc_ring.c, so
+*				both see the same MPSC_RING_ENTER/LEAVE_CRITICAL.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef MPSC_TEST_LOCK_H_
+#define MPSC_TEST_LOCK_H_
+
+#include <pthread.h>
+
+/// Lock of the mpsc_ring critical sections, defined in test_mpsc_ring.c
+extern pthread_mutex_t mpscTestLock;
+
+#define MPSC_RING_ENTER_CRITICAL()    pthread_mutex_lock(&mpscTestLock)
+#define MPSC_RING_LEAVE_CRITICAL()    pthread_mutex_unlock(&mpscTestLock)
+
+#endif //MPSC_TEST_LOCK_H_
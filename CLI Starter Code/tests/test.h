@@ -0,0 +1,39 @@
+/**************************************************************************//**
+* @file        test.h
+* @brief       Minimal assertions for the host tests.
+* @details     A failed CHECK prints its location and the failed expression and
+*				counts the failure; test_result() turns the count into the exit
+*				status, so `make check` stops at the first failing test program.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+
+/// Failed checks so far in this test program
+static unsigned testFailures;
+
+/// Checks a condition, reporting it and carrying on if it is false
+#define CHECK(cond) \
+	do { \
+		if(!(cond)) \
+		{ \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			testFailures++; \
+		} \
+	} while(0)
+
+/// Prints the verdict of the test program; returns its exit status
+static inline int test_result(const char * name)
+{
+	printf("%s: %s\n", name, testFailures ? "FAILED" : "ok");
+	return testFailures ? 1 : 0;
+}
+
+#endif //TEST_H_
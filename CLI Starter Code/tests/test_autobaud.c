@@ -0,0 +1,205 @@
+/**************************************************************************//**
+* @file        test_autobaud.c
+* @brief       Host test of the baud rate estimation, autobaud.c.
+* @details     The RX line is drawn as 8N1 characters and idle or BREAK spans,
+*				and its edges are timestamped as TC3 would, at 48 MHz and at
+*				8 MHz. For every standard rate from 1200 to 460800 Bd:
+*				- a 'U' alone, a BREAK then 'U', and a CR then 'U' give the rate;
+*				- so do they with the host 2 % fast or slow, and with every edge
+*				  moved by up to 2 % of a bit;
+*				- text without a 'U', and a 'U' with one bit far off, give 0.
+*				autobaud_is_break() is checked against a BREAK and against NUL,
+*				the longest low level of a character, and autobaud_snap() against
+*				rates near and between the standard ones.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include <string.h>
+
+#include "autobaud.h"
+#include "test.h"
+
+#define MAX_EDGES       128u     ///< Edges of one drawn line
+#define JITTER_PERCENT  2        ///< Largest move of an edge, in percent of a bit
+#define RATE_PERCENT    2        ///< Rate error of the host, in percent
+
+static const uint32_t rates[] = {
+	1200, 2400, 4800, 9600, 14400, 19200, 28800, 38400, 57600, 76800, 115200, 230400, 460800
+};
+
+static const uint32_t clocks[] = { 48000000, 8000000 };
+
+/// A drawn RX line: its edges in timer ticks
+struct Line {
+	double bitTicks;            ///< Bit time of the host
+	double now;                 ///< End of what is drawn, in ticks
+	bool level;                 ///< Level at now
+	uint32_t edges[MAX_EDGES];  ///< Edge timestamps
+	size_t count;               ///< Edges drawn
+	unsigned jitter;            ///< Largest move of an edge, in percent of a bit
+	uint32_t seed;              ///< State of the jitter generator
+};
+
+/// Starts an idle line at baud, with the host rate off by ratePermille
+static void line_start(struct Line * line, uint32_t baud, int ratePermille, uint32_t clockHz, unsigned jitter)
+{
+	memset(line, 0, sizeof(*line));
+	line->bitTicks = (double)clockHz / baud * 1000.0 / (1000 + ratePermille);
+	line->now = 1000.0;
+	line->level = true;
+	line->jitter = jitter;
+	line->seed = baud ^ clockHz;
+}
+
+/// Holds level for bits bit times, with an edge at the start if the level changes
+static void line_level(struct Line * line, bool level, double bits)
+{
+	if(level != line->level)
+	{
+		double at = line->now;
+		if(line->jitter > 0)
+		{
+			line->seed = line->seed * 1103515245u + 12345u;
+			double unit = (double)((line->seed >> 8) % 2001u) / 1000.0 - 1.0; // -1 to 1
+			at += unit * line->bitTicks * line->jitter / 100.0;
+		}
+		if(line->count < MAX_EDGES)
+		{
+			line->edges[line->count++] = (uint32_t)(at + 0.5);
+		}
+		line->level = level;
+	}
+	line->now += bits * line->bitTicks;
+}
+
+/// Draws one 8N1 character
+static void line_char(struct Line * line, uint8_t c)
+{
+	line_level(line, false, 1);
+	for(unsigned bit = 0; bit < 8; bit++)
+	{
+		line_level(line, (c >> bit) & 1, 1);
+	}
+	line_level(line, true, 1);
+}
+
+/// Draws a string of characters back to back
+static void line_text(struct Line * line, const char * text)
+{
+	while(*text)
+	{
+		line_char(line, (uint8_t)*text++);
+	}
+}
+
+/// Estimate of what was drawn
+static uint32_t line_estimate(const struct Line * line, uint32_t clockHz)
+{
+	return autobaud_estimate(line->edges, line->count, clockHz);
+}
+
+/// The sync character after nothing, a BREAK, or a CR, at the given rate error and jitter
+static void check_sync(uint32_t baud, uint32_t clockHz, int ratePermille, unsigned jitter)
+{
+	struct Line line;
+
+	line_start(&line, baud, ratePermille, clockHz, jitter);
+	line_char(&line, 'U');
+	CHECK(line_estimate(&line, clockHz) == baud);
+
+	/* A BREAK of two characters at the slowest rate, idle, then 'U' */
+	line_start(&line, baud, ratePermille, clockHz, jitter);
+	line_level(&line, false, 20.0 * baud / AUTOBAUD_MIN_BAUD);
+	line_level(&line, true, 3);
+	line_char(&line, 'U');
+	CHECK(line_estimate(&line, clockHz) == baud);
+
+	/* A terminal sends Enter, then the sync character right after it */
+	line_start(&line, baud, ratePermille, clockHz, jitter);
+	line_text(&line, "\rU");
+	CHECK(line_estimate(&line, clockHz) == baud);
+}
+
+/// Lines without a sync character at baud
+static void check_rejected(uint32_t baud, uint32_t clockHz)
+{
+	struct Line line;
+
+	line_start(&line, baud, 0, clockHz, 0);
+	line_text(&line, "help\r\n");
+	CHECK(line_estimate(&line, clockHz) == 0);
+
+	/* A BREAK alone */
+	line_start(&line, baud, 0, clockHz, 0);
+	line_level(&line, false, 20.0 * baud / AUTOBAUD_MIN_BAUD);
+	line_level(&line, true, 3);
+	CHECK(line_estimate(&line, clockHz) == 0);
+
+	/* 'U' with its fifth data bit half as long again: a glitch, not a rate */
+	line_start(&line, baud, 0, clockHz, 0);
+	line_level(&line, false, 1);
+	for(unsigned bit = 0; bit < 8; bit++)
+	{
+		line_level(&line, bit & 1 ? false : true, bit == 4 ? 1.5 : 1);
+	}
+	line_level(&line, true, 1);
+	CHECK(line_estimate(&line, clockHz) == 0);
+}
+
+/// BREAK detection against the longest low level of a character
+static void check_break(uint32_t clockHz)
+{
+	uint32_t breakTicks = clockHz / AUTOBAUD_MIN_BAUD * 20;
+	/* NUL: the start bit and eight data bits low */
+	uint32_t nulTicks = clockHz / AUTOBAUD_MIN_BAUD * 9;
+
+	CHECK(autobaud_is_break(breakTicks, clockHz));
+	/* A whole character at the slowest rate, rounded up to a tick */
+	CHECK(autobaud_is_break((clockHz * 10 + AUTOBAUD_MIN_BAUD - 1) / AUTOBAUD_MIN_BAUD, clockHz));
+	CHECK(!autobaud_is_break(nulTicks, clockHz));
+	CHECK(!autobaud_is_break(clockHz / 115200, clockHz));
+}
+
+/// Snapping to the standard rates
+static void check_snap(void)
+{
+	for(size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+	{
+		CHECK(autobaud_snap(rates[i]) == rates[i]);
+		CHECK(autobaud_snap(rates[i] * 103 / 100) == rates[i]);
+		CHECK(autobaud_snap(rates[i] * 97 / 100) == rates[i]);
+	}
+	/* Too far from any standard rate: kept as measured */
+	CHECK(autobaud_snap(100000) == 100000);
+	CHECK(autobaud_snap(115200 * 108 / 100) == 115200 * 108 / 100);
+	CHECK(autobaud_snap(200000) == 200000);
+}
+
+int main(void)
+{
+	for(size_t k = 0; k < sizeof(clocks) / sizeof(clocks[0]); k++)
+	{
+		for(size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+		{
+			check_sync(rates[i], clocks[k], 0, 0);
+			check_sync(rates[i], clocks[k], RATE_PERCENT * 10, 0);
+			check_sync(rates[i], clocks[k], -RATE_PERCENT * 10, 0);
+			check_sync(rates[i], clocks[k], 0, JITTER_PERCENT);
+			check_rejected(rates[i], clocks[k]);
+		}
+		check_break(clocks[k]);
+	}
+
+	/* Faster than the SERCOM can sample at the timer clock */
+	struct Line line;
+	line_start(&line, 921600, 0, 8000000, 0);
+	line_char(&line, 'U');
+	CHECK(line_estimate(&line, 8000000) == 0);
+
+	check_snap();
+	return test_result("autobaud");
+}
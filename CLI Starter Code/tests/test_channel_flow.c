@@ -0,0 +1,196 @@
+/**************************************************************************//**
+* @file        test_channel_flow.c
+* @brief       Host test of SerialChannel RTS/CTS flow control on a fast link.
+* @details     Runs a channel at 3 Mbaud on the simulated SERCOM and DMAC of
+*				channel_harness.h, against a peer like the ESP32 of the link.
+*				Receive: the peer streams 64 KiB as fast as the line allows and
+*				stops within a few characters of seeing RTS deasserted, while
+*				the reader drains 32 bytes per millisecond, a tenth of the line
+*				rate. With ASF jobs, the lean handler and RX DMA alike, nothing
+*				may be lost: every byte arrives in order and the ring never
+*				overruns. Without the RTS pin the same peer overruns the ring.
+*				Per received byte ASF takes a callback and starts a job; the
+*				lean handler does neither.
+*				Transmit: the peer raises CTS repeatedly during a transfer. The
+*				SERCOM must not start a character while CTS is high, every hold
+*				is counted, and the stream must arrive intact.
+*				Pauses, resumes and holds are printed.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include "SerialChannel.c"
+#include "channel_harness.h"
+#include "test.h"
+
+#define BAUD_RATE       3000000u  ///< Line rate
+#define FLOW_SERCOM     4u        ///< SERCOM of the channel under test
+#define RTS_PIN         42u       ///< GPIO driving our RTS
+#define DMA_RX_CHANNEL  1         ///< DMAC channel of the RX DMA runs
+#define DMA_TX_CHANNEL  0         ///< DMAC channel of the TX DMA run
+#define PEER_REACT_NS   10000u    ///< Time the peer takes to see RTS change
+#define RX_STREAM       65536u    ///< Bytes the peer sends
+#define READ_CHUNK      32u       ///< Bytes the reader takes per millisecond
+#define RX_DEADLINE_MS  4000u     ///< Longest receive run
+#define TX_HOLDS        200u      ///< Times the peer raises CTS during the transfer
+#define TX_MESSAGE      100u      ///< Bytes written per hold
+#define HOLD_NS         300000u   ///< How long the peer keeps CTS high
+
+SERIAL_CHANNEL_DEFINE(channel, 256, 1024, 64, 64);
+
+/// Serving paths of a run
+enum FlowPath {
+	PATH_ASF,
+	PATH_LEAN,
+	PATH_DMA,
+	PATHS
+};
+
+static const char * const pathName[PATHS] = { "ASF jobs", "lean ISR", "DMAC" };
+
+/// Brings the channel up on a fresh simulated SERCOM; rts selects flow control
+static void channel_init(enum FlowPath path, bool rx, bool rts)
+{
+	struct SerialChannelConfig config;
+	struct TestUart * u = &testUart[FLOW_SERCOM];
+
+	harness_reset();
+	memset(&channel.stats, 0, sizeof(channel.stats));
+	/* What the previous run left in the receive path */
+	spsc_ring_reset(&channel.rx);
+	channel.rxFlowPaused = false;
+	channel.dmaRxPosition = 0;
+	channel.dmaRxLastSeen = 0;
+	channel.dmaRxQuietTicks = 0;
+	SerialChannelGetConfigDefaults(&config);
+	config.hw = &testSercom[FLOW_SERCOM];
+	config.baudRate = BAUD_RATE;
+	config.txPolicy = TX_POLICY_BLOCK;
+	config.muxSetting = USART_RX_1_TX_0_RTS_2_CTS_3;
+	config.rtsPin = rts ? RTS_PIN : SERIAL_CHANNEL_NO_PIN;
+	config.leanIsr = path == PATH_LEAN;
+	if(path == PATH_DMA && rx)
+	{
+		config.dmaRxChannel = DMA_RX_CHANNEL;
+	}
+	else if(path == PATH_DMA)
+	{
+		config.dmaTxChannel = DMA_TX_CHANNEL;
+	}
+	SerialChannelInit(&channel, &config);
+
+	u->peerRtsPin = config.rtsPin;
+	u->peerReactNs = PEER_REACT_NS;
+}
+
+/// The peer streams RX_STREAM bytes to a slow reader; returns the bytes read in order
+static uint32_t receive(enum FlowPath path, bool rts)
+{
+	struct TestUart * u = &testUart[FLOW_SERCOM];
+	uint8_t chunk[READ_CHUNK];
+	uint32_t received = 0;
+	uint32_t errors = 0;
+
+	channel_init(path, true, rts);
+	u->peerTxLeft = RX_STREAM;
+	while(received < RX_STREAM && testNowNs < RX_DEADLINE_MS * 1000000ull)
+	{
+		vTaskDelay(1);
+		size_t len = SerialChannelRead(&channel, chunk, sizeof(chunk));
+		for(size_t i = 0; i < len; i++)
+		{
+			errors += chunk[i] != harness_peer_byte(received++);
+		}
+	}
+	if(rts)
+	{
+		CHECK(errors == 0);
+	}
+	return received;
+}
+
+/// Writes TX_HOLDS messages while the peer raises CTS in between; returns the holds during a character
+static uint32_t transmit(enum FlowPath path)
+{
+	struct TestUart * u = &testUart[FLOW_SERCOM];
+	uint8_t message[TX_MESSAGE];
+	uint32_t written = 0;
+	uint32_t midCharacter = 0;
+
+	channel_init(path, false, true);
+	for(uint32_t hold = 0; hold < TX_HOLDS; hold++)
+	{
+		for(size_t i = 0; i < sizeof(message); i++)
+		{
+			message[i] = harness_peer_byte(written + (uint32_t)i);
+		}
+		CHECK(SerialChannelWrite(&channel, message, sizeof(message)));
+		written += sizeof(message);
+		harness_run((hold * 7919u) % (TX_MESSAGE * u->charNs)); // Raise CTS at a different point of each message
+
+		/* The character being shifted out completes, no other one starts */
+		harness_set_cts(FLOW_SERCOM, true);
+		uint32_t allowed = u->peerRxCount + u->txShifting;
+		midCharacter += u->txShifting;
+		harness_run(HOLD_NS);
+		CHECK(u->peerRxCount == allowed && !u->txShifting);
+		harness_set_cts(FLOW_SERCOM, false);
+	}
+	tx_drain(&channel);
+	harness_run(0);
+
+	uint32_t errors = 0;
+	for(uint32_t i = 0; i < u->peerRxCount; i++)
+	{
+		errors += u->peerRx[i] != harness_peer_byte(i);
+	}
+	CHECK(u->peerRxCount == written && errors == 0);
+	CHECK(channel.stats.txDropped == 0 && u->txLost == 0);
+	CHECK(channel.stats.txFlowPauses == TX_HOLDS);
+	return midCharacter;
+}
+
+int main(void)
+{
+	struct TestUart * u = &testUart[FLOW_SERCOM];
+	uint32_t rxCallbacks[PATHS], rxJobs[PATHS];
+
+	for(unsigned path = 0; path < PATHS; path++)
+	{
+		uint32_t received = receive((enum FlowPath)path, true);
+		rxCallbacks[path] = u->callbacks;
+		rxJobs[path] = u->jobs;
+
+		CHECK(received == RX_STREAM);
+		CHECK(channel.stats.rxOverruns == 0 && channel.stats.rxBufferOverflows == 0 && u->rxLost == 0);
+		CHECK(channel.stats.rxFlowPauses > 0);
+		CHECK(channel.stats.rxFlowResumes == channel.stats.rxFlowPauses);
+		printf("channel_flow: RX %-8s %u bytes in %u ms, %u pauses, %u resumes, %u overruns\n",
+		       pathName[path], (unsigned)received, (unsigned)(testNowNs / 1000000u),
+		       (unsigned)channel.stats.rxFlowPauses, (unsigned)channel.stats.rxFlowResumes,
+		       (unsigned)channel.stats.rxOverruns);
+		printf("channel_flow: RX %-8s %u callbacks, %u jobs, %u register writes\n", pathName[path],
+		       (unsigned)u->callbacks, (unsigned)u->jobs, (unsigned)u->regWrites);
+	}
+	/* ASF restarts a one-byte read job from its callback per byte; the lean handler has neither */
+	CHECK(rxCallbacks[PATH_ASF] >= RX_STREAM && rxJobs[PATH_ASF] >= RX_STREAM);
+	CHECK(rxCallbacks[PATH_LEAN] == 0 && rxJobs[PATH_LEAN] == 0);
+
+	/* The same peer without RTS fills the ring within a millisecond */
+	receive(PATH_LEAN, false);
+	CHECK(channel.stats.rxOverruns > 0 && channel.stats.rxFlowPauses == 0);
+	printf("channel_flow: RX without RTS: %u overruns\n", (unsigned)channel.stats.rxOverruns);
+
+	for(unsigned path = 0; path < PATHS; path++)
+	{
+		uint32_t midCharacter = transmit((enum FlowPath)path);
+
+		CHECK(midCharacter > 0);
+		printf("channel_flow: TX %-8s %u holds counted, %u during a character\n", pathName[path],
+		       (unsigned)channel.stats.txFlowPauses, (unsigned)midCharacter);
+	}
+	return test_result("channel_flow");
+}
@@ -0,0 +1,186 @@
+/**************************************************************************//**
+* @file        test_channel_line.c
+* @brief       Host test of the SerialChannel cooked mode: one wakeup per line.
+* @details     A peer types a script of commands, with CR, LF and CR LF line
+*				ends, backspaces, an empty line and an up arrow, into a channel
+*				in cooked mode with the echo done by the receive path, on the
+*				simulated SERCOM and DMAC of channel_harness.h. With ASF jobs,
+*				the lean handler and RX DMA alike:
+*				- the reader gets every line as typed and edited;
+*				- the reader is woken exactly once per completed line;
+*				- the peer receives the echo of every character and erase;
+*				- the line discipline runs with interrupts enabled: its echo
+*				  nests critical sections no deeper than a write from a task.
+*				A receive path that finds the line discipline busy leaves the
+*				bytes to the one running it, which also takes them.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include "SerialChannel.c"
+#include "channel_harness.h"
+#include "test.h"
+
+#define BAUD_RATE       115200u  ///< Line rate
+#define LINE_SERCOM     3u       ///< SERCOM of the channel under test
+#define DMA_RX_CHANNEL  1        ///< DMAC channel of the RX DMA path
+#define SCRIPT_RUNS     40u      ///< Times the peer types the script
+
+SERIAL_CHANNEL_DEFINE(channel, 256, 2048, 64, 64);
+SERIAL_LINE_DEFINE(line, 64, 256);
+
+/// Receive paths under test
+enum LinePath {
+	PATH_ASF,
+	PATH_LEAN,
+	PATH_DMA,
+	PATHS
+};
+
+static const char * const pathName[PATHS] = { "ASF jobs", "lean ISR", "DMAC" };
+
+/// One line of the script: what the peer types, what the reader gets, what the peer sees echoed
+struct ScriptLine {
+	const char * typed;
+	const char * line;
+	const char * echo;
+};
+
+static const struct ScriptLine script[] = {
+	{ "help\r\n",             "help",   "help\r\n" },
+	{ "status\r",             "status", "status\r\n" },
+	{ "led on\n",             "led on", "led on\r\n" },
+	{ "typo\b\b\bpo\r\n",     "tpo",    "typo\b \b\b \b\b \bpo\r\n" },
+	{ "\r\n",                 "",       "\r\n" },
+	{ "\x1b[A\r",             "tpo",    "\x1b[2K\r>tpo\r\n" }
+};
+
+#define SCRIPT_LINES    (sizeof(script) / sizeof(script[0]))
+
+static uint8_t typed[HARNESS_PEER_BYTES];  ///< What the peer types
+static uint8_t echoed[HARNESS_PEER_BYTES]; ///< What it must see echoed
+static uint32_t taskDepth;                 ///< Nesting of critical sections in a write from a task
+
+/// Brings the channel up in cooked mode on a fresh simulated SERCOM, with the receive path under test
+static void channel_init(enum LinePath path)
+{
+	struct SerialChannelConfig config;
+
+	harness_reset();
+	memset(&channel.stats, 0, sizeof(channel.stats));
+	/* What the previous run left in the receive path */
+	spsc_ring_reset(&channel.rx);
+	channel.dmaRxPosition = 0;
+	channel.dmaRxLastSeen = 0;
+	channel.dmaRxQuietTicks = 0;
+	spsc_ring_reset(&line.lines);
+	line.length = 0;
+	line.escape = 0;
+	line.lastCR = false;
+	line.reader = NULL;
+	SerialChannelGetConfigDefaults(&config);
+	config.hw = &testSercom[LINE_SERCOM];
+	config.baudRate = BAUD_RATE;
+	config.echoMode = ECHO_MODE_ISR;
+	config.line = &line;
+	config.leanIsr = path == PATH_LEAN;
+	config.dmaRxChannel = (path == PATH_DMA) ? DMA_RX_CHANNEL : SERIAL_CHANNEL_NO_DMA;
+	SerialChannelInit(&channel, &config);
+}
+
+/// Appends text to buffer at *len
+static void append(uint8_t * buffer, uint32_t * len, const char * text)
+{
+	size_t n = strlen(text);
+
+	assert(*len + n <= HARNESS_PEER_BYTES);
+	memcpy(&buffer[*len], text, n);
+	*len += (uint32_t)n;
+}
+
+/// The peer types the script SCRIPT_RUNS times; checks the lines read, the wakeups and the echo
+static void run_path(enum LinePath path)
+{
+	struct TestUart * u = &testUart[LINE_SERCOM];
+	uint32_t typedLen = 0;
+	uint32_t echoLen = 0;
+	uint32_t lines = 0;
+	uint32_t errors = 0;
+	char text[64];
+
+	for(uint32_t run = 0; run < SCRIPT_RUNS; run++)
+	{
+		for(size_t i = 0; i < SCRIPT_LINES; i++)
+		{
+			append(typed, &typedLen, script[i].typed);
+			append(echoed, &echoLen, script[i].echo);
+		}
+	}
+
+	channel_init(path);
+	u->peerTxData = typed;
+	u->peerTxLeft = typedLen;
+	for(uint32_t run = 0; run < SCRIPT_RUNS; run++)
+	{
+		for(size_t i = 0; i < SCRIPT_LINES; i++)
+		{
+			size_t len = SerialChannelReadLine(&channel, text, sizeof(text));
+			errors += len != strlen(script[i].line) || strcmp(text, script[i].line) != 0;
+			lines++;
+		}
+	}
+	tx_drain(&channel);
+	harness_run(0);
+
+	CHECK(errors == 0);
+	CHECK(channel.stats.rxLines == lines && channel.stats.rxLineDrops == 0);
+	CHECK(channel.stats.rxWakeups == lines && testNotifyGives == lines);
+	CHECK(u->peerRxCount == echoLen && memcmp(u->peerRx, echoed, echoLen) == 0);
+	CHECK(channel.stats.rxOverruns == 0 && u->rxLost == 0);
+	/* The echo takes the TX critical sections only, not inside one of the receive path */
+	CHECK(testCriticalDepthMax == taskDepth);
+	printf("channel_line: %-8s %u lines, %u wakeups, %u echo bytes\n", pathName[path], (unsigned)lines,
+	       (unsigned)testNotifyGives, (unsigned)u->peerRxCount);
+}
+
+/// A receive path that finds the line discipline busy leaves its bytes to the running one
+static void run_busy(void)
+{
+	static const uint8_t held[] = "held\rnext\r";
+	struct TestUart * u = &testUart[LINE_SERCOM];
+	char text[64];
+
+	channel_init(PATH_LEAN);
+	line.reader = xTaskGetCurrentTaskHandle();
+	channel.lineBusy = true;
+	u->peerTxData = held;
+	u->peerTxLeft = 5;
+	harness_run(10 * HARNESS_TICK_NS);
+	CHECK(channel.stats.rxLines == 0 && spsc_ring_size(&channel.rx) == 5);
+
+	/* The holder takes what arrived meanwhile along with its own bytes */
+	channel.lineBusy = false;
+	u->peerTxLeft = 5;
+	CHECK(SerialChannelReadLine(&channel, text, sizeof(text)) == 4 && strcmp(text, "held") == 0);
+	CHECK(SerialChannelReadLine(&channel, text, sizeof(text)) == 4 && strcmp(text, "next") == 0);
+	CHECK(channel.stats.rxLines == 2 && !channel.lineBusy);
+}
+
+int main(void)
+{
+	channel_init(PATH_ASF);
+	CHECK(SerialChannelWrite(&channel, (const uint8_t *)"> ", 2));
+	taskDepth = testCriticalDepthMax;
+	tx_drain(&channel);
+	harness_run(0);
+
+	for(unsigned path = 0; path < PATHS; path++)
+	{
+		run_path((enum LinePath)path);
+	}
+	run_busy();
+	return test_result("channel_line");
+}
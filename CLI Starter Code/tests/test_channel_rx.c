@@ -0,0 +1,161 @@
+/**************************************************************************//**
+* @file        test_channel_rx.c
+* @brief       Host test of the SerialChannel receive paths: consumer wakeups.
+* @details     A peer replays the same byte stream into a raw-mode channel on
+*				the simulated SERCOM and DMAC of channel_harness.h, once with
+*				the one-byte ASF read jobs and once with RX DMA. The stream is a
+*				pasted script of CLI commands, sent as bursts with pauses in
+*				between, followed by a binary upload. A reader task waits for
+*				data and drains the ring. Checked for each path:
+*				- the reader gets the stream exactly, nothing overrun;
+*				- the consumer wakeups counted by the channel match the times
+*				  the reader woke up.
+*				ASF jobs wake the reader about once per byte; RX DMA once per
+*				watermark block, plus an idle-line wakeup at the end of a burst,
+*				at least 16 times less. The wakeups per KiB are printed.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include "SerialChannel.c"
+#include "channel_harness.h"
+#include "test.h"
+
+#define BAUD_RATE       115200u  ///< Line rate
+#define RX_SERCOM       1u       ///< SERCOM of the channel under test
+#define DMA_RX_CHANNEL  1        ///< DMAC channel of the RX DMA path
+#define RX_RING         1024u    ///< RX ring size
+#define RX_WATERMARK    32u      ///< RX DMA block
+#define SCRIPT_BURSTS   24u      ///< Bursts of the pasted script
+#define UPLOAD_BYTES    16384u   ///< Bytes of the binary upload
+#define PAUSE_MS        20u      ///< Pause after a burst
+#define WAIT_TICKS      5u       ///< Longest wait of the reader
+
+SERIAL_CHANNEL_DEFINE(channel, RX_RING, 256, 64, RX_WATERMARK);
+
+/// Receive paths under test
+enum RxPath {
+	PATH_ASF,
+	PATH_DMA,
+	PATHS
+};
+
+static const char * const pathName[PATHS] = { "ASF jobs", "DMAC" };
+
+static const char * const commands[] = {
+	"help\r\n",
+	"version\r\n",
+	"constats\r\n",
+	"led on\r\n",
+	"set rate 115200\r\n",
+	"log level debug\r\n",
+	"dump 0x20000000 64\r\n"
+};
+
+static uint8_t stream[HARNESS_PEER_BYTES]; ///< What the peer replays
+static uint32_t bursts[SCRIPT_BURSTS + 1]; ///< End of each burst in stream
+
+/// Builds the stream: SCRIPT_BURSTS bursts of commands, then the upload as one burst
+static uint32_t stream_build(void)
+{
+	uint32_t len = 0;
+
+	for(uint32_t burst = 0; burst < SCRIPT_BURSTS; burst++)
+	{
+		for(uint32_t i = 0; i <= burst % 5; i++)
+		{
+			const char * command = commands[(burst + i) % (sizeof(commands) / sizeof(commands[0]))];
+			memcpy(&stream[len], command, strlen(command));
+			len += (uint32_t)strlen(command);
+		}
+		bursts[burst] = len;
+	}
+	for(uint32_t i = 0; i < UPLOAD_BYTES; i++)
+	{
+		stream[len++] = (uint8_t)(i * 131u + (i >> 7));
+	}
+	bursts[SCRIPT_BURSTS] = len;
+	return len;
+}
+
+/// Brings the channel up in raw mode on a fresh simulated SERCOM, with the receive path under test
+static void channel_init(enum RxPath path)
+{
+	struct SerialChannelConfig config;
+
+	harness_reset();
+	memset(&channel.stats, 0, sizeof(channel.stats));
+	spsc_ring_reset(&channel.rx);
+	channel.dmaRxPosition = 0;
+	channel.dmaRxLastSeen = 0;
+	channel.dmaRxQuietTicks = 0;
+	SerialChannelGetConfigDefaults(&config);
+	config.hw = &testSercom[RX_SERCOM];
+	config.baudRate = BAUD_RATE;
+	config.echoMode = ECHO_MODE_OFF;
+	config.dmaRxChannel = (path == PATH_DMA) ? DMA_RX_CHANNEL : SERIAL_CHANNEL_NO_DMA;
+	SerialChannelInit(&channel, &config);
+}
+
+/// Replays the stream burst by burst to a reader; returns the times the reader woke up
+static uint32_t run_path(enum RxPath path, uint32_t len)
+{
+	struct TestUart * u = &testUart[RX_SERCOM];
+	uint8_t chunk[64];
+	uint32_t received = 0;
+	uint32_t wakeups = 0;
+	uint32_t errors = 0;
+
+	channel_init(path);
+	u->peerTxData = stream;
+	for(uint32_t burst = 0; burst <= SCRIPT_BURSTS; burst++)
+	{
+		u->peerTxLeft = bursts[burst] - u->peerTxCount;
+		while(received < bursts[burst])
+		{
+			wakeups += SerialChannelWaitForData(&channel, WAIT_TICKS);
+			size_t got;
+			while((got = SerialChannelRead(&channel, chunk, sizeof(chunk))) > 0)
+			{
+				for(size_t i = 0; i < got; i++)
+				{
+					errors += chunk[i] != stream[received++];
+				}
+			}
+		}
+		vTaskDelay(PAUSE_MS);
+		wakeups += SerialChannelWaitForData(&channel, 0); // A signal for bytes already read
+	}
+
+	CHECK(received == len && errors == 0);
+	CHECK(channel.stats.rxBytes == len);
+	CHECK(channel.stats.rxOverruns == 0 && channel.stats.rxBufferOverflows == 0 && u->rxLost == 0);
+	CHECK(channel.stats.rxWakeups >= wakeups);
+	return wakeups;
+}
+
+int main(void)
+{
+	uint32_t len = stream_build();
+	uint32_t wakeups[PATHS];
+	uint32_t signals[PATHS];
+
+	for(unsigned path = 0; path < PATHS; path++)
+	{
+		wakeups[path] = run_path((enum RxPath)path, len);
+		signals[path] = channel.stats.rxWakeups;
+		printf("channel_rx: %-8s %u bytes, %u signals, %u reader wakeups (%u/KiB), %u idle wakeups\n",
+		       pathName[path], (unsigned)len, (unsigned)signals[path], (unsigned)wakeups[path],
+		       (unsigned)((wakeups[path] * 1024ull + len / 2) / len), (unsigned)channel.stats.rxIdleWakeups);
+	}
+
+	/* One-byte jobs signal every byte; DMA a block, or the tail of a burst after the line idles */
+	CHECK(signals[PATH_ASF] == len);
+	CHECK(signals[PATH_DMA] <= len / RX_WATERMARK + 2 * (SCRIPT_BURSTS + 1));
+	CHECK(channel.stats.rxIdleWakeups > 0 && channel.stats.rxIdleWakeups <= SCRIPT_BURSTS + 1);
+	CHECK(wakeups[PATH_DMA] * 16 <= wakeups[PATH_ASF]);
+	return test_result("channel_rx");
+}
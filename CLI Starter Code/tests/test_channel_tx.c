@@ -0,0 +1,234 @@
+/**************************************************************************//**
+* @file        test_channel_tx.c
+* @brief       Host test of the SerialChannel transmit paths: interrupts per kilobyte.
+* @details     The same stream of messages, 8 to 120 bytes long, is written
+*				under TX_POLICY_BLOCK through a channel on the simulated SERCOM
+*				and DMAC of channel_harness.h, once per transmit path: ASF jobs,
+*				the lean SERCOM handler, and a DMAC channel. Checked for each:
+*				- the peer receives the stream exactly, nothing dropped;
+*				- the line stays busy while messages are queued.
+*				The interrupts taken per transmitted kilobyte are compared: the
+*				DMAC path interrupts once per transfer, far less than once per
+*				byte, and never enters the SERCOM handler. The work of the SERCOM
+*				path is compared as well: ASF starts a job and takes a callback
+*				per byte, the lean handler neither, and writes a fraction of the
+*				registers. The figures are printed for comparison between changes.
+*				Under TX_POLICY_DROP_OLDEST a task writing into a full ring evicts
+*				the oldest queued whole messages, while an interrupt handler or a
+*				critical section drops its own message and evicts nothing.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include "SerialChannel.c"
+#include "channel_harness.h"
+#include "test.h"
+
+#define STREAM_BYTES    65536u   ///< Bytes written per transmit path
+#define BAUD_RATE       115200u  ///< Line rate
+#define TX_SERCOM       2u       ///< SERCOM of the channel under test
+#define TX_DMA_CHANNEL  0        ///< DMAC channel of the DMA path
+
+#define TX_RING         1024u    ///< Bulk lane size
+#define TX_RING_MS      (TX_RING * 10u * 1000u / BAUD_RATE) ///< Time to shift out a full bulk lane
+#define DROP_MESSAGE    100u     ///< Length of the messages of the TX_POLICY_DROP_OLDEST run
+#define DROP_MESSAGES   20u      ///< Messages the task writes in that run, twice what the ring holds
+
+SERIAL_CHANNEL_DEFINE(channel, 256, TX_RING, 64, 256);
+
+/// Transmit paths under test
+enum TxPath {
+	PATH_ASF,
+	PATH_LEAN,
+	PATH_DMA,
+	PATHS
+};
+
+static const char * const pathName[PATHS] = { "ASF jobs", "lean ISR", "DMAC" };
+
+/// Figures of one transmit path
+struct TxResult {
+	uint32_t irqs;        ///< Interrupts taken: SERCOM and DMAC handler calls
+	uint32_t sercomIrqs;  ///< Of those, SERCOM handler calls
+	uint32_t messages;    ///< Messages written
+	unsigned perKiB;      ///< Interrupts per transmitted KiB
+	unsigned utilization; ///< Percent of the line time spent shifting out data
+	unsigned callbacks;   ///< ASF callbacks per transmitted KiB
+	unsigned jobs;        ///< ASF jobs started per transmitted KiB
+	unsigned regWrites;   ///< SERCOM register writes per transmitted KiB
+};
+
+/// Events per KiB of the stream
+static unsigned per_kib(uint32_t events)
+{
+	return (unsigned)((events * 1024ull + STREAM_BYTES / 2) / STREAM_BYTES);
+}
+
+/// Length of message n
+static size_t message_length(uint32_t n)
+{
+	return 8 + (n * 37u) % 113;
+}
+
+/// Byte i of the stream
+static uint8_t stream_byte(uint32_t i)
+{
+	return (uint8_t)(i * 13u + (i >> 9));
+}
+
+/// Brings the channel up on a fresh simulated SERCOM, with the transmit path under test
+static void channel_init(enum TxPath path)
+{
+	struct SerialChannelConfig config;
+
+	harness_reset();
+	memset(&channel.stats, 0, sizeof(channel.stats));
+	SerialChannelGetConfigDefaults(&config);
+	config.hw = &testSercom[TX_SERCOM];
+	config.baudRate = BAUD_RATE;
+	config.txPolicy = TX_POLICY_BLOCK;
+	/* A DMA transfer frees its bytes at the end only, and may span most of the ring */
+	config.txTimeoutMs = 2 * TX_RING_MS;
+	config.leanIsr = path == PATH_LEAN;
+	config.dmaTxChannel = (path == PATH_DMA) ? TX_DMA_CHANNEL : SERIAL_CHANNEL_NO_DMA;
+	SerialChannelInit(&channel, &config);
+}
+
+/// Writes STREAM_BYTES as messages, waits until the last one is shifted out and checks what the peer got
+static void run_path(enum TxPath path, struct TxResult * result)
+{
+	struct TestUart * u = &testUart[TX_SERCOM];
+	uint8_t message[128];
+	uint32_t written = 0;
+
+	channel_init(path);
+	memset(result, 0, sizeof(*result));
+	while(written < STREAM_BYTES)
+	{
+		size_t len = Min(message_length(result->messages), STREAM_BYTES - written);
+
+		for(size_t i = 0; i < len; i++)
+		{
+			message[i] = stream_byte(written + (uint32_t)i);
+		}
+		CHECK(SerialChannelWrite(&channel, message, len));
+		written += (uint32_t)len;
+		result->messages++;
+	}
+	tx_drain(&channel);
+	harness_run(0);
+
+	CHECK(u->peerRxCount == STREAM_BYTES);
+	uint32_t errors = 0;
+	for(uint32_t i = 0; i < u->peerRxCount; i++)
+	{
+		errors += u->peerRx[i] != stream_byte(i);
+	}
+	CHECK(errors == 0);
+	CHECK(channel.stats.txBytes == STREAM_BYTES);
+	CHECK(channel.stats.txDropped == 0 && channel.stats.txDroppedMessages == 0);
+	CHECK(u->txLost == 0);
+
+	result->sercomIrqs = u->irqs;
+	result->irqs = u->irqs + testDmacIrqs;
+	result->perKiB = per_kib(result->irqs);
+	result->callbacks = per_kib(u->callbacks);
+	result->jobs = per_kib(u->jobs);
+	result->regWrites = per_kib(u->regWrites);
+	/* The writer kept the ring full from the start, so the line never idled */
+	result->utilization = (unsigned)(100ull * STREAM_BYTES * u->charNs / testNowNs);
+}
+
+/// Writes message n of the TX_POLICY_DROP_OLDEST run: DROP_MESSAGE bytes of value n
+static bool drop_write(uint32_t n)
+{
+	uint8_t message[DROP_MESSAGE];
+
+	memset(message, (int)n, sizeof(message));
+	return SerialChannelWrite(&channel, message, sizeof(message));
+}
+
+/// TX_POLICY_DROP_OLDEST: tasks evict queued messages, interrupts and critical sections drop their own
+static void run_drop_oldest(void)
+{
+	struct TestUart * u = &testUart[TX_SERCOM];
+	uint32_t n;
+
+	channel_init(PATH_LEAN);
+	channel.txPolicy = TX_POLICY_DROP_OLDEST;
+	/* The line barely starts before the ring is full */
+	for(n = 0; n < DROP_MESSAGES; n++)
+	{
+		CHECK(drop_write(n));
+	}
+	uint32_t evicted = channel.stats.txEvictedMessages;
+	CHECK(evicted >= DROP_MESSAGES - TX_RING / DROP_MESSAGE);
+	CHECK(channel.stats.txDroppedMessages == evicted);
+
+	testInInterrupt = true;
+	CHECK(!drop_write(n++));
+	testInInterrupt = false;
+	system_interrupt_enter_critical_section();
+	CHECK(!drop_write(n++));
+	system_interrupt_leave_critical_section();
+	CHECK(channel.stats.txEvictedMessages == evicted && channel.stats.txDroppedMessages == evicted + 2);
+
+	tx_drain(&channel);
+	harness_run(0);
+
+	/* The newest messages of the task, whole and in the order written */
+	uint32_t kept = u->peerRxCount / DROP_MESSAGE;
+	uint32_t errors = u->peerRxCount % DROP_MESSAGE;
+	for(uint32_t i = 0; i < u->peerRxCount; i++)
+	{
+		errors += u->peerRx[i] != DROP_MESSAGES - kept + i / DROP_MESSAGE;
+	}
+	CHECK(errors == 0);
+	CHECK(kept == DROP_MESSAGES - evicted);
+	CHECK(u->peerRxCount + channel.stats.txDropped == n * DROP_MESSAGE);
+	printf("channel_tx: DROP_OLDEST %u of %u messages evicted by the task, 2 dropped by interrupt and critical section\n",
+	       (unsigned)evicted, (unsigned)DROP_MESSAGES);
+}
+
+int main(void)
+{
+	struct TxResult result[PATHS];
+
+	for(unsigned path = 0; path < PATHS; path++)
+	{
+		run_path((enum TxPath)path, &result[path]);
+		CHECK(result[path].utilization >= 95);
+	}
+
+	/* ASF jobs: a DRE and a TXC interrupt per byte; the lean handler: one DRE per byte */
+	CHECK(result[PATH_ASF].irqs >= 2 * STREAM_BYTES);
+	CHECK(result[PATH_LEAN].irqs >= STREAM_BYTES && result[PATH_LEAN].irqs < STREAM_BYTES + STREAM_BYTES / 16);
+	CHECK(channel.stats.txInterrupts == result[PATH_DMA].irqs);
+	/* Per byte, ASF starts a one-byte job and calls back; the lean handler writes DATA and nothing else */
+	CHECK(result[PATH_ASF].callbacks >= 1024 && result[PATH_ASF].jobs >= 1024);
+	CHECK(result[PATH_LEAN].callbacks == 0 && result[PATH_LEAN].jobs == 0);
+	CHECK(result[PATH_LEAN].regWrites * 4 < result[PATH_ASF].regWrites);
+
+	/* DMAC: one interrupt per transfer of whole messages, no SERCOM interrupt at all */
+	CHECK(result[PATH_DMA].sercomIrqs == 0);
+	CHECK(result[PATH_DMA].irqs <= result[PATH_DMA].messages);
+	CHECK(result[PATH_DMA].perKiB * 16 < result[PATH_LEAN].perKiB);
+	/* The ring wrapped under some transfers, which still took a single interrupt */
+	CHECK(channel.stats.txDmaBlocks > channel.stats.txInterrupts);
+
+	for(unsigned path = 0; path < PATHS; path++)
+	{
+		printf("channel_tx: %-8s %5u interrupts/KiB, line %u%% busy\n", pathName[path], result[path].perKiB,
+		       result[path].utilization);
+		printf("channel_tx: %-8s %5u callbacks/KiB, %5u jobs/KiB, %5u register writes/KiB\n", pathName[path],
+		       result[path].callbacks, result[path].jobs, result[path].regWrites);
+	}
+	printf("channel_tx: DMAC %u transfers for %u messages\n", (unsigned)channel.stats.txInterrupts,
+	       (unsigned)result[PATH_DMA].messages);
+
+	run_drop_oldest();
+	return test_result("channel_tx");
+}
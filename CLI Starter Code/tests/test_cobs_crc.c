@@ -0,0 +1,132 @@
+/**************************************************************************//**
+* @file        test_cobs_crc.c
+* @brief       Host test of the SerialLink framing codecs, cobs.c and crc16.c.
+* @details     Fixed encodings for the edge cases of COBS (empty input, a full
+*				254-byte run, zeros at either end), rejection of malformed input,
+*				then random round trips, out of place and in place, over data rich
+*				in zeros and in 0xFF bytes. The CRC is checked against the CCITT
+*				check value and for piecewise computation.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cobs.h"
+#include "crc16.h"
+#include "test.h"
+
+#define RANDOM_ROUNDS    20000u ///< Random round trips
+#define RANDOM_MAX       600u   ///< Longest random input; spans several 254-byte runs
+
+/// Encodes src, checks the result against expected, and decodes it back
+static void check_encoding(const uint8_t * src, size_t len, const uint8_t * expected, size_t expectedLen)
+{
+	uint8_t enc[COBS_ENCODED_MAX(RANDOM_MAX)];
+	uint8_t dec[RANDOM_MAX];
+
+	size_t n = cobs_encode(src, len, enc);
+	CHECK(n == expectedLen);
+	CHECK(n <= COBS_ENCODED_MAX(len));
+	CHECK(memcmp(enc, expected, expectedLen) == 0);
+	CHECK(cobs_decode(enc, n, dec) == len);
+	CHECK(memcmp(dec, src, len) == 0);
+}
+
+/// Fixed encodings at the boundaries of the code bytes
+static void test_cobs_edges(void)
+{
+	uint8_t src[256];
+	uint8_t expected[260];
+	uint8_t dec[16];
+
+	/* Empty input: a lone code byte, which decodes to nothing */
+	check_encoding((const uint8_t *)"", 0, (const uint8_t[]){ 0x01 }, 1);
+
+	/* Zeros at either end */
+	check_encoding((const uint8_t[]){ 1, 2, 0 }, 3, (const uint8_t[]){ 0x03, 1, 2, 0x01 }, 4);
+	check_encoding((const uint8_t[]){ 0, 1, 2 }, 3, (const uint8_t[]){ 0x01, 0x03, 1, 2 }, 4);
+	check_encoding((const uint8_t[]){ 0 }, 1, (const uint8_t[]){ 0x01, 0x01 }, 2);
+	check_encoding((const uint8_t[]){ 0, 0 }, 2, (const uint8_t[]){ 0x01, 0x01, 0x01 }, 3);
+
+	/* Exactly 254 non-zero bytes: a full run, then an empty one that adds no zero */
+	for(size_t i = 0; i < 254; i++)
+	{
+		src[i] = (uint8_t)(1 + i % 255);
+	}
+	expected[0] = 0xFF;
+	memcpy(expected + 1, src, 254);
+	expected[255] = 0x01;
+	check_encoding(src, 254, expected, 256);
+
+	/* One more byte starts a second run */
+	src[254] = 0x42;
+	expected[255] = 0x02;
+	expected[256] = 0x42;
+	check_encoding(src, 255, expected, 257);
+
+	/* 254 non-zero bytes and a trailing zero */
+	src[254] = 0;
+	expected[255] = 0x01;
+	expected[256] = 0x01;
+	check_encoding(src, 255, expected, 257);
+
+	/* Malformed input: a zero byte, a run past the end of the frame */
+	CHECK(cobs_decode((const uint8_t[]){ 0x00 }, 1, dec) == 0);
+	CHECK(cobs_decode((const uint8_t[]){ 0x03, 1, 0, 0x01 }, 4, dec) == 0);
+	CHECK(cobs_decode((const uint8_t[]){ 0x05, 1, 2 }, 3, dec) == 0);
+}
+
+/// Random round trips, each decoded out of place and then in place
+static void test_cobs_random(void)
+{
+	uint8_t src[RANDOM_MAX];
+	uint8_t enc[COBS_ENCODED_MAX(RANDOM_MAX)];
+	uint8_t dec[RANDOM_MAX];
+	unsigned long errors = 0;
+
+	srand(1);
+	for(unsigned round = 0; round < RANDOM_ROUNDS; round++)
+	{
+		size_t len = (size_t)rand() % (RANDOM_MAX + 1);
+		for(size_t i = 0; i < len; i++)
+		{
+			int r = rand() % 4;
+			src[i] = (r == 0) ? 0 : (r == 1) ? 0xFF : (uint8_t)rand();
+		}
+		if(round % 7 == 0)
+		{
+			memset(src, (round % 2) ? 0 : 1, len); // Runs of zeros, and long runs without one
+		}
+
+		size_t n = cobs_encode(src, len, enc);
+		errors += n > COBS_ENCODED_MAX(len);
+		errors += memchr(enc, 0, n) != NULL;
+		errors += cobs_decode(enc, n, dec) != len || memcmp(dec, src, len) != 0;
+		errors += cobs_decode(enc, n, enc) != len || memcmp(enc, src, len) != 0;
+	}
+	CHECK(errors == 0);
+}
+
+/// CRC-16/CCITT-FALSE: the check value, and a CRC carried across pieces
+static void test_crc(void)
+{
+	const uint8_t * check = (const uint8_t *)"123456789";
+
+	CHECK(crc16_ccitt(CRC16_CCITT_INIT, check, 9) == 0x29B1);
+	CHECK(crc16_ccitt(CRC16_CCITT_INIT, check, 0) == CRC16_CCITT_INIT);
+	CHECK(crc16_ccitt(crc16_ccitt(CRC16_CCITT_INIT, check, 4), check + 4, 5) == 0x29B1);
+}
+
+int main(void)
+{
+	test_cobs_edges();
+	test_cobs_random();
+	test_crc();
+
+	return test_result("cobs_crc");
+}
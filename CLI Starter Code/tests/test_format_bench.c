@@ -0,0 +1,278 @@
+/**************************************************************************//**
+* @file        test_format_bench.c
+* @brief       Host microbenchmark of console_capture against formatting in place.
+* @details     The same mix of log messages goes through the two ways a caller
+*				can hand a message on: formatted at once, console_vformat sizing
+*				it and writing it into an mpsc_ring reservation between
+*				reserve and commit, as SerialChannelVPrintf does; or captured,
+*				console_capture copying the argument words and %s strings into a
+*				log entry, as the deferred logger does. The cost to the caller of
+*				each, the best of a few repetitions, is printed in cycles per
+*				message (ns without a cycle counter), along with the cost of
+*				console_wformat formatting the captured entries later. Capture
+*				must be cheaper for the caller, and replaying every entry must
+*				give the text formatted at once.
+*				A %s arriving with the strings buffer exactly full replays as an
+*				empty string, not as (null), and the bytes reported are those the
+*				strings needed, so that the cut can be counted.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "console_format.h"
+#include "mpsc_ring.h"
+#include "test.h"
+
+#define BENCH_MESSAGES  4096u    ///< Messages per run
+#define BENCH_RUNS      5u       ///< Repetitions, the best one counts
+#define ENTRY_WORDS     8u       ///< Argument words of an entry, CONF_SERIAL_CONSOLE_LOG_MAX_ARGS
+#define ENTRY_STRINGS   48u      ///< %s bytes of an entry, CONF_SERIAL_CONSOLE_LOG_MAX_STRINGS
+
+MPSC_RING_DEFINE(benchRing, 512u * 1024u);
+
+/// A captured message, as in the log buffer
+struct BenchEntry {
+	const char * format;
+	uint32_t words[ENTRY_WORDS];
+	size_t count;
+	char strings[ENTRY_STRINGS];
+	size_t stringsLen;
+};
+
+static struct BenchEntry entries[BENCH_MESSAGES];
+
+/// Write position inside a reservation
+struct BenchCursor {
+	mpsc_reservation_t res;
+	size_t offset;
+};
+
+/// Output of a replay
+struct BenchText {
+	char text[256];
+	size_t len;
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_UNIT      "cycles"
+/// Time stamp counter
+static uint64_t bench_clock(void)
+{
+	return __rdtsc();
+}
+#else
+#define BENCH_UNIT      "ns"
+static uint64_t bench_clock(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+#endif
+
+static const char * const taskNames[] = { "CLI", "Logger", "Control", "WiFi" };
+
+/// Copies formatted output into the reservation
+static void ring_sink(void * ctx, const char * data, size_t len)
+{
+	struct BenchCursor * cursor = ctx;
+
+	cursor->offset += mpsc_reservation_write(&cursor->res, cursor->offset, (const uint8_t *)data, len);
+}
+
+/// Appends formatted output to a BenchText
+static void text_sink(void * ctx, const char * data, size_t len)
+{
+	struct BenchText * t = ctx;
+
+	if(t->len + len < sizeof(t->text))
+	{
+		memcpy(&t->text[t->len], data, len);
+		t->len += len;
+	}
+}
+
+/// Hands one message on: captured into entry, or formatted into the ring if entry is NULL
+static void message(struct BenchEntry * entry, const char * format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	if(entry != NULL)
+	{
+		entry->format = format;
+		entry->count = console_capture(format, args, entry->words, ENTRY_WORDS, entry->strings,
+		                               sizeof(entry->strings), &entry->stringsLen);
+	}
+	else
+	{
+		va_list sizing;
+		struct BenchCursor cursor = { .offset = 0 };
+
+		va_copy(sizing, args);
+		size_t len = console_vformat(NULL, NULL, format, sizing);
+		va_end(sizing);
+		if(mpsc_ring_reserve(&benchRing, len, &cursor.res))
+		{
+			console_vformat(ring_sink, &cursor, format, args);
+			mpsc_ring_commit(&benchRing);
+		}
+	}
+	va_end(args);
+}
+
+/// Message n of the mix, into entry or the ring
+static void message_mix(uint32_t n, struct BenchEntry * entry)
+{
+	switch(n % 6)
+	{
+	case 0:
+		message(entry, "Task %s started, %u words of stack free\r\n", taskNames[n % 4], 512u - n % 300u);
+		break;
+	case 1:
+		message(entry, "adc ch%u = %d mV\r\n", n % 8u, (int)(n * 37u % 3300u) - 100);
+		break;
+	case 2:
+		message(entry, "rx %u bytes, %u overruns, %lu Bd\r\n", n * 13u, n % 3u, 115200ul);
+		break;
+	case 3:
+		message(entry, "link %d -> %d (%s), rto %u ms\r\n", (int)(n % 4), (int)((n + 1) % 4), "retransmit", 30u + n % 50u);
+		break;
+	case 4:
+		message(entry, "heap free %u, min %u, at %p\r\n", 24576u - n % 4096u, 16384u, (void *)(uintptr_t)0x20001000u);
+		break;
+	default:
+		message(entry, "uptime %llu us, state 0x%08x\r\n", (unsigned long long)n * 1000003ull, n * 0x9E3779B9u);
+		break;
+	}
+}
+
+/// Hands on BENCH_MESSAGES messages; returns the clock ticks taken
+static uint64_t bench_run(bool capture)
+{
+	/* Nothing consumes the ring: start it empty */
+	spsc_ring_reset(&benchRing.ring);
+	benchRing.reserved = 0;
+
+	uint64_t start = bench_clock();
+	for(uint32_t n = 0; n < BENCH_MESSAGES; n++)
+	{
+		message_mix(n, capture ? &entries[n] : NULL);
+	}
+	return bench_clock() - start;
+}
+
+/// Formats the captured entries; returns the clock ticks taken
+static uint64_t bench_replay(void)
+{
+	struct BenchText t;
+
+	uint64_t start = bench_clock();
+	for(uint32_t n = 0; n < BENCH_MESSAGES; n++)
+	{
+		t.len = 0;
+		console_wformat(text_sink, &t, entries[n].format, entries[n].words, entries[n].count, entries[n].strings);
+	}
+	return bench_clock() - start;
+}
+
+/// Best of BENCH_RUNS runs of fn
+static uint64_t bench_best(uint64_t (*fn)(bool), bool arg)
+{
+	uint64_t best = UINT64_MAX;
+
+	for(unsigned run = 0; run < BENCH_RUNS; run++)
+	{
+		uint64_t ticks = fn(arg);
+		if(ticks < best)
+		{
+			best = ticks;
+		}
+	}
+	return best;
+}
+
+static uint64_t bench_replay_run(bool unused)
+{
+	(void)unused;
+	return bench_replay();
+}
+
+/// Replaying every captured entry gives the text formatted into the ring, in order
+static uint32_t check_replay(void)
+{
+	uint32_t errors = 0;
+	size_t offset = 0;
+
+	bench_run(true);
+	bench_run(false);
+	for(uint32_t n = 0; n < BENCH_MESSAGES; n++)
+	{
+		struct BenchText t = { .len = 0 };
+		console_wformat(text_sink, &t, entries[n].format, entries[n].words, entries[n].count, entries[n].strings);
+		for(size_t i = 0; i < t.len; i++)
+		{
+			errors += benchRing.ring.buffer[(offset + i) & benchRing.ring.mask] != (uint8_t)t.text[i];
+		}
+		offset += t.len;
+	}
+	errors += offset != benchRing.reserved;
+	return errors;
+}
+
+/// A %s that finds the strings buffer full replays as an empty string; the bytes reported are those needed
+static void check_full_strings(void)
+{
+	struct BenchEntry entry;
+	struct BenchText t = { .len = 0 };
+	char first[ENTRY_STRINGS];
+
+	/* The first string and its terminator take the whole buffer */
+	memset(first, 'a', sizeof(first) - 1);
+	first[sizeof(first) - 1] = '\0';
+	message(&entry, "[%s]", first);
+	CHECK(entry.stringsLen == ENTRY_STRINGS); // An exact fit, nothing cut
+	message(&entry, "[%.3s]", first);
+	CHECK(entry.stringsLen == 4); // The precision is not a cut
+	message(&entry, "[%s][%s][%s]", first, "late", (const char *)NULL);
+	CHECK(entry.stringsLen == ENTRY_STRINGS + 5); // What it needed, to count the cut
+	console_wformat(text_sink, &t, entry.format, entry.words, entry.count, entry.strings);
+	t.text[t.len] = '\0';
+	CHECK(t.len == 1 + (ENTRY_STRINGS - 1) + 4 + 6 + 1);
+	CHECK(strncmp(&t.text[ENTRY_STRINGS], "][][(null)]", 11) == 0);
+
+	/* One byte short: the second string is cut to nothing as well */
+	t.len = 0;
+	first[sizeof(first) - 2] = '\0';
+	message(&entry, "[%s][%s]", first, "late");
+	CHECK(entry.stringsLen == ENTRY_STRINGS - 1 + 5);
+	console_wformat(text_sink, &t, entry.format, entry.words, entry.count, entry.strings);
+	t.text[t.len] = '\0';
+	CHECK(t.len == 1 + (ENTRY_STRINGS - 2) + 3);
+}
+
+int main(void)
+{
+	uint64_t immediate = bench_best(bench_run, false);
+	uint64_t capture = bench_best(bench_run, true);
+	uint64_t replay = bench_best(bench_replay_run, false);
+
+	printf("format_bench: vformat+reserve/commit %4u, capture %4u, later wformat %4u %s/message (x%u.%u)\n",
+	       (unsigned)(immediate / BENCH_MESSAGES), (unsigned)(capture / BENCH_MESSAGES),
+	       (unsigned)(replay / BENCH_MESSAGES), BENCH_UNIT, (unsigned)(immediate / (capture ? capture : 1)),
+	       (unsigned)(immediate * 10 / (capture ? capture : 1) % 10));
+	CHECK(capture < immediate);
+	CHECK(check_replay() == 0);
+	check_full_strings();
+	return test_result("format_bench");
+}
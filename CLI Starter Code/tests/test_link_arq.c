@@ -0,0 +1,178 @@
+/**************************************************************************//**
+* @file        test_link_arq.c
+* @brief       Host test of the reliable channel of SerialLink under frame loss.
+* @details     Two links exchange numbered frames in both directions on their
+*				reliable channel over the simulated wire of link_harness.h,
+*				which damages 0 to 50 % of all frames, data and ACKs alike.
+*				Each receiver checks that the frames reach its handler in order
+*				and exactly once, including after the transfer, when nothing more
+*				may arrive. SerialLinkSetLossInjection is exercised the same way,
+*				and so is a peer that restarts, whose first frames may be lost.
+*				Retransmissions and goodput are printed per loss rate.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include "SerialLink.c"
+#include "link_harness.h"
+#include "test.h"
+
+#define FRAMES          400u        ///< Frames sent in each direction
+#define DEADLINE_US     600000000u  ///< Simulated time allowed for one transfer
+#define SETTLE_US       5000000u    ///< Run on after the transfer, for late duplicates
+
+/// Delivery checks of one receiver
+struct Delivery {
+	uint32_t next;   ///< Number of the frame expected next
+	uint32_t errors; ///< Frames out of order, repeated, or with a wrong payload
+};
+
+static struct Delivery delivery[2];
+
+/// Length of frame n, all sizes from 4 to the maximum
+static size_t frame_length(uint32_t n)
+{
+	return 4 + n % (CONF_SERIAL_LINK_MAX_PAYLOAD - 3);
+}
+
+/// Frame n: its number, then bytes derived from it
+static size_t frame_build(uint8_t * payload, uint32_t n)
+{
+	size_t len = frame_length(n);
+
+	memcpy(payload, &n, 4);
+	for(size_t i = 4; i < len; i++)
+	{
+		payload[i] = (uint8_t)(n * 7u + i);
+	}
+	return len;
+}
+
+/// Handler: the frame must be the next one, whole
+static void on_frame(void * ctx, const uint8_t * payload, size_t len)
+{
+	struct Delivery * rx = ctx;
+	uint8_t expected[CONF_SERIAL_LINK_MAX_PAYLOAD];
+	size_t expectedLen = frame_build(expected, rx->next);
+
+	rx->errors += len != expectedLen || memcmp(payload, expected, len) != 0;
+	rx->next++;
+}
+
+/// Makes the bulk channel of link i reliable, as after a start
+static void setup_link(unsigned i, uint16_t injectEvery)
+{
+	SerialLinkSetReliable(&testLink[i], LINK_CHANNEL_BULK);
+	SerialLinkSetHandler(&testLink[i], LINK_CHANNEL_BULK, on_frame, &delivery[i]);
+	SerialLinkSetLossInjection(&testLink[i], injectEvery);
+}
+
+/// Sends frames[i] frames from link i and checks their delivery; returns the time the transfer took
+static uint32_t transfer(const uint32_t frames[2])
+{
+	uint32_t sent[2] = { 0, 0 };
+	uint32_t start = testNowUs;
+	uint8_t payload[CONF_SERIAL_LINK_MAX_PAYLOAD];
+
+	memset(delivery, 0, sizeof(delivery));
+	while((delivery[1].next < frames[0] || delivery[0].next < frames[1]) && testNowUs - start < DEADLINE_US)
+	{
+		for(unsigned i = 0; i < 2; i++)
+		{
+			/* The queue filling up behind a full window is back-pressure, not a loss */
+			while(sent[i] < frames[i] && SerialLinkSend(&testLink[i], LINK_CHANNEL_BULK, payload,
+			                                            frame_build(payload, sent[i])))
+			{
+				sent[i]++;
+			}
+		}
+		harness_step();
+	}
+	uint32_t elapsed = testNowUs - start;
+
+	for(uint32_t settled = testNowUs; testNowUs - settled < SETTLE_US; )
+	{
+		harness_step();
+	}
+	for(unsigned i = 0; i < 2; i++)
+	{
+		CHECK(delivery[i ^ 1].errors == 0);
+		CHECK(delivery[i ^ 1].next == frames[i]);
+		CHECK(testLink[i].arq.txBase == testLink[i].arq.txNext); // Everything acknowledged
+	}
+	return elapsed;
+}
+
+/// Sends FRAMES frames each way over a wire that damages lossPercent % of the frames
+static uint32_t run_transfer(unsigned lossPercent, uint16_t injectEvery, uint32_t seed)
+{
+	static const uint32_t frames[2] = { FRAMES, FRAMES };
+
+	harness_init(lossPercent, seed);
+	setup_link(0, injectEvery);
+	setup_link(1, injectEvery);
+	return transfer(frames);
+}
+
+/// Link 0 restarts after a transfer: link 1 must take its frames from seq 0 again
+static void test_restart(void)
+{
+	static const uint32_t frames[2] = { FRAMES / 4, 0 };
+
+	harness_init(10, 300);
+	setup_link(0, 0);
+	setup_link(1, 0);
+	transfer(frames);
+	uint32_t resyncs = testLink[1].stats.rxResyncs;
+
+	for(unsigned restart = 0; restart < 10; restart++)
+	{
+		SerialLinkInit(&testLink[0], &testChannel[0]);
+		setup_link(0, 0);
+		transfer(frames);
+	}
+	CHECK(testLink[1].stats.rxResyncs == resyncs + 10);
+}
+
+/// Prints the counters of the sender on link 0
+static void report(const char * what, unsigned percent, uint32_t elapsed)
+{
+	struct SerialLinkStats stats;
+
+	SerialLinkGetStats(&testLink[0], &stats);
+	printf("link_arq: %s %2u%%: %4u ms, %4u retransmits, %3u timeouts, %3u duplicates, rto %4u ms, goodput %u%%\n",
+	       what, percent, (unsigned)(elapsed / 1000), (unsigned)stats.txRetransmits, (unsigned)stats.txTimeouts,
+	       (unsigned)testLink[1].stats.rxDuplicates, (unsigned)stats.rtoMs,
+	       (unsigned)(100ull * stats.txPayloadBytes / stats.txWireBytes));
+}
+
+int main(void)
+{
+	static const unsigned lossPercent[] = { 0, 1, 5, 10, 20, 35, 50 };
+
+	for(size_t k = 0; k < sizeof(lossPercent) / sizeof(lossPercent[0]); k++)
+	{
+		uint32_t elapsed = run_transfer(lossPercent[k], 0, 100 + k);
+		report("wire loss", lossPercent[k], elapsed);
+		if(lossPercent[k] == 0)
+		{
+			CHECK(testLink[0].stats.txRetransmits == 0 && testLink[1].stats.rxDuplicates == 0);
+		}
+		else
+		{
+			CHECK(testDamaged > 0 && testLink[0].stats.txRetransmits > 0);
+		}
+	}
+
+	/* The sender's own loss injection: every 7th transmission is skipped */
+	uint32_t elapsed = run_transfer(0, 7, 200);
+	report("injected", 100 / 7, elapsed);
+	CHECK(testLink[0].stats.txInjectedLosses > 0 && testLink[0].stats.txRetransmits > 0);
+
+	test_restart();
+
+	return test_result("link_arq");
+}
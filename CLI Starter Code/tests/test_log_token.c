@@ -0,0 +1,249 @@
+/**************************************************************************//**
+* @file        test_log_token.c
+* @brief       Host test of the tokenized log records, log_token.c, and their decoder.
+* @details     LOG_TEST places its format in LOG_TOKEN_SECTION and encodes the
+*				arguments as the LogModuleMessage macro of a tokenized build does.
+*				log_fmt.ld puts the section at address 0, not loaded, as the
+*				target linker script does, so the tokens are the same small offsets.
+*				Checked here:
+*				- the varint and zigzag encoding of 32-bit and 64-bit integers,
+*				  doubles, strings and NULL, and the cut of a record that does not fit;
+*				- the size of the records of a representative mix of log calls
+*				  against the text printf makes of them, which is printed.
+*				The records are framed as SerialConsoleWriteLogFrame frames them,
+*				between CLI text, into log_token.bin, and the text printf makes
+*				of the same calls goes to log_token.txt. `make check` then runs
+*				tools/log_decode.py on log_token.bin with this binary as the ELF,
+*				and its output must equal log_token.txt.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conf_serial_console.h"
+#include "log_token.h"
+#include "cobs.h"
+#include "crc16.h"
+#include "test.h"
+
+#define RECORD_SIZE     CONF_SERIAL_CONSOLE_LOG_TOKEN_RECORD_SIZE
+#define RECORD_TAG      0xF0u    ///< LOG_TOKEN_RECORD_TAG of SerialConsole.c
+#define FRAME_HEADER    2u       ///< SERIAL_LINK_HEADER_SIZE: channel and sequence number
+#define CHANNEL_LOG     2u       ///< LINK_CHANNEL_LOG
+#define CAPTURE_SIZE    8192u    ///< Bytes of the capture and of the expected text
+
+/// What the UART carries, and what the decoder must make of it
+struct Capture {
+	uint8_t wire[CAPTURE_SIZE];
+	size_t wireLen;
+	char text[CAPTURE_SIZE];
+	size_t textLen;
+	uint8_t seq;            ///< Sequence number of the next frame
+	size_t records;         ///< Records sent
+	size_t recordBytes;     ///< Their level, token and argument bytes
+	size_t frameBytes;      ///< The same framed, with the zero bytes around them
+	size_t formattedBytes;  ///< Text the same calls would have sent
+};
+
+static struct Capture capture;
+
+/// LogModuleMessage of a tokenized build, into the capture
+#define LOG_TEST(level, format, ...) \
+	do { \
+		static const char logFormat[] __attribute__((section(LOG_TOKEN_SECTION), used)) = format; \
+		log_test((level), LOG_TOKEN_ID(logFormat), LOG_TOKEN_TYPES(__VA_ARGS__), format, ##__VA_ARGS__); \
+	} while(0)
+
+/// log_token_encode of the arguments that follow
+static size_t encode(uint8_t * buf, size_t size, uint32_t token, uint32_t types, ...)
+{
+	va_list args;
+
+	va_start(args, types);
+	size_t len = log_token_encode(buf, size, token, types, args);
+	va_end(args);
+	return len;
+}
+
+/// Frames record as SerialConsoleWriteLogFrame does, zero bytes around it, into the capture
+static void capture_frame(const uint8_t * record, size_t len)
+{
+	uint8_t frame[FRAME_HEADER + RECORD_SIZE + 2];
+	size_t frameLen = FRAME_HEADER + len;
+
+	frame[0] = CHANNEL_LOG;
+	frame[1] = capture.seq++;
+	memcpy(&frame[FRAME_HEADER], record, len);
+	uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, frame, frameLen);
+	frame[frameLen++] = (uint8_t)crc;
+	frame[frameLen++] = (uint8_t)(crc >> 8);
+
+	size_t start = capture.wireLen;
+	assert(capture.wireLen + COBS_ENCODED_MAX(frameLen) + 2 <= CAPTURE_SIZE);
+	capture.wire[capture.wireLen++] = 0;
+	capture.wireLen += cobs_encode(frame, frameLen, &capture.wire[capture.wireLen]);
+	capture.wire[capture.wireLen++] = 0;
+	capture.frameBytes += capture.wireLen - start;
+}
+
+/// Appends text the decoder prints of its own accord
+static void expect_text(const char * text)
+{
+	size_t len = strlen(text);
+
+	assert(capture.textLen + len <= CAPTURE_SIZE);
+	memcpy(&capture.text[capture.textLen], text, len);
+	capture.textLen += len;
+}
+
+/// Appends CLI output, passed through by the decoder
+static void capture_text(const char * text)
+{
+	size_t len = strlen(text);
+
+	assert(capture.wireLen + len <= CAPTURE_SIZE);
+	memcpy(&capture.wire[capture.wireLen], text, len);
+	capture.wireLen += len;
+	expect_text(text);
+}
+
+/// Sends one tokenized message into the capture, and the text printf makes of it into the expected text
+static void __attribute__((format(printf, 4, 5))) log_test(unsigned level, uint32_t token, uint32_t types,
+                                                           const char * format, ...)
+{
+	uint8_t record[RECORD_SIZE];
+	va_list args;
+
+	va_start(args, format);
+	record[0] = (uint8_t)(RECORD_TAG + level);
+	size_t len = 1 + log_token_encode(&record[1], sizeof(record) - 1, token, types, args);
+	va_end(args);
+	capture_frame(record, len);
+	capture.records++;
+	capture.recordBytes += len;
+
+	va_start(args, format);
+	int textLen = vsnprintf(&capture.text[capture.textLen], CAPTURE_SIZE - capture.textLen, format, args);
+	va_end(args);
+	assert(textLen >= 0 && capture.textLen + (size_t)textLen < CAPTURE_SIZE);
+	capture.textLen += (size_t)textLen;
+	capture.formattedBytes += (size_t)textLen;
+}
+
+/// The argument encodings, byte by byte
+static void check_encoding(void)
+{
+	uint8_t buf[RECORD_SIZE];
+	size_t len;
+
+	/* Tokens are varints too */
+	CHECK(encode(buf, sizeof(buf), 0x12, LOG_TOKEN_TYPES()) == 1 && buf[0] == 0x12);
+	CHECK(encode(buf, sizeof(buf), 300, LOG_TOKEN_TYPES()) == 2 && buf[0] == 0xAC && buf[1] == 0x02);
+
+	/* Zigzag: small magnitudes of either sign take one byte */
+	CHECK(encode(buf, sizeof(buf), 0, LOG_TOKEN_TYPES(0, -1, 1, -64, 63), 0, -1, 1, -64, 63) == 6);
+	CHECK(memcmp(&buf[1], "\x00\x01\x02\x7F\x7E", 5) == 0);
+	CHECK(encode(buf, sizeof(buf), 0, LOG_TOKEN_TYPES(64, -65), 64, -65) == 5);
+	CHECK(memcmp(&buf[1], "\x80\x01\x81\x01", 4) == 0);
+
+	/* 32-bit extremes: 5 bytes; an unsigned value goes as its signed bit pattern */
+	len = encode(buf, sizeof(buf), 0, LOG_TOKEN_TYPES(INT32_MIN, 0xFFFFFFFFu), INT32_MIN, 0xFFFFFFFFu);
+	CHECK(len == 1 + 5 + 1);
+	CHECK(memcmp(&buf[1], "\xFF\xFF\xFF\xFF\x0F\x01", 6) == 0);
+
+	/* 64-bit: the zigzag of INT64_MIN is all ones, 10 bytes */
+	long long min64 = INT64_MIN;
+	unsigned long long max64 = UINT64_MAX;
+	CHECK(LOG_TOKEN_TYPES(min64, max64) == (2u | LOG_TOKEN_INT64 << 4 | LOG_TOKEN_INT64 << 6));
+	len = encode(buf, sizeof(buf), 0, LOG_TOKEN_TYPES(min64, max64), min64, max64);
+	CHECK(len == 1 + 10 + 1);
+	CHECK(memcmp(&buf[1], "\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x01\x01", 11) == 0);
+
+	/* Doubles, floats promoted: 8 bytes little endian */
+	float f = 1.5f;
+	double d = -2.0;
+	CHECK(LOG_TOKEN_TYPES(f, d) == (2u | LOG_TOKEN_DOUBLE << 4 | LOG_TOKEN_DOUBLE << 6));
+	CHECK(encode(buf, sizeof(buf), 0, LOG_TOKEN_TYPES(f, d), f, d) == 17);
+	CHECK(memcmp(&buf[1], "\x00\x00\x00\x00\x00\x00\xF8\x3F\x00\x00\x00\x00\x00\x00\x00\xC0", 16) == 0);
+
+	/* Strings: length byte and characters; NULL is a lone 0xFF */
+	const char * name = "uart";
+	const char * none = NULL;
+	CHECK(LOG_TOKEN_TYPES(name, none) == (2u | LOG_TOKEN_STRING << 4 | LOG_TOKEN_STRING << 6));
+	CHECK(encode(buf, sizeof(buf), 0, LOG_TOKEN_TYPES(name, none), name, none) == 1 + 5 + 1);
+	CHECK(memcmp(&buf[1], "\x04uart\xFF", 6) == 0);
+
+	/* Too long: the string is cut, and a number that does not fit ends the record */
+	CHECK(encode(buf, 6, 0, LOG_TOKEN_TYPES(name, 1), name, 1) == 6 && memcmp(&buf[1], "\x04uart", 5) == 0);
+	CHECK(encode(buf, 4, 0, LOG_TOKEN_TYPES(name, 1), name, 1) == 4 && memcmp(&buf[1], "\x02ua", 3) == 0);
+	CHECK(encode(buf, 8, 0, LOG_TOKEN_TYPES(1, d), 1, d) == 2);
+	CHECK(encode(buf, 0, 0, LOG_TOKEN_TYPES()) == 0);
+}
+
+/// Log calls of the kind the firmware makes, some CLI text between them
+static void capture_mix(void)
+{
+	static const char * const tasks[] = { "CLI", "Logger", "Control", "WiFi" };
+	const char * volatile missing = NULL; // Not known to be NULL: glibc prints (null), as the decoder does
+
+	LOG_TEST(0, "Boot complete\r\n");
+	capture_text("> help\r\nhelp: lists the commands\r\n> ");
+	for(unsigned n = 0; n < 32; n++)
+	{
+		LOG_TEST(1, "Task %s started, %u words of stack free\r\n", tasks[n % 4], 512u - n * 7u);
+		LOG_TEST(1, "adc ch%u = %d mV\r\n", n % 8u, (int)(n * 37u % 3300u) - 100);
+		LOG_TEST(0, "rx %u bytes, %u overruns, state 0x%08x\r\n", n * 1301u, n % 3u, n * 0x9E3779B9u);
+		LOG_TEST(2, "link %d -> %d (%s), rto %u ms\r\n", (int)(n % 4), (int)((n + 1) % 4), "retransmit", 30u + n);
+		LOG_TEST(1, "temperature %.2f C, vdd %.3f V\r\n", 21.5 + n / 8.0, 3.3f - n / 1000.0f);
+	}
+	capture_text("> constats\r\n");
+	LOG_TEST(3, "offset %d us, drift %d ppm\r\n", -123456, -42);
+	LOG_TEST(1, "uptime %llu us, delta %lld us\r\n", (unsigned long long)UINT64_MAX, (long long)INT64_MIN);
+	LOG_TEST(1, "limits %d %u %x %lld\r\n", INT32_MIN, UINT32_MAX, 0xDEADBEEFu, (long long)INT64_MAX);
+	LOG_TEST(2, "sensor %s: %s, code %c%c, 100%%\r\n", "bme280", missing, 'E', '7');
+	LOG_TEST(1, "%5d|%-6s|%08.3f|%e|%g\r\n", -42, "pad", -3.14159, 6.02214076e23, 0.0001);
+	LOG_TEST(4, "Hard fault at %p\r\n", (void *)(uintptr_t)0x2000F00Cu);
+
+	/* A record lost on the way: the decoder reports the gap in the sequence numbers */
+	capture.seq++;
+	expect_text("[1 log messages lost]\r\n");
+	LOG_TEST(0, "Back after %u drops\r\n", 1u);
+}
+
+/// Writes len bytes of data to path
+static void write_file(const char * path, const void * data, size_t len)
+{
+	FILE * f = fopen(path, "wb");
+
+	CHECK(f != NULL && fwrite(data, 1, len, f) == len);
+	if(f != NULL)
+	{
+		fclose(f);
+	}
+}
+
+int main(void)
+{
+	check_encoding();
+	capture_mix();
+
+	printf("log_token: %u records, %u bytes (%u framed) for %u bytes of text (x%u.%u, x%u.%u framed)\n",
+	       (unsigned)capture.records, (unsigned)capture.recordBytes, (unsigned)capture.frameBytes,
+	       (unsigned)capture.formattedBytes, (unsigned)(capture.formattedBytes / capture.recordBytes),
+	       (unsigned)(capture.formattedBytes * 10 / capture.recordBytes % 10),
+	       (unsigned)(capture.formattedBytes / capture.frameBytes),
+	       (unsigned)(capture.formattedBytes * 10 / capture.frameBytes % 10));
+	CHECK(capture.recordBytes * 2 <= capture.formattedBytes);
+	CHECK(capture.frameBytes * 3 <= capture.formattedBytes * 2);
+
+	write_file("log_token.bin", capture.wire, capture.wireLen);
+	write_file("log_token.txt", capture.text, capture.textLen);
+	return test_result("log_token");
+}
@@ -0,0 +1,215 @@
+/**************************************************************************//**
+* @file        test_mpsc_ring.c
+* @brief       Host test of mpsc_ring: concurrent writers and discards.
+* @details     Writer threads stand in for tasks and interrupts sharing the TX
+*				ring, with a mutex as the critical section (mpsc_test_lock.h).
+*				Each message carries its length, its writer and a per-writer
+*				sequence number, and every body byte is derived from them. The
+*				consumer thread parses the stream and checks that every message
+*				arrives whole, uninterleaved, and in order per writer.
+*
+*				Writers yield between reserving and committing, so reservations
+*				overlap and commits arrive out of order, which is the case the
+*				last-writer-publishes rule exists for.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include <sched.h>
+#include <string.h>
+
+#include "mpsc_ring.h"
+#include "test.h"
+
+#define WRITERS          4      ///< Concurrent writer threads
+#define MESSAGES         50000u ///< Messages per writer
+#define MESSAGE_MAX      40u    ///< Longest message, header included
+#define MESSAGE_HEADER   4u     ///< length | writer | sequence (16 bit)
+
+pthread_mutex_t mpscTestLock = PTHREAD_MUTEX_INITIALIZER;
+
+MPSC_RING_DEFINE(stressRing, 256);
+
+/// Body byte i of message seq from writer w
+static uint8_t body_byte(unsigned w, unsigned seq, size_t i)
+{
+	return (uint8_t)(w * 61u + seq * 7u + i);
+}
+
+/// Length of message seq from writer w, header included
+static size_t message_length(unsigned w, unsigned seq)
+{
+	return MESSAGE_HEADER + (w * 13u + seq) % (MESSAGE_MAX - MESSAGE_HEADER + 1);
+}
+
+/// Builds message seq of writer w into msg; returns its length
+static size_t message_build(uint8_t * msg, unsigned w, unsigned seq)
+{
+	size_t len = message_length(w, seq);
+
+	msg[0] = (uint8_t)len;
+	msg[1] = (uint8_t)w;
+	msg[2] = (uint8_t)seq;
+	msg[3] = (uint8_t)(seq >> 8);
+	for(size_t i = MESSAGE_HEADER; i < len; i++)
+	{
+		msg[i] = body_byte(w, seq, i);
+	}
+	return len;
+}
+
+/// Writer thread: queues MESSAGES messages, retrying while the ring is full
+static void * writer(void * arg)
+{
+	unsigned w = (unsigned)(uintptr_t)arg;
+	uint8_t msg[MESSAGE_MAX];
+
+	for(unsigned seq = 0; seq < MESSAGES; seq++)
+	{
+		size_t len = message_build(msg, w, seq);
+		mpsc_reservation_t res;
+
+		while(!mpsc_ring_reserve(&stressRing, len, &res))
+		{
+			sched_yield();
+		}
+		/* Two pieces, the second one after letting other writers in */
+		size_t half = len / 2;
+		CHECK(mpsc_reservation_write(&res, 0, msg, half) == half);
+		if(seq % 3 == 0)
+		{
+			sched_yield();
+		}
+		CHECK(mpsc_reservation_write(&res, half, msg + half, MESSAGE_MAX) == len - half);
+		mpsc_ring_commit(&stressRing);
+	}
+	return NULL;
+}
+
+/// Consumer thread: parses and checks the messages of all writers
+static void * consumer(void * arg)
+{
+	unsigned next[WRITERS] = { 0 };
+	unsigned long total = 0;
+	unsigned long errors = 0;
+	uint8_t msg[MESSAGE_MAX];
+	size_t have = 0;
+
+	(void)arg;
+	while(total < (unsigned long)WRITERS * MESSAGES)
+	{
+		/* Header first, then the rest of the length it announces */
+		size_t want = (have < 1) ? 1 : msg[0];
+		if(have >= 1 && (want < MESSAGE_HEADER || want > MESSAGE_MAX))
+		{
+			errors++;
+			break;
+		}
+		size_t got = spsc_ring_get_range(&stressRing.ring, msg + have, want - have);
+		if(got == 0)
+		{
+			sched_yield();
+			continue;
+		}
+		have += got;
+		if(have < want || want == 1)
+		{
+			continue;
+		}
+
+		uint8_t expected[MESSAGE_MAX];
+		unsigned w = msg[1];
+		if(w >= WRITERS)
+		{
+			errors++;
+			break;
+		}
+		message_build(expected, w, next[w]++);
+		errors += memcmp(msg, expected, have) != 0;
+		total++;
+		have = 0;
+	}
+	CHECK(errors == 0);
+	CHECK(total == (unsigned long)WRITERS * MESSAGES);
+	return NULL;
+}
+
+/// Single-threaded: reservation bookkeeping and a discard in the middle of the ring
+static void test_reserve_discard(void)
+{
+	MPSC_RING_DEFINE(ring, 16);
+	mpsc_reservation_t a, b, res;
+	mpsc_discard_t discard;
+	uint8_t out[16];
+
+	/* A later reservation committed first is not published before the earlier one */
+	CHECK(!mpsc_ring_reserve(&ring, 0, &a));
+	CHECK(!mpsc_ring_reserve(&ring, 17, &a));
+	CHECK(mpsc_ring_reserve(&ring, 4, &a));
+	CHECK(mpsc_ring_reserve(&ring, 4, &b));
+	mpsc_reservation_fill(&b, (const uint8_t *)"BBBB");
+	CHECK(!mpsc_ring_commit(&ring));
+	CHECK(spsc_ring_empty(&ring.ring));
+	mpsc_reservation_fill(&a, (const uint8_t *)"AAAA");
+	CHECK(mpsc_ring_commit(&ring));
+	CHECK(spsc_ring_size(&ring.ring) == 8);
+	CHECK(mpsc_ring_space(&ring) == 8);
+
+	/* Discards are refused while a reservation is outstanding */
+	CHECK(mpsc_ring_reserve(&ring, 4, &res));
+	CHECK(!mpsc_ring_discard_begin(&ring, 0, 4, &discard));
+	mpsc_reservation_fill(&res, (const uint8_t *)"CCCC");
+	CHECK(mpsc_ring_commit(&ring));
+
+	/* Drop "BBBB": the consumer stops in front of it and writers find no room until the end */
+	CHECK(mpsc_ring_discard_begin(&ring, 4, 8, &discard));
+	CHECK(spsc_ring_size(&ring.ring) == 4);
+	CHECK(mpsc_ring_space(&ring) == 0);
+	CHECK(!mpsc_ring_reserve(&ring, 1, &res));
+	CHECK(!mpsc_ring_discard_begin(&ring, 0, 4, &discard));
+	CHECK(mpsc_ring_discard_end(&ring, &discard));
+	CHECK(spsc_ring_get_range(&ring.ring, out, sizeof(out)) == 8);
+	CHECK(memcmp(out, "AAAACCCC", 8) == 0);
+	CHECK(mpsc_ring_space(&ring) == 16);
+
+	/* Wrapped reservation and a discard whose moved data wraps too */
+	CHECK(mpsc_ring_reserve(&ring, 12, &res)); // Counters 8..20
+	CHECK(res.firstLen == 8 && res.secondLen == 4);
+	mpsc_reservation_fill(&res, (const uint8_t *)"0123456789ab");
+	CHECK(mpsc_ring_commit(&ring));
+	CHECK(mpsc_ring_discard_begin(&ring, 9, 11, &discard));
+	CHECK(mpsc_ring_discard_end(&ring, &discard));
+	CHECK(spsc_ring_get_range(&ring.ring, out, sizeof(out)) == 10);
+	CHECK(memcmp(out, "03456789ab", 10) == 0);
+
+	/* Dropping everything up to the head publishes nothing new */
+	CHECK(mpsc_ring_reserve(&ring, 3, &res));
+	mpsc_reservation_fill(&res, (const uint8_t *)"xyz");
+	CHECK(mpsc_ring_commit(&ring));
+	CHECK(mpsc_ring_discard_begin(&ring, 18, 21, &discard));
+	CHECK(!mpsc_ring_discard_end(&ring, &discard));
+	CHECK(spsc_ring_empty(&ring.ring));
+	CHECK(mpsc_ring_space(&ring) == 16);
+}
+
+int main(void)
+{
+	pthread_t threads[WRITERS + 1];
+
+	test_reserve_discard();
+
+	pthread_create(&threads[WRITERS], NULL, consumer, NULL);
+	for(unsigned w = 0; w < WRITERS; w++)
+	{
+		pthread_create(&threads[w], NULL, writer, (void *)(uintptr_t)w);
+	}
+	for(unsigned w = 0; w <= WRITERS; w++)
+	{
+		pthread_join(threads[w], NULL);
+	}
+
+	return test_result("mpsc_ring");
+}
@@ -0,0 +1,230 @@
+/**************************************************************************//**
+* @file        test_serial_link.c
+* @brief       Host loopback test of SerialLink: frame latency, priorities and goodput.
+* @details     Two links talk over the simulated 115200 baud wire of
+*				link_harness.h. Measured, and checked against what the wire
+*				allows:
+*				- latency of a telemetry frame on an idle link, and of a ping
+*				  round trip;
+*				- latency of telemetry frames while bulk data saturates the link,
+*				  which priorities bound by the TX ring rather than the bulk queue;
+*				- goodput of a bulk transfer, payload bytes over line capacity.
+*				The figures are printed for comparison between changes.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include "SerialLink.c"
+#include "link_harness.h"
+#include "test.h"
+
+#define TELEMETRY_SIZE     32u        ///< Payload of a telemetry frame
+#define TELEMETRY_FRAMES   100u       ///< Frames timed per measurement
+#define TELEMETRY_PERIOD   50000u     ///< Between telemetry frames under load, in us
+#define BULK_US            2000000u   ///< Duration of the bulk transfer
+#define TIMEOUT_US         1000000u   ///< Longest wait for one frame
+
+/// Wire time of a frame with len payload bytes, delimiter included
+#define FRAME_WIRE_US(len) \
+	((COBS_ENCODED_MAX(SERIAL_LINK_HEADER_SIZE + (len) + SERIAL_LINK_CRC_SIZE) + 1) * WIRE_BYTE_US)
+
+/// Frames received on one logical channel
+struct Receiver {
+	uint32_t frames;  ///< Frames received
+	uint32_t bytes;   ///< Payload bytes received
+	uint32_t lastUs;  ///< Arrival of the last one
+	uint32_t errors;  ///< Frames whose payload was not the expected one
+	uint32_t order;   ///< Arrival order, across receivers
+};
+
+static uint32_t arrivals; ///< Frames received on any channel
+
+/// Payload byte i of frame n
+static uint8_t payload_byte(uint32_t n, size_t i)
+{
+	return (uint8_t)(n * 31u + i);
+}
+
+static void fill_payload(uint8_t * payload, uint32_t n, size_t len)
+{
+	for(size_t i = 0; i < len; i++)
+	{
+		payload[i] = payload_byte(n, i);
+	}
+}
+
+/// Handler: checks that the payload is that of the next frame and records its arrival
+static void on_frame(void * ctx, const uint8_t * payload, size_t len)
+{
+	struct Receiver * rx = ctx;
+
+	for(size_t i = 0; i < len; i++)
+	{
+		rx->errors += payload[i] != payload_byte(rx->frames, i);
+	}
+	rx->frames++;
+	rx->bytes += (uint32_t)len;
+	rx->lastUs = testNowUs;
+	rx->order = arrivals++;
+}
+
+/// Control handler: checks that a pong echoes the frame number its ping carried
+static void on_pong(void * ctx, const uint8_t * payload, size_t len)
+{
+	struct Receiver * rx = ctx;
+	uint32_t n = rx->frames;
+
+	rx->errors += len != 5 || payload[0] != LINK_CONTROL_PONG || memcmp(&payload[1], &n, 4) != 0;
+	rx->frames++;
+	rx->lastUs = testNowUs;
+}
+
+/// Runs the links until rx has more than frames frames; returns the time waited
+static uint32_t wait_for_frame(struct Receiver * rx, uint32_t frames)
+{
+	uint32_t start = testNowUs;
+
+	while(rx->frames <= frames && testNowUs - start < TIMEOUT_US)
+	{
+		harness_step();
+	}
+	CHECK(rx->frames > frames);
+	return rx->lastUs - start;
+}
+
+/// Idle link: one telemetry frame at a time, then ping round trips
+static void test_idle_latency(uint32_t * frameUs, uint32_t * pingUs)
+{
+	struct Receiver telemetry = { 0 };
+	struct Receiver pong = { 0 };
+	uint8_t payload[TELEMETRY_SIZE];
+
+	harness_init(0, 1);
+	SerialLinkSetHandler(&testLink[1], LINK_CHANNEL_TELEMETRY, on_frame, &telemetry);
+	SerialLinkSetHandler(&testLink[0], LINK_CHANNEL_CONTROL, on_pong, &pong);
+
+	*frameUs = 0;
+	for(uint32_t n = 0; n < TELEMETRY_FRAMES; n++)
+	{
+		fill_payload(payload, n, sizeof(payload));
+		CHECK(SerialLinkSend(&testLink[0], LINK_CHANNEL_TELEMETRY, payload, sizeof(payload)));
+		uint32_t us = wait_for_frame(&telemetry, n);
+		*frameUs = Max(*frameUs, us);
+	}
+	CHECK(telemetry.errors == 0);
+	/* Picked up within a step, shifted out, delivered, read within a step */
+	CHECK(*frameUs <= FRAME_WIRE_US(TELEMETRY_SIZE) + WIRE_LATENCY_US + 2 * HARNESS_STEP_US);
+
+	/* The peer answers a ping with a pong carrying the same bytes */
+	*pingUs = 0;
+	for(uint32_t n = 0; n < TELEMETRY_FRAMES; n++)
+	{
+		uint8_t ping[5] = { LINK_CONTROL_PING };
+		memcpy(&ping[1], &n, 4);
+		CHECK(SerialLinkSend(&testLink[0], LINK_CHANNEL_CONTROL, ping, sizeof(ping)));
+		uint32_t us = wait_for_frame(&pong, n);
+		*pingUs = Max(*pingUs, us);
+	}
+	CHECK(pong.errors == 0);
+	CHECK(*pingUs <= 2 * (FRAME_WIRE_US(5) + WIRE_LATENCY_US + 2 * HARNESS_STEP_US));
+	CHECK(testLink[1].stats.rxUnhandled == 0);
+}
+
+/// Saturated link: bulk frames queued as fast as they drain, telemetry frames in between
+static void test_priority(uint32_t * frameUs)
+{
+	struct Receiver telemetry = { 0 };
+	struct Receiver bulk = { 0 };
+	uint8_t payload[CONF_SERIAL_LINK_MAX_PAYLOAD];
+	uint32_t bulkSent = 0;
+	uint32_t telemetrySent = 0;
+	uint32_t sentUs = 0;
+
+	harness_init(0, 2);
+	SerialLinkSetHandler(&testLink[1], LINK_CHANNEL_TELEMETRY, on_frame, &telemetry);
+	SerialLinkSetHandler(&testLink[1], LINK_CHANNEL_BULK, on_frame, &bulk);
+
+	/* A bulk frame queued first still goes out after a telemetry frame queued behind it */
+	fill_payload(payload, bulkSent++, sizeof(payload));
+	CHECK(SerialLinkSend(&testLink[0], LINK_CHANNEL_BULK, payload, sizeof(payload)));
+	fill_payload(payload, telemetrySent++, TELEMETRY_SIZE);
+	CHECK(SerialLinkSend(&testLink[0], LINK_CHANNEL_TELEMETRY, payload, TELEMETRY_SIZE));
+	wait_for_frame(&bulk, 0);
+	CHECK(telemetry.frames == 1 && telemetry.order < bulk.order);
+
+	*frameUs = 0;
+	while(telemetrySent <= TELEMETRY_FRAMES && testNowUs - sentUs < TIMEOUT_US)
+	{
+		fill_payload(payload, bulkSent, sizeof(payload));
+		if(SerialLinkSend(&testLink[0], LINK_CHANNEL_BULK, payload, sizeof(payload)))
+		{
+			bulkSent++;
+		}
+		else
+		{
+			testLink[0].stats.txQueueDrops--; // Back-pressure, not a loss
+		}
+
+		if(telemetry.frames == telemetrySent && testNowUs - sentUs >= TELEMETRY_PERIOD)
+		{
+			if(telemetrySent > 1)
+			{
+				*frameUs = Max(*frameUs, telemetry.lastUs - sentUs);
+			}
+			sentUs = testNowUs;
+			fill_payload(payload, telemetrySent++, TELEMETRY_SIZE);
+			CHECK(SerialLinkSend(&testLink[0], LINK_CHANNEL_TELEMETRY, payload, TELEMETRY_SIZE));
+		}
+		harness_step();
+	}
+	CHECK(telemetrySent > TELEMETRY_FRAMES);
+	CHECK(telemetry.errors == 0 && bulk.errors == 0);
+	CHECK(bulk.frames > 2 * telemetry.frames);
+	/* Waits for what is already in the TX ring, never for the bulk queue */
+	CHECK(*frameUs <= (WIRE_TX_RING * WIRE_BYTE_US) + FRAME_WIRE_US(TELEMETRY_SIZE) + WIRE_LATENCY_US +
+	                  2 * HARNESS_STEP_US);
+}
+
+/// Bulk transfer at full speed; returns the goodput in percent of the line capacity
+static unsigned test_goodput(void)
+{
+	struct Receiver bulk = { 0 };
+	uint8_t payload[CONF_SERIAL_LINK_MAX_PAYLOAD];
+	uint32_t bulkSent = 0;
+
+	harness_init(0, 3);
+	SerialLinkSetHandler(&testLink[1], LINK_CHANNEL_BULK, on_frame, &bulk);
+
+	while(testNowUs < BULK_US)
+	{
+		fill_payload(payload, bulkSent, sizeof(payload));
+		if(SerialLinkSend(&testLink[0], LINK_CHANNEL_BULK, payload, sizeof(payload)))
+		{
+			bulkSent++;
+		}
+		harness_step();
+	}
+	CHECK(bulk.errors == 0);
+	CHECK(testLink[1].stats.rxSeqGaps == 0 && testLink[1].stats.rxCrcErrors == 0);
+
+	unsigned goodput = (unsigned)((uint64_t)bulk.bytes * WIRE_BYTE_US * 100u / BULK_US);
+	/* Framing costs 6 bytes per 128: anything much lower means the line sat idle */
+	CHECK(goodput >= 90);
+	return goodput;
+}
+
+int main(void)
+{
+	uint32_t idleUs, pingUs, loadedUs;
+
+	test_idle_latency(&idleUs, &pingUs);
+	test_priority(&loadedUs);
+	unsigned goodput = test_goodput();
+
+	printf("serial_link: telemetry latency %u us idle, %u us under bulk load; ping %u us; goodput %u%%\n",
+	       (unsigned)idleUs, (unsigned)loadedUs, (unsigned)pingUs, goodput);
+	return test_result("serial_link");
+}
@@ -0,0 +1,140 @@
+/**************************************************************************//**
+* @file        test_spsc_bench.c
+* @brief       Host microbenchmark of spsc_ring: range API against the per-byte API.
+* @details     The same stream goes through a ring in chunks, once byte by byte
+*				with spsc_ring_put/spsc_ring_get and once with
+*				spsc_ring_put_range/spsc_ring_get_range, for several chunk
+*				sizes. The chunks do not divide the capacity, so the range calls
+*				cross the wrap-around. Both runs must deliver the stream intact;
+*				the throughput of each, the best of a few repetitions, is printed
+*				in bytes per cycle (bytes per ns without a cycle counter). The
+*				range API must be faster from 16-byte chunks on, and several
+*				times faster from 61.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "spsc_ring.h"
+#include "test.h"
+
+#define BENCH_BYTES     (4u * 1024u * 1024u) ///< Bytes moved per run
+#define BENCH_RUNS      5u                   ///< Repetitions, the best one counts
+#define BENCH_MAX_CHUNK 256u                 ///< Largest chunk
+
+SPSC_RING_DEFINE(benchRing, 1024);
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_UNIT      "cycle"
+/// Time stamp counter
+static uint64_t bench_clock(void)
+{
+	return __rdtsc();
+}
+#else
+#define BENCH_UNIT      "ns"
+static uint64_t bench_clock(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+#endif
+
+/// Byte number i of the stream
+static uint8_t stream_byte(uint32_t i)
+{
+	return (uint8_t)(i ^ (i >> 8) ^ (i >> 16));
+}
+
+/// Moves BENCH_BYTES through the ring in chunks of chunk bytes; returns the clock ticks taken
+static uint64_t bench_run(size_t chunk, bool range, uint32_t * errors)
+{
+	static uint8_t stream[BENCH_BYTES + BENCH_MAX_CHUNK];
+	static uint8_t received[BENCH_BYTES + BENCH_MAX_CHUNK];
+
+	for(uint32_t i = 0; i < BENCH_BYTES; i++)
+	{
+		stream[i] = stream_byte(i);
+	}
+	memset(received, 0, sizeof(received));
+	spsc_ring_reset(&benchRing);
+
+	uint64_t start = bench_clock();
+	for(uint32_t done = 0; done < BENCH_BYTES; done += chunk)
+	{
+		if(range)
+		{
+			spsc_ring_put_range(&benchRing, &stream[done], chunk);
+			spsc_ring_get_range(&benchRing, &received[done], chunk);
+		}
+		else
+		{
+			for(size_t i = 0; i < chunk; i++)
+			{
+				spsc_ring_put(&benchRing, stream[done + i]);
+			}
+			for(size_t i = 0; i < chunk; i++)
+			{
+				spsc_ring_get(&benchRing, &received[done + i]);
+			}
+		}
+	}
+	uint64_t ticks = bench_clock() - start;
+
+	*errors += memcmp(stream, received, BENCH_BYTES) != 0 || !spsc_ring_empty(&benchRing);
+	return ticks;
+}
+
+/// Best throughput of BENCH_RUNS runs, in bytes per 1000 clock ticks
+static uint64_t bench_best(size_t chunk, bool range, uint32_t * errors)
+{
+	uint64_t best = UINT64_MAX;
+
+	for(unsigned run = 0; run < BENCH_RUNS; run++)
+	{
+		uint64_t ticks = bench_run(chunk, range, errors);
+		if(ticks < best)
+		{
+			best = ticks;
+		}
+	}
+	return BENCH_BYTES * 1000ull / (best ? best : 1);
+}
+
+int main(void)
+{
+	static const size_t chunks[] = { 1, 7, 16, 61, 255 };
+	uint32_t errors = 0;
+
+	for(size_t k = 0; k < sizeof(chunks) / sizeof(chunks[0]); k++)
+	{
+		uint64_t perByte = bench_best(chunks[k], false, &errors);
+		uint64_t perRange = bench_best(chunks[k], true, &errors);
+
+		printf("spsc_bench: chunk %3u: put/get %2u.%03u, put_range/get_range %2u.%03u bytes/%s (x%u.%u)\n",
+		       (unsigned)chunks[k], (unsigned)(perByte / 1000), (unsigned)(perByte % 1000),
+		       (unsigned)(perRange / 1000), (unsigned)(perRange % 1000), BENCH_UNIT,
+		       (unsigned)(perRange / perByte), (unsigned)(perRange * 10 / perByte % 10));
+		/* Single bytes are cheaper through the per-byte calls; ranges win from a few bytes on */
+		if(chunks[k] >= 16)
+		{
+			CHECK(perRange > perByte);
+		}
+		if(chunks[k] >= 61)
+		{
+			CHECK(perRange >= 4 * perByte);
+		}
+	}
+	CHECK(errors == 0);
+	return test_result("spsc_bench");
+}
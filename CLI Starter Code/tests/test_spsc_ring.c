@@ -0,0 +1,228 @@
+/**************************************************************************//**
+* @file        test_spsc_ring.c
+* @brief       Host test of spsc_ring: edge cases and a two-thread stress run.
+* @details     The stress run lets a producer and a consumer thread stand in for
+*				the interrupt and the task. Both sides mix the byte, range and
+*				in-place (linear) APIs over a small ring, so the calls cross the
+*				wrap-around often, and the consumer checks that it receives exactly
+*				the sequence the producer generated: no byte lost, duplicated or
+*				reordered.
+*
+* @copyright
+* @author
+* @date        October 17, 2026
+* @version		0.1
+*****************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include "spsc_ring.h"
+#include "test.h"
+
+#define STRESS_BYTES    (4u * 1024u * 1024u) ///< Bytes sent through the ring by the stress run
+#define STRESS_CHUNK    37u                   ///< Largest range moved at once; not a divisor of the capacity
+
+SPSC_RING_DEFINE(stressRing, 64);
+
+/// Byte number i of the stream; not periodic in 256, so a skipped lap is detected
+static uint8_t stream_byte(uint32_t i)
+{
+	return (uint8_t)(i ^ (i >> 8) ^ (i >> 16));
+}
+
+/// Producer thread: rotates through put, put_range and linear_write + produce
+static void * producer(void * arg)
+{
+	uint8_t chunk[STRESS_CHUNK];
+	uint32_t sent = 0;
+	uint32_t turn = 0;
+
+	(void)arg;
+	while(sent < STRESS_BYTES)
+	{
+		size_t want = 1 + (turn * 7) % STRESS_CHUNK;
+		uint32_t before = sent;
+		if(want > STRESS_BYTES - sent)
+		{
+			want = STRESS_BYTES - sent;
+		}
+
+		switch(turn++ % 3)
+		{
+		case 0:
+			if(spsc_ring_put(&stressRing, stream_byte(sent)) == 0)
+			{
+				sent++;
+			}
+			break;
+		case 1:
+			for(size_t i = 0; i < want; i++)
+			{
+				chunk[i] = stream_byte(sent + (uint32_t)i);
+			}
+			sent += (uint32_t)spsc_ring_put_range(&stressRing, chunk, want);
+			break;
+		default:
+		{
+			uint8_t * span;
+			size_t len = spsc_ring_linear_write(&stressRing, &span);
+			if(len > want)
+			{
+				len = want;
+			}
+			for(size_t i = 0; i < len; i++)
+			{
+				span[i] = stream_byte(sent + (uint32_t)i);
+			}
+			spsc_ring_produce(&stressRing, len);
+			sent += (uint32_t)len;
+			break;
+		}
+		}
+		/* Also give way now and then, so that on a single core the two sides
+		 * still meet at every offset rather than only at full and empty */
+		if(sent == before || turn % 13 == 0)
+		{
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+/// Consumer thread: rotates through get, peek + get_range and linear_read + consume
+static void * consumer(void * arg)
+{
+	uint8_t chunk[STRESS_CHUNK];
+	uint8_t peeked[STRESS_CHUNK];
+	uint32_t received = 0;
+	uint32_t turn = 0;
+	unsigned long errors = 0;
+
+	(void)arg;
+	while(received < STRESS_BYTES)
+	{
+		size_t want = 1 + (turn * 5) % STRESS_CHUNK;
+		uint32_t before = received;
+
+		switch(turn++ % 3)
+		{
+		case 0:
+		{
+			uint8_t c;
+			if(spsc_ring_get(&stressRing, &c) == 0)
+			{
+				errors += c != stream_byte(received);
+				received++;
+			}
+			break;
+		}
+		case 1:
+		{
+			/* Only the consumer removes data, so a peek is a lower bound of what follows */
+			size_t seen = spsc_ring_peek(&stressRing, peeked, want);
+			size_t len = spsc_ring_get_range(&stressRing, chunk, want);
+			errors += len < seen || memcmp(peeked, chunk, seen) != 0;
+			for(size_t i = 0; i < len; i++)
+			{
+				errors += chunk[i] != stream_byte(received + (uint32_t)i);
+			}
+			received += (uint32_t)len;
+			break;
+		}
+		default:
+		{
+			uint8_t * span;
+			size_t len = spsc_ring_linear_read(&stressRing, &span);
+			if(len > want)
+			{
+				len = want;
+			}
+			for(size_t i = 0; i < len; i++)
+			{
+				errors += span[i] != stream_byte(received + (uint32_t)i);
+			}
+			spsc_ring_consume(&stressRing, len);
+			received += (uint32_t)len;
+			break;
+		}
+		}
+		if(received == before || turn % 11 == 0)
+		{
+			sched_yield();
+		}
+	}
+	CHECK(errors == 0);
+	return NULL;
+}
+
+/// Single-threaded edge cases: full, empty, wrap-around and in-place access
+static void test_edges(void)
+{
+	SPSC_RING_DEFINE(ring, 8);
+	uint8_t data[16];
+	uint8_t out[16];
+	uint8_t * span;
+
+	for(size_t i = 0; i < sizeof(data); i++)
+	{
+		data[i] = (uint8_t)(0xA0 + i);
+	}
+
+	CHECK(spsc_ring_empty(&ring));
+	CHECK(spsc_ring_get(&ring, out) == -1);
+	CHECK(spsc_ring_get_range(&ring, out, sizeof(out)) == 0);
+	CHECK(spsc_ring_linear_read(&ring, &span) == 0);
+
+	/* Overlong ranges are clipped to the free space */
+	CHECK(spsc_ring_put_range(&ring, data, sizeof(data)) == 8);
+	CHECK(spsc_ring_full(&ring));
+	CHECK(spsc_ring_put(&ring, 0) == -1);
+	CHECK(spsc_ring_linear_write(&ring, &span) == 0);
+
+	/* Wrap: consume 5, add 5, the data now straddles the end of the storage */
+	CHECK(spsc_ring_get_range(&ring, out, 5) == 5);
+	CHECK(memcmp(out, data, 5) == 0);
+	CHECK(spsc_ring_put_range(&ring, data + 8, 5) == 5);
+	CHECK(spsc_ring_size(&ring) == 8);
+	CHECK(spsc_ring_linear_read(&ring, &span) == 3); // Up to the end of the storage
+	CHECK(spsc_ring_peek(&ring, out, sizeof(out)) == 8);
+	CHECK(memcmp(out, data + 5, 8) == 0);
+	CHECK(spsc_ring_size(&ring) == 8);               // Peek removes nothing
+
+	/* In-place write behind the data, up to the tail */
+	CHECK(spsc_ring_get_range(&ring, out, 8) == 8);
+	CHECK(spsc_ring_linear_write(&ring, &span) == 3);
+	memcpy(span, data, 3);
+	spsc_ring_produce(&ring, 3);
+	CHECK(spsc_ring_linear_write(&ring, &span) == 5);
+	CHECK(spsc_ring_get_range(&ring, out, sizeof(out)) == 3);
+	CHECK(memcmp(out, data, 3) == 0);
+
+	/* A producer that cannot be held off: the consumer skips the overwritten bytes */
+	spsc_ring_reset(&ring);
+	for(size_t i = 0; i < 12; i++)
+	{
+		ring.buffer[i & ring.mask] = data[i];
+	}
+	ring.head = 12;
+	CHECK(spsc_ring_size(&ring) == 8);
+	CHECK(spsc_ring_get_range(&ring, out, sizeof(out)) == 8);
+	CHECK(memcmp(out, data + 4, 8) == 0);
+}
+
+int main(void)
+{
+	pthread_t threads[2];
+
+	test_edges();
+
+	pthread_create(&threads[0], NULL, producer, NULL);
+	pthread_create(&threads[1], NULL, consumer, NULL);
+	pthread_join(threads[0], NULL);
+	pthread_join(threads[1], NULL);
+	CHECK(spsc_ring_empty(&stressRing));
+
+	return test_result("spsc_ring");
+}
@@ -0,0 +1,286 @@
+#!/usr/bin/env python3
+"""Decode the console output of a build with CONF_SERIAL_CONSOLE_TOKENIZED_LOG.
+
+Tokenized messages arrive as LINK_CHANNEL_LOG frames (SerialLink.h):
+
+    COBS( header | seq | payload | crc16 ) 0x00
+
+whose payload is a tokenized record (SerialConsole.h, log_token.h):
+
+    0xF0 + level | token (varint) | arguments
+
+The token is the offset of the format string in the .log_fmt section of the
+firmware ELF. Without --link the frames are embedded in plain text, each one
+between two zero bytes, and everything else is passed through unchanged.
+
+Usage:
+    log_decode.py Debug/GccBoardProject3.elf --port COM5 [--baud 115200] [--link]
+    log_decode.py Debug/GccBoardProject3.elf capture.bin
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_SECTION = ".log_fmt"
+CHANNEL_MASK = 0x0F
+FLAG_ACK = 0x20
+FLAG_RELIABLE = 0x10
+CHANNEL_CLI = 1
+CHANNEL_LOG = 2
+RECORD_TAG = 0xF0
+NULL_STRING = 0xFF
+LEVELS = ["INFO", "DEBUG", "WARNING", "ERROR", "FATAL"]
+
+SPEC = re.compile(rb"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L)?([diouxXcspfFeEgGaA%])")
+
+
+def read_formats(path):
+    """Return (address, bytes) of the .log_fmt section of an ELF file."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        raise SystemExit("%s is not an ELF file" % path)
+    is64 = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+    if is64:
+        shoff, = struct.unpack_from(endian + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x3A)
+        header = endian + "IIQQQQ"
+    else:
+        shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x2E)
+        header = endian + "IIIIII"
+
+    sections = [struct.unpack_from(header, elf, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx][4]
+    for name, _type, _flags, addr, offset, size in sections:
+        end = elf.index(b"\0", names + name)
+        if elf[names + name:end].decode() == LOG_SECTION:
+            return addr, elf[offset:offset + size]
+    raise SystemExit("%s has no %s section: was it built with CONF_SERIAL_CONSOLE_TOKENIZED_LOG?"
+                     % (path, LOG_SECTION))
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        run = data[i]
+        i += 1
+        if run == 0 or i + run - 1 > len(data):
+            return None
+        out += data[i:i + run - 1]
+        i += run - 1
+        if run != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Record:
+    """Reads the arguments of one tokenized record."""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def varint(self):
+        value = shift = 0
+        while True:
+            if self.pos >= len(self.data):
+                raise IndexError
+            byte = self.data[self.pos]
+            self.pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    def integer(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def double(self):
+        if self.pos + 8 > len(self.data):
+            raise IndexError
+        value, = struct.unpack_from("<d", self.data, self.pos)
+        self.pos += 8
+        return value
+
+    def string(self):
+        if self.pos >= len(self.data):
+            raise IndexError
+        length = self.data[self.pos]
+        self.pos += 1
+        if length == NULL_STRING:
+            return b"(null)"
+        value = self.data[self.pos:self.pos + length]
+        self.pos += length
+        return value
+
+
+def format_record(fmt, record):
+    """printf fmt with the arguments of record; missing arguments print as <?>."""
+    out = bytearray()
+    pos = 0
+    for m in SPEC.finditer(fmt):
+        out += fmt[pos:m.start()]
+        pos = m.end()
+        flags, width, precision, length, conv = m.groups()
+        conv = conv.decode()
+        if conv == "%":
+            out += b"%"
+            continue
+        try:
+            if width == b"*":
+                width = str(record.integer()).encode()
+            if precision == b"*":
+                precision = str(record.integer()).encode()
+            spec = "%" + flags.decode() + (width or b"").decode()
+            if precision is not None:
+                spec += "." + precision.decode()
+            bits = 64 if length in (b"ll", b"j") else 32
+            if conv in "di":
+                out += (spec + "d").encode() % record.integer()
+            elif conv in "ouxX":
+                value = record.integer() & ((1 << bits) - 1)
+                out += (spec + conv.replace("u", "d")).encode() % value
+            elif conv == "c":
+                out += (spec + "c").encode() % (record.integer() & 0xFF)
+            elif conv == "p":
+                out += b"0x%x" % (record.integer() & 0xFFFFFFFF)
+            elif conv == "s":
+                out += (spec + "s").encode() % record.string()
+            elif conv in "aA":
+                out += record.double().hex().encode()
+            else:
+                out += (spec + conv).encode() % record.double()
+        except IndexError:
+            out += b"<?>"
+    out += fmt[pos:]
+    return bytes(out)
+
+
+class Decoder:
+    def __init__(self, base, formats, link, levels, out):
+        self.base = base
+        self.formats = formats
+        self.link = link
+        self.levels = levels
+        self.out = out
+        self.frame = bytearray()
+        self.in_frame = link
+        self.seq = None
+        self.lost = 0
+
+    def feed(self, data):
+        for byte in data:
+            if byte == 0:
+                self.delimiter()
+            elif self.in_frame:
+                self.frame.append(byte)
+            else:
+                self.out.write(bytes([byte]))
+        self.out.flush()
+
+    def delimiter(self):
+        if not self.in_frame:
+            self.in_frame = True  # Leading zero of an embedded frame
+            return
+        if not self.frame:
+            return  # Trailing zero of the last frame followed by a leading one
+        raw = bytes(self.frame)
+        self.frame.clear()
+        if self.handle(raw):
+            self.in_frame = self.link
+        elif not self.link:
+            self.out.write(raw)  # Text after a lost zero; this zero may lead the next frame
+
+    def handle(self, raw):
+        frame = cobs_decode(raw)
+        if frame is None or len(frame) < 4:
+            return False
+        if crc16_ccitt(frame[:-2]) != frame[-2] | frame[-1] << 8:
+            return False
+        header, seq, payload = frame[0], frame[1], frame[2:-2]
+        channel = header & CHANNEL_MASK
+        if header & FLAG_ACK:
+            return True
+        if channel == CHANNEL_CLI:
+            self.out.write(payload)
+        elif channel == CHANNEL_LOG:
+            if not header & FLAG_RELIABLE:
+                self.count_lost(seq)
+            if payload and payload[0] & 0xF0 == RECORD_TAG:
+                self.out.write(self.decode(payload))
+            else:
+                self.out.write(payload)
+        return True
+
+    def count_lost(self, seq):
+        if self.seq is not None:
+            gap = (seq - self.seq - 1) & 0xFF
+            if 0 < gap < 128:
+                self.lost += gap
+                self.out.write(b"[%d log messages lost]\r\n" % gap)
+        self.seq = seq
+
+    def decode(self, payload):
+        level = payload[0] & 0x0F
+        record = Record(payload[1:])
+        try:
+            offset = record.varint() - self.base
+        except IndexError:
+            return b"<truncated log record>\r\n"
+        if not 0 <= offset < len(self.formats):
+            return b"<unknown log token 0x%x: wrong ELF?>\r\n" % (offset + self.base)
+        fmt = self.formats[offset:self.formats.index(b"\0", offset)]
+        text = format_record(fmt, record)
+        if self.levels and level < len(LEVELS):
+            text = b"[" + LEVELS[level].encode() + b"] " + text
+        return text
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("elf", help="firmware ELF holding the .log_fmt section")
+    parser.add_argument("capture", nargs="?", help="file with captured UART bytes (default: stdin)")
+    parser.add_argument("--port", help="read from this serial port instead (needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate of --port")
+    parser.add_argument("--link", action="store_true", help="the console runs CONF_SERIAL_CONSOLE_LINK")
+    parser.add_argument("--levels", action="store_true", help="prefix decoded messages with their level")
+    args = parser.parse_args()
+
+    base, formats = read_formats(args.elf)
+    decoder = Decoder(base, formats, args.link, args.levels, sys.stdout.buffer)
+
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            try:
+                while True:
+                    decoder.feed(port.read(256))
+            except KeyboardInterrupt:
+                pass
+    else:
+        source = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+        with source:
+            while True:
+                data = source.read(4096)
+                if not data:
+                    break
+                decoder.feed(data)
+
+
+if __name__ == "__main__":
+    main()